@@ -275,6 +275,26 @@ init_agent_read_config(const char *app)
     netsnmp_ds_register_config(ASN_INTEGER, app, "maxGetbulkResponses",
                                NETSNMP_DS_APPLICATION_ID,
                                NETSNMP_DS_AGENT_MAX_GETBULKRESPONSES);
+    netsnmp_ds_register_config(ASN_BOOLEAN, app, "coalesceRequests",
+                               NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_COALESCE_REQUESTS);
+    netsnmp_ds_register_config(ASN_BOOLEAN, app, "lazyInit",
+                               NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_LAZY_INIT);
+    register_app_config_handler("responseCache",
+                                snmpd_parse_config_response_cache,
+                                snmpd_free_response_cache,
+                                "OID TTL\t\t(TTL in milliseconds)");
+    register_app_config_handler("responseCacheMaxEntries",
+                                snmpd_parse_config_response_cache_max, NULL,
+                                "NUM");
+    register_app_config_handler("rateLimit",
+                                snmpd_parse_config_rate_limit,
+                                snmpd_free_rate_limits,
+                                "[-p PRIORITY] source|secName NAME RATE [BURST]");
+    register_app_config_handler("rateLimitTotal",
+                                snmpd_parse_config_rate_limit_total, NULL,
+                                "RATE [BURST]");
     netsnmp_init_handler_conf();
 
 #include "agent_module_dot_conf.h"
@@ -304,6 +324,19 @@ snmpd_register_config_handler(const char *token,
     register_app_config_handler(token, parser, releaser, help);
 }
 
+void
+snmpd_register_config_handler_incremental(const char *token,
+                                          void (*parser) (const char *, char *),
+                                          void (*remover) (const char *, char *),
+                                          void (*releaser) (void),
+                                          const char *help)
+{
+    DEBUGMSGTL(("snmpd_register_app_config_handler",
+                "registering incremental .conf token for \"%s\"\n", token));
+    register_app_config_handler_incremental(token, parser, remover, releaser,
+                                            help);
+}
+
 void
 snmpd_register_const_config_handler(const char *token,
                                     void (*parser) (const char *, const char *),
@@ -2155,6 +2155,48 @@ netsnmp_acm_check_subtree(netsnmp_pdu *pdu, oid *name, size_t namelen)
     return 1;
 }
 
+/** Finds the name of the read view that applies to the given PDU.
+ *  Two requests with the same context and view name are guaranteed to
+ *  see the same MIB contents.
+ *
+ * @param pdu     PDU requesting access
+ *
+ * @return the view name, or NULL if access control is bypassed or no
+ *         access control module could resolve it.  The string belongs
+ *         to the access control module and is only valid until the
+ *         configuration is next changed.
+ */
+const char *
+netsnmp_acm_view_name(netsnmp_pdu *pdu)
+{
+    struct view_parameters view_parms;
+    view_parms.pdu = pdu;
+    view_parms.name = NULL;
+    view_parms.namelen = 0;
+    view_parms.errorcode = 0;
+    view_parms.check_subtree = 0;
+    view_parms.view_name = NULL;
+
+    if (pdu->flags & UCD_MSG_FLAG_ALWAYS_IN_VIEW)
+        return NULL;
+
+    switch (pdu->version) {
+#ifndef NETSNMP_DISABLE_SNMPV1
+    case SNMP_VERSION_1:
+#endif
+#ifndef NETSNMP_DISABLE_SNMPV2C
+    case SNMP_VERSION_2c:
+#endif
+    case SNMP_VERSION_3:
+        snmp_call_callbacks(SNMP_CALLBACK_APPLICATION,
+                            SNMPD_CALLBACK_ACM_CHECK_INITIAL, &view_parms);
+        if (view_parms.errorcode)
+            return NULL;
+        return view_parms.view_name;
+    }
+    return NULL;
+}
+
 netsnmp_feature_child_of(get_session_for_oid,netsnmp_unused)
 #ifndef NETSNMP_FEATURE_REMOVE_GET_SESSION_FOR_OID
 netsnmp_session *
@@ -2178,6 +2220,164 @@ get_session_for_oid(const oid *name, size_t len, const char *context_name)
 }
 #endif /* NETSNMP_FEATURE_REMOVE_GET_SESSION_FOR_OID */
 
+/** @defgroup agent_lazy_init Deferring expensive module initialization.
+ *  Modules can register their subtrees straight away but leave loading
+ *  their data until the first request for one of those subtrees.
+ *  With "lazyInit yes" the deferred work is done on first access;
+ *  otherwise it is all done once the configuration has been read.
+ *   @ingroup agent_registry
+ *
+ * @{
+ */
+
+typedef struct lazy_init_s {
+    char           *name;
+    oid            *root;
+    size_t          root_len;
+    void            (*init_fn)(void *);
+    void           *magic;
+    struct lazy_init_s *next;
+} lazy_init;
+
+static lazy_init *lazy_inits = NULL;
+static int      lazy_init_config_read = 0;
+
+static void
+_lazy_init_run(lazy_init *li)
+{
+    DEBUGMSGTL(("agent_registry:lazy", "running deferred init for %s\n",
+                li->name));
+    (*li->init_fn)(li->magic);
+    free(li->name);
+    free(li->root);
+    free(li);
+}
+
+static void
+_lazy_init_run_all(void)
+{
+    lazy_init      *li;
+
+    while ((li = lazy_inits) != NULL) {
+        lazy_inits = li->next;
+        _lazy_init_run(li);
+    }
+}
+
+static int
+_lazy_init_post_config(int majorID, int minorID, void *serverarg,
+                       void *clientarg)
+{
+    lazy_init_config_read = 1;
+    if (!netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                                NETSNMP_DS_AGENT_LAZY_INIT))
+        _lazy_init_run_all();
+    return SNMPERR_SUCCESS;
+}
+
+/** Registers work to be done before the first request for a subtree.
+ *
+ * @param name     name of the module, for debugging
+ * @param root     OID of the subtree that needs the work done
+ * @param root_len length of root
+ * @param init_fn  function doing the work
+ * @param magic    passed to init_fn
+ *
+ * Until the agent configuration has been read, the work is always
+ * queued, since whether it should be deferred isn't known yet.  After
+ * that, it runs straight away unless "lazyInit" is set.
+ *
+ * @return SNMPERR_SUCCESS, or SNMPERR_GENERR if no memory.
+ */
+int
+netsnmp_register_lazy_init(const char *name, const oid *root,
+                           size_t root_len, void (*init_fn)(void *),
+                           void *magic)
+{
+    static int      callback_registered = 0;
+    lazy_init      *li;
+
+    if (lazy_init_config_read &&
+        !netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                                NETSNMP_DS_AGENT_LAZY_INIT)) {
+        (*init_fn)(magic);
+        return SNMPERR_SUCCESS;
+    }
+
+    li = SNMP_MALLOC_TYPEDEF(lazy_init);
+    if (!li)
+        return SNMPERR_GENERR;
+    li->name = strdup(name ? name : "");
+    li->root = snmp_duplicate_objid(root, root_len);
+    if (!li->name || !li->root) {
+        free(li->name);
+        free(li);
+        return SNMPERR_GENERR;
+    }
+    li->root_len = root_len;
+    li->init_fn = init_fn;
+    li->magic = magic;
+    li->next = lazy_inits;
+    lazy_inits = li;
+
+    if (!callback_registered) {
+        snmp_register_callback(SNMP_CALLBACK_LIBRARY,
+                               SNMP_CALLBACK_POST_READ_CONFIG,
+                               _lazy_init_post_config, NULL);
+        callback_registered = 1;
+    }
+
+    DEBUGMSGTL(("agent_registry:lazy", "deferring init for %s at ", name));
+    DEBUGMSGOID(("agent_registry:lazy", root, root_len));
+    DEBUGMSG(("agent_registry:lazy", "\n"));
+    return SNMPERR_SUCCESS;
+}
+
+/** Drops deferred work that hasn't been run yet, e.g. because the
+ *  data it would load is being freed.
+ */
+void
+netsnmp_unregister_lazy_init(void (*init_fn)(void *), void *magic)
+{
+    lazy_init      *li, **prevNext;
+
+    for (prevNext = &lazy_inits; (li = *prevNext) != NULL; ) {
+        if (li->init_fn == init_fn && li->magic == magic) {
+            *prevNext = li->next;
+            free(li->name);
+            free(li->root);
+            free(li);
+            continue;
+        }
+        prevNext = &li->next;
+    }
+}
+
+/** Runs any deferred work for the given subtree, ahead of a request
+ *  being passed to it.
+ */
+void
+netsnmp_lazy_init_subtree(netsnmp_subtree *tp)
+{
+    lazy_init      *li, **prevNext;
+
+    for (prevNext = &lazy_inits; (li = *prevNext) != NULL; ) {
+        if (netsnmp_oid_is_subtree(li->root, li->root_len,
+                                   tp->start_a, tp->start_len) == 0 ||
+            netsnmp_oid_is_subtree(tp->start_a, tp->start_len,
+                                   li->root, li->root_len) == 0) {
+            *prevNext = li->next;
+            _lazy_init_run(li);
+            /* the init function may have changed the list */
+            prevNext = &lazy_inits;
+            continue;
+        }
+        prevNext = &li->next;
+    }
+}
+
+/** @} */
+
 void
 setup_tree(void)
 {
@@ -2234,6 +2434,15 @@ shutdown_tree(void) {
     remove_tree_entry(iso, 1);
     remove_tree_entry(ccitt, 1);
 
+    while (lazy_inits) {
+        lazy_init      *li = lazy_inits;
+
+        lazy_inits = li->next;
+        free(li->name);
+        free(li->root);
+        free(li);
+    }
+
 }
 
 extern void     dump_idx_registry(void);
@@ -22,6 +22,15 @@
 
 #include <net-snmp/agent/cache_handler.h>
 
+#ifdef NETSNMP_REENTRANT
+#include <pthread.h>
+#include <fcntl.h>
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <net-snmp/library/fd_event_manager.h>
+#endif /* NETSNMP_REENTRANT */
+
 netsnmp_feature_child_of(cache_handler, mib_helpers)
 
 netsnmp_feature_child_of(cache_find_by_oid, cache_handler)
@@ -30,6 +39,11 @@ netsnmp_feature_child_of(cache_get_head, cache_handler)
 static netsnmp_cache  *cache_head = NULL;
 static int             cache_outstanding_valid = 0;
 static int             _cache_load( netsnmp_cache *cache );
+static void            _cache_preload( void *cache );
+static void            _cache_background_reload(unsigned int regNo,
+                                                void *clientargs);
+static int             _cache_load_submit(netsnmp_cache *cache);
+static void            _cache_load_orphan(netsnmp_cache *cache);
 
 #define CACHE_RELEASE_FREQUENCY 60      /* Check for expired caches every 60s */
 
@@ -93,6 +107,36 @@ void            release_cached_resources(unsigned int regNo,
  *  not be used if cache is not synchronized automatically as it would
  *  result in stale cache information when if polling happens too fast.
  *
+ *  If NETSNMP_CACHE_STALE_WHILE_REVALIDATE is set, a request finding the
+ *  cache expired is answered from the old contents, and the reload is
+ *  done from the main loop right after the request has been processed.
+ *  The expired contents are used for at most max_stale seconds (or
+ *  another timeout period if that is 0) past the timeout; after that the
+ *  cache is reloaded before the request is processed, as usual. This
+ *  removes the reload time from the response time of the request that
+ *  happens to find the cache expired, at the price of serving data that
+ *  is a little older. The load routine will not get a cache_hint for a
+ *  background reload. Note that the "background" reload is a zero-delay
+ *  snmp_alarm, run by the agent's main loop: unless the cache is also
+ *  NETSNMP_CACHE_LOAD_THREAD_SAFE and the agent was built with
+ *  --enable-reentrant (see below), it still blocks the agent while it
+ *  runs, and requests arriving meanwhile wait for it as before.
+ *
+ *  If NETSNMP_CACHE_LOAD_THREAD_SAFE is set, the load_cache routine
+ *  builds the new contents from scratch and stores them in the magic
+ *  field of the cache structure it is passed, which starts out NULL;
+ *  it must not touch any data the agent may be using meanwhile, nor
+ *  call library functions that aren't thread safe; that includes
+ *  logging (snmp_log, DEBUGMSG) and looking up containers by name.
+ *  Leave such work to whatever uses the contents. The free_cache
+ *  routine must free the contents it is passed as its second argument.
+ *  The agent installs the new contents in place of the old ones once
+ *  the load has succeeded. In an agent built with --enable-reentrant,
+ *  background reloads (NETSNMP_CACHE_AUTO_RELOAD and
+ *  NETSNMP_CACHE_STALE_WHILE_REVALIDATE) of such caches are run by a
+ *  small pool of worker threads, and requests keep using the old
+ *  contents until the new ones are installed.
+ *
  *
  *  Here are some suggestions for some common situations.
  *
@@ -253,9 +297,17 @@ netsnmp_cache_free(netsnmp_cache *cache)
         }
     }
 
+    netsnmp_unregister_lazy_init(_cache_preload, cache);
+
     if(0 != cache->timer_id)
         netsnmp_cache_timer_stop(cache);
 
+    if(0 != cache->reload_id)
+        snmp_alarm_unregister(cache->reload_id);
+
+    if(NULL != cache->load_job)
+        _cache_load_orphan(cache);
+
     if (cache->valid)
         _cache_free(cache);
 
@@ -310,7 +362,8 @@ _timer_reload(unsigned int regNo, void *clientargs)
 
     cache->expired = 1;
 
-    _cache_load(cache);
+    if (_cache_load_submit(cache) != 0)
+        _cache_load(cache);
 }
 
 /** starts the recurring cache_load callback */
@@ -384,10 +437,16 @@ netsnmp_cache_handler_get(netsnmp_cache* cache)
         if(NULL != cache) {
             if ((cache->flags & NETSNMP_CACHE_PRELOAD) && ! cache->valid) {
                 /*
-                 * load cache, ignore rc
-                 * (failed load doesn't affect registration)
+                 * load cache once the config has been read, or on
+                 * first access with "lazyInit yes"
                  */
-                (void)_cache_load(cache);
+                if (cache->rootoid)
+                    netsnmp_register_lazy_init("cache_handler",
+                                               cache->rootoid,
+                                               cache->rootoid_len,
+                                               _cache_preload, cache);
+                else
+                    _cache_preload(cache);
             }
             if (cache->flags & NETSNMP_CACHE_AUTO_RELOAD)
                 netsnmp_cache_timer_start(cache);
@@ -530,6 +589,22 @@ netsnmp_cache_check_expired(netsnmp_cache *cache)
     return cache->expired;
 }
 
+/*
+ * Can an expired cache still be used until a background reload?
+ */
+static int
+_cache_stale_ok(netsnmp_cache *cache)
+{
+    int max_stale;
+
+    if (!(cache->flags & NETSNMP_CACHE_STALE_WHILE_REVALIDATE) ||
+        !cache->valid || (NULL == cache->timestampM) || (cache->timeout <= 0))
+        return 0;
+    max_stale = cache->max_stale > 0 ? cache->max_stale : cache->timeout;
+    return !netsnmp_ready_monotonic(cache->timestampM,
+                                    1000 * (cache->timeout + max_stale));
+}
+
 /** Reload the cache if required */
 int
 netsnmp_cache_check_and_reload(netsnmp_cache * cache)
@@ -538,8 +613,24 @@ netsnmp_cache_check_and_reload(netsnmp_cache * cache)
         DEBUGMSGT(("helper:cache_handler", " no cache\n"));
         return 0;	/* ?? or -1 */
     }
-    if (!cache->valid || netsnmp_cache_check_expired(cache))
+    if (!cache->valid || netsnmp_cache_check_expired(cache)) {
+        if (cache->valid && (NULL != cache->load_job)) {
+            DEBUGMSGT(("helper:cache_handler", " reload in progress\n"));
+            return 0;
+        }
+        if (_cache_stale_ok(cache)) {
+            if (0 == cache->reload_id)
+                cache->reload_id = snmp_alarm_register(0, 0,
+                                                _cache_background_reload,
+                                                cache);
+            if (0 != cache->reload_id) {
+                DEBUGMSGT(("helper:cache_handler",
+                           " expired, reloading in background\n"));
+                return 0;
+            }
+        }
         return _cache_load( cache );
+    }
     else {
         DEBUGMSGT(("helper:cache_handler", " cached (%d)\n",
                    cache->timeout));
@@ -656,10 +747,8 @@ netsnmp_cache_helper_handler(netsnmp_mib_handler * handler,
          */
     case MODE_SET_COMMIT:
         if (cache->valid && 
-            ! (cache->flags & NETSNMP_CACHE_DONT_INVALIDATE_ON_SET) ) {
-            cache->free_cache(cache, cache->magic);
-            cache->valid = 0;
-        }
+            ! (cache->flags & NETSNMP_CACHE_DONT_INVALIDATE_ON_SET) )
+            _cache_free(cache);
         /** next handler called automatically - 'AUTO_NEXT' */
         break;
 #endif /* NETSNMP_NO_WRITE_SUPPORT */
@@ -681,7 +770,32 @@ _cache_free( netsnmp_cache *cache )
     if (NULL != cache->free_cache) {
         cache->free_cache(cache, cache->magic);
         cache->valid = 0;
+        if (cache->flags & NETSNMP_CACHE_LOAD_THREAD_SAFE)
+            cache->magic = NULL;
+    }
+}
+
+static void _cache_loaded( netsnmp_cache *cache );
+
+/*
+ * replace the contents of a NETSNMP_CACHE_LOAD_THREAD_SAFE cache by
+ * those built by a load into a copy of it
+ */
+static int
+_cache_install( netsnmp_cache *cache, void *magic, int ret )
+{
+    void *old = cache->magic;
+
+    if (ret < 0) {
+        /* keep the old contents, if any, and try again later */
+        DEBUGMSGT(("helper:cache_handler", " load failed (%d)\n", ret));
+        return ret;
     }
+    cache->magic = magic;
+    if (cache->valid && (NULL != cache->free_cache))
+        cache->free_cache(cache, old);
+    _cache_loaded(cache);
+    return ret;
 }
 
 static int
@@ -689,6 +803,15 @@ _cache_load( netsnmp_cache *cache )
 {
     int ret = -1;
 
+    if (cache->flags & NETSNMP_CACHE_LOAD_THREAD_SAFE) {
+        netsnmp_cache shadow = *cache;
+
+        shadow.magic = NULL;
+        if ( cache->load_cache)
+            ret = cache->load_cache(&shadow, NULL);
+        return _cache_install(cache, shadow.magic, ret);
+    }
+
     /*
      * If we've got a valid cache, then release it before reloading
      */
@@ -703,6 +826,14 @@ _cache_load( netsnmp_cache *cache )
         cache->valid = 0;
         return ret;
     }
+    _cache_loaded(cache);
+    return ret;
+}
+
+/* bookkeeping after a successful load */
+static void
+_cache_loaded( netsnmp_cache *cache )
+{
     cache->valid = 1;
     cache->expired = 0;
 
@@ -718,8 +849,208 @@ _cache_load( netsnmp_cache *cache )
     }
     netsnmp_set_monotonic_marker(&cache->timestampM);
     DEBUGMSGT(("helper:cache_handler", " loaded (%d)\n", cache->timeout));
+}
 
-    return ret;
+/** callback function to reload an expired cache after the request
+ *  that found it expired has been answered */
+static void
+_cache_background_reload(unsigned int regNo, void *clientargs)
+{
+    netsnmp_cache *cache = (netsnmp_cache *)clientargs;
+
+    cache->reload_id = 0;
+    if (cache->valid && !netsnmp_cache_check_expired(cache))
+        return;                 /* reloaded meanwhile */
+    DEBUGMSGT(("helper:cache_handler", "background reload of %p\n", cache));
+    cache->cache_hint = NULL;
+    if (_cache_load_submit(cache) != 0)
+        (void)_cache_load(cache);
+}
+
+#ifdef NETSNMP_REENTRANT
+/*
+ * Worker threads for loading NETSNMP_CACHE_LOAD_THREAD_SAFE caches.
+ *
+ * A job holds a copy of the cache for the load routine to fill in.
+ * Finished jobs are handed back to the main loop through a pipe, and
+ * installed there, so request processing never sees a partial load.
+ */
+#define CACHE_LOAD_THREADS 2
+
+typedef struct cache_load_job_s {
+    netsnmp_cache             *cache;   /* NULL if freed meanwhile */
+    netsnmp_cache              shadow;
+    int                        rc;
+    struct cache_load_job_s   *next;
+} cache_load_job;
+
+static pthread_mutex_t cache_load_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  cache_load_cond = PTHREAD_COND_INITIALIZER;
+static cache_load_job *cache_load_queue = NULL, *cache_load_done = NULL;
+static int             cache_load_pipe[2] = { -1, -1 };
+static int             cache_load_threads = 0;
+
+static void *
+_cache_load_worker(void *arg)
+{
+    cache_load_job *job;
+
+    pthread_mutex_lock(&cache_load_lock);
+    for (;;) {
+        while (NULL == cache_load_queue)
+            pthread_cond_wait(&cache_load_cond, &cache_load_lock);
+        job = cache_load_queue;
+        cache_load_queue = job->next;
+        pthread_mutex_unlock(&cache_load_lock);
+
+        job->rc = job->shadow.load_cache(&job->shadow, NULL);
+
+        pthread_mutex_lock(&cache_load_lock);
+        job->next = cache_load_done;
+        cache_load_done = job;
+        if (write(cache_load_pipe[1], "", 1) < 0) {
+            /* pipe full: the main loop has been woken up already */
+        }
+    }
+    return NULL;
+}
+
+/* install the results of finished jobs (called from the main loop) */
+static void
+_cache_load_finished(int fd, void *data)
+{
+    cache_load_job *job, *next;
+    char            buf[64];
+
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+    pthread_mutex_lock(&cache_load_lock);
+    job = cache_load_done;
+    cache_load_done = NULL;
+    pthread_mutex_unlock(&cache_load_lock);
+
+    for (; job; job = next) {
+        next = job->next;
+        if (NULL == job->cache) {
+            if ((job->rc >= 0) && (NULL != job->shadow.free_cache))
+                job->shadow.free_cache(&job->shadow, job->shadow.magic);
+        } else {
+            DEBUGMSGT(("helper:cache_handler", "installing load of %p\n",
+                       job->cache));
+            job->cache->load_job = NULL;
+            (void)_cache_install(job->cache, job->shadow.magic, job->rc);
+        }
+        free(job);
+    }
+}
+
+static int
+_cache_load_start_threads(void)
+{
+    pthread_attr_t attr;
+    pthread_t      tid;
+    int            i;
+
+    if (pipe(cache_load_pipe) < 0) {
+        snmp_log(LOG_ERR, "cache_handler: can't create load pipe\n");
+        return -1;
+    }
+    fcntl(cache_load_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(cache_load_pipe[1], F_SETFL, O_NONBLOCK);
+    if (register_readfd(cache_load_pipe[0], _cache_load_finished, NULL) != 0)
+        goto fail;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for (i = 0; i < CACHE_LOAD_THREADS; i++)
+        if (pthread_create(&tid, &attr, _cache_load_worker, NULL) == 0)
+            ++cache_load_threads;
+    pthread_attr_destroy(&attr);
+    if (cache_load_threads > 0) {
+        DEBUGMSGTL(("helper:cache_handler", "started %d load threads\n",
+                    cache_load_threads));
+        return 0;
+    }
+    snmp_log(LOG_ERR, "cache_handler: can't start load threads\n");
+    unregister_readfd(cache_load_pipe[0]);
+  fail:
+    close(cache_load_pipe[0]);
+    close(cache_load_pipe[1]);
+    cache_load_pipe[0] = cache_load_pipe[1] = -1;
+    return -1;
+}
+
+/*
+ * queue a background load of a thread safe cache
+ *
+ * @return 0 if the load is (already) queued, -1 if it must be done
+ *         by the caller
+ */
+static int
+_cache_load_submit(netsnmp_cache *cache)
+{
+    cache_load_job *job, **pos;
+
+    if (!(cache->flags & NETSNMP_CACHE_LOAD_THREAD_SAFE) ||
+        (NULL == cache->load_cache))
+        return -1;
+    if (NULL != cache->load_job)
+        return 0;
+    if ((0 == cache_load_threads) && (_cache_load_start_threads() != 0))
+        return -1;
+
+    job = SNMP_MALLOC_TYPEDEF(cache_load_job);
+    if (NULL == job)
+        return -1;
+    job->cache = cache;
+    job->shadow = *cache;
+    job->shadow.magic = NULL;
+    job->shadow.cache_hint = NULL;
+    job->shadow.timestampM = NULL;
+    job->shadow.rootoid = NULL;
+    job->shadow.rootoid_len = 0;
+    job->shadow.next = job->shadow.prev = NULL;
+    job->shadow.load_job = NULL;
+    cache->load_job = job;
+    DEBUGMSGT(("helper:cache_handler", "queueing load of %p\n", cache));
+
+    pthread_mutex_lock(&cache_load_lock);
+    for (pos = &cache_load_queue; *pos; pos = &(*pos)->next)
+        ;
+    *pos = job;
+    pthread_cond_signal(&cache_load_cond);
+    pthread_mutex_unlock(&cache_load_lock);
+    return 0;
+}
+
+/* the cache is going away: drop the results of its pending load */
+static void
+_cache_load_orphan(netsnmp_cache *cache)
+{
+    ((cache_load_job *)cache->load_job)->cache = NULL;
+    cache->load_job = NULL;
+}
+#else /* !NETSNMP_REENTRANT */
+static int
+_cache_load_submit(netsnmp_cache *cache)
+{
+    return -1;
+}
+
+static void
+_cache_load_orphan(netsnmp_cache *cache)
+{
+}
+#endif /* !NETSNMP_REENTRANT */
+
+static void
+_cache_preload( void *cache )
+{
+    /*
+     * ignore rc (failed load doesn't affect registration)
+     */
+    if (! ((netsnmp_cache *)cache)->valid)
+        (void)_cache_load((netsnmp_cache *)cache);
 }
 
 
@@ -750,7 +1081,7 @@ release_cached_resources(unsigned int regNo, void *clientargs)
              * Otherwise, note that we still have at
              *   least one active cache.
              */
-            if (netsnmp_cache_check_expired(cache)) {
+            if (netsnmp_cache_check_expired(cache) && !_cache_stale_ok(cache)) {
                 if(! (cache->flags & NETSNMP_CACHE_DONT_FREE_EXPIRED))
                     _cache_free(cache);
             } else {
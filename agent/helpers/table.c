@@ -1288,3 +1288,111 @@ netsnmp_table_next_column(netsnmp_table_request_info *table_info)
     
     return 0; /* out of range */
 }
+
+static void
+_table_cursor_source(netsnmp_agent_request_info *reqinfo,
+                     const u_char **source, size_t *source_len)
+{
+    *source = NULL;
+    *source_len = 0;
+    if (reqinfo && reqinfo->asp && reqinfo->asp->pdu &&
+        reqinfo->asp->pdu->transport_data) {
+        *source = (const u_char *) reqinfo->asp->pdu->transport_data;
+        *source_len = reqinfo->asp->pdu->transport_data_length;
+    }
+}
+
+static void
+_table_cursor_reset(netsnmp_table_cursor *cursor)
+{
+    if (cursor->data && cursor->free_data)
+        (cursor->free_data) (cursor->data);
+    SNMP_FREE(cursor->source);
+    memset(cursor, 0, sizeof(*cursor));
+}
+
+/*
+ * find the cursor of a walk by this manager which ended at name
+ *
+ * @return the cursor, or NULL if this request doesn't continue a walk
+ */
+netsnmp_table_cursor *
+netsnmp_table_cursor_find(netsnmp_table_cursors *cursors,
+                          netsnmp_agent_request_info *reqinfo,
+                          const oid *name, size_t name_len)
+{
+    netsnmp_table_cursor *cursor;
+    const u_char   *source;
+    size_t          source_len;
+    int             i;
+
+    if (!cursors || !name)
+        return NULL;
+    _table_cursor_source(reqinfo, &source, &source_len);
+    for (i = 0; i < NETSNMP_TABLE_CURSOR_MAX; i++) {
+        cursor = &cursors->cursor[i];
+        if (cursor->name_len == name_len && cursor->source_len == source_len &&
+            (0 == source_len || 0 == memcmp(cursor->source, source,
+                                            source_len)) &&
+            0 == snmp_oid_compare(cursor->name, cursor->name_len,
+                                  name, name_len)) {
+            DEBUGMSGTL(("table:cursor", "continuing walk at slot %d\n", i));
+            cursor->last_used = ++cursors->clock;
+            return cursor;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * record that the walk of this manager has now reached name. cursor
+ * is the one returned by netsnmp_table_cursor_find for this request,
+ * or NULL to start a new walk, replacing the least recently used one.
+ *
+ * @return the cursor, for the caller to update its position
+ */
+netsnmp_table_cursor *
+netsnmp_table_cursor_save(netsnmp_table_cursors *cursors,
+                          netsnmp_table_cursor *cursor,
+                          netsnmp_agent_request_info *reqinfo,
+                          const oid *name, size_t name_len)
+{
+    const u_char   *source;
+    size_t          source_len;
+    int             i;
+
+    if (!cursors || !name || name_len > MAX_OID_LEN)
+        return NULL;
+    if (!cursor) {
+        cursor = &cursors->cursor[0];
+        for (i = 1; i < NETSNMP_TABLE_CURSOR_MAX; i++)
+            if (cursors->cursor[i].last_used < cursor->last_used)
+                cursor = &cursors->cursor[i];
+        _table_cursor_reset(cursor);
+        _table_cursor_source(reqinfo, &source, &source_len);
+        if (source_len) {
+            cursor->source = (u_char *) netsnmp_memdup(source, source_len);
+            if (!cursor->source)
+                return NULL;
+            cursor->source_len = source_len;
+        }
+        cursor->last_used = ++cursors->clock;
+    }
+    memcpy(cursor->name, name, name_len * sizeof(oid));
+    cursor->name_len = name_len;
+    return cursor;
+}
+
+/*
+ * forget all walks, eg because the table has changed
+ */
+void
+netsnmp_table_cursors_clear(netsnmp_table_cursors *cursors)
+{
+    int             i;
+
+    if (!cursors)
+        return;
+    for (i = 0; i < NETSNMP_TABLE_CURSOR_MAX; i++)
+        _table_cursor_reset(&cursors->cursor[i]);
+}
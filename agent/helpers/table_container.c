@@ -63,6 +63,9 @@ typedef struct container_table_data_s {
    /* what type of key do we want? */
    char            key_type;
 
+   /* where recent walks ended (data: iterator at that row) */
+   netsnmp_table_cursors *cursors;
+
 } container_table_data;
 
 /** @defgroup table_container table_container
@@ -279,8 +282,13 @@ netsnmp_container_table_data_clone(container_table_data *tad)
 static void
 netsnmp_container_table_data_free(container_table_data *tad)
 {
-    if (--tad->refcnt == 0)
+    if (--tad->refcnt == 0) {
+        if (tad->cursors) {
+            netsnmp_table_cursors_clear(tad->cursors);
+            free(tad->cursors);
+        }
 	free(tad);
+    }
 }
 
 /** returns a netsnmp_mib_handler object for the table_container helper */
@@ -577,6 +585,102 @@ _set_key( container_table_data * tad, netsnmp_request_info *request,
 }
 
 
+/*
+ * walk cursors: an iterator left at the row a manager's walk last
+ * returned, so the following GETNEXT costs one ITERATOR_NEXT. Only
+ * for netsnmp_index keys without duplicates, and only while the
+ * container hasn't changed.
+ */
+static void
+_cursor_release(void *data)
+{
+    netsnmp_iterator *it = (netsnmp_iterator *) data;
+
+    ITERATOR_RELEASE(it);
+}
+
+NETSNMP_STATIC_INLINE int
+_cursor_usable(container_table_data *tad)
+{
+    return (TABLE_CONTAINER_KEY_NETSNMP_INDEX == tad->key_type &&
+            NULL != tad->table->get_iterator &&
+            !(tad->table->flags & CONTAINER_KEY_ALLOW_DUPLICATES));
+}
+
+static netsnmp_index *
+_cursor_next_row(container_table_data *tad,
+                 netsnmp_agent_request_info *agtreq_info,
+                 netsnmp_request_info *request,
+                 netsnmp_table_request_info *tblreq_info,
+                 netsnmp_table_cursor **cursor)
+{
+    netsnmp_iterator *it;
+    netsnmp_index *row;
+    unsigned int nc;
+
+    *cursor = netsnmp_table_cursor_find(tad->cursors, agtreq_info,
+                                        request->requestvb->name,
+                                        request->requestvb->name_length);
+    if (NULL == *cursor)
+        return NULL;
+    it = (netsnmp_iterator *) (*cursor)->data;
+    if (NULL == it || it->sync != tad->table->sync) {
+        *cursor = NULL;
+        return NULL;
+    }
+    row = (netsnmp_index *) ITERATOR_NEXT(it);
+    if ((NULL == row) && (0 != (nc = netsnmp_table_next_column(tblreq_info)))) {
+        tblreq_info->colnum = nc;
+        row = (netsnmp_index *) ITERATOR_FIRST(it);
+    }
+    if (NULL == row)
+        *cursor = NULL;
+    return row;
+}
+
+static void
+_cursor_save(container_table_data *tad,
+             netsnmp_agent_request_info *agtreq_info,
+             netsnmp_request_info *request, netsnmp_index *row,
+             netsnmp_table_cursor *cursor)
+{
+    netsnmp_variable_list *var = request->requestvb;
+    netsnmp_iterator *it;
+
+    if (NULL != cursor) {
+        /* the iterator has moved along with the walk */
+        netsnmp_table_cursor_save(tad->cursors, cursor, agtreq_info,
+                                  var->name, var->name_length);
+        return;
+    }
+
+    /*
+     * a new walk can be followed from the first row of a column on
+     */
+    if (CONTAINER_FIRST(tad->table) != row)
+        return;
+    if (NULL == tad->cursors) {
+        tad->cursors = SNMP_MALLOC_TYPEDEF(netsnmp_table_cursors);
+        if (NULL == tad->cursors)
+            return;
+    }
+    it = CONTAINER_ITERATOR(tad->table);
+    if (NULL == it)
+        return;
+    if (ITERATOR_FIRST(it) != row) {
+        ITERATOR_RELEASE(it);
+        return;
+    }
+    cursor = netsnmp_table_cursor_save(tad->cursors, NULL, agtreq_info,
+                                       var->name, var->name_length);
+    if (NULL == cursor) {
+        ITERATOR_RELEASE(it);
+        return;
+    }
+    cursor->data = it;
+    cursor->free_data = _cursor_release;
+}
+
 NETSNMP_STATIC_INLINE void
 _data_lookup(netsnmp_handler_registration *reginfo,
             netsnmp_agent_request_info *agtreq_info,
@@ -584,6 +688,7 @@ _data_lookup(netsnmp_handler_registration *reginfo,
 {
     netsnmp_index *row = NULL;
     netsnmp_table_request_info *tblreq_info;
+    netsnmp_table_cursor *cursor = NULL;
     netsnmp_variable_list *var;
     netsnmp_index index;
     void *key;
@@ -612,7 +717,12 @@ _data_lookup(netsnmp_handler_registration *reginfo,
          * column, if necessary.
          */
         _set_key( tad, request, tblreq_info, &key, &index );
-        row = (netsnmp_index*)_find_next_row(tad->table, tblreq_info, key);
+        if (_cursor_usable(tad))
+            row = _cursor_next_row(tad, agtreq_info, request, tblreq_info,
+                                   &cursor);
+        if (NULL == row)
+            row = (netsnmp_index*)_find_next_row(tad->table, tblreq_info,
+                                                 key);
         if (row) {
             /*
              * update indexes in tblreq_info (index & varbind),
@@ -634,6 +744,9 @@ _data_lookup(netsnmp_handler_registration *reginfo,
                 netsnmp_table_build_oid_from_index(reginfo, request,
                                                    tblreq_info);
             }
+
+            if (_cursor_usable(tad))
+                _cursor_save(tad, agtreq_info, request, row, cursor);
         }
         else {
             /*
@@ -52,6 +52,10 @@ netsnmp_feature_child_of(table_data_row_first, table_data_extras)
  *  for or accept data for.  Complex GETNEXT handling is greatly
  *  simplified in this case.
  *
+ *  Rows are kept in a doubly linked list, in index order, for walking
+ *  the table. They are also indexed by a container, so that adding a
+ *  row and looking one up don't have to search the list.
+ *
  *  @{
  */
 
@@ -61,6 +65,66 @@ netsnmp_feature_child_of(table_data_row_first, table_data_extras)
  *
  * ================================== */
 
+/*
+ * compares two rows by index
+ */
+static int
+_row_compare(const void *lhs, const void *rhs)
+{
+    const netsnmp_table_row *l = (const netsnmp_table_row *) lhs;
+    const netsnmp_table_row *r = (const netsnmp_table_row *) rhs;
+
+    return snmp_oid_compare(l->index_oid, l->index_oid_len,
+                            r->index_oid, r->index_oid_len);
+}
+
+/*
+ * returns the row index of a table, creating it if needed. Rows which
+ * are already in the list (from before the index existed) are added.
+ */
+static netsnmp_container *
+_table_data_container(netsnmp_table_data *table)
+{
+    netsnmp_table_row *row;
+
+    if (table->container)
+        return table->container;
+
+    table->container = netsnmp_container_find("table_data:btree:binary_array");
+    if (NULL == table->container) {
+        snmp_log(LOG_ERR, "couldn't create row index for table %s\n",
+                 table->name ? table->name : "");
+        return NULL;
+    }
+    table->container->container_name = strdup("table_data");
+    table->container->compare = _row_compare;
+    for (row = table->first_row; row; row = row->next)
+        if (row->index_oid)
+            CONTAINER_INSERT(table->container, row);
+
+    return table->container;
+}
+
+/*
+ * returns the first row with an index greater than instance
+ */
+static netsnmp_table_row *
+_table_data_next(netsnmp_table_data *table, oid *instance, size_t len)
+{
+    netsnmp_container *c;
+    netsnmp_table_row key;
+
+    if (!table->first_row)
+        return NULL;
+    c = _table_data_container(table);
+    if (!c)
+        return NULL;
+
+    key.index_oid = instance;
+    key.index_oid_len = len;
+    return (netsnmp_table_row *) CONTAINER_NEXT(c, &key);
+}
+
 /*
  * generates the index portion of an table oid from a varlist.
  */
@@ -156,8 +220,8 @@ int
 netsnmp_table_data_add_row(netsnmp_table_data *table,
                            netsnmp_table_row *row)
 {
-    int rc, dup = 0;
-    netsnmp_table_row *nextrow = NULL, *prevrow;
+    netsnmp_container *c;
+    netsnmp_table_row *nextrow, *prevrow;
 
     if (!row || !table)
         return SNMPERR_GENERR;
@@ -181,42 +245,11 @@ netsnmp_table_data_add_row(netsnmp_table_data *table,
         return SNMPERR_GENERR;
     }
 
-    /*
-     * check for simple append
-     */
-    if ((prevrow = table->last_row) != NULL) {
-        rc = snmp_oid_compare(prevrow->index_oid, prevrow->index_oid_len,
-                              row->index_oid, row->index_oid_len);
-        if (0 == rc)
-            dup = 1;
-    }
-    else
-        rc = 1;
-    
-    /*
-     * if no last row, or newrow < last row, search the table and
-     * insert it into the table in the proper oid-lexographical order 
-     */
-    if (rc > 0) {
-        for (nextrow = table->first_row, prevrow = NULL;
-             nextrow != NULL; prevrow = nextrow, nextrow = nextrow->next) {
-            if (NULL == nextrow->index_oid) {
-                DEBUGMSGT(("table_data_add_data", "row doesn't have index!\n"));
-                /** xxx-rks: remove invalid row? */
-                continue;
-            }
-            rc = snmp_oid_compare(nextrow->index_oid, nextrow->index_oid_len,
-                                  row->index_oid, row->index_oid_len);
-            if(rc > 0)
-                break;
-            if (0 == rc) {
-                dup = 1;
-                break;
-            }
-        }
-    }
+    c = _table_data_container(table);
+    if (NULL == c)
+        return SNMPERR_GENERR;
 
-    if (dup) {
+    if (CONTAINER_FIND(c, row)) {
         /*
          * exact match.  Duplicate entries illegal 
          */
@@ -224,6 +257,20 @@ netsnmp_table_data_add_row(netsnmp_table_data *table,
                  "duplicate table data attempted to be entered. row exists\n");
         return SNMPERR_GENERR;
     }
+    if (CONTAINER_INSERT(c, row))
+        return SNMPERR_GENERR;
+
+    /*
+     * link it in before the next larger row, or at the end. Appending
+     * is the common case, so check that first.
+     */
+    prevrow = table->last_row;
+    if (prevrow && _row_compare(prevrow, row) < 0)
+        nextrow = NULL;
+    else {
+        nextrow = (netsnmp_table_row *) CONTAINER_NEXT(c, row);
+        prevrow = nextrow ? nextrow->prev : table->last_row;
+    }
 
     /*
      * ok, we have the location of where it should go 
@@ -273,6 +320,10 @@ netsnmp_table_data_remove_row(netsnmp_table_data *table,
     if (!row || !table)
         return NULL;
 
+    if (table->container && row->index_oid &&
+        CONTAINER_FIND(table->container, row) == row)
+        CONTAINER_REMOVE(table->container, row);
+
     if (row->prev)
         row->prev->next = row->next;
     else
@@ -337,6 +388,8 @@ netsnmp_table_data_delete_table( netsnmp_table_data *table )
         /* Can't delete table-specific entry memory */
     }
     table->first_row = NULL;
+    if (table->container)
+        CONTAINER_FREE(table->container);
 
     SNMP_FREE(table->name);
     SNMP_FREE(table);
@@ -546,34 +599,13 @@ netsnmp_table_data_helper_handler(netsnmp_mib_handler *handler,
                 row = table->first_row;
             } else {
                 /*
-                 * loop through all rows looking for the first one
-                 * that is equal to the request or greater than it 
+                 * find the first row greater than the request
                  */
-                for (row = table->first_row; row; row = row->next) {
-                    /*
-                     * compare the index of the request to the row 
-                     */
-                    result =
-                        snmp_oid_compare(row->index_oid,
-                                         row->index_oid_len,
+                row = _table_data_next(table,
                                          request->requestvb->name + 2 +
                                          reginfo->rootoid_len,
                                          request->requestvb->name_length -
                                          2 - reginfo->rootoid_len);
-                    if (result == 0) {
-                        /*
-                         * equal match, return the next row 
-                         */
-                        row = row->next;
-                        break;
-                    } else if (result > 0) {
-                        /*
-                         * the current row is greater than the
-                         * request, use it 
-                         */
-                        break;
-                    }
-                }
             }
             if (!row) {
                 table_info->colnum++;
@@ -871,30 +903,26 @@ netsnmp_table_row *
 netsnmp_table_data_get_from_oid(netsnmp_table_data *table,
                                 oid * searchfor, size_t searchfor_len)
 {
-    netsnmp_table_row *row;
-    if (!table)
+    netsnmp_container *c;
+    netsnmp_table_row key;
+
+    if (!table || !table->first_row)
+        return NULL;
+    c = _table_data_container(table);
+    if (!c)
         return NULL;
 
-    for (row = table->first_row; row != NULL; row = row->next) {
-        if (row->index_oid &&
-            snmp_oid_compare(searchfor, searchfor_len,
-                             row->index_oid, row->index_oid_len) == 0)
-            return row;
-    }
-    return NULL;
+    key.index_oid = searchfor;
+    key.index_oid_len = searchfor_len;
+    return (netsnmp_table_row *) CONTAINER_FIND(c, &key);
 }
 
 int
 netsnmp_table_data_num_rows(netsnmp_table_data *table)
 {
-    int i=0;
-    netsnmp_table_row *row;
-    if (!table)
+    if (!table || !table->first_row || !_table_data_container(table))
         return 0;
-    for (row = table->first_row; row; row = row->next) {
-        i++;
-    }
-    return i;
+    return CONTAINER_SIZE(table->container);
 }
 
     /* =====================================
@@ -937,18 +965,9 @@ netsnmp_table_row *
 netsnmp_table_data_row_next_byoid(netsnmp_table_data *table,
                                   oid *instance, size_t len)
 {
-    netsnmp_table_row *row;
-
     if (!table || !instance)
         return NULL;
-    
-    for (row = table->first_row; row; row = row->next) {
-        if (snmp_oid_compare(row->index_oid,
-                             row->index_oid_len,
-                             instance, len) > 0)
-            return row;
-    }
-    return NULL;
+    return _table_data_next(table, instance, len);
 }
 
 netsnmp_table_row *
@@ -78,6 +78,15 @@
         then the free_loop_context_at_end pointer should be set, which
         is more efficient since a malloc/free will only be performed
         once for every iteration.
+
+    Since every GETNEXT request costs a pass over all the rows, a
+    full walk of a large table is quadratic.  If the data contexts
+    stay valid between requests (typically because they point into
+    data held by a cache handler registered for the same table),
+    setting NETSNMP_ITERATOR_FLAG_SNAPSHOT in the flags makes the
+    helper build a sorted snapshot of the row indexes once per cache
+    load, and answer GET and GETNEXT requests by a binary search of
+    it.  Tables without a cache can set snapshot_timeout instead.
  *
  *  @{
  */
@@ -111,6 +120,9 @@ netsnmp_feature_child_of(table_iterator_row_count, table_iterator_all)
 netsnmp_feature_require(data_list_get_list_node)
 netsnmp_feature_require(oid_stash_add_data)
 #endif /* NETSNMP_FEATURE_REQUIRE_STASH_CACHE */
+netsnmp_feature_require(cache_find_by_oid)
+
+static void _ti_snapshot_free(netsnmp_iterator_info *iinfo);
 
 /* ==================================
  *
@@ -160,6 +172,7 @@ netsnmp_iterator_delete_table( netsnmp_iterator_info *iinfo )
     if (!iinfo)
         return;
 
+    _ti_snapshot_free(iinfo);
     if (iinfo->indexes) {
         snmp_free_varbind( iinfo->indexes );
         iinfo->indexes = NULL;
@@ -434,6 +447,346 @@ netsnmp_iterator_remember(netsnmp_request_info *request,
     return ti_info;
 }    
 
+/*
+ * Sorted snapshot of the row indexes (NETSNMP_ITERATOR_FLAG_SNAPSHOT).
+ *
+ * Walking a table through the data point hooks costs a full pass over
+ * the rows for each GETNEXT.  With a snapshot the pass is made once,
+ * the resulting indexes are sorted, and each GET or GETNEXT is a
+ * binary search.  The data contexts are kept for as long as the
+ * snapshot, so they must remain valid until the table's cache is
+ * reloaded (or snapshot_timeout expires).
+ */
+typedef struct ti_snapshot_row_s {
+    oid            *index;
+    size_t          index_len;
+    size_t          offset;     /* in oids, until the buffer is final */
+    void           *data_context;
+} ti_snapshot_row;
+
+typedef struct ti_snapshot_s {
+    ti_snapshot_row *rows;
+    size_t          count;
+    oid            *oids;
+    netsnmp_cache  *cache;          /* cache the snapshot follows */
+    struct timeval  cache_loaded;   /* its load time when built */
+    marker_t        built;
+    long            transid;
+    netsnmp_table_cursors cursors;  /* pos: row last returned */
+} ti_snapshot;
+
+static void
+_ti_snapshot_free(netsnmp_iterator_info *iinfo)
+{
+    ti_snapshot    *snap = (ti_snapshot *) iinfo->snapshot;
+    size_t          i;
+
+    if (!snap)
+        return;
+    if (iinfo->free_data_context)
+        for (i = 0; i < snap->count; i++)
+            if (snap->rows[i].data_context)
+                (iinfo->free_data_context) (snap->rows[i].data_context,
+                                            iinfo);
+    netsnmp_table_cursors_clear(&snap->cursors);
+    SNMP_FREE(snap->rows);
+    SNMP_FREE(snap->oids);
+    SNMP_FREE(snap->built);
+    free(snap);
+    iinfo->snapshot = NULL;
+}
+
+static int
+_ti_snapshot_row_compare(const void *a, const void *b)
+{
+    const ti_snapshot_row *ra = (const ti_snapshot_row *) a;
+    const ti_snapshot_row *rb = (const ti_snapshot_row *) b;
+
+    return snmp_oid_compare(ra->index, ra->index_len,
+                            rb->index, rb->index_len);
+}
+
+static int
+_ti_snapshot_valid(ti_snapshot *snap, netsnmp_iterator_info *iinfo,
+                   netsnmp_cache *cache, long transid)
+{
+    if (cache || snap->cache) {
+        return (cache == snap->cache && cache->valid && cache->timestampM &&
+                timercmp((struct timeval *) cache->timestampM,
+                         &snap->cache_loaded, ==));
+    }
+    if (iinfo->snapshot_timeout > 0)
+        return !netsnmp_ready_monotonic(snap->built,
+                                        iinfo->snapshot_timeout * 1000);
+    return transid && transid == snap->transid;
+}
+
+/* make sure iinfo->snapshot holds the current set of rows */
+static ti_snapshot *
+_ti_snapshot_get(netsnmp_handler_registration *reginfo,
+                 netsnmp_agent_request_info *reqinfo,
+                 netsnmp_iterator_info *iinfo,
+                 netsnmp_variable_list *indexes)
+{
+    ti_snapshot    *snap = (ti_snapshot *) iinfo->snapshot;
+    netsnmp_cache  *cache;
+    netsnmp_variable_list *index_search, *free_this_index_search;
+    void           *loop_context = NULL, *last_loop_context;
+    void           *data_context = NULL;
+    oid             index[MAX_OID_LEN];
+    size_t          index_len, oids_used = 0, oids_size = 0, rows_size = 0;
+    size_t          i;
+    long            transid = 0;
+
+    cache = netsnmp_cache_find_by_oid(reginfo->rootoid, reginfo->rootoid_len);
+    if (reqinfo->asp && reqinfo->asp->pdu)
+        transid = reqinfo->asp->pdu->transid;
+    if (snap && _ti_snapshot_valid(snap, iinfo, cache, transid))
+        return snap;
+
+    _ti_snapshot_free(iinfo);
+    snap = SNMP_MALLOC_TYPEDEF(ti_snapshot);
+    if (!snap)
+        return NULL;
+    iinfo->snapshot = snap;
+    snap->transid = transid;
+    netsnmp_set_monotonic_marker(&snap->built);
+    if (cache && cache->valid && cache->timestampM) {
+        snap->cache = cache;
+        snap->cache_loaded = *(struct timeval *) cache->timestampM;
+    }
+
+    free_this_index_search = index_search = snmp_clone_varbind(indexes);
+    if (!index_search)
+        return snap;
+
+    DEBUGMSGTL(("table_iterator", "building snapshot for %s\n",
+                reginfo->handlerName));
+    index_search = (iinfo->get_first_data_point) (&loop_context,
+                                                  &data_context,
+                                                  index_search, iinfo);
+    while (index_search) {
+        free_this_index_search = index_search;
+        if (!data_context && iinfo->make_data_context)
+            data_context = (iinfo->make_data_context) (loop_context, iinfo);
+
+        if (build_oid_noalloc(index, MAX_OID_LEN, &index_len, NULL, 0,
+                              index_search) == SNMPERR_SUCCESS) {
+            if (snap->count == rows_size) {
+                ti_snapshot_row *rows;
+
+                rows_size = rows_size ? rows_size * 2 : 64;
+                rows = (ti_snapshot_row *)
+                    realloc(snap->rows, rows_size * sizeof(*rows));
+                if (!rows)
+                    break;
+                snap->rows = rows;
+            }
+            if (oids_used + index_len > oids_size) {
+                oid            *oids;
+
+                oids_size = oids_size ? oids_size * 2 : 256;
+                if (oids_size < oids_used + index_len)
+                    oids_size = oids_used + index_len;
+                oids = (oid *) realloc(snap->oids, oids_size * sizeof(oid));
+                if (!oids)
+                    break;
+                snap->oids = oids;
+            }
+            memcpy(&snap->oids[oids_used], index, index_len * sizeof(oid));
+            snap->rows[snap->count].offset = oids_used;
+            snap->rows[snap->count].index_len = index_len;
+            snap->rows[snap->count].data_context = data_context;
+            snap->count++;
+            oids_used += index_len;
+        } else if (data_context && iinfo->free_data_context) {
+            (iinfo->free_data_context) (data_context, iinfo);
+        }
+        data_context = NULL;
+
+        last_loop_context = loop_context;
+        index_search = (iinfo->get_next_data_point) (&loop_context,
+                                                     &data_context,
+                                                     index_search, iinfo);
+        if (iinfo->free_loop_context && last_loop_context &&
+            data_context != last_loop_context)
+            (iinfo->free_loop_context) (last_loop_context, iinfo);
+    }
+    if (index_search && data_context && iinfo->free_data_context)
+        (iinfo->free_data_context) (data_context, iinfo);   /* out of memory */
+    if (loop_context && iinfo->free_loop_context_at_end)
+        (iinfo->free_loop_context_at_end) (loop_context, iinfo);
+    snmp_free_varbind(free_this_index_search);
+
+    for (i = 0; i < snap->count; i++)
+        snap->rows[i].index = &snap->oids[snap->rows[i].offset];
+    if (snap->count > 1)
+        qsort(snap->rows, snap->count, sizeof(ti_snapshot_row),
+              _ti_snapshot_row_compare);
+    DEBUGMSGTL(("table_iterator", "snapshot for %s has %" NETSNMP_PRIz
+                "d rows\n", reginfo->handlerName, snap->count));
+    return snap;
+}
+
+/* returns the first row whose index is greater than (or, if exact is
+   set, equal to) the given one */
+static ti_snapshot_row *
+_ti_snapshot_search(ti_snapshot *snap, const oid *index, size_t index_len,
+                    int exact)
+{
+    size_t          lo = 0, hi = snap->count, mid;
+    int             rc;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        rc = snmp_oid_compare(snap->rows[mid].index,
+                              snap->rows[mid].index_len, index, index_len);
+        if (rc < 0 || (rc == 0 && !exact))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == snap->count)
+        return NULL;
+    if (exact && snmp_oid_compare(snap->rows[lo].index,
+                                  snap->rows[lo].index_len,
+                                  index, index_len) != 0)
+        return NULL;
+    return &snap->rows[lo];
+}
+
+/* fills in the TI_REQUEST_CACHE of GET and GETNEXT requests from the
+   snapshot, in place of the walk through the data point hooks */
+static int
+_ti_snapshot_lookup(netsnmp_handler_registration *reginfo,
+                    netsnmp_agent_request_info *reqinfo,
+                    netsnmp_request_info *requests,
+                    netsnmp_iterator_info *iinfo,
+                    oid *coloid, size_t coloid_len)
+{
+    netsnmp_table_request_info *table_info = NULL;
+    netsnmp_request_info *request;
+    netsnmp_variable_list *indexes;
+    netsnmp_table_cursor *cursor;
+    ti_snapshot    *snap;
+    ti_snapshot_row *row;
+    ti_cache_info  *ti_info;
+    oid            *name;
+    size_t          name_len, cmp_len;
+    int             rc;
+
+    for (request = requests; request; request = request->next)
+        if (!request->processed &&
+            (table_info = netsnmp_extract_table_info(request)) != NULL)
+            break;
+    if (!table_info)
+        return SNMP_ERR_NOERROR;
+
+    indexes = iinfo->indexes ? iinfo->indexes : table_info->indexes;
+    snap = _ti_snapshot_get(reginfo, reqinfo, iinfo, indexes);
+    if (!snap)
+        return SNMP_ERR_GENERR;
+
+    for (request = requests; request; request = request->next) {
+        if (request->processed)
+            continue;
+        table_info = netsnmp_extract_table_info(request);
+        if (table_info == NULL)
+            return SNMP_ERR_GENERR;
+        name = request->requestvb->name;
+        name_len = request->requestvb->name_length;
+        row = NULL;
+        cursor = NULL;
+        if (reqinfo->mode == MODE_GETNEXT && iinfo->table_reginfo &&
+            table_info->colnum < iinfo->table_reginfo->min_column)
+            table_info->colnum = iinfo->table_reginfo->min_column;
+
+        /*
+         * a walk usually asks for the row after the one we returned last
+         */
+        if (reqinfo->mode == MODE_GETNEXT)
+            cursor = netsnmp_table_cursor_find(&snap->cursors, reqinfo,
+                                               name, name_len);
+        if (cursor) {
+            if (cursor->pos + 1 < snap->count) {
+                row = &snap->rows[cursor->pos + 1];
+                if (_ti_snapshot_row_compare(row - 1, row) >= 0)
+                    row = NULL;         /* duplicate index */
+            }
+            else if ((rc = netsnmp_table_next_column(table_info)) != 0) {
+                table_info->colnum = rc;
+                row = &snap->rows[0];
+            }
+            coloid[reginfo->rootoid_len + 1] = table_info->colnum;
+        }
+
+        while (!row) {
+            coloid[reginfo->rootoid_len + 1] = table_info->colnum;
+            cmp_len = SNMP_MIN(name_len, coloid_len);
+            rc = snmp_oid_compare(name, cmp_len, coloid, coloid_len);
+            if (reqinfo->mode == MODE_GET) {
+                if (rc == 0 && name_len > coloid_len)
+                    row = _ti_snapshot_search(snap, name + coloid_len,
+                                              name_len - coloid_len, 1);
+                break;
+            }
+            if (rc < 0)
+                row = snap->count ? &snap->rows[0] : NULL;
+            else if (rc == 0)
+                row = _ti_snapshot_search(snap, name + coloid_len,
+                                          name_len - coloid_len, 0);
+            if (row)
+                break;
+            rc = netsnmp_table_next_column(table_info);
+            if (rc == 0)
+                break;
+            table_info->colnum = rc;
+        }
+        if (!row || coloid_len + row->index_len > MAX_OID_LEN)
+            continue;
+
+        ti_info = (ti_cache_info *)
+            netsnmp_request_get_list_data(request, TI_REQUEST_CACHE);
+        if (!ti_info) {
+            ti_info = SNMP_MALLOC_TYPEDEF(ti_cache_info);
+            if (ti_info == NULL)
+                return SNMP_ERR_GENERR;
+            netsnmp_request_add_list_data(request,
+                                          netsnmp_create_data_list
+                                          (TI_REQUEST_CACHE,
+                                           ti_info,
+                                           netsnmp_free_ti_cache));
+        }
+        if (ti_info->data_context && ti_info->free_context)
+            (ti_info->free_context)(ti_info->data_context, iinfo);
+        ti_info->data_context = row->data_context;
+        ti_info->free_context = NULL;   /* owned by the snapshot */
+        ti_info->iinfo = iinfo;
+        memcpy(ti_info->best_match, coloid, coloid_len * sizeof(oid));
+        memcpy(&ti_info->best_match[coloid_len], row->index,
+               row->index_len * sizeof(oid));
+        ti_info->best_match_len = coloid_len + row->index_len;
+
+        if (reqinfo->mode == MODE_GETNEXT) {
+            cursor = netsnmp_table_cursor_save(&snap->cursors, cursor, reqinfo,
+                                               ti_info->best_match,
+                                               ti_info->best_match_len);
+            if (cursor)
+                cursor->pos = row - snap->rows;
+        }
+
+        if (reqinfo->mode == MODE_GETNEXT) {
+            if (ti_info->results)
+                snmp_free_varbind(ti_info->results);
+            ti_info->results = snmp_clone_varbind(table_info->indexes);
+            if (!ti_info->results)
+                return SNMP_ERR_GENERR;
+            parse_oid_indexes(row->index, row->index_len, ti_info->results);
+        }
+    }
+    return SNMP_ERR_NOERROR;
+}
+
 #define TABLE_ITERATOR_NOTAGAIN 255
 /* implements the table_iterator helper */
 int
@@ -460,6 +813,7 @@ netsnmp_table_iterator_helper_handler(netsnmp_mib_handler *handler,
     void           *callback_data_context = NULL;
     ti_cache_info  *ti_info = NULL;
     int             request_count = 0;
+    int             use_snapshot = 0;
 #ifndef NETSNMP_FEATURE_REMOVE_STASH_CACHE
     netsnmp_oid_stash_node **cinfo = NULL;
     netsnmp_variable_list *old_indexes = NULL, *vb;
@@ -561,16 +915,28 @@ netsnmp_table_iterator_helper_handler(netsnmp_mib_handler *handler,
         break;
     }
 
+    /*
+     * answer GET and GETNEXT requests from the sorted snapshot
+     */
+    if ((iinfo->flags & NETSNMP_ITERATOR_FLAG_SNAPSHOT) &&
+        (reqinfo->mode == MODE_GET || reqinfo->mode == MODE_GETNEXT)) {
+        ret = _ti_snapshot_lookup(reginfo, reqinfo, requests, iinfo,
+                                  coloid, coloid_len);
+        if (ret != SNMP_ERR_NOERROR)
+            return ret;
+        use_snapshot = 1;
+    }
+
     /*
      * collect all information for each needed row
      */
-    if (reqinfo->mode == MODE_GET ||
+    if (!use_snapshot && (reqinfo->mode == MODE_GET ||
         reqinfo->mode == MODE_GETNEXT ||
         reqinfo->mode == MODE_GET_STASH
 #ifndef NETSNMP_NO_WRITE_SUPPORT
         || reqinfo->mode == MODE_SET_RESERVE1
 #endif /* NETSNMP_NO_WRITE_SUPPORT */
-        ) {
+        )) {
         /*
          * Count the number of request in the list,
          *   so that we'll know when we're finished
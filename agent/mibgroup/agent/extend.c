@@ -39,6 +39,9 @@ typedef struct extend_registration_block_s {
 } extend_registration_block;
 extend_registration_block *ereg_head = NULL;
 
+void _free_extension( netsnmp_extend *extension,
+                      extend_registration_block *ereg );
+
 
 #ifndef USING_UCD_SNMP_EXTENSIBLE_MODULE
 typedef struct netsnmp_old_extend_s {
@@ -262,47 +265,71 @@ _unregister_extend(extend_registration_block *eptr)
     free(eptr);
 }
 
-int
-extend_clear_callback(int majorID, int minorID,
-                    void *serverarg, void *clientarg)
+static void
+_unregister_extend_handlers(extend_registration_block *eptr)
+{
+    netsnmp_unregister_handler( eptr->reg[0] );
+    netsnmp_unregister_handler( eptr->reg[1] );
+    netsnmp_unregister_handler( eptr->reg[2] );
+    netsnmp_unregister_handler( eptr->reg[3] );
+}
+
+#ifndef USING_UCD_SNMP_EXTENSIBLE_MODULE
+    /*
+     * The UCD-compatible directives rely on the order of the exec
+     *  entries, so these are still all dropped and read again on a reload.
+     */
+static void
+extend_free_compat_config(void)
 {
-    extend_registration_block *eptr, *enext = NULL;
-
-    for ( eptr=ereg_head; eptr; eptr=enext ) {
-        enext=eptr->next;
-        netsnmp_unregister_handler( eptr->reg[0] );
-        netsnmp_unregister_handler( eptr->reg[1] );
-        netsnmp_unregister_handler( eptr->reg[2] );
-        netsnmp_unregister_handler( eptr->reg[3] );
-        SNMP_FREE(eptr);
+    extend_registration_block *eptr;
+    unsigned int i;
+
+    if (!compatability_entries) {
+        num_compatability_entries = 0;
+        return;
+    }
+    eptr = _find_extension_block( ns_extend_oid, OID_LENGTH(ns_extend_oid));
+    for ( i=0; i < num_compatability_entries; i++ ) {
+        if (compatability_entries[i].efix_entry)
+            _free_extension( compatability_entries[i].efix_entry, eptr );
+        if (compatability_entries[i].exec_entry)
+            _free_extension( compatability_entries[i].exec_entry, eptr );
     }
-    ereg_head = NULL;
-    return 0;
+    memset(compatability_entries, 0,
+           max_compatability_entries * sizeof(netsnmp_old_extend));
+    num_compatability_entries = 0;
 }
+#endif
 
 void init_extend( void )
 {
-    snmpd_register_config_handler("extend",    extend_parse_config, NULL, NULL);
-    snmpd_register_config_handler("extend-sh", extend_parse_config, NULL, NULL);
-    snmpd_register_config_handler("extendfix", extend_parse_config, NULL, NULL);
-    snmpd_register_config_handler("exec2", extend_parse_config, NULL, NULL);
-    snmpd_register_config_handler("sh2",   extend_parse_config, NULL, NULL);
-    snmpd_register_config_handler("execFix2", extend_parse_config, NULL, NULL);
+    snmpd_register_config_handler_incremental("extend",
+                    extend_parse_config, extend_remove_config, NULL, NULL);
+    snmpd_register_config_handler_incremental("extend-sh",
+                    extend_parse_config, extend_remove_config, NULL, NULL);
+    snmpd_register_config_handler_incremental("extendfix",
+                    extend_parse_config, extend_remove_config, NULL, NULL);
+    snmpd_register_config_handler_incremental("exec2",
+                    extend_parse_config, extend_remove_config, NULL, NULL);
+    snmpd_register_config_handler_incremental("sh2",
+                    extend_parse_config, extend_remove_config, NULL, NULL);
+    snmpd_register_config_handler_incremental("execFix2",
+                    extend_parse_config, extend_remove_config, NULL, NULL);
     (void)_register_extend( ns_extend_oid, OID_LENGTH(ns_extend_oid));
 
 #ifndef USING_UCD_SNMP_EXTENSIBLE_MODULE
-    snmpd_register_config_handler("exec", extend_parse_config, NULL, NULL);
-    snmpd_register_config_handler("sh",   extend_parse_config, NULL, NULL);
-    snmpd_register_config_handler("execFix", extend_parse_config, NULL, NULL);
+    snmpd_register_config_handler("exec", extend_parse_config,
+                                  extend_free_compat_config, NULL);
+    snmpd_register_config_handler("sh",   extend_parse_config,
+                                  extend_free_compat_config, NULL);
+    snmpd_register_config_handler("execFix", extend_parse_config,
+                                  extend_free_compat_config, NULL);
     compatability_entries = (netsnmp_old_extend *)
         calloc( max_compatability_entries, sizeof(netsnmp_old_extend));
     REGISTER_MIB("ucd-extensible", old_extensible_variables,
                  variable2, old_extensible_variables_oid);
 #endif
-
-    snmp_register_callback(SNMP_CALLBACK_APPLICATION,
-                           SNMPD_CALLBACK_PRE_UPDATE_CONFIG,
-                           extend_clear_callback, NULL);
 }
 
 void
@@ -311,6 +338,7 @@ shutdown_extend(void)
 #ifndef USING_UCD_SNMP_EXTENSIBLE_MODULE
     free(compatability_entries);
     compatability_entries = NULL;
+    num_compatability_entries = 0;
 #endif
     while (ereg_head)
 	_unregister_extend(ereg_head);
@@ -434,6 +462,7 @@ _free_extension( netsnmp_extend *extension, extend_registration_block *ereg )
             eprev->next = eptr->next;
         else
             ereg->ehead = eptr->next;
+        ereg->num_entries--;
         netsnmp_table_data_remove_and_delete_row( ereg->dinfo, extension->row);
     }
 
@@ -610,6 +639,56 @@ extend_parse_config(const char *token, char *cptr)
 #endif
 }
 
+void
+extend_remove_config(const char *token, char *cptr)
+{
+    netsnmp_extend *extension;
+    char exec_name[STRMAX];
+    oid  oid_buf[MAX_OID_LEN];
+    size_t oid_len;
+    extend_registration_block *eptr;
+
+    cptr = copy_nword(cptr, exec_name,    sizeof(exec_name));
+    if ( *exec_name == '.' ) {
+        oid_len = MAX_OID_LEN - 2;
+        if (0 == read_objid( exec_name, oid_buf, &oid_len ))
+            return;
+        cptr = copy_nword(cptr, exec_name,    sizeof(exec_name));
+    } else {
+        memcpy( oid_buf, ns_extend_oid, sizeof(ns_extend_oid));
+        oid_len = OID_LENGTH(ns_extend_oid);
+    }
+    if (!strcmp( token, "extendfix" ) ||
+        !strcmp( token, "execFix2" ))
+        strlcat( exec_name, "Fix", sizeof(exec_name));
+
+    for ( eptr=ereg_head; eptr; eptr=eptr->next ) {
+        if (!snmp_oid_compare( oid_buf, oid_len, eptr->root_oid, eptr->oid_len))
+            break;
+    }
+    if (!eptr)
+        return;
+    for ( extension=eptr->ehead; extension; extension=extension->next ) {
+        if ((extension->flags & NS_EXTEND_FLAGS_CONFIG) &&
+            !strcmp( extension->token, exec_name ))
+            break;
+    }
+    if (!extension)
+        return;
+    DEBUGMSGTL(( "nsExtendTable:config", "removing %s\n", exec_name));
+    _free_extension( extension, eptr );
+
+        /*
+         * Drop any extra registration that is no longer needed
+         */
+    if (!eptr->ehead &&
+        snmp_oid_compare( eptr->root_oid, eptr->oid_len,
+                          ns_extend_oid, OID_LENGTH(ns_extend_oid))) {
+        _unregister_extend_handlers( eptr );
+        _unregister_extend( eptr );
+    }
+}
+
         /*************************
          *
          *  Main table handlers
@@ -33,6 +33,7 @@ Netsnmp_Node_Handler handle_nsExtendConfigTable;
 Netsnmp_Node_Handler handle_nsExtendOutput1Table;
 Netsnmp_Node_Handler handle_nsExtendOutput2Table;
 void                 extend_parse_config(const char*, char*);
+void                 extend_remove_config(const char*, char*);
 
 #define COLUMN_EXTCFG_COMMAND	2
 #define COLUMN_EXTCFG_ARGS	3
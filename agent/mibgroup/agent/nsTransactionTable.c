@@ -9,6 +9,7 @@
 
 #include <net-snmp/agent/table.h>
 #include <net-snmp/agent/table_iterator.h>
+#include <net-snmp/agent/scalar.h>
 #include "nsTransactionTable.h"
 
 netsnmp_feature_require(table_dataset)
@@ -72,10 +73,37 @@ void
 init_nsTransactionTable(void)
 {
 
+    const oid nsRateLimitDropped_oid[] = { 1, 3, 6, 1, 4, 1, 8072, 1, 8, 2 };
+
     /*
      * here we initialize all the tables we're planning on supporting 
      */
     initialize_table_nsTransactionTable();
+
+    netsnmp_register_scalar(
+        netsnmp_create_handler_registration(
+            "nsRateLimitDropped", handle_nsRateLimitDropped,
+            nsRateLimitDropped_oid, OID_LENGTH(nsRateLimitDropped_oid),
+            HANDLER_CAN_RONLY));
+}
+
+/** handles requests for the nsRateLimitDropped scalar */
+int
+handle_nsRateLimitDropped(netsnmp_mib_handler *handler,
+                          netsnmp_handler_registration *reginfo,
+                          netsnmp_agent_request_info *reqinfo,
+                          netsnmp_request_info *requests)
+{
+    u_long          dropped;
+
+    if (reqinfo->mode != MODE_GET)
+        return SNMP_ERR_GENERR;
+
+    dropped = netsnmp_agent_rate_limit_dropped() & 0xffffffff;
+    for (; requests; requests = requests->next)
+        snmp_set_var_typed_value(requests->requestvb, ASN_COUNTER,
+                                 (u_char *) &dropped, sizeof(dropped));
+    return SNMP_ERR_NOERROR;
 }
 
 /** returns the first data point within the nsTransactionTable table data.
@@ -10,6 +10,7 @@
 void            init_nsTransactionTable(void);
 void            initialize_table_nsTransactionTable(void);
 Netsnmp_Node_Handler nsTransactionTable_handler;
+Netsnmp_Node_Handler handle_nsRateLimitDropped;
 Netsnmp_First_Data_Point nsTransactionTable_get_first_data_point;
 Netsnmp_Next_Data_Point nsTransactionTable_get_next_data_point;
 
@@ -22,6 +22,15 @@ static netsnmp_cpu_info *_cpu_head  = NULL;
 static netsnmp_cpu_info *_cpu_tail  = NULL;
 static netsnmp_cache    *_cpu_cache = NULL;
 
+    /*
+     * The same entries in an array, sorted by index, for direct
+     *   lookups. The list through the 'next' pointers is kept
+     *   in step with it, for netsnmp_cpu_get_next().
+     */
+static netsnmp_cpu_info **_cpu_array = NULL;
+static int                _cpu_count = 0;
+static int                _cpu_alloc = 0;
+
 void init_cpu( void ) {
     oid nsCPU[] = { 1, 3, 6, 1, 4, 1, 8072, 1, 33 };
     /*
@@ -56,6 +65,58 @@ void shutdown_cpu( void ) {
         SNMP_FREE(tmp);
     }
     _cpu_tail = NULL;
+    SNMP_FREE(_cpu_array);
+    _cpu_count = _cpu_alloc = 0;
+}
+
+    /*
+     * Position of the first entry whose index is not below idx
+     */
+static int
+_cpu_find_pos( int idx ) {
+    int lo = 0, hi = _cpu_count, mid;
+
+        /* The entries are normally numbered consecutively from -1 */
+    if ( idx >= -1 && idx+1 < _cpu_count && _cpu_array[idx+1]->idx == idx )
+        return idx+1;
+    while ( lo < hi ) {
+        mid = lo + (hi-lo)/2;
+        if ( _cpu_array[mid]->idx < idx )
+            lo = mid+1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+    /*
+     * Insert a new entry at the given position of the array,
+     *   and link it into the list
+     */
+static int
+_cpu_insert( netsnmp_cpu_info *cpu, int pos ) {
+    if ( _cpu_count == _cpu_alloc ) {
+        int new_alloc = _cpu_alloc ? _cpu_alloc*2 : 16;
+        netsnmp_cpu_info **new_array = (netsnmp_cpu_info **)
+            realloc( _cpu_array, new_alloc * sizeof(netsnmp_cpu_info *));
+        if (!new_array)
+            return -1;
+        _cpu_array = new_array;
+        _cpu_alloc = new_alloc;
+    }
+    memmove( &_cpu_array[pos+1], &_cpu_array[pos],
+             (_cpu_count-pos) * sizeof(netsnmp_cpu_info *));
+    _cpu_array[pos] = cpu;
+    _cpu_count++;
+
+    cpu->next = ( pos+1 < _cpu_count ? _cpu_array[pos+1] : NULL );
+    if ( pos > 0 )
+        _cpu_array[pos-1]->next = cpu;
+    else
+        _cpu_head = cpu;
+    if ( !cpu->next )
+        _cpu_tail = cpu;
+    return 0;
 }
 
 
@@ -70,17 +131,17 @@ netsnmp_cpu_info *netsnmp_cpu_get_next( netsnmp_cpu_info *this_ptr ) {
      * Work with a list of CPU entries, indexed numerically
      */
 netsnmp_cpu_info *netsnmp_cpu_get_byIdx(  int idx, int create ) {
-    netsnmp_cpu_info *cpu, *cpu2;
+    netsnmp_cpu_info *cpu;
+    int pos;
 
         /*
          * Find the specified CPU entry
          */
     DEBUGMSGTL(("cpu", "cpu_get_byIdx %d ", idx));
-    for ( cpu=_cpu_head; cpu; cpu=cpu->next ) {
-        if ( cpu->idx == idx ) {
-            DEBUGMSG(("cpu", "(found)\n"));
-            return cpu;
-        }
+    pos = _cpu_find_pos( idx );
+    if ( pos < _cpu_count && _cpu_array[pos]->idx == idx ) {
+        DEBUGMSG(("cpu", "(found)\n"));
+        return _cpu_array[pos];
     }
     if (!create) {
         DEBUGMSG(("cpu", "(not found)\n"));
@@ -88,35 +149,33 @@ netsnmp_cpu_info *netsnmp_cpu_get_byIdx(  int idx, int create ) {
     }
 
         /*
-         * Create a new CPU entry, and insert it into the list....
+         * Create a new CPU entry, and insert it in the appropriate position
          */
     cpu = SNMP_MALLOC_TYPEDEF( netsnmp_cpu_info );
     if (!cpu) {
         DEBUGMSG(("cpu", "(failed)\n"));
         return NULL;
     }
-    DEBUGMSG(("cpu", "(created)\n"));
     cpu->idx = idx;
-        /* ... either as the first (or only) entry....  */
-    if ( !_cpu_head || _cpu_head->idx > idx ) {
-        cpu->next = _cpu_head;
-        _cpu_head = cpu;
-        if (!_cpu_tail)
-            _cpu_tail = cpu;
-        return cpu;
-    }
-        /* ... or in the appropriate position  */
-    for ( cpu2=_cpu_head; cpu2; cpu2=cpu2->next ) {
-        if ( !cpu2->next || cpu2->next->idx > idx ) {
-            cpu->next  = cpu2->next;
-            cpu2->next = cpu;
-            if (!cpu->next)
-                _cpu_tail = cpu;
-            return cpu;
-        }
+    if ( _cpu_insert( cpu, pos ) < 0 ) {
+        DEBUGMSG(("cpu", "(failed)\n"));
+        SNMP_FREE(cpu);
+        return NULL;
     }
-    SNMP_FREE(cpu); /* just in case */
-    return NULL;  /* Shouldn't happen! */
+    DEBUGMSG(("cpu", "(created)\n"));
+    return cpu;
+}
+
+    /*
+     * The first CPU entry with an index above idx
+     */
+netsnmp_cpu_info *netsnmp_cpu_get_next_byIdx( int idx ) {
+    int pos;
+
+    if ( _cpu_tail && idx >= _cpu_tail->idx )
+        return NULL;
+    pos = _cpu_find_pos( idx+1 );
+    return ( pos < _cpu_count ? _cpu_array[pos] : NULL );
 }
 
     /*
@@ -149,14 +208,10 @@ netsnmp_cpu_info *netsnmp_cpu_get_byName( char *name, int create ) {
     }
 
     strcpy(cpu->name, name);
-    if ( _cpu_tail ) {
-        cpu->idx = _cpu_tail->idx+1;
-        _cpu_tail->next = cpu;
-        _cpu_tail       = cpu;
-    } else {
-        cpu->idx = 0;
-        _cpu_head = cpu;
-        _cpu_tail = cpu;
+    cpu->idx = ( _cpu_tail ? _cpu_tail->idx+1 : 0 );
+    if ( _cpu_insert( cpu, _cpu_count ) < 0 ) {
+        free(cpu);
+        return NULL;
     }
     return cpu;
 }
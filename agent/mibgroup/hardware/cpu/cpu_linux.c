@@ -101,32 +101,43 @@ int netsnmp_cpu_arch_load( netsnmp_cache *cache, void *magic ) {
     static int   first = 1;
     static int   num_cpuline_elem = 0;
     int          bytes_read, statfd, i;
-    char        *b1, *b2;
-    unsigned long long cusell = 0, cicell = 0, csysll = 0, cidell = 0,
-                       ciowll = 0, cirqll = 0, csoftll = 0, cstealll = 0,
-                       cguestll = 0, cguest_nicell = 0;
+    char        *b1, *b2, *newbuff;
+    unsigned long long val[10];
     netsnmp_cpu_info* cpu;
 
-    if ((statfd = open(STAT_FILE, O_RDONLY, 0)) == -1) {
-        snmp_log_perror(STAT_FILE);
-        return -1;
-    }
     if (bsize == 0) {
         bsize = getpagesize()-1;
         buff = (char*)malloc(bsize+1);
+        if (!buff) {
+            bsize = 0;
+            return -1;
+        }
     }
-    while ((bytes_read = read(statfd, buff, bsize)) == bsize) {
-        bsize += BUFSIZ;
-        buff = (char*)realloc(buff, bsize+1);
-        DEBUGMSGTL(("cpu", "/proc/stat buffer increased to %d\n", bsize));
-        close(statfd);
-        statfd = open(STAT_FILE, O_RDONLY, 0);
-        if (statfd == -1) {
+
+        /*
+         * Read the whole file with a single read(), so that all
+         *   the figures come from the same snapshot. If it didn't
+         *   fit, start again with a buffer twice the size; that
+         *   size is kept for the next time round.
+         */
+    for (;;) {
+        if ((statfd = open(STAT_FILE, O_RDONLY, 0)) == -1) {
             snmp_log_perror(STAT_FILE);
             return -1;
-	}
+        }
+        bytes_read = read(statfd, buff, bsize);
+        close(statfd);
+        if (bytes_read < bsize)
+            break;
+        newbuff = (char*)realloc(buff, 2*(bsize+1));
+        if (!newbuff) {
+            snmp_log(LOG_ERR, "cannot grow the %s buffer\n", STAT_FILE);
+            return -1;
+        }
+        buff  = newbuff;
+        bsize = 2*(bsize+1)-1;
+        DEBUGMSGTL(("cpu", "/proc/stat buffer increased to %d\n", bsize));
     }
-    close(statfd);
 
     if ( bytes_read < 0 ) {
         snmp_log_perror(STAT_FILE "read error");
@@ -135,57 +146,69 @@ int netsnmp_cpu_arch_load( netsnmp_cache *cache, void *magic ) {
     buff[bytes_read] = '\0';
 
         /*
-         * CPU statistics (overall and per-CPU)
+         * CPU statistics (overall and per-CPU), which are the
+         *   first lines of the file
          */
     b1 = buff;
-    while ((b2 = strstr( b1, "cpu" ))) {
-        if (b2[3] == ' ') {
+    while (!strncmp( b1, "cpu", 3 )) {
+        if (b1[3] == ' ') {
             cpu = netsnmp_cpu_get_byIdx( -1, 0 );
             if (!cpu) {
                 snmp_log_perror("No (overall) CPU info entry");
                 return -1;
             }
-            b1 = b2+4; /* Skip "cpu " */
+            b1 += 4; /* Skip "cpu " */
         } else {
-            sscanf( b2, "cpu%d", &i );
+            i = strtol( b1+3, &b2, 10 );
+            if (b2 == b1+3)
+                break;
                        /* Create on the fly to support non-x86 systems - see init */
             cpu = netsnmp_cpu_get_byIdx( i, 1 );
             if (!cpu) {
                 snmp_log_perror("Missing CPU info entry");
                 break;
             }
-            b1 = b2; /* Skip "cpuN " */
-            while(*b1 != ' ') b1++;
-            b1++;
+            b1 = b2; /* Skip "cpuN" */
         }
 
-        num_cpuline_elem = sscanf(b1, "%llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
-         &cusell, &cicell, &csysll, &cidell, &ciowll, &cirqll, &csoftll, &cstealll, &cguestll, &cguest_nicell);
+        /* fields missing from older kernels count as 0 */
+        memset(val, 0, sizeof(val));
+        for (num_cpuline_elem = 0; num_cpuline_elem < 10; num_cpuline_elem++) {
+            val[num_cpuline_elem] = strtoull( b1, &b2, 10 );
+            if (b2 == b1)
+                break;
+            b1 = b2;
+        }
         DEBUGMSGTL(("cpu", "/proc/stat cpu line number of elements: %i\n", num_cpuline_elem));
 
         /* kernel 2.6.33 and above */
         if (num_cpuline_elem == 10) {
-            cpu->guestnice_ticks = cguest_nicell;
+            cpu->guestnice_ticks = val[9];
         }
         /* kernel 2.6.24 and above */
         if (num_cpuline_elem >= 9) {
-            cpu->guest_ticks = cguestll;
+            cpu->guest_ticks = val[8];
         }
         /* kernel 2.6.11 and above */
         if (num_cpuline_elem >= 8) {
-            cpu->steal_ticks = cstealll;
+            cpu->steal_ticks = val[7];
         }
         /* kernel 2.6 */
         if (num_cpuline_elem >= 5) {
-            cpu->wait_ticks   = ciowll;
-            cpu->intrpt_ticks = cirqll;
-            cpu->sirq_ticks   = csoftll;
+            cpu->wait_ticks   = val[4];
+            cpu->intrpt_ticks = val[5];
+            cpu->sirq_ticks   = val[6];
         }
         /* rest */
-        cpu->user_ticks = cusell;
-        cpu->nice_ticks = cicell;
-        cpu->sys_ticks  = csysll;
-        cpu->idle_ticks = cidell;
+        if (num_cpuline_elem >= 4) {
+            cpu->user_ticks = val[0];
+            cpu->nice_ticks = val[1];
+            cpu->sys_ticks  = val[2];
+            cpu->idle_ticks = val[3];
+        }
+
+        b2 = strchr( b1, '\n' );
+        b1 = ( b2 ? b2+1 : buff+bytes_read );
     }
     if ( b1 == buff ) {
 	if (first)
@@ -197,7 +220,8 @@ int netsnmp_cpu_arch_load( netsnmp_cache *cache, void *magic ) {
          *   XXX - Do these really belong here ?
          */
     cpu = netsnmp_cpu_get_byIdx( -1, 0 );
-    _cpu_load_swap_etc( buff, cpu );
+    if (cpu)
+        _cpu_load_swap_etc( b1, cpu );
 
     /*
      * XXX - TODO: extract per-CPU statistics
@@ -25,6 +25,20 @@
 #if HAVE_SYS_STATVFS_H
 #include <sys/statvfs.h>
 #endif
+#include <errno.h>
+#ifdef NETSNMP_REENTRANT
+#include <pthread.h>
+#define _NETSNMP_FSYS_PROBE 1
+#elif defined(HAVE_FORK)
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if HAVE_SYS_WAIT_H
+#include <sys/wait.h>
+#endif
+#include <net-snmp/agent/netsnmp_close_fds.h>
+#define _NETSNMP_FSYS_PROBE 1
+#endif
 
 #ifdef solaris2
 #define _NETSNMP_GETMNTENT_TWO_ARGS 1
@@ -57,6 +71,15 @@
 
 #endif
 
+#ifdef irix6
+#define _FSYS_STATFS(path, buf) NSFS_STATFS(path, buf, sizeof(struct statfs), 0)
+#else
+#define _FSYS_STATFS(path, buf) NSFS_STATFS(path, buf)
+#endif
+
+/* default fsysStatTimeout, in seconds */
+#define FSYS_STAT_TIMEOUT 1
+
 static int
 _fsys_remote( char *device, int type )
 {
@@ -155,9 +178,517 @@ _fsys_type( char *typename )
        return NETSNMP_FS_TYPE_IGNORE;
 }
 
+/*
+ * store the result of a statfs() in a filesystem entry
+ */
+static void
+_fsys_set_stats( netsnmp_fsys_info *entry, int rc,
+                 struct NSFS_STATFS *stat_buf )
+{
+    char               tmpbuf[1024];
+
+    entry->flags &= ~NETSNMP_FS_FLAG_STALE;
+    if ( rc < 0 ) {
+        snprintf( tmpbuf, sizeof(tmpbuf), "Cannot statfs %s", entry->path );
+        snmp_log_perror( tmpbuf );
+        memset( stat_buf, 0, sizeof(*stat_buf));
+        entry->units = stat_buf->NSFS_SIZE;
+        entry->size  = 0;
+        entry->used  = 0;
+        entry->avail = 0;
+        entry->inums_total = stat_buf->f_files;
+        entry->inums_avail = stat_buf->f_ffree;
+        netsnmp_fsys_calculate32(entry);
+        return;
+    }
+    entry->units =  stat_buf->NSFS_SIZE;
+    entry->size  =  stat_buf->f_blocks;
+    entry->used  = (stat_buf->f_blocks - stat_buf->f_bfree);
+    /* entry->avail is currently unsigned, so protect against negative
+     * values!
+     * This should be changed to a signed field.
+     */
+    if (stat_buf->f_bavail < 0)
+        entry->avail = 0;
+    else
+        entry->avail =  stat_buf->f_bavail;
+    entry->inums_total = stat_buf->f_files;
+    entry->inums_avail = stat_buf->f_ffree;
+    netsnmp_fsys_calculate32(entry);
+}
+
+#ifdef _NETSNMP_FSYS_PROBE
+/*
+ * statfs() of a mount whose (NFS) server is gone can block for a very
+ * long time, so the load never calls it. A single prober, a thread or,
+ * in agents built without --enable-reentrant, a child process, samples
+ * the mounts one after the other into _samples. The load copies the
+ * last sample of every mount it lists into its entry, and asks for a
+ * new one, without waiting for it. A first load a second after startup
+ * gets the first samples going.
+ *
+ * A mount which was asked for more than fsysStatTimeout seconds ago and
+ * hasn't been sampled since is flagged NETSNMP_FS_FLAG_STALE. It keeps
+ * the statistics of its last sample (none for a mount which never
+ * answered). If the prober is stuck in the statfs() of such a mount, it
+ * is retired: it quits once that call has returned, and a new prober
+ * takes over the other mounts. The hung mount isn't sampled again until
+ * then.
+ *
+ * The samples belong to the main thread. A prober thread takes the
+ * requests and fills in the results under _probe_lock. A child prober
+ * is sent one path at a time through a pipe, and sends the result back
+ * through another one, which the main loop reads.
+ */
+typedef struct fsys_probe_result_s {
+    struct NSFS_STATFS   stat_buf;
+    int                  rc;
+    int                  err;
+} fsys_probe_result;
+
+typedef struct fsys_sample_s {
+    char                 path[SNMP_MAXPATH+1];
+    fsys_probe_result    result;   /* of the last statfs() that returned */
+    int                  sampled;  /* result is set */
+    int                  wanted;   /* asked for, not started yet */
+    int                  busy;     /* in the statfs() of a prober */
+    int                  listed;   /* by the current load */
+    struct timespec      asked;    /* when the pending request was made */
+    struct fsys_sample_s *next;
+} fsys_sample;
+
+typedef struct fsys_prober_s {
+    fsys_sample         *current;  /* being sampled */
+    struct timespec      since;    /* when current was started */
+    int                  retired;
+#ifndef NETSNMP_REENTRANT
+    pid_t                pid;
+    int                  req_fd;   /* paths to the child */
+    int                  res_fd;   /* results from the child */
+#endif
+} fsys_prober;
+
+static fsys_sample    *_samples = NULL;
+static fsys_prober    *_prober  = NULL;   /* the one taking requests */
+
+/*
+ * request times are kept on the monotonic clock, which setting the
+ * system time doesn't move
+ */
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+#define _FSYS_PROBE_CLOCK CLOCK_MONOTONIC
+#else
+#define _FSYS_PROBE_CLOCK CLOCK_REALTIME
+#endif
+
+#ifdef NETSNMP_REENTRANT
+static pthread_mutex_t _probe_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  _probe_cond = PTHREAD_COND_INITIALIZER;
+
+#define _FSYS_PROBE_LOCK()   pthread_mutex_lock(&_probe_lock)
+#define _FSYS_PROBE_UNLOCK() pthread_mutex_unlock(&_probe_lock)
+#else
+#define _FSYS_PROBE_LOCK()
+#define _FSYS_PROBE_UNLOCK()
+#endif
+
+/*
+ * has the request made at *since been pending for longer than
+ * fsysStatTimeout?
+ */
+static int
+_fsys_probe_overdue( const struct timespec *since )
+{
+    struct timespec    now;
+    int                timeout;
+
+    timeout = netsnmp_ds_get_int(NETSNMP_DS_APPLICATION_ID,
+                                 NETSNMP_DS_AGENT_FSYS_STAT_TIMEOUT);
+    if (timeout <= 0)
+        timeout = FSYS_STAT_TIMEOUT;
+    clock_gettime(_FSYS_PROBE_CLOCK, &now);
+    if (now.tv_sec - since->tv_sec != timeout)
+        return now.tv_sec - since->tv_sec > timeout;
+    return now.tv_nsec >= since->tv_nsec;
+}
+
+/*
+ * the next mount to sample, if any; it is marked busy
+ */
+static fsys_sample *
+_fsys_probe_take( fsys_prober *prober )
+{
+    fsys_sample       *sample;
+
+    for (sample = _samples; sample; sample = sample->next)
+        if (sample->wanted && !sample->busy)
+            break;
+    if (sample) {
+        sample->wanted = 0;
+        sample->busy = 1;
+        prober->current = sample;
+        clock_gettime(_FSYS_PROBE_CLOCK, &prober->since);
+    }
+    return sample;
+}
+
+/*
+ * store the result of a sample
+ */
+static void
+_fsys_probe_done( fsys_prober *prober, const fsys_probe_result *result )
+{
+    fsys_sample       *sample = prober->current;
+
+    prober->current = NULL;
+    if (!sample)
+        return;
+    sample->busy = 0;
+    if (result) {
+        sample->result = *result;
+        sample->sampled = 1;
+    }
+    if (sample->wanted)   /* asked for again meanwhile */
+        clock_gettime(_FSYS_PROBE_CLOCK, &sample->asked);
+}
+
+#ifdef NETSNMP_REENTRANT
+static void *
+_fsys_probe_thread( void *arg )
+{
+    fsys_prober       *prober = (fsys_prober *)arg;
+    fsys_sample       *sample;
+    fsys_probe_result  result;
+
+    pthread_mutex_lock(&_probe_lock);
+    while (!prober->retired) {
+        sample = _fsys_probe_take(prober);
+        if (!sample) {
+            pthread_cond_wait(&_probe_cond, &_probe_lock);
+            continue;
+        }
+        pthread_mutex_unlock(&_probe_lock);
+
+        /* a busy sample isn't freed, nor is its path changed */
+        memset(&result, 0, sizeof(result));
+        result.rc  = _FSYS_STATFS( sample->path, &result.stat_buf );
+        result.err = errno;
+
+        pthread_mutex_lock(&_probe_lock);
+        _fsys_probe_done(prober, &result);
+    }
+    pthread_mutex_unlock(&_probe_lock);
+    free(prober);
+    return NULL;
+}
+
+/*
+ * @retval 0 the prober is running
+ */
+static int
+_fsys_probe_start( void )
+{
+    fsys_prober       *prober;
+    pthread_attr_t     attr;
+    pthread_t          tid;
+    int                rc;
+
+    prober = SNMP_MALLOC_TYPEDEF(fsys_prober);
+    if (!prober)
+        return -1;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    rc = pthread_create(&tid, &attr, _fsys_probe_thread, prober);
+    pthread_attr_destroy(&attr);
+    if (rc) {
+        free(prober);
+        return -1;
+    }
+    _prober = prober;
+    return 0;
+}
+
+/*
+ * let the prober know there are requests
+ */
+static void
+_fsys_probe_kick( void )
+{
+    pthread_cond_broadcast(&_probe_cond);
+}
+
+#else /* NETSNMP_REENTRANT */
+
+/*
+ * read a whole message from a pipe
+ */
+static int
+_fsys_probe_read( int fd, void *buf, size_t len )
+{
+    ssize_t            n;
+    size_t             got = 0;
+
+    while (got < len) {
+        n = read(fd, (char *)buf + got, len - got);
+        if (n < 0 && EINTR == errno)
+            continue;
+        if (n <= 0)
+            return -1;
+        got += n;
+    }
+    return 0;
+}
+
+/*
+ * the child: statfs() each path read from stdin, and write the result
+ * to stdout
+ */
+static void
+_fsys_probe_child( void )
+{
+    char               path[SNMP_MAXPATH+1];
+    fsys_probe_result  result;
+
+    while (_fsys_probe_read(0, path, sizeof(path)) == 0) {
+        path[sizeof(path)-1] = '\0';
+        memset(&result, 0, sizeof(result));
+        result.rc  = _FSYS_STATFS( path, &result.stat_buf );
+        result.err = errno;
+        if (write(1, &result, sizeof(result)) != sizeof(result))
+            break;
+    }
+    _exit(0);
+}
+
+/*
+ * send the child its next request, if there is one
+ */
+static void
+_fsys_probe_send( fsys_prober *prober )
+{
+    char               path[SNMP_MAXPATH+1];
+    fsys_sample       *sample;
+
+    if (prober->current || prober->retired)
+        return;
+    sample = _fsys_probe_take(prober);
+    if (!sample)
+        return;
+    memset(path, 0, sizeof(path));
+    strlcpy(path, sample->path, sizeof(path));
+    if (write(prober->req_fd, path, sizeof(path)) != sizeof(path)) {
+        /* the child is gone; its pipe says so next */
+        sample->wanted = 1;
+        _fsys_probe_done(prober, NULL);
+    }
+}
+
+static void
+_fsys_probe_stop( fsys_prober *prober )
+{
+    unregister_readfd(prober->res_fd);
+    close(prober->res_fd);
+    close(prober->req_fd);
+    waitpid(prober->pid, NULL, 0);
+    if (_prober == prober)
+        _prober = NULL;
+    free(prober);
+}
+
+/*
+ * called from the main loop with the result of a sample
+ */
+static void
+_fsys_probe_answer( int fd, void *data )
+{
+    fsys_prober       *prober = (fsys_prober *)data;
+    fsys_probe_result  result;
+
+    if (_fsys_probe_read(fd, &result, sizeof(result)) < 0) {
+        DEBUGMSGTL(("fsys:probe", "prober %d went away\n", prober->pid));
+        if (prober->current)
+            prober->current->wanted = 1;
+        _fsys_probe_done(prober, NULL);
+        _fsys_probe_stop(prober);
+        return;
+    }
+    _fsys_probe_done(prober, &result);
+    if (prober->retired)
+        _fsys_probe_stop(prober);
+    else
+        _fsys_probe_send(prober);
+}
+
+/*
+ * @retval 0 the prober is running
+ */
+static int
+_fsys_probe_start( void )
+{
+    fsys_prober       *prober;
+    int                req[2], res[2];
+
+    prober = SNMP_MALLOC_TYPEDEF(fsys_prober);
+    if (!prober)
+        return -1;
+    if (pipe(req) < 0) {
+        free(prober);
+        return -1;
+    }
+    if (pipe(res) < 0) {
+        close(req[0]);
+        close(req[1]);
+        free(prober);
+        return -1;
+    }
+
+    prober->pid = fork();
+    if (prober->pid == 0) {
+        /*
+         * child: requests on stdin, results on stdout, close the rest
+         */
+        dup2(req[0], 0);
+        dup2(res[1], 1);
+        netsnmp_close_fds(1);
+        _fsys_probe_child();
+    }
+
+    close(req[0]);
+    close(res[1]);
+    prober->req_fd = req[1];
+    prober->res_fd = res[0];
+    if (prober->pid < 0) {
+        close(prober->req_fd);
+        close(prober->res_fd);
+        free(prober);
+        return -1;
+    }
+    if (register_readfd(prober->res_fd, _fsys_probe_answer,
+                        prober) != FD_REGISTERED_OK) {
+        _fsys_probe_stop(prober);
+        return -1;
+    }
+    DEBUGMSGTL(("fsys:probe", "started prober %d\n", prober->pid));
+    _prober = prober;
+    return 0;
+}
+
+static void
+_fsys_probe_kick( void )
+{
+    if (_prober)
+        _fsys_probe_send(_prober);
+}
+#endif /* NETSNMP_REENTRANT */
+
+/*
+ * start of a load: no mount listed yet
+ */
+static void
+_fsys_probe_begin( void )
+{
+    fsys_sample       *sample;
+
+    _FSYS_PROBE_LOCK();
+    for (sample = _samples; sample; sample = sample->next)
+        sample->listed = 0;
+    _FSYS_PROBE_UNLOCK();
+}
+
+/*
+ * copy the last sample of a filesystem into its entry, flag it stale if
+ * the sample is overdue, and ask for a new one.
+ */
+static void
+_fsys_probe_copy( netsnmp_fsys_info *entry )
+{
+    fsys_sample       *sample;
+
+    _FSYS_PROBE_LOCK();
+    for (sample = _samples; sample; sample = sample->next)
+        if (!strcmp(sample->path, entry->path))
+            break;
+    if (!sample) {
+        sample = SNMP_MALLOC_TYPEDEF(fsys_sample);
+        if (!sample) {
+            _FSYS_PROBE_UNLOCK();
+            return;
+        }
+        strlcpy(sample->path, entry->path, sizeof(sample->path));
+        sample->next = _samples;
+        _samples = sample;
+    }
+    sample->listed = 1;
+
+    if (sample->sampled) {
+        errno = sample->result.err;
+        _fsys_set_stats(entry, sample->result.rc, &sample->result.stat_buf);
+    }
+    if (sample->wanted || sample->busy) {
+        if (_fsys_probe_overdue(&sample->asked)) {
+            DEBUGMSGTL(("fsys:probe", "%s not responding\n", entry->path));
+            entry->flags |= NETSNMP_FS_FLAG_STALE;
+        }
+    } else
+        clock_gettime(_FSYS_PROBE_CLOCK, &sample->asked);
+    sample->wanted = 1;
+    _FSYS_PROBE_UNLOCK();
+}
+
+/*
+ * end of a load: forget the mounts which are gone, replace a prober
+ * which hangs, and have the new requests sampled
+ */
+static void
+_fsys_probe_end( void )
+{
+    fsys_sample       *sample, **sp;
+
+    _FSYS_PROBE_LOCK();
+    for (sp = &_samples; (sample = *sp); ) {
+        if (!sample->listed && !sample->busy) {
+            *sp = sample->next;
+            free(sample);
+        } else
+            sp = &sample->next;
+    }
+
+    if (_prober && _prober->current &&
+        _fsys_probe_overdue(&_prober->since)) {
+        snmp_log(LOG_WARNING, "fsys: %s not responding\n",
+                 _prober->current->path);
+        _prober->retired = 1;   /* it goes once that statfs() returns */
+        _prober = NULL;
+    }
+    if (!_prober && _fsys_probe_start() < 0)
+        snmp_log(LOG_ERR, "fsys: could not start the statfs prober\n");
+    _fsys_probe_kick();
+    _FSYS_PROBE_UNLOCK();
+}
+
+/*
+ * have the mounts sampled once soon after startup, so that the first
+ * load finds statistics to copy
+ */
+static void
+_fsys_probe_prime( unsigned int clientreg, void *clientarg )
+{
+    netsnmp_fsys_load(NULL, NULL);
+}
+#endif /* _NETSNMP_FSYS_PROBE */
+
 void
 netsnmp_fsys_arch_init( void )
 {
+    netsnmp_ds_register_config(ASN_INTEGER,
+                               netsnmp_ds_get_string(NETSNMP_DS_LIBRARY_ID,
+                                                     NETSNMP_DS_LIB_APPTYPE),
+                               "fsysStatTimeout",
+                               NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_FSYS_STAT_TIMEOUT);
+#ifdef _NETSNMP_FSYS_PROBE
+    snmp_alarm_register(1, 0, _fsys_probe_prime, NULL);
+#endif
     return;
 }
 
@@ -171,7 +702,10 @@ netsnmp_fsys_arch_load( void )
 #else
     struct mntent     *m;
 #endif
+#ifndef _NETSNMP_FSYS_PROBE
     struct NSFS_STATFS stat_buf;
+    int                rc;
+#endif
     netsnmp_fsys_info *entry;
     char               tmpbuf[1024];
 
@@ -184,6 +718,9 @@ netsnmp_fsys_arch_load( void )
         snmp_log_perror( tmpbuf );
         return;
     }
+#ifdef _NETSNMP_FSYS_PROBE
+    _fsys_probe_begin( );
+#endif
 
     /*
      * ... and insert this into the filesystem container.
@@ -236,37 +773,15 @@ netsnmp_fsys_arch_load( void )
                                    NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES))
             continue;
 
-#ifdef irix6
-        if ( NSFS_STATFS( entry->path, &stat_buf, sizeof(struct statfs), 0) < 0 )
+#ifdef _NETSNMP_FSYS_PROBE
+        _fsys_probe_copy( entry );
 #else
-        if ( NSFS_STATFS( entry->path, &stat_buf ) < 0 )
+        rc = _FSYS_STATFS( entry->path, &stat_buf );
+        _fsys_set_stats( entry, rc, &stat_buf );
 #endif
-        {
-            snprintf( tmpbuf, sizeof(tmpbuf), "Cannot statfs %s", entry->path );
-            snmp_log_perror( tmpbuf );
-            entry->units = stat_buf.NSFS_SIZE;
-            entry->size  = 0;
-            entry->used  = 0;
-            entry->avail = 0;
-            entry->inums_total = stat_buf.f_files;
-            entry->inums_avail = stat_buf.f_ffree;
-            netsnmp_fsys_calculate32(entry);
-            continue;
-        }
-        entry->units =  stat_buf.NSFS_SIZE;
-        entry->size  =  stat_buf.f_blocks;
-        entry->used  = (stat_buf.f_blocks - stat_buf.f_bfree);
-        /* entry->avail is currently unsigned, so protect against negative
-         * values!
-         * This should be changed to a signed field.
-         */
-        if (stat_buf.f_bavail < 0)
-            entry->avail = 0;
-        else
-            entry->avail =  stat_buf.f_bavail;
-        entry->inums_total = stat_buf.f_files;
-        entry->inums_avail = stat_buf.f_ffree;
-        netsnmp_fsys_calculate32(entry);
     }
     fclose( fp );
+#ifdef _NETSNMP_FSYS_PROBE
+    _fsys_probe_end( );
+#endif
 }
@@ -25,6 +25,80 @@ netsnmp_feature_child_of(header_complex_all, libnetsnmpmibs)
 netsnmp_feature_child_of(header_complex_free_all, header_complex_all)
 netsnmp_feature_child_of(header_complex_find_entry, header_complex_all)
 
+/*
+ * Entries are kept in a sorted, doubly linked list, which modules walk
+ * directly. Every list also has a store, shared by all of its entries,
+ * which indexes them by name so that lookups and inserts don't have to
+ * scan the list. Duplicate names are allowed, and kept in the order
+ * they were added.
+ */
+struct header_complex_store {
+    netsnmp_container *c;
+    struct header_complex_index *tail;
+};
+
+static int
+_header_complex_compare(const void *lhs, const void *rhs)
+{
+    const struct header_complex_index *l =
+        (const struct header_complex_index *) lhs;
+    const struct header_complex_index *r =
+        (const struct header_complex_index *) rhs;
+
+    return snmp_oid_compare(l->name, l->namelen, r->name, r->namelen);
+}
+
+/*
+ * returns the store of the list starting at head, creating (and
+ * filling) it if needed.
+ */
+static struct header_complex_store *
+_header_complex_store(struct header_complex_index *head)
+{
+    struct header_complex_store *store;
+    struct header_complex_index *hciptr;
+    int             rc;
+
+    if (head && head->store)
+        return head->store;
+
+    store = SNMP_MALLOC_STRUCT(header_complex_store);
+    if (store == NULL)
+        return NULL;
+    store->c = netsnmp_container_find("header_complex:btree:binary_array");
+    if (store->c == NULL) {
+        free(store);
+        return NULL;
+    }
+    store->c->container_name = strdup("header_complex");
+    store->c->compare = _header_complex_compare;
+    CONTAINER_SET_OPTIONS(store->c, CONTAINER_KEY_ALLOW_DUPLICATES, rc);
+    if (rc < 0) {
+        CONTAINER_FREE(store->c);
+        free(store);
+        return NULL;
+    }
+
+    for (hciptr = head; hciptr != NULL; hciptr = hciptr->next) {
+        hciptr->store = store;
+        CONTAINER_INSERT(store->c, hciptr);
+        store->tail = hciptr;
+    }
+    return store;
+}
+
+/*
+ * returns the store to search for a lookup starting at datalist. Only
+ * lookups over a whole list can use it.
+ */
+static struct header_complex_store *
+_header_complex_lookup_store(struct header_complex_index *datalist)
+{
+    if (datalist == NULL || datalist->prev != NULL)
+        return NULL;
+    return _header_complex_store(datalist);
+}
+
 int
 header_complex_generate_varoid(netsnmp_variable_list * var)
 {
@@ -265,7 +339,17 @@ void           *
 header_complex_get_from_oid(struct header_complex_index *datalist,
                             oid * searchfor, size_t searchfor_len)
 {
-    struct header_complex_index *nptr;
+    struct header_complex_store *store;
+    struct header_complex_index *nptr, key;
+
+    store = _header_complex_lookup_store(datalist);
+    if (store) {
+        key.name = searchfor;
+        key.namelen = searchfor_len;
+        nptr = (struct header_complex_index *) CONTAINER_FIND(store->c, &key);
+        return nptr ? nptr->data : NULL;
+    }
+
     for (nptr = datalist; nptr != NULL; nptr = nptr->next) {
         if (netsnmp_oid_equals(searchfor, searchfor_len,
                              nptr->name, nptr->namelen) == 0)
@@ -283,9 +367,10 @@ header_complex(struct header_complex_index *datalist,
                int exact, size_t * var_len, WriteMethod ** write_method)
 {
 
-    struct header_complex_index *nptr, *found = NULL;
+    struct header_complex_store *store;
+    struct header_complex_index *nptr, *found = NULL, key;
     oid             indexOid[MAX_OID_LEN];
-    size_t          len;
+    size_t          len, prefix_len;
     int             result;
 
     /*
@@ -296,6 +381,35 @@ header_complex(struct header_complex_index *datalist,
     if (var_len)
         *var_len = sizeof(long);
 
+    store = _header_complex_lookup_store(datalist);
+    if (store) {
+        /*
+         * compare against the column prefix first. If it matches, the
+         * rest of the request is the index to look for.
+         */
+        prefix_len = vp ? vp->namelen : 0;
+        result = 0;
+        if (prefix_len) {
+            result = snmp_oid_compare(name, SNMP_MIN(*length, prefix_len),
+                                      vp->name, prefix_len);
+            if (result == 0 && *length < prefix_len)
+                result = -1;
+        }
+        if (result < 0)
+            found = exact ? NULL : datalist;
+        else if (result == 0) {
+            key.name = name + prefix_len;
+            key.namelen = *length - prefix_len;
+            if (exact)
+                found = (struct header_complex_index *)
+                    CONTAINER_FIND(store->c, &key);
+            else
+                found = (struct header_complex_index *)
+                    CONTAINER_NEXT(store->c, &key);
+        }
+        datalist = NULL;        /* skip the scan below */
+    }
+
     for (nptr = datalist; nptr != NULL && found == NULL; nptr = nptr->next) {
         if (vp) {
             memcpy(indexOid, vp->name, vp->namelen * sizeof(oid));
@@ -377,6 +491,7 @@ header_complex_add_data(struct header_complex_index **thedata,
 
 struct header_complex_index *
 _header_complex_add_between(struct header_complex_index **thedata,
+                            struct header_complex_store *store,
                             struct header_complex_index *hciptrp,
                             struct header_complex_index *hciptrn,
                             oid * newoid, size_t newoid_len, void *data)
@@ -411,18 +526,22 @@ _header_complex_add_between(struct header_complex_index **thedata,
     ourself->data = data;
     ourself->name = snmp_duplicate_objid(newoid, newoid_len);
     ourself->namelen = newoid_len;
+    ourself->store = store;
+
+    if (store) {
+        CONTAINER_INSERT(store->c, ourself);
+        if (ourself->next == NULL)
+            store->tail = ourself;
+    }
 
     /*
-     * rewind to the head of the list and return it (since the new head
-     * could be us, we need to notify the above routine who the head now is. 
+     * notify the above routine who the head now is, since it could be us.
      */
-    for (hciptrp = ourself; hciptrp->prev != NULL;
-         hciptrp = hciptrp->prev);
-
-    *thedata = hciptrp;
+    if (ourself->prev == NULL)
+        *thedata = ourself;
     DEBUGMSGTL(("header_complex_add_data", "adding something...\n"));
 
-    return hciptrp;
+    return *thedata;
 }
 
 
@@ -431,12 +550,33 @@ header_complex_maybe_add_data_by_oid(struct header_complex_index **thedata,
                                      oid * newoid, size_t newoid_len, void *data,
                                      int dont_allow_duplicates)
 {
-    struct header_complex_index *hciptrn, *hciptrp;
+    struct header_complex_store *store;
+    struct header_complex_index *hciptrn, *hciptrp, key;
     int rc;
 
     if (thedata == NULL || newoid == NULL || data == NULL)
         return NULL;
 
+    store = _header_complex_store(*thedata);
+    if (store) {
+        /*
+         * add after any duplicates, in front of the next larger entry
+         */
+        key.name = newoid;
+        key.namelen = newoid_len;
+        if (CONTAINER_FIND(store->c, &key)) {
+            snmp_log(LOG_WARNING, "header_complex_add_data_by_oid with "
+                     "duplicate index.\n");
+            if (dont_allow_duplicates)
+                return NULL;
+        }
+        hciptrn = (struct header_complex_index *)
+            CONTAINER_NEXT(store->c, &key);
+        hciptrp = hciptrn ? hciptrn->prev : store->tail;
+        return _header_complex_add_between(thedata, store, hciptrp, hciptrn,
+                                           newoid, newoid_len, data);
+    }
+
     for (hciptrn = *thedata, hciptrp = NULL;
          hciptrn != NULL; hciptrp = hciptrn, hciptrn = hciptrn->next) {
         /*
@@ -457,7 +597,7 @@ header_complex_maybe_add_data_by_oid(struct header_complex_index **thedata,
         }
     }
 
-    return _header_complex_add_between(thedata, hciptrp, hciptrn,
+    return _header_complex_add_between(thedata, NULL, hciptrp, hciptrn,
                                        newoid, newoid_len, data);
 }
 
@@ -481,6 +621,7 @@ void           *
 header_complex_extract_entry(struct header_complex_index **thetop,
                              struct header_complex_index *thespot)
 {
+    struct header_complex_store *store;
     struct header_complex_index *hciptrp, *hciptrn;
     void           *retdata;
 
@@ -495,6 +636,17 @@ header_complex_extract_entry(struct header_complex_index **thetop,
     hciptrp = thespot->prev;
     hciptrn = thespot->next;
 
+    store = thespot->store;
+    if (store) {
+        CONTAINER_REMOVE(store->c, thespot);
+        if (store->tail == thespot)
+            store->tail = hciptrp;
+        if (CONTAINER_SIZE(store->c) == 0) {
+            CONTAINER_FREE(store->c);
+            free(store);
+        }
+    }
+
     if (hciptrp)
         hciptrp->next = hciptrn;
     else if (thetop)
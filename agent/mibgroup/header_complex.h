@@ -4,12 +4,15 @@
 #ifndef _MIBGROUP_HEADER_COMPLEX_H
 #define _MIBGROUP_HEADER_COMPLEX_H
 
+struct header_complex_store;
+
 struct header_complex_index {
     oid            *name;
     size_t          namelen;
     void           *data;
     struct header_complex_index *next;
     struct header_complex_index *prev;
+    struct header_complex_store *store; /* index shared by the whole list */
 };
 
 /*
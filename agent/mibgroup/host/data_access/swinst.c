@@ -28,27 +28,48 @@ extern void netsnmp_swinst_arch_init(void);
 extern void netsnmp_swinst_arch_shutdown(void);
 extern int netsnmp_swinst_arch_load(netsnmp_container *, u_int);
 
+static int swinst_arch_initialized = 0;
+
+static void
+_swinst_arch_init( void *magic )
+{
+    if (swinst_arch_initialized)
+        return;
+    swinst_arch_initialized = 1;
+
+    /*
+     * call arch init code
+     */
+    netsnmp_swinst_arch_init();
+}
+
 void init_swinst( void )
 {
     static int initialized = 0;
+    static const oid hrSWInstalled_oid[] = { 1, 3, 6, 1, 2, 1, 25, 6 };
 
     DEBUGMSGTL(("swinst", "init called\n"));
 
     if (initialized)
         return; /* already initialized */
-
+    initialized = 1;
 
     /*
-     * call arch init code
+     * the arch init code may have to open the package database, so
+     * leave it until it's needed
      */
-    netsnmp_swinst_arch_init();
+    netsnmp_register_lazy_init("swinst", hrSWInstalled_oid,
+                               OID_LENGTH(hrSWInstalled_oid),
+                               _swinst_arch_init, NULL);
 }
 
 void shutdown_swinst( void )
 {
     DEBUGMSGTL(("swinst", "shutdown called\n"));
 
-    netsnmp_swinst_arch_shutdown();
+    if (swinst_arch_initialized)
+        netsnmp_swinst_arch_shutdown();
+    swinst_arch_initialized = 0;
 }
 
 /* ---------------------------------------------------------------------
@@ -81,6 +102,8 @@ netsnmp_swinst_container_load( netsnmp_container *user_container, int flags )
     if (NULL == container->container_name)
         container->container_name = strdup("swinst container");
 
+    _swinst_arch_init(NULL);
+
     /*
      * call the arch specific code to load the container
      */
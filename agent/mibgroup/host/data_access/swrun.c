@@ -33,6 +33,7 @@ static int _swrun_init = 0;
        int _swrun_max  = 0;
 static netsnmp_cache     *swrun_cache     = NULL;
 static netsnmp_container *swrun_container = NULL;
+static u_int              swrun_generation = 0;
 
 netsnmp_container * netsnmp_swrun_container(void);
 netsnmp_cache     * netsnmp_swrun_cache    (void);
@@ -79,28 +80,56 @@ shutdown_swrun(void)
 
 }
 
+/**
+ * the process table shared by all consumers: hrSWRunTable,
+ * hrSWRunPerfTable, hrSystemProcesses and prTable. It is reloaded when
+ * its cache has expired; for up to another cache timeout after that, the
+ * old table is still returned and the reload is done once the current
+ * request has been answered (NETSNMP_CACHE_STALE_WHILE_REVALIDATE).
+ *
+ * @param generation if not NULL, set to a number which changes whenever
+ *                   the table is reloaded, so that callers can keep
+ *                   what they derived from it until then. It is never 0.
+ *
+ * @retval NULL  no process table
+ */
+netsnmp_container *
+netsnmp_swrun_snapshot(u_int *generation)
+{
+    netsnmp_cache_check_and_reload(swrun_cache);
+    if (generation)
+        *generation = swrun_generation;
+    return swrun_container;
+}
+
 int
 swrun_count_processes(int include_kthreads)
 {
+    static u_int count_generation = 0;
+    static int count = 0;
     netsnmp_swrun_entry *entry;
     netsnmp_iterator  *it;
-    int i = 0;
+    u_int generation;
 
-    netsnmp_cache_check_and_reload(swrun_cache);
-    if ( !swrun_container )
+    if ( !netsnmp_swrun_snapshot(&generation) )
         return 0;    /* or -1 */
 
     if (include_kthreads)
         return ( swrun_container ? CONTAINER_SIZE(swrun_container) : 0 );
 
+    if (generation == count_generation)
+        return count;
+
+    count = 0;
     it = CONTAINER_ITERATOR( swrun_container );
     while ((entry = (netsnmp_swrun_entry*)ITERATOR_NEXT( it )) != NULL) {
         if (4 == entry->hrSWRunType)
-            i++;
+            count++;
     }
     ITERATOR_RELEASE( it );
+    count_generation = generation;
 
-    return i;
+    return count;
 }
 
 #ifndef NETSNMP_FEATURE_REMOVE_SWRUN_MAX_PROCESSES
@@ -175,6 +204,8 @@ static int
 _cache_load( netsnmp_cache *cache,  void *magic )
 {
     netsnmp_swrun_container_load( swrun_container, 0 );
+    if (0 == ++swrun_generation)
+        swrun_generation = 1;
     return 0;
 }
 
@@ -199,7 +230,8 @@ netsnmp_swrun_cache(void)
                            _cache_load,  _cache_free,
                            hrSWRunTable_oid, hrSWRunTable_oid_len);
         if (swrun_cache)
-            swrun_cache->flags = NETSNMP_CACHE_DONT_INVALIDATE_ON_SET;
+            swrun_cache->flags = NETSNMP_CACHE_DONT_INVALIDATE_ON_SET |
+                NETSNMP_CACHE_STALE_WHILE_REVALIDATE;
     }
     return swrun_cache;
 }
@@ -20,6 +20,10 @@
 #ifdef HAVE_DIRENT_H
 #include <dirent.h>
 #endif
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#include <errno.h>
 #ifdef HAVE_LINUX_TASKS_H
 #include <linux/tasks.h>
 #endif
@@ -27,12 +31,53 @@
 #include <net-snmp/net-snmp-includes.h>
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include <net-snmp/library/container.h>
+#include <net-snmp/library/container_binary_array.h>
 #include <net-snmp/library/snmp_debug.h>
 #include <net-snmp/data_access/swrun.h>
 
 static long pagesize;
 static long sc_clk_tck;
 
+/*
+ * root of the process tree; the swrun benchmark in testing/fulltests
+ * points it at a synthetic one
+ */
+const char *_swrun_procfs_dir = "/proc";
+
+/*
+ * the name, path and arguments of a process, which hardly ever change,
+ * but cost two more files per process to read. They are kept from one
+ * load to the next, and reread when the start time or the command name
+ * (which exec changes) in /proc/PID/stat no longer match.
+ */
+typedef struct swrun_pid_info_s {
+    netsnmp_index       oid_index;
+    oid                 pid;
+    unsigned long long  start;
+    char                comm[64+1];
+    char                name[64+1];
+    char                path[128+1];
+    char                params[128+1];
+    u_char              comm_len;
+    u_char              name_len;
+    u_char              path_len;
+    u_char              params_len;
+    u_char              type;
+} swrun_pid_info;
+
+/*
+ * info of the previous load, and of the one in progress
+ */
+static netsnmp_container *_pid_info = NULL;
+static netsnmp_container *_pid_info_next = NULL;
+
+/* fields of /proc/PID/stat, counted from 1 */
+#define STAT_STATE       3
+#define STAT_UTIME      14
+#define STAT_STIME      15
+#define STAT_STARTTIME  22
+#define STAT_RSS        24
+
 /* ---------------------------------------------------------------------
  */
 void
@@ -44,9 +89,236 @@ netsnmp_arch_swrun_init(void)
     
     pagesize = getpagesize();
     sc_clk_tck = sysconf(_SC_CLK_TCK);
+
+    _pid_info = netsnmp_container_find("swrun_pid_info:hash");
+    _pid_info_next = netsnmp_container_find("swrun_pid_info:hash");
+    if (NULL == _pid_info || NULL == _pid_info_next)
+        snmp_log(LOG_ERR, "swrun: could not create the process info cache\n");
     return;
 }
 
+static void
+_pid_info_free(swrun_pid_info *info, void *context)
+{
+    free(info);
+}
+
+static void
+_swrun_entry_free(netsnmp_swrun_entry *entry, void *context)
+{
+    netsnmp_swrun_entry_free(entry);
+}
+
+/*
+ * read a file below the process tree with a single read.
+ *
+ * @return the length read, or -1 if the process went away.
+ */
+static int
+_read_file(int dirfd, int pid, const char *file, char *buf, size_t size)
+{
+    char path[32];
+    int  fd, len;
+
+    snprintf(path, sizeof(path), "%d/%s", pid, file);
+    fd = openat(dirfd, path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    do {
+        len = read(fd, buf, size - 1);
+    } while (len < 0 && EINTR == errno);
+    close(fd);
+    if (len < 0)
+        return -1;
+    buf[len] = '\0';
+    return len;
+}
+
+/*
+ * fill in name, path, arguments and type from /proc/PID/status and
+ * /proc/PID/cmdline.
+ */
+static int
+_read_pid_info(int dirfd, swrun_pid_info *info)
+{
+    char  buf[BUFSIZ], *cp;
+    int   len, plen;
+
+    /*
+     *   Name:  process name
+     */
+    len = _read_file(dirfd, info->pid, "status", buf, 256);
+    if (len <= 0)
+        return -1;   /* file (process) probably went away */
+    cp = strchr(buf, ':');
+    if (NULL == cp)
+        return -1;
+    while (isspace((unsigned char)*(++cp)))  /* Skip ':' and following spaces */
+        ;
+    info->name_len = strcspn(cp, "\n");
+    if (info->name_len > sizeof(info->name) - 1)
+        info->name_len = sizeof(info->name) - 1;
+    memcpy(info->name, cp, info->name_len);
+    info->name[info->name_len] = '\0';
+
+    /*
+     *  Command Line:
+     *     argv[0] '\0' argv[1] '\0' ....
+     */
+    len = _read_file(dirfd, info->pid, "cmdline", buf, sizeof(buf));
+    if (len < 0)
+        return -1;   /* file (process) probably went away */
+    if (len > 0 && '\0' == buf[len - 1])
+        buf[--len] = '\0';
+    if (0 == len) {
+        /* empty /proc/PID/cmdline, it's probably a kernel thread */
+        info->path_len = 0;
+        info->params_len = 0;
+        info->type = HRSWRUNTYPE_OPERATINGSYSTEM;
+        info->path[0] = info->params[0] = '\0';
+        return 0;
+    }
+    info->type = HRSWRUNTYPE_APPLICATION;
+
+    /*
+     *     argv[0]   is hrSWRunPath
+     */
+    plen = strlen(buf);
+    info->path_len = plen < (int)sizeof(info->path) - 1 ?
+        plen : sizeof(info->path) - 1;
+    memcpy(info->path, buf, info->path_len);
+    info->path[info->path_len] = '\0';
+
+    /*
+     * Stitch together argv[1..] to construct hrSWRunParameters
+     */
+    info->params_len = 0;
+    if (plen < len) {
+        for (cp = buf + plen + 1; cp < buf + len; cp++) {
+            if ('\0' != *cp)
+                continue;
+            if (cp + 1 == buf + len || '\0' == *(cp+1))
+                break;      /* '\0''\0' => End of command line */
+            *cp = ' ';
+        }
+        len = cp - buf;
+        info->params_len = len - plen - 1 < (int)sizeof(info->params) - 1 ?
+            len - plen - 1 : sizeof(info->params) - 1;
+        memcpy(info->params, buf + plen + 1, info->params_len);
+    }
+    info->params[info->params_len] = '\0';
+
+    return 0;
+}
+
+/*
+ * load one process: /proc/PID/stat is read every time, the rest only
+ * when the cached info is stale.
+ */
+static netsnmp_swrun_entry *
+_load_pid(int dirfd, int pid)
+{
+    netsnmp_swrun_entry *entry;
+    swrun_pid_info      *info;
+    netsnmp_index        key;
+    oid                  pid_oid = pid;
+    char                 buf[1024], *field[STAT_RSS + 1], *comm, *cp;
+    unsigned long long   start, cpu;
+    int                  i, comm_len;
+
+    /*
+     *   {xxx} ({comm}) STATUS  {xxx}*10  UTIME STIME  {xxx}*6 START {xxx} RSS
+     */
+    if (_read_file(dirfd, pid, "stat", buf, sizeof(buf)) <= 0)
+        return NULL;   /* file (process) probably went away */
+    comm = strchr(buf, '(');
+    cp = strrchr(buf, ')');
+    if (NULL == comm || NULL == cp || ' ' != cp[1])
+        return NULL;
+    comm++;
+    comm_len = cp - comm;
+    cp += 2;
+    for (i = STAT_STATE; i <= STAT_RSS; i++) {
+        field[i] = cp;
+        cp = strchr(cp, ' ');
+        if (NULL == cp)
+            break;
+        cp++;
+    }
+    if (i <= STAT_RSS)
+        return NULL;
+    start = strtoull(field[STAT_STARTTIME], NULL, 10);
+
+    key.len = 1;
+    key.oids = &pid_oid;
+    info = (swrun_pid_info *) CONTAINER_FIND(_pid_info, &key);
+    if (info && (info->start != start || info->comm_len != comm_len ||
+                 memcmp(info->comm, comm, comm_len) != 0)) {
+        CONTAINER_REMOVE(_pid_info, info);
+        free(info);
+        info = NULL;
+    }
+    if (info) {
+        CONTAINER_REMOVE(_pid_info, info);
+    } else {
+        info = SNMP_MALLOC_TYPEDEF(swrun_pid_info);
+        if (NULL == info)
+            return NULL;
+        info->pid = pid;
+        info->oid_index.len = 1;
+        info->oid_index.oids = &info->pid;
+        info->start = start;
+        info->comm_len = comm_len < (int)sizeof(info->comm) - 1 ?
+            comm_len : sizeof(info->comm) - 1;
+        memcpy(info->comm, comm, info->comm_len);
+        if (_read_pid_info(dirfd, info) < 0) {
+            free(info);
+            return NULL;
+        }
+        DEBUGMSGTL(("swrun:load:arch", "read info of %d\n", pid));
+    }
+    if (CONTAINER_INSERT(_pid_info_next, info) < 0) {
+        free(info);
+        info = NULL;
+    }
+
+    entry = netsnmp_swrun_entry_create(pid);
+    if (NULL == entry)
+        return NULL;   /* error already logged by function */
+
+    if (info) {
+        memcpy(entry->hrSWRunName, info->name, info->name_len + 1);
+        entry->hrSWRunName_len = info->name_len;
+        memcpy(entry->hrSWRunPath, info->path, info->path_len + 1);
+        entry->hrSWRunPath_len = info->path_len;
+        memcpy(entry->hrSWRunParameters, info->params, info->params_len + 1);
+        entry->hrSWRunParameters_len = info->params_len;
+        entry->hrSWRunType = info->type;
+    }
+
+    switch (*field[STAT_STATE]) {
+    case 'R':  entry->hrSWRunStatus = HRSWRUNSTATUS_RUNNING;
+               break;
+    case 'S':  entry->hrSWRunStatus = HRSWRUNSTATUS_RUNNABLE;
+               break;
+    case 'D':
+    case 'T':  entry->hrSWRunStatus = HRSWRUNSTATUS_NOTRUNNABLE;
+               break;
+    case 'Z':
+    default:   entry->hrSWRunStatus = HRSWRUNSTATUS_INVALID;
+               break;
+    }
+
+    cpu  = strtoull(field[STAT_UTIME], NULL, 10);
+    cpu += strtoull(field[STAT_STIME], NULL, 10);
+    entry->hrSWRunPerfCPU  = cpu * 100 / sc_clk_tck;
+
+    entry->hrSWRunPerfMem  = atol(field[STAT_RSS]);
+    entry->hrSWRunPerfMem *= (pagesize/1024);  /* in kB */
+
+    return entry;
+}
+
 /* ---------------------------------------------------------------------
  */
 int
@@ -54,165 +326,57 @@ netsnmp_arch_swrun_container_load( netsnmp_container *container, u_int flags)
 {
     DIR                 *procdir = NULL;
     struct dirent       *procentry_p;
-    FILE                *fp;
-    int                  pid, i;
-    unsigned long long   cpu;
-    char                 buf[BUFSIZ], buf2[BUFSIZ], *cp, *cp1;
+    netsnmp_container   *tmp;
     netsnmp_swrun_entry *entry;
+    int                  pid, proc_fd, bulk;
     
-    procdir = opendir("/proc");
+    if (NULL == _pid_info || NULL == _pid_info_next)
+        return -1;
+
+    procdir = opendir(_swrun_procfs_dir);
     if ( NULL == procdir ) {
-        snmp_log( LOG_ERR, "Failed to open /proc" );
+        snmp_log( LOG_ERR, "Failed to open %s\n", _swrun_procfs_dir );
         return -1;
     }
+    proc_fd = dirfd(procdir);
+
+    /*
+     * readdir of /proc returns the pids in order, but don't rely on it
+     */
+    bulk = (0 == netsnmp_binary_array_bulk_begin(container));
 
     /*
      * Walk through the list of processes in the /proc tree
      */
     while ( NULL != (procentry_p = readdir( procdir ))) {
+        if (!isdigit((unsigned char)procentry_p->d_name[0]))
+            continue;   /* not a process */
         pid = atoi( procentry_p->d_name );
         if ( 0 == pid )
-            continue;   /* Presumably '.' or '..' */
-
-        entry = netsnmp_swrun_entry_create(pid);
-        if (NULL == entry)
-            continue;   /* error already logged by function */
-
-        /*
-         * Now extract the interesting information
-         *   from the various /proc{PID}/ interface files
-         */
-
-        /*
-         *   Name:  process name
-         */
-        snprintf( buf2, BUFSIZ, "/proc/%d/status", pid );
-        fp = fopen( buf2, "r" );
-        if (!fp) {
-            netsnmp_swrun_entry_free(entry);
-            continue; /* file (process) probably went away */
-	}
-        memset(buf, 0, sizeof(buf));
-        if (fgets( buf, BUFSIZ-1, fp ) == NULL) {
-            fclose(fp);
-            netsnmp_swrun_entry_free(entry);
             continue;
-        }
-        fclose(fp);
-
-        for ( cp = buf; *cp != ':'; cp++ )
-            ;
-        while (isspace(*(++cp)))	/* Skip ':' and following spaces */
-            ;
-        entry->hrSWRunName_len = snprintf(entry->hrSWRunName,
-                                   sizeof(entry->hrSWRunName)-1, "%s", cp);
-        if ( '\n' == entry->hrSWRunName[ entry->hrSWRunName_len-1 ]) {
-            entry->hrSWRunName[ entry->hrSWRunName_len-1 ] = '\0';
-            entry->hrSWRunName_len--;           /* Stamp on trailing newline */
-        }
-
-        /*
-         *  Command Line:
-         *     argv[0] '\0' argv[1] '\0' ....
-         */
-        snprintf( buf2, BUFSIZ, "/proc/%d/cmdline", pid );
-        fp = fopen( buf2, "r" );
-        if (!fp) {
-            netsnmp_swrun_entry_free(entry);
-            continue; /* file (process) probably went away */
-        }
-        entry->hrSWRunType = HRSWRUNTYPE_APPLICATION;
-        memset(buf, 0, sizeof(buf));
-        cp = fgets( buf, BUFSIZ-1, fp );
-        fclose(fp);
-        if (cp != NULL) {
-            /*
-             *     argv[0]   is hrSWRunPath
-             */ 
-            entry->hrSWRunPath_len = snprintf(entry->hrSWRunPath,
-                                       sizeof(entry->hrSWRunPath)-1, "%s", buf);
-            /*
-             * Stitch together argv[1..] to construct hrSWRunParameters
-             */
-            cp = buf + entry->hrSWRunPath_len+1;
-            while ( 1 ) {
-                while (*cp)
-                    cp++;
-                if ( '\0' == *(cp+1))
-                    break;      /* '\0''\0' => End of command line */
-                *cp = ' ';
-            }
-            entry->hrSWRunParameters_len
-                = sprintf(entry->hrSWRunParameters, "%.*s",
-                          (int)sizeof(entry->hrSWRunParameters) - 1,
-                          buf + entry->hrSWRunPath_len + 1);
-        } else {
-            /* empty /proc/PID/cmdline, it's probably a kernel thread */
-            entry->hrSWRunPath_len = 0;
-            entry->hrSWRunParameters_len = 0;
-            entry->hrSWRunType = HRSWRUNTYPE_OPERATINGSYSTEM;
-        }
 
-        /*
-         *   {xxx} {xxx} STATUS  {xxx}*10  UTIME STIME  {xxx}*8 RSS
-         */
-        snprintf( buf, BUFSIZ, "/proc/%d/stat", pid );
-        fp = fopen( buf, "r" );
-        if (!fp) {
-            netsnmp_swrun_entry_free(entry);
-            continue; /* file (process) probably went away */
-	}
-        if (fgets( buf, BUFSIZ-1, fp ) == NULL) {
-            fclose(fp);
+        entry = _load_pid(proc_fd, pid);
+        if (NULL == entry)
+            continue;   /* process probably went away */
+        if (CONTAINER_INSERT(container, entry) < 0)
             netsnmp_swrun_entry_free(entry);
-            continue;
-        }
-        fclose(fp);
-
-        cp = buf;
-        while ( ' ' != *(cp++))    /* Skip first field */
-            ;
-        cp1 = cp;                  /* Skip second field */
-        while (*cp1) {
-            if (*cp1 == ')') cp = cp1;
-            cp1++;
-        }
-        cp += 2;
-        
-        switch (*cp) {
-        case 'R':  entry->hrSWRunStatus = HRSWRUNSTATUS_RUNNING;
-                   break;
-        case 'S':  entry->hrSWRunStatus = HRSWRUNSTATUS_RUNNABLE;
-                   break;
-        case 'D':
-        case 'T':  entry->hrSWRunStatus = HRSWRUNSTATUS_NOTRUNNABLE;
-                   break;
-        case 'Z':
-        default:   entry->hrSWRunStatus = HRSWRUNSTATUS_INVALID;
-                   break;
-        }
-        for (i=11; i; i--) {   /* Skip STATUS + 10 fields */
-            while (' ' != *(++cp))
-                ;
-            cp++;
-        }
-        cpu  = atol( cp );                     /*  utime */
-        while ( ' ' != *(++cp))
-            ;
-        cpu += atol( cp );                     /* +stime */
-        entry->hrSWRunPerfCPU  = cpu * 100 / sc_clk_tck;
-
-        for (i=9; i; i--) {   /* Skip stime + 8 fields */
-            while (' ' != *(++cp))
-                ;
-            cp++;
-        }
-        entry->hrSWRunPerfMem  = atol( cp );       /* rss   */
-        entry->hrSWRunPerfMem *= (pagesize/1024);  /* in kB */
-        CONTAINER_INSERT(container, entry);
     }
     closedir( procdir );
 
+    if (bulk)
+        netsnmp_binary_array_bulk_end(container,
+                                      (netsnmp_container_obj_func *)
+                                      _swrun_entry_free, NULL);
+
+    /*
+     * whatever is left belongs to processes which have exited
+     */
+    CONTAINER_CLEAR(_pid_info,
+                    (netsnmp_container_obj_func *) _pid_info_free, NULL);
+    tmp = _pid_info;
+    _pid_info = _pid_info_next;
+    _pid_info_next = tmp;
+
     DEBUGMSGTL(("swrun:load:arch"," loaded %" NETSNMP_PRIz "d entries\n",
                 CONTAINER_SIZE(container)));
 
@@ -197,7 +197,7 @@ static void     parse_disk_config(const char *, char *);
 static void     free_disk_config(void);
 
 #ifdef linux
-static void     Add_LVM_Disks(void);
+static void     Add_LVM_Disks(void *);
 static void     Remove_LVM_Disks(void);
 #endif
 
@@ -243,7 +243,17 @@ init_hr_disk(void)
     Add_HR_Disk_entry("/dev/md%d", -1, -1, 0, 3, "/dev/md%d", 0, 0);
     Add_HR_Disk_entry("/dev/fd%d", -1, -1, 0, 1, "/dev/fd%d", 0, 0);
 
-    Add_LVM_Disks();
+    /*
+     * scanning /dev/mapper can be slow, so wait until hrDeviceTable or
+     * hrDiskStorageTable is first asked for
+     */
+    {
+        static const oid hrDevice_oid[] = { 1, 3, 6, 1, 2, 1, 25, 3 };
+
+        netsnmp_register_lazy_init("hr_disk", hrDevice_oid,
+                                   OID_LENGTH(hrDevice_oid),
+                                   Add_LVM_Disks, NULL);
+    }
 
 #elif defined(hpux)
 #if defined(hpux10) || defined(hpux11)
@@ -1352,7 +1362,7 @@ static int      lvm_device_count;
 #endif
 
 static void
-Add_LVM_Disks(void)
+Add_LVM_Disks(void *magic)
 {
 #if defined(HAVE_REGEX_H) && defined(HAVE_REGCOMP)
     /*
@@ -94,8 +94,10 @@ header_hrproc(struct variable *vp,
 {
 #define HRPROC_ENTRY_NAME_LENGTH	11
     oid             newname[MAX_OID_LEN];
-    int             proc_idx, LowIndex = -1;
+    int             LowIndex = -1;
     int             result;
+    oid             base = (oid)HRDEV_PROC << HRDEV_TYPE_SHIFT;
+    netsnmp_cpu_info *cpu = NULL;
 
     DEBUGMSGTL(("host/hr_proc", "var_hrproc: "));
     DEBUGMSGOID(("host/hr_proc", name, *length));
@@ -103,33 +105,28 @@ header_hrproc(struct variable *vp,
 
     memcpy((char *) newname, (char *) vp->name, vp->namelen * sizeof(oid));
     /*
-     * Find "next" proc entry 
+     * Look the requested (or "next") proc entry up by its index
      */
-
-    Init_HR_Proc();
-    for (;;) {
-        proc_idx = Get_Next_HR_Proc();
-        if (proc_idx == -1)
-            break;
-        newname[HRPROC_ENTRY_NAME_LENGTH] = proc_idx;
-        result = snmp_oid_compare(name, *length, newname, vp->namelen + 1);
-        if (exact && (result == 0)) {
-            LowIndex = proc_idx;
-            /*
-             * Save processor status information 
-             */
-            break;
-        }
-        if ((!exact && (result < 0)) &&
-            (LowIndex == -1 || proc_idx < LowIndex)) {
-            LowIndex = proc_idx;
-            /*
-             * Save processor status information 
-             */
-#ifdef HRPROC_MONOTONICALLY_INCREASING
-            break;
-#endif
-        }
+    result = snmp_oid_compare(name, SNMP_MIN(*length, vp->namelen),
+                              vp->name, vp->namelen);
+    if (result < 0 || (result == 0 && *length == vp->namelen)) {
+        if (!exact)
+            cpu = netsnmp_cpu_get_next_byIdx( -1 );
+    } else if (result == 0) {
+        oid req = name[vp->namelen];
+
+        if (exact) {
+            if (*length == vp->namelen + 1 && req >= base &&
+                req - base <= HRDEV_TYPE_MASK)
+                cpu = netsnmp_cpu_get_byIdx( (int)(req - base), 0 );
+        } else if (req < base)
+            cpu = netsnmp_cpu_get_next_byIdx( -1 );
+        else if (req - base <= HRDEV_TYPE_MASK)
+            cpu = netsnmp_cpu_get_next_byIdx( (int)(req - base) );
+    }
+    if (cpu && cpu->idx >= 0) {
+        LowIndex = base + cpu->idx;
+        newname[HRPROC_ENTRY_NAME_LENGTH] = LowIndex;
     }
 
     if (LowIndex == -1) {
@@ -18,6 +18,13 @@ extern          "C" {
 /**---------------------------------------------------------------------*/
 /**/
 
+int
+netsnmp_access_interface_ioctl_arphrd_type(unsigned short hwtype);
+
+void
+netsnmp_access_interface_ioctl_flags_apply(netsnmp_interface_entry *ifentry,
+                                           unsigned int flags);
+
 int
 netsnmp_access_interface_ioctl_physaddr_get(int fd,
                                             netsnmp_interface_entry *ifentry);
@@ -10,6 +10,7 @@
 netsnmp_feature_require(fd_event_manager)
 netsnmp_feature_require(delete_prefix_info)
 netsnmp_feature_require(create_prefix_info)
+netsnmp_feature_require(container_lifo)
 netsnmp_feature_child_of(interface_arch_set_admin_status, interface_all)
 
 #ifdef NETSNMP_FEATURE_REQUIRE_INTERFACE_ARCH_SET_ADMIN_STATUS
@@ -73,6 +74,7 @@ typedef __u8 u8;           /* ditto */
 #include "if-mib/data_access/interface.h"
 #include "mibgroup/util_funcs.h"
 #include "interface_ioctl.h"
+#include "ip-mib/data_access/ipaddress_linux.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -94,14 +96,12 @@ typedef __u8 u8;           /* ditto */
 #define SIOCGMIIREG 0x8948
 #endif
 
-#ifdef NETSNMP_ENABLE_IPV6
 #if defined(HAVE_LINUX_RTNETLINK_H)
 #include <linux/rtnetlink.h>
-#ifdef RTMGRP_IPV6_PREFIX
+#if defined(NETSNMP_ENABLE_IPV6) && defined(RTMGRP_IPV6_PREFIX)
 #define SUPPORT_PREFIX_FLAGS 1
-#endif  /* RTMGRP_IPV6_PREFIX */
+#endif  /* NETSNMP_ENABLE_IPV6 && RTMGRP_IPV6_PREFIX */
 #endif  /* HAVE_LINUX_RTNETLINK_H */
-#endif  /* NETSNMP_ENABLE_IPV6 */
 unsigned long long
 netsnmp_linux_interface_get_if_speed(int fd, const char *name,
         unsigned long long defaultspeed);
@@ -130,6 +130,10 @@ netsnmp_prefix_listen_info list_info;
 int netsnmp_prefix_listen(void);
 #endif
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+static void _ifcache_listen(void);
+#endif
+
 
 void
 netsnmp_arch_interface_init(void)
@@ -169,6 +173,10 @@ netsnmp_arch_interface_init(void)
     netsnmp_prefix_listen();
 #endif
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+    _ifcache_listen();
+#endif
+
 #ifdef HAVE_PCI_LOOKUP_NAME
     pci_access = pci_alloc();
     if (!pci_access) {
@@ -585,16 +593,814 @@ _parse_stats(netsnmp_interface_entry *entry, char *stats, int expected)
     return 0;
 }
 
+/**
+ * @internal
+ * physaddr should have set the type. make some guesses (based
+ * on name) if not.
+ */
+static void
+_arch_interface_type_guess(netsnmp_interface_entry *entry)
+{
+    typedef struct _match_if {
+       int             mi_type;
+       const char     *mi_name;
+    }              *pmatch_if, match_if;
+
+    static match_if lmatch_if[] = {
+        {IANAIFTYPE_SOFTWARELOOPBACK, "lo"},
+        {IANAIFTYPE_ETHERNETCSMACD, "eth"},
+        {IANAIFTYPE_ETHERNETCSMACD, "vmnet"},
+        {IANAIFTYPE_ISO88025TOKENRING, "tr"},
+        {IANAIFTYPE_FASTETHER, "feth"},
+        {IANAIFTYPE_GIGABITETHERNET,"gig"},
+        {IANAIFTYPE_INFINIBAND,"ib"},
+        {IANAIFTYPE_PPP, "ppp"},
+        {IANAIFTYPE_SLIP, "sl"},
+        {IANAIFTYPE_TUNNEL, "sit"},
+        {IANAIFTYPE_BASICISDN, "ippp"},
+        {IANAIFTYPE_PROPVIRTUAL, "bond"}, /* Bonding driver find fastest slave */
+        {IANAIFTYPE_PROPVIRTUAL, "vad"},  /* ANS driver - ?speed? */
+        {0, NULL}                  /* end of list */
+    };
+
+    int             len;
+    register pmatch_if pm;
+
+    if (0 != entry->type)
+        return;
+
+    for (pm = lmatch_if; pm->mi_name; pm++) {
+        len = strlen(pm->mi_name);
+        if (0 == strncmp(entry->name, pm->mi_name, len)) {
+            entry->type = pm->mi_type;
+            break;
+        }
+    }
+    if(NULL == pm->mi_name)
+        entry->type = IANAIFTYPE_OTHER;
+}
+
+/**
+ * @internal
+ * interface identifier is specified based on physaddr and type
+ */
+static void
+_arch_interface_v6_if_id_set(netsnmp_interface_entry *entry)
+{
+    switch (entry->type) {
+    case IANAIFTYPE_ETHERNETCSMACD:
+    case IANAIFTYPE_ETHERNET3MBIT:
+    case IANAIFTYPE_FASTETHER:
+    case IANAIFTYPE_FASTETHERFX:
+    case IANAIFTYPE_GIGABITETHERNET:
+    case IANAIFTYPE_FDDI:
+    case IANAIFTYPE_ISO88025TOKENRING:
+        if (NULL != entry->paddr && ETH_ALEN != entry->paddr_len)
+            break;
+
+        entry->v6_if_id_len = entry->paddr_len + 2;
+        memcpy(entry->v6_if_id, entry->paddr, 3);
+        memcpy(entry->v6_if_id + 5, entry->paddr + 3, 3);
+        entry->v6_if_id[0] ^= 2;
+        entry->v6_if_id[3] = 0xFF;
+        entry->v6_if_id[4] = 0xFE;
+
+        entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_IFID;
+        break;
+
+    case IANAIFTYPE_SOFTWARELOOPBACK:
+        entry->v6_if_id_len = 0;
+        entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_IFID;
+        break;
+    }
+}
+
+/**
+ * @internal
+ */
+static void
+_arch_interface_speed_get(int fd, netsnmp_interface_entry *entry)
+{
+    if (IANAIFTYPE_ETHERNETCSMACD == entry->type) {
+        unsigned long long speed;
+        unsigned long long defaultspeed = NOMINAL_LINK_SPEED;
+        if (!(entry->os_flags & IFF_RUNNING)) {
+            /*
+             * use speed 0 if the if speed cannot be determined *and* the
+             * interface is down
+             */
+            defaultspeed = 0;
+        }
+        speed = netsnmp_linux_interface_get_if_speed(fd,
+                entry->name, defaultspeed);
+        if (speed > 0xffffffffL) {
+            entry->speed = 0xffffffff;
+        } else
+            entry->speed = speed;
+        entry->speed_high = speed / 1000000LL;
+    }
+#ifdef APPLIED_PATCH_836390   /* xxx-rks ifspeed fixes */
+    else if (IANAIFTYPE_PROPVIRTUAL == entry->type)
+        entry->speed = _get_bonded_if_speed(entry);
+#endif
+    else
+        netsnmp_access_interface_entry_guess_speed(entry);
+}
+
+/**
+ * @internal
+ * the settings which follow from the speed and flags, and the
+ * overrides from the configuration.
+ */
+static void
+_arch_interface_entry_finish(netsnmp_interface_entry *entry)
+{
+    /*
+     * Zero speed means link problem.
+     * - i'm not sure this is always true...
+     */
+    if((entry->speed == 0) && (entry->os_flags & IFF_UP)) {
+        entry->os_flags &= ~IFF_RUNNING;
+    }
+
+    /*
+     * check for promiscuous mode.
+     *  NOTE: there are 2 ways to set promiscuous mode in Linux
+     *  (kernels later than 2.2.something) - using ioctls and
+     *  using setsockopt. The ioctl method tested here does not
+     *  detect if an interface was set using setsockopt. google
+     *  on IFF_PROMISC and linux to see lots of arguments about it.
+     */
+    if(entry->os_flags & IFF_PROMISC) {
+        entry->promiscuous = 1; /* boolean */
+    }
+
+    /*
+     * hardcoded max packet size
+     * (see ip_frag_reasm: if(len > 65535) goto out_oversize;)
+     */
+    entry->reasm_max_v4 = entry->reasm_max_v6 = 65535;
+    entry->ns_flags |= 
+        NETSNMP_INTERFACE_FLAGS_HAS_V4_REASMMAX |
+        NETSNMP_INTERFACE_FLAGS_HAS_V6_REASMMAX;
+
+    netsnmp_access_interface_entry_overrides(entry);
+}
+
+#ifdef HAVE_LINUX_RTNETLINK_H
+/*
+ * big enough for a few dozen links in every datagram of a dump
+ */
+#define IF_NETLINK_BUF_SIZE 32768
+
+/*
+ * The attributes which take ioctls, sysfs reads or pci lookups to get
+ * are kept from one load to the next, until a link notification for the
+ * interface invalidates them. The notifications also tell when the
+ * operational status of an interface changed, for ifLastChange.
+ */
+typedef struct _ifcache_entry_s {
+    netsnmp_index   oid_index;
+    oid             index;
+
+    u_int           generation;
+    u_int           flags;          /* IFCACHE_xxx */
+    u_int           ip_flags;       /* NETSNMP_INTERFACE_FLAGS_HAS_IPVx */
+    int             oper_status;
+    u_long          lastchange;
+
+    u_int           speed;
+    u_int           speed_high;
+    char           *descr;
+} _ifcache_entry;
+
+#define IFCACHE_STATIC          0x01    /* speed and descr are valid */
+#define IFCACHE_OPER_STATUS     0x02    /* oper_status is valid */
+#define IFCACHE_LASTCHANGE      0x04    /* lastchange is valid */
+
+static netsnmp_container *_ifcache = NULL;
+static u_int    _ifcache_generation = 0;
+static int      _ifcache_fd = -1;       /* link notifications */
+
+typedef struct _netlink_load_ctx_s {
+    netsnmp_container *container;
+    u_int           load_flags;
+    int             fd;                 /* for the ioctls */
+} _netlink_load_ctx;
+
+typedef int (_netlink_func)(struct nlmsghdr *nlh, void *context);
+
+static _ifcache_entry *
+_ifcache_get(oid if_index, int create)
+{
+    _ifcache_entry *ice;
+    netsnmp_index   key;
+
+    if (NULL == _ifcache)
+        return NULL;
+
+    key.len = 1;
+    key.oids = &if_index;
+    ice = (_ifcache_entry *) CONTAINER_FIND(_ifcache, &key);
+    if ((NULL != ice) || !create)
+        return ice;
+
+    ice = SNMP_MALLOC_TYPEDEF(_ifcache_entry);
+    if (NULL == ice)
+        return NULL;
+    ice->index = if_index;
+    ice->oid_index.len = 1;
+    ice->oid_index.oids = &ice->index;
+    if (CONTAINER_INSERT(_ifcache, ice) != 0) {
+        free(ice);
+        return NULL;
+    }
+    return ice;
+}
+
+static void
+_ifcache_entry_free(_ifcache_entry *ice, void *context)
+{
+    SNMP_FREE(ice->descr);
+    free(ice);
+}
+
+static void
+_ifcache_invalidate(_ifcache_entry *ice, void *context)
+{
+    ice->flags &= ~IFCACHE_STATIC;
+    SNMP_FREE(ice->descr);
+}
+
+static void
+_ifcache_clear_ip_flags(_ifcache_entry *ice, void *context)
+{
+    ice->ip_flags = 0;
+}
+
+static void
+_ifcache_collect_stale(_ifcache_entry *ice, netsnmp_container *stale)
+{
+    if (ice->generation != _ifcache_generation)
+        CONTAINER_INSERT(stale, ice);
+}
+
+/*
+ * drop the interfaces which didn't show up in the last dump
+ */
+static void
+_ifcache_gc(void)
+{
+    netsnmp_container *stale = netsnmp_container_find("lifo");
+
+    if (NULL == stale)
+        return;
+
+    CONTAINER_FOR_EACH(_ifcache,
+                       (netsnmp_container_obj_func *) _ifcache_collect_stale,
+                       stale);
+    while (CONTAINER_SIZE(stale)) {
+        _ifcache_entry *ice = (_ifcache_entry *) CONTAINER_FIRST(stale);
+        DEBUGMSGTL(("access:interface:cache", "forget index %" NETSNMP_PRIo
+                    "u\n", ice->index));
+        CONTAINER_REMOVE(_ifcache, ice);
+        _ifcache_entry_free(ice, NULL);
+        CONTAINER_REMOVE(stale, NULL);
+    }
+    CONTAINER_FREE(stale);
+}
+
+static int
+_netlink_oper_status(unsigned int flags)
+{
+    return ((flags & IFF_UP) && (flags & IFF_RUNNING)) ?
+        IFOPERSTATUS_UP : IFOPERSTATUS_DOWN;
+}
+
+/*
+ * read one datagram of link notifications
+ *
+ * @retval 1 something was read
+ * @retval 0 nothing to read
+ */
+static int
+_ifcache_recv(int fd)
+{
+    long            buf[IF_NETLINK_BUF_SIZE / sizeof(long)];
+    struct nlmsghdr *nlh;
+    int             len;
+
+    do {
+        len = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    } while (len < 0 && EINTR == errno);
+    if (len < 0) {
+        if (EAGAIN == errno || EWOULDBLOCK == errno)
+            return 0;
+        /*
+         * ENOBUFS: notifications were lost, forget everything
+         */
+        DEBUGMSGTL(("access:interface:cache", "netlink buffer overrun\n"));
+        CONTAINER_FOR_EACH(_ifcache,
+                           (netsnmp_container_obj_func *) _ifcache_invalidate,
+                           NULL);
+        return 1;
+    }
+
+    for (nlh = (struct nlmsghdr *) buf; NLMSG_OK(nlh, len);
+         nlh = NLMSG_NEXT(nlh, len)) {
+        struct ifinfomsg *ifi;
+        _ifcache_entry  *ice;
+        int              oper_status;
+
+        if ((RTM_NEWLINK != nlh->nlmsg_type &&
+             RTM_DELLINK != nlh->nlmsg_type) ||
+            nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*ifi)))
+            continue;
+
+        ifi = (struct ifinfomsg *) NLMSG_DATA(nlh);
+        ice = _ifcache_get(ifi->ifi_index, 0);
+        if (NULL == ice)
+            continue;       /* new interface, the next load picks it up */
+
+        if (RTM_DELLINK == nlh->nlmsg_type) {
+            DEBUGMSGTL(("access:interface:cache", "index %d deleted\n",
+                        ifi->ifi_index));
+            CONTAINER_REMOVE(_ifcache, ice);
+            _ifcache_entry_free(ice, NULL);
+            continue;
+        }
+
+        _ifcache_invalidate(ice, NULL);
+        oper_status = _netlink_oper_status(ifi->ifi_flags);
+        if ((ice->flags & IFCACHE_OPER_STATUS) &&
+            (ice->oper_status != oper_status)) {
+            ice->lastchange = netsnmp_get_agent_uptime();
+            ice->flags |= IFCACHE_LASTCHANGE;
+            DEBUGMSGTL(("access:interface:cache", "index %d oper status %d\n",
+                        ifi->ifi_index, oper_status));
+        }
+        ice->oper_status = oper_status;
+        ice->flags |= IFCACHE_OPER_STATUS;
+    }
+    return 1;
+}
+
+static void
+_ifcache_read_netlink(int fd, void *data)
+{
+    _ifcache_recv(fd);
+}
+
+/*
+ * subscribe to link notifications. Without them, nothing is cached.
+ */
+static void
+_ifcache_listen(void)
+{
+    struct sockaddr_nl sa;
+    int             fd;
+
+    _ifcache = netsnmp_container_find("access_interface_cache:"
+                                      "table_container");
+    if (NULL == _ifcache) {
+        snmp_log(LOG_ERR, "could not create interface cache container\n");
+        return;
+    }
+
+    fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (fd < 0) {
+        DEBUGMSGTL(("access:interface:cache", "socket: %s\n",
+                    strerror(errno)));
+        return;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = RTMGRP_LINK;
+    if (bind(fd, (struct sockaddr *) &sa, sizeof(sa)) < 0) {
+        DEBUGMSGTL(("access:interface:cache", "bind: %s\n",
+                    strerror(errno)));
+        close(fd);
+        return;
+    }
+
+    if (register_readfd(fd, _ifcache_read_netlink, NULL) != 0) {
+        snmp_log(LOG_ERR, "error registering interface netlink socket\n");
+        close(fd);
+        return;
+    }
+    _ifcache_fd = fd;
+}
+
 /*
+ * dump the links
+ *
+ * @retval  0 success
+ * @retval -2 rtnetlink not available, nothing was passed to func
+ * @retval <0 other errors, or the return value of func
+ */
+static int
+_netlink_dump(int type, _netlink_func *func, void *context)
+{
+    static unsigned int seq;
+    struct {
+        struct nlmsghdr  nlh;
+        struct ifinfomsg ifi;
+    } req;
+    struct sockaddr_nl sa;
+    long        buf[IF_NETLINK_BUF_SIZE / sizeof(long)];
+    int         fd, len, rc = 0, done = 0, count = 0;
+
+    fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (fd < 0) {
+        DEBUGMSGTL(("access:interface:netlink", "socket: %s\n",
+                    strerror(errno)));
+        return -2;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+
+    memset(&req, 0, sizeof(req));
+    req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    req.nlh.nlmsg_type = type;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nlh.nlmsg_seq = ++seq;
+
+    if (sendto(fd, &req, req.nlh.nlmsg_len, 0, (struct sockaddr *) &sa,
+               sizeof(sa)) < 0) {
+        DEBUGMSGTL(("access:interface:netlink", "sendto: %s\n",
+                    strerror(errno)));
+        close(fd);
+        return -2;
+    }
+
+    while (!done) {
+        struct nlmsghdr *nlh = (struct nlmsghdr *) buf;
+
+        len = recv(fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (EINTR == errno)
+                continue;
+            snmp_log_perror("interface _netlink_dump: recv");
+            rc = count ? -1 : -2;
+            break;
+        }
+        if (0 == len)
+            break;
+
+        for (; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_seq != seq)
+                continue;
+            if (NLMSG_DONE == nlh->nlmsg_type) {
+                done = 1;
+                break;
+            }
+            if (NLMSG_ERROR == nlh->nlmsg_type) {
+                DEBUGMSGTL(("access:interface:netlink", "dump %d failed\n",
+                            type));
+                rc = count ? -1 : -2;
+                done = 1;
+                break;
+            }
+            ++count;
+            rc = (*func)(nlh, context);
+            if (rc < 0) {
+                done = 1;
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    DEBUGMSGTL(("access:interface:netlink", "%d messages of dump %d (rc %d)\n",
+                count, type, rc));
+
+    return rc < 0 ? rc : 0;
+}
+
+/*
+ * the ip versions of an interface, from its addresses
+ */
+static void
+_netlink_addr(netsnmp_ipaddress_entry *addr, void *context)
+{
+    _ifcache_entry  *ice = _ifcache_get(addr->if_index, 1);
+
+    if (NULL == ice)
+        return;
+
+    if (4 == addr->ia_address_len)
+        ice->ip_flags |= NETSNMP_INTERFACE_FLAGS_HAS_IPV4;
+#ifdef NETSNMP_ENABLE_IPV6
+    else if (16 == addr->ia_address_len)
+        ice->ip_flags |= NETSNMP_INTERFACE_FLAGS_HAS_IPV6;
+#endif
+}
+
+/**
+ * @internal
+ */
+static void
+_netlink_stats(netsnmp_interface_entry *entry,
+               const struct rtnl_link_stats64 *stats, int high)
+{
+    uint64_t        rec_pkt = stats->rx_packets;
+    uint64_t        snd_pkt = stats->tx_packets;
+
+    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_BYTES;
+    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_DROPS;
+    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_MCAST_PKTS;
+    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_HIGH_SPEED;
+    if (high) {
+        entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_HIGH_BYTES;
+        entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_HIGH_PACKETS;
+    }
+    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_ACTIVE;
+
+    /*
+     * linux previous to 1.3.~13 may miss transmitted loopback pkts: 
+     */
+    if (!strcmp(entry->name, "lo") && rec_pkt > 0 && !snd_pkt)
+        snd_pkt = rec_pkt;
+
+    /*
+     * same counters as in /proc/net/dev
+     */
+    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_CALCULATE_UCAST;
+    entry->stats.ibytes.low = stats->rx_bytes & 0xffffffff;
+    entry->stats.ibytes.high = stats->rx_bytes >> 32;
+    entry->stats.iall.low = rec_pkt & 0xffffffff;
+    entry->stats.iall.high = rec_pkt >> 32;
+    entry->stats.imcast.low = stats->multicast & 0xffffffff;
+    entry->stats.imcast.high = stats->multicast >> 32;
+    entry->stats.obytes.low = stats->tx_bytes & 0xffffffff;
+    entry->stats.obytes.high = stats->tx_bytes >> 32;
+    entry->stats.oucast.low = snd_pkt & 0xffffffff;
+    entry->stats.oucast.high = snd_pkt >> 32;
+    entry->stats.ierrors   = stats->rx_errors;
+    entry->stats.idiscards = stats->rx_dropped + stats->rx_missed_errors;
+    entry->stats.oerrors   = stats->tx_errors;
+    entry->stats.odiscards = stats->tx_dropped;
+    entry->stats.collisions = stats->collisions;
+
+    /*
+     * calculated stats.
+     *
+     *  we have imcast, but not ibcast.
+     */
+    entry->stats.inucast = entry->stats.imcast.low +
+        entry->stats.ibcast.low;
+    entry->stats.onucast = entry->stats.omcast.low +
+        entry->stats.obcast.low;
+}
+
+/*
+ * one interface of the link dump
+ */
+static int
+_netlink_link(struct nlmsghdr *nlh, void *context)
+{
+    _netlink_load_ctx *ctx = (_netlink_load_ctx *) context;
+    netsnmp_interface_entry *entry;
+    _ifcache_entry  *ice;
+    struct ifinfomsg *ifi;
+    struct rtattr   *rta;
+    struct rtnl_link_stats64 stats;
+    const char      *name = NULL;
+    const void      *addr = NULL;
+    int              len, addr_len = 0, have_stats = 0;
+    u_int            mtu = 0, flags;
+
+    if (RTM_NEWLINK != nlh->nlmsg_type ||
+        nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*ifi)))
+        return 0;
+
+    ifi = (struct ifinfomsg *) NLMSG_DATA(nlh);
+    len = IFLA_PAYLOAD(nlh);
+    memset(&stats, 0, sizeof(stats));
+    for (rta = IFLA_RTA(ifi); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        switch (rta->rta_type) {
+        case IFLA_IFNAME:
+            name = (const char *) RTA_DATA(rta);
+            break;
+        case IFLA_ADDRESS:
+            addr = RTA_DATA(rta);
+            addr_len = RTA_PAYLOAD(rta);
+            break;
+        case IFLA_MTU:
+            if (RTA_PAYLOAD(rta) >= sizeof(mtu))
+                memcpy(&mtu, RTA_DATA(rta), sizeof(mtu));
+            break;
+        case IFLA_STATS64:
+            /*
+             * 64 bit counters, only 4 byte aligned. The structure grows
+             * with new kernels: take what the running kernel has, and
+             * leave the rest 0, like iproute2 does.
+             */
+            memset(&stats, 0, sizeof(stats));
+            memcpy(&stats, RTA_DATA(rta),
+                   SNMP_MIN(RTA_PAYLOAD(rta), sizeof(stats)));
+            have_stats = 64;
+            break;
+        case IFLA_STATS:
+            if (!have_stats) {
+                struct rtnl_link_stats s32;
+
+                memset(&s32, 0, sizeof(s32));
+                memcpy(&s32, RTA_DATA(rta),
+                       SNMP_MIN(RTA_PAYLOAD(rta), sizeof(s32)));
+                stats.rx_packets = s32.rx_packets;
+                stats.tx_packets = s32.tx_packets;
+                stats.rx_bytes = s32.rx_bytes;
+                stats.tx_bytes = s32.tx_bytes;
+                stats.rx_errors = s32.rx_errors;
+                stats.tx_errors = s32.tx_errors;
+                stats.rx_dropped = s32.rx_dropped;
+                stats.tx_dropped = s32.tx_dropped;
+                stats.multicast = s32.multicast;
+                stats.collisions = s32.collisions;
+                stats.rx_missed_errors = s32.rx_missed_errors;
+                have_stats = 32;
+            }
+            break;
+        }
+    }
+    if (NULL == name)
+        return 0;
+
+    DEBUGMSGTL(("9:access:ifcontainer", "processing '%s'\n", name));
+
+    ice = _ifcache_get(ifi->ifi_index, 1);
+    if (NULL != ice)
+        ice->generation = _ifcache_generation;
+    flags = ice ? ice->ip_flags : 0;
+
+    /*
+     * do we only want one address type?
+     */
+    if (((ctx->load_flags & NETSNMP_ACCESS_INTERFACE_LOAD_IP4_ONLY) &&
+         ((flags & NETSNMP_INTERFACE_FLAGS_HAS_IPV4) == 0)) ||
+        ((ctx->load_flags & NETSNMP_ACCESS_INTERFACE_LOAD_IP6_ONLY) &&
+         ((flags & NETSNMP_INTERFACE_FLAGS_HAS_IPV6) == 0))) {
+        DEBUGMSGTL(("9:access:ifcontainer",
+                    "interface '%s' excluded by ip version\n", name));
+        return 0;
+    }
+
+    entry = netsnmp_access_interface_entry_create(name, ifi->ifi_index);
+    if (NULL == entry)
+        return -3;
+    entry->ns_flags = flags; /* initial flags; we'll set more later */
+
+    /*
+     * same layout as the SIOCGIFHWADDR ioctl gives, but keep longer
+     * addresses (infiniband) whole.
+     */
+    entry->paddr_len = addr_len > IFHWADDRLEN ? addr_len : IFHWADDRLEN;
+    entry->paddr = (char *) calloc(1, entry->paddr_len);
+    if (NULL == entry->paddr) {
+        netsnmp_access_interface_entry_free(entry);
+        return -3;
+    }
+    if (NULL != addr)
+        memcpy(entry->paddr, addr, addr_len);
+    entry->type = netsnmp_access_interface_ioctl_arphrd_type(ifi->ifi_type);
+
+    _arch_interface_type_guess(entry);
+    _arch_interface_v6_if_id_set(entry);
+
+    /*
+     * cached attributes are only good while we hear about changes
+     */
+    if ((NULL != ice) && (ice->flags & IFCACHE_STATIC) && (_ifcache_fd >= 0)) {
+        entry->speed = ice->speed;
+        entry->speed_high = ice->speed_high;
+        if (NULL != ice->descr) {
+            free(entry->descr);
+            entry->descr = strdup(ice->descr);
+        }
+    } else {
+#ifdef HAVE_PCI_LOOKUP_NAME
+        _arch_interface_description_get(entry);
+#endif
+        _arch_interface_speed_get(ctx->fd, entry);
+        if (NULL != ice) {
+            _ifcache_invalidate(ice, NULL);
+            ice->speed = entry->speed;
+            ice->speed_high = entry->speed_high;
+            if (NULL != entry->descr)
+                ice->descr = strdup(entry->descr);
+            ice->flags |= IFCACHE_STATIC;
+        }
+    }
+
+    netsnmp_access_interface_ioctl_flags_apply(entry, ifi->ifi_flags);
+    entry->mtu = mtu;
+
+    if (NULL != ice) {
+        ice->oper_status = entry->oper_status;
+        ice->flags |= IFCACHE_OPER_STATUS;
+        if (ice->flags & IFCACHE_LASTCHANGE) {
+            entry->lastchange = ice->lastchange;
+            entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_LASTCHANGE;
+        }
+    }
+
+    _arch_interface_entry_finish(entry);
+
+    if (have_stats &&
+        !(ctx->load_flags & NETSNMP_ACCESS_INTERFACE_LOAD_NO_STATS))
+        _netlink_stats(entry, &stats, 64 == have_stats);
+
+    if (flags & NETSNMP_INTERFACE_FLAGS_HAS_IPV4)
+        _arch_interface_flags_v4_get(entry);
+
+#ifdef NETSNMP_ENABLE_IPV6
+    if (flags & NETSNMP_INTERFACE_FLAGS_HAS_IPV6)
+        _arch_interface_flags_v6_get(entry);
+#endif /* NETSNMP_ENABLE_IPV6 */
+
+    /*
+     * add to container
+     */
+    if (CONTAINER_INSERT(ctx->container, entry) != 0)
+        netsnmp_access_interface_entry_free(entry);
+    return 0;
+}
+
+/**
+ * @internal
+ * load the interfaces from a RTM_GETLINK dump, with their ip versions
+ * from the addresses kept by ipaddress_linux
+ *
+ * @retval  0 success
+ * @retval -2 rtnetlink not available
+ * @retval -3 could not create entry (probably malloc)
+ * @retval <0 other errors
+ */
+static int
+_load_netlink(netsnmp_container *container, u_int load_flags)
+{
+    _netlink_load_ctx ctx;
+    int rc;
+
+    /*
+     * catch up with the notifications first, so that status changes
+     * are not mistaken for ones we already know about.
+     */
+    if (_ifcache_fd >= 0)
+        while (_ifcache_recv(_ifcache_fd) > 0)
+            ;
+
+    /*
+     * set address type flags.
+     * the only way I know of to check an interface for
+     * ip version is to look for ip addresses. If anyone
+     * knows a better way, put it here!
+     */
+    if (NULL != _ifcache) {
+        netsnmp_container *addrs = netsnmp_linux_ipaddress_container();
+
+        if (NULL == addrs)
+            return -2;
+        CONTAINER_FOR_EACH(_ifcache,
+                           (netsnmp_container_obj_func *) _ifcache_clear_ip_flags,
+                           NULL);
+        CONTAINER_FOR_EACH(addrs,
+                           (netsnmp_container_obj_func *) _netlink_addr,
+                           NULL);
+    }
+
+    ctx.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (ctx.fd < 0) {
+        snmp_log_perror("interface_linux: could not create socket");
+        return -2;
+    }
+    ctx.container = container;
+    ctx.load_flags = load_flags;
+
+    ++_ifcache_generation;
+    rc = _netlink_dump(RTM_GETLINK, _netlink_link, &ctx);
+    close(ctx.fd);
+
+    if (0 == rc && NULL != _ifcache)
+        _ifcache_gc();
+
+    return rc;
+}
+#endif /* HAVE_LINUX_RTNETLINK_H */
+
+/**
+ * @internal
+ * load the interfaces from /proc/net/dev and ioctls
  *
  * @retval  0 success
- * @retval -1 no container specified
  * @retval -2 could not open /proc/net/dev
  * @retval -3 could not create entry (probably malloc)
  */
-int
-netsnmp_arch_interface_container_load(netsnmp_container* container,
-                                      u_int load_flags)
+static int
+_load_procfs(netsnmp_container *container, u_int load_flags)
 {
     FILE           *devin;
     char            line[256];
@@ -605,14 +1411,6 @@ netsnmp_arch_interface_container_load(netsnmp_container* container,
     netsnmp_container *addr_container;
 #endif
 
-    DEBUGMSGTL(("access:interface:container:arch", "load (flags %x)\n",
-                load_flags));
-
-    if (NULL == container) {
-        snmp_log(LOG_ERR, "no container specified/found for interface\n");
-        return -1;
-    }
-
     if (!(devin = fopen("/proc/net/dev", "r"))) {
         DEBUGMSGTL(("access:interface",
                     "Failed to load Interface Table (linux1)\n"));
@@ -748,136 +1546,15 @@ netsnmp_arch_interface_container_load(netsnmp_container* container,
          */
         netsnmp_access_interface_ioctl_physaddr_get(fd, entry);
 
-        /*
-         * physaddr should have set type. make some guesses (based
-         * on name) if not.
-         */
-        if(0 == entry->type) {
-            typedef struct _match_if {
-               int             mi_type;
-               const char     *mi_name;
-            }              *pmatch_if, match_if;
-            
-            static match_if lmatch_if[] = {
-                {IANAIFTYPE_SOFTWARELOOPBACK, "lo"},
-                {IANAIFTYPE_ETHERNETCSMACD, "eth"},
-                {IANAIFTYPE_ETHERNETCSMACD, "vmnet"},
-                {IANAIFTYPE_ISO88025TOKENRING, "tr"},
-                {IANAIFTYPE_FASTETHER, "feth"},
-                {IANAIFTYPE_GIGABITETHERNET,"gig"},
-                {IANAIFTYPE_INFINIBAND,"ib"},
-                {IANAIFTYPE_PPP, "ppp"},
-                {IANAIFTYPE_SLIP, "sl"},
-                {IANAIFTYPE_TUNNEL, "sit"},
-                {IANAIFTYPE_BASICISDN, "ippp"},
-                {IANAIFTYPE_PROPVIRTUAL, "bond"}, /* Bonding driver find fastest slave */
-                {IANAIFTYPE_PROPVIRTUAL, "vad"},  /* ANS driver - ?speed? */
-                {0, NULL}                  /* end of list */
-            };
-
-            int             len;
-            register pmatch_if pm;
-            
-            for (pm = lmatch_if; pm->mi_name; pm++) {
-                len = strlen(pm->mi_name);
-                if (0 == strncmp(entry->name, pm->mi_name, len)) {
-                    entry->type = pm->mi_type;
-                    break;
-                }
-            }
-            if(NULL == pm->mi_name)
-                entry->type = IANAIFTYPE_OTHER;
-        }
-
-        /*
-         * interface identifier is specified based on physaddr and type
-         */
-        switch (entry->type) {
-        case IANAIFTYPE_ETHERNETCSMACD:
-        case IANAIFTYPE_ETHERNET3MBIT:
-        case IANAIFTYPE_FASTETHER:
-        case IANAIFTYPE_FASTETHERFX:
-        case IANAIFTYPE_GIGABITETHERNET:
-        case IANAIFTYPE_FDDI:
-        case IANAIFTYPE_ISO88025TOKENRING:
-            if (NULL != entry->paddr && ETH_ALEN != entry->paddr_len)
-                break;
+        _arch_interface_type_guess(entry);
+        _arch_interface_v6_if_id_set(entry);
+        _arch_interface_speed_get(fd, entry);
 
-            entry->v6_if_id_len = entry->paddr_len + 2;
-            memcpy(entry->v6_if_id, entry->paddr, 3);
-            memcpy(entry->v6_if_id + 5, entry->paddr + 3, 3);
-            entry->v6_if_id[0] ^= 2;
-            entry->v6_if_id[3] = 0xFF;
-            entry->v6_if_id[4] = 0xFE;
-
-            entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_IFID;
-            break;
-
-        case IANAIFTYPE_SOFTWARELOOPBACK:
-            entry->v6_if_id_len = 0;
-            entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_IFID;
-            break;
-        }
-
-        if (IANAIFTYPE_ETHERNETCSMACD == entry->type) {
-            unsigned long long speed;
-            unsigned long long defaultspeed = NOMINAL_LINK_SPEED;
-            if (!(entry->os_flags & IFF_RUNNING)) {
-                /*
-                 * use speed 0 if the if speed cannot be determined *and* the
-                 * interface is down
-                 */
-                defaultspeed = 0;
-            }
-            speed = netsnmp_linux_interface_get_if_speed(fd,
-                    entry->name, defaultspeed);
-            if (speed > 0xffffffffL) {
-                entry->speed = 0xffffffff;
-            } else
-                entry->speed = speed;
-            entry->speed_high = speed / 1000000LL;
-        }
-#ifdef APPLIED_PATCH_836390   /* xxx-rks ifspeed fixes */
-        else if (IANAIFTYPE_PROPVIRTUAL == entry->type)
-            entry->speed = _get_bonded_if_speed(entry);
-#endif
-        else
-            netsnmp_access_interface_entry_guess_speed(entry);
-        
         netsnmp_access_interface_ioctl_flags_get(fd, entry);
 
         netsnmp_access_interface_ioctl_mtu_get(fd, entry);
 
-        /*
-         * Zero speed means link problem.
-         * - i'm not sure this is always true...
-         */
-        if((entry->speed == 0) && (entry->os_flags & IFF_UP)) {
-            entry->os_flags &= ~IFF_RUNNING;
-        }
-
-        /*
-         * check for promiscuous mode.
-         *  NOTE: there are 2 ways to set promiscuous mode in Linux
-         *  (kernels later than 2.2.something) - using ioctls and
-         *  using setsockopt. The ioctl method tested here does not
-         *  detect if an interface was set using setsockopt. google
-         *  on IFF_PROMISC and linux to see lots of arguments about it.
-         */
-        if(entry->os_flags & IFF_PROMISC) {
-            entry->promiscuous = 1; /* boolean */
-        }
-
-        /*
-         * hardcoded max packet size
-         * (see ip_frag_reasm: if(len > 65535) goto out_oversize;)
-         */
-        entry->reasm_max_v4 = entry->reasm_max_v6 = 65535;
-        entry->ns_flags |= 
-            NETSNMP_INTERFACE_FLAGS_HAS_V4_REASMMAX |
-            NETSNMP_INTERFACE_FLAGS_HAS_V6_REASMMAX;
-
-        netsnmp_access_interface_entry_overrides(entry);
+        _arch_interface_entry_finish(entry);
 
         if (! (load_flags & NETSNMP_ACCESS_INTERFACE_LOAD_NO_STATS))
             _parse_stats(entry, stats, scan_expected);
@@ -903,6 +1580,36 @@ netsnmp_arch_interface_container_load(netsnmp_container* container,
     return 0;
 }
 
+/*
+ *
+ * @retval  0 success
+ * @retval -1 no container specified
+ * @retval -2 could not open /proc/net/dev
+ * @retval -3 could not create entry (probably malloc)
+ */
+int
+netsnmp_arch_interface_container_load(netsnmp_container* container,
+                                      u_int load_flags)
+{
+    DEBUGMSGTL(("access:interface:container:arch", "load (flags %x)\n",
+                load_flags));
+
+    if (NULL == container) {
+        snmp_log(LOG_ERR, "no container specified/found for interface\n");
+        return -1;
+    }
+
+#ifdef HAVE_LINUX_RTNETLINK_H
+    {
+        int rc = _load_netlink(container, load_flags);
+        if (-2 != rc)
+            return rc;
+    }
+#endif
+
+    return _load_procfs(container, load_flags);
+}
+
 #ifndef NETSNMP_FEATURE_REMOVE_INTERFACE_ARCH_SET_ADMIN_STATUS
 int
 netsnmp_arch_set_admin_status(netsnmp_interface_entry * entry,
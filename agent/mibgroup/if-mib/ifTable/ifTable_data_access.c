@@ -313,7 +313,7 @@ static void
 _check_interface_entry_for_updates(ifTable_rowreq_ctx * rowreq_ctx,
                                    cd_container *cdc)
 {
-    char            oper_changed = 0;
+    char            oper_changed = 0, has_lastchange = 0;
     int lastchanged = rowreq_ctx->data.ifLastChange;
     netsnmp_container *ifcontainer = cdc->current;
 
@@ -403,9 +403,10 @@ _check_interface_entry_for_updates(ifTable_rowreq_ctx * rowreq_ctx,
         /*
          * Check for changes, then update
          */
-        if ((!(ifentry->ns_flags & NETSNMP_INTERFACE_FLAGS_HAS_LASTCHANGE))
-            && (rowreq_ctx->data.ifOperStatus != ifentry->oper_status))
+        if (rowreq_ctx->data.ifOperStatus != ifentry->oper_status)
             oper_changed = 1;
+        if (ifentry->ns_flags & NETSNMP_INTERFACE_FLAGS_HAS_LASTCHANGE)
+            has_lastchange = 1;
         netsnmp_access_interface_entry_copy(rowreq_ctx->data.ifentry,
                                             ifentry);
 
@@ -417,10 +418,12 @@ _check_interface_entry_for_updates(ifTable_rowreq_ctx * rowreq_ctx,
     }
 
     /*
-     * if ifOperStatus changed, update ifLastChange
+     * if ifOperStatus changed, update ifLastChange, unless the
+     * architecture knows when it happened.
      */
     if (oper_changed) {
-        rowreq_ctx->data.ifLastChange = netsnmp_get_agent_uptime();
+        if (!has_lastchange)
+            rowreq_ctx->data.ifLastChange = netsnmp_get_agent_uptime();
 #ifdef USING_IF_MIB_IFXTABLE_IFXTABLE_MODULE
         if (rowreq_ctx->data.ifLinkUpDownTrapEnable == 1) {
             if (rowreq_ctx->data.ifOperStatus == IFOPERSTATUS_UP) {
@@ -440,7 +443,7 @@ _check_interface_entry_for_updates(ifTable_rowreq_ctx * rowreq_ctx,
 #endif
     }
 
-    else
+    else if (!has_lastchange)
         rowreq_ctx->data.ifLastChange = lastchanged;
 }
 
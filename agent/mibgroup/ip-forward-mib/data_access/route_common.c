@@ -15,6 +15,8 @@
  * local static prototypes
  */
 static void _access_route_entry_release(netsnmp_route_entry * entry, void *unused);
+static void _access_route_entry_update(netsnmp_route_entry * entry,
+                                       netsnmp_route_access *access);
 
 /**---------------------------------------------------------------------*/
 /*
@@ -29,6 +31,10 @@ extern int
 netsnmp_arch_route_create(netsnmp_route_entry *entry);
 extern int
 netsnmp_arch_route_delete(netsnmp_route_entry *entry);
+extern int
+netsnmp_arch_route_access_load(netsnmp_route_access *access);
+extern int
+netsnmp_arch_route_access_unload(netsnmp_route_access *access);
 
 
 /**---------------------------------------------------------------------*/
@@ -89,6 +95,120 @@ netsnmp_access_route_container_free(netsnmp_container *container, u_int free_fla
         CONTAINER_FREE(container);
 }
 
+/**---------------------------------------------------------------------*/
+/*
+ * route access functions
+ */
+
+/**
+ * @param cache_flags   flags of the cache the container belongs to. When
+ *                      subscribing, the container is kept between loads.
+ * @param cache_expired set when the subscription is lost, so the next
+ *                      load resynchronizes.
+ */
+netsnmp_route_access *
+netsnmp_access_route_create(u_int init_flags,
+                            NetsnmpAccessRouteUpdate *update_hook,
+                            NetsnmpAccessRouteGC *gc_hook,
+                            int *cache_flags, char *cache_expired)
+{
+    netsnmp_route_access *access;
+
+    access = SNMP_MALLOC_TYPEDEF(netsnmp_route_access);
+    if (NULL == access) {
+        snmp_log(LOG_ERR,"malloc error in netsnmp_access_route_create\n");
+        return NULL;
+    }
+
+    access->flags = init_flags;
+    access->update_hook = update_hook;
+    access->gc_hook = gc_hook;
+    access->cache_expired = cache_expired;
+
+    if ((init_flags & NETSNMP_ACCESS_ROUTE_CREATE_SUBSCRIBE) &&
+        (NULL != cache_flags))
+        *cache_flags |= NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD |
+            NETSNMP_CACHE_DONT_FREE_EXPIRED | NETSNMP_CACHE_DONT_AUTO_RELEASE;
+
+    DEBUGMSGTL(("access:route:access", "create (flags %x)\n", init_flags));
+
+    return access;
+}
+
+int
+netsnmp_access_route_delete(netsnmp_route_access *access)
+{
+    if (NULL == access)
+        return 0;
+
+    netsnmp_access_route_unload(access);
+    free(access);
+
+    return 0;
+}
+
+/**
+ * @retval  0 success
+ * @retval -1 error
+ */
+int
+netsnmp_access_route_load(netsnmp_route_access *access)
+{
+    netsnmp_container *container;
+    int                rc;
+
+    if (access->flags & NETSNMP_ACCESS_ROUTE_CREATE_SUBSCRIBE) {
+        rc = netsnmp_arch_route_access_load(access);
+        if (0 == rc)
+            return 0;
+
+        if (-2 == rc) {
+            /*
+             * not supported here: reload everything every time
+             */
+            snmp_log(LOG_WARNING, "route updates not supported, "
+                     "reloading routes instead\n");
+            access->flags &= ~NETSNMP_ACCESS_ROUTE_CREATE_SUBSCRIBE;
+        }
+        /*
+         * else the subscription failed or timed out: reload everything
+         * this time, and subscribe again on the next load
+         */
+    }
+
+    DEBUGMSGTL(("access:route:access", "load\n"));
+
+    container = netsnmp_access_route_container_load(NULL,
+                                          NETSNMP_ACCESS_ROUTE_LOAD_NOFLAGS);
+    if (NULL == container)
+        return -1;
+
+    access->generation++;
+    CONTAINER_FOR_EACH(container,
+                       (netsnmp_container_obj_func *) _access_route_entry_update,
+                       access);
+    /*
+     * the update hook claimed every entry
+     */
+    netsnmp_access_route_container_free(container,
+                                        NETSNMP_ACCESS_ROUTE_FREE_DONT_CLEAR);
+    access->gc_hook(access);
+
+    return 0;
+}
+
+int
+netsnmp_access_route_unload(netsnmp_route_access *access)
+{
+    DEBUGMSGTL(("access:route:access", "unload\n"));
+
+    if (access->flags & NETSNMP_ACCESS_ROUTE_CREATE_SUBSCRIBE)
+        netsnmp_arch_route_access_unload(access);
+    access->synchronized = 0;
+
+    return 0;
+}
+
 /**---------------------------------------------------------------------*/
 /*
  * ifentry functions
@@ -228,10 +348,12 @@ netsnmp_access_route_entry_copy(netsnmp_route_entry *lhs,
         if ((NETSNMP_ACCESS_ROUTE_POLICY_STATIC & rhs->flags) &&
             ! (NETSNMP_ACCESS_ROUTE_POLICY_DEEP_COPY & rhs->flags)) {
             lhs->rt_policy = rhs->rt_policy;
+            lhs->flags |= NETSNMP_ACCESS_ROUTE_POLICY_STATIC;
         }
         else {
             snmp_clone_mem((void **) &lhs->rt_policy, rhs->rt_policy,
                            rhs->rt_policy_len * sizeof(oid));
+            lhs->flags &= ~NETSNMP_ACCESS_ROUTE_POLICY_STATIC;
         }
     }
     lhs->rt_policy_len = rhs->rt_policy_len;
@@ -272,6 +394,16 @@ netsnmp_access_route_entry_copy(netsnmp_route_entry *lhs,
  * Utility routines
  */
 
+/**
+ */
+static void
+_access_route_entry_update(netsnmp_route_entry * entry,
+                           netsnmp_route_access *access)
+{
+    entry->generation = access->generation;
+    access->update_hook(access, entry);
+}
+
 /**
  */
 void
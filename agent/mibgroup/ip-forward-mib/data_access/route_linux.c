@@ -16,6 +16,109 @@
 #include "ip-forward-mib/inetCidrRouteTable/inetCidrRouteTable_constants.h"
 #include "if-mib/data_access/interface_ioctl.h"
 
+#include <errno.h>
+#ifdef HAVE_LINUX_RTNETLINK_H
+#include <linux/types.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+/*
+ * big enough for the kernel to put a few hundred routes in every
+ * datagram of a dump.
+ */
+#define ROUTE_NETLINK_BUF_SIZE 32768
+
+/*
+ * the subscription socket has to absorb bursts of updates, like a
+ * BGP session coming up, between two passes of the agent main loop.
+ */
+#define ROUTE_NETLINK_RCVBUF (4 * 1024 * 1024)
+
+typedef int (_netlink_route_func)(netsnmp_route_entry *entry, void *context);
+
+static void _route_read_netlink(int fd, void *data);
+
+/*
+ * sequence number of the last dump of the subscription socket
+ */
+static unsigned int _route_dump_seq;
+
+/*
+ * how long a load waits for the dump of the subscription socket
+ */
+#define ROUTE_NETLINK_DUMP_TIMEOUT 5
+
+#ifdef USING_IP_FORWARD_MIB_INETCIDRROUTETABLE_INETCIDRROUTETABLE_MODULE
+static netsnmp_container *_policies = NULL;
+
+static int
+_policy_compare(const void *lhs, const void *rhs)
+{
+    const oid *l = (const oid *) lhs, *r = (const oid *) rhs;
+
+    if (l[1] != r[1])
+        return l[1] < r[1] ? -1 : 1;
+    if (l[2] != r[2])
+        return l[2] < r[2] ? -1 : 1;
+    return 0;
+}
+
+/*
+ * routes only differ in a handful of policies (one per interface and
+ * routing table). The rows kept up to date by the subscription share
+ * them instead of holding one per route. They are flagged
+ * NETSNMP_ACCESS_ROUTE_POLICY_STATIC, and the policies are freed with
+ * the subscription, in netsnmp_arch_route_access_unload.
+ */
+static void
+_policy_share(netsnmp_route_entry *entry)
+{
+    oid *policy;
+
+    if ((NULL == entry->rt_policy) ||
+        (entry->flags & NETSNMP_ACCESS_ROUTE_POLICY_STATIC))
+        return;
+
+    if (NULL == _policies) {
+        _policies = netsnmp_container_find("access:route:policies:"
+                                           "table_container");
+        if (NULL == _policies)
+            return;
+        _policies->compare = _policy_compare;
+    }
+
+    policy = (oid *) CONTAINER_FIND(_policies, entry->rt_policy);
+    if (NULL == policy) {
+        if (CONTAINER_INSERT(_policies, entry->rt_policy) != 0)
+            return;
+    } else {
+        free(entry->rt_policy);
+        entry->rt_policy = policy;
+    }
+    entry->flags |= NETSNMP_ACCESS_ROUTE_POLICY_STATIC;
+}
+
+static void
+_policy_free(void *policy, void *context)
+{
+    free(policy);
+}
+#endif
+#endif
+
+#ifdef USING_IP_FORWARD_MIB_INETCIDRROUTETABLE_INETCIDRROUTETABLE_MODULE
+static void
+_policy_set(netsnmp_route_entry *entry, oid table, oid if_index)
+{
+    entry->rt_policy = calloc(3, sizeof(oid));
+    if (NULL == entry->rt_policy)
+        return;
+    entry->rt_policy[1] = table;
+    entry->rt_policy[2] = if_index;
+    entry->rt_policy_len = 3;
+}
+#endif
+
 static int
 _type_from_flags(unsigned int flags)
 {
@@ -163,11 +266,8 @@ _load_ipv4(netsnmp_container* container, u_long *index )
          * xxx-rks: It should really only be for the duplicate case, but that
          *     would be more complicated than I want to get into now. Fix later.
          */
-        if (0 == nexthop) {
-            entry->rt_policy = calloc(3, sizeof(oid));
-            entry->rt_policy[2] = entry->if_index;
-            entry->rt_policy_len = sizeof(oid)*3;
-        }
+        if (0 == nexthop)
+            _policy_set(entry, 0, entry->if_index);
 #endif
 
         /*
@@ -309,12 +409,11 @@ _load_ipv6(netsnmp_container* container, u_long *index )
         */
         /*
          * on linux, default routes all look alike, and would have the same
-         * indexed based on dest and next hop. So we use our arbitrary index
-         * as the policy, to distinguish between them.
+         * indexed based on dest and next hop. So we use the if index
+         * as the policy, like the rtnetlink loader does. The table is
+         * not listed here, so it is left out.
          */
-        entry->rt_policy = calloc(3, sizeof(oid));
-        entry->rt_policy[2] = entry->ns_rt_index;
-        entry->rt_policy_len = sizeof(oid)*3;
+        _policy_set(entry, 0, entry->if_index);
 #endif
 
         /*
@@ -336,6 +435,566 @@ _load_ipv6(netsnmp_container* container, u_long *index )
 }
 #endif
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+/*
+ * fill in everything but the next hop and interface
+ */
+static void
+_netlink_route_fill(netsnmp_route_entry *entry, const struct rtmsg *rtm,
+                    struct rtattr **tb)
+{
+    int  len;
+
+    len = (AF_INET6 == rtm->rtm_family) ? 16 : 4;
+    entry->rt_dest_type = (16 == len) ?
+        INETADDRESSTYPE_IPV6 : INETADDRESSTYPE_IPV4;
+    entry->rt_dest_len = len;
+    if (tb[RTA_DST] && RTA_PAYLOAD(tb[RTA_DST]) >= len)
+        memcpy(entry->rt_dest, RTA_DATA(tb[RTA_DST]), len);
+    entry->rt_pfx_len = rtm->rtm_dst_len;
+
+    entry->rt_nexthop_type = entry->rt_dest_type;
+    entry->rt_nexthop_len = len;
+
+#ifdef USING_IP_FORWARD_MIB_IPCIDRROUTETABLE_IPCIDRROUTETABLE_MODULE
+    if (4 == len)
+        entry->rt_mask = htonl(rtm->rtm_dst_len ?
+                               0xffffffffU << (32 - rtm->rtm_dst_len) : 0);
+    entry->rt_tos = rtm->rtm_tos;
+#endif
+
+    if (tb[RTA_PRIORITY])
+        entry->rt_metric1 = *(uint32_t *) RTA_DATA(tb[RTA_PRIORITY]);
+    else
+        entry->rt_metric1 = 0;
+
+    switch (rtm->rtm_type) {
+    case RTN_UNREACHABLE:
+    case RTN_PROHIBIT:
+        entry->rt_type = INETCIDRROUTETYPE_REJECT;
+        break;
+    case RTN_BLACKHOLE:
+        entry->rt_type = INETCIDRROUTETYPE_BLACKHOLE;
+        break;
+    case RTN_UNICAST:
+        /* remote or local is decided by the next hop */
+        entry->rt_type = INETCIDRROUTETYPE_LOCAL;
+        break;
+    default:
+        entry->rt_type = INETCIDRROUTETYPE_LOCAL;
+        break;
+    }
+
+    switch (rtm->rtm_protocol) {
+    case RTPROT_REDIRECT:
+        entry->rt_proto = IANAIPROUTEPROTOCOL_ICMP;
+        break;
+    case RTPROT_STATIC:
+        entry->rt_proto = IANAIPROUTEPROTOCOL_NETMGMT;
+        break;
+#ifdef RTPROT_BGP
+    case RTPROT_BGP:
+        entry->rt_proto = IANAIPROUTEPROTOCOL_BGP;
+        break;
+#endif
+#ifdef RTPROT_OSPF
+    case RTPROT_OSPF:
+        entry->rt_proto = IANAIPROUTEPROTOCOL_OSPF;
+        break;
+#endif
+#ifdef RTPROT_RIP
+    case RTPROT_RIP:
+        entry->rt_proto = IANAIPROUTEPROTOCOL_RIP;
+        break;
+#endif
+#ifdef RTPROT_ISIS
+    case RTPROT_ISIS:
+        entry->rt_proto = IANAIPROUTEPROTOCOL_ISIS;
+        break;
+#endif
+#ifdef RTPROT_EIGRP
+    case RTPROT_EIGRP:
+        entry->rt_proto = IANAIPROUTEPROTOCOL_CISCOEIGRP;
+        break;
+#endif
+    default:
+        entry->rt_proto = IANAIPROUTEPROTOCOL_LOCAL;
+        break;
+    }
+}
+
+/*
+ * set the next hop of a filled in entry, and pass it on
+ */
+static int
+_netlink_route_nexthop(netsnmp_route_entry *entry, const struct rtmsg *rtm,
+                       u_int table, int if_index, struct rtattr *gateway,
+                       _netlink_route_func *func, void *context)
+{
+    entry->if_index = if_index;
+    if (gateway && RTA_PAYLOAD(gateway) >= entry->rt_nexthop_len) {
+        memcpy(entry->rt_nexthop, RTA_DATA(gateway), entry->rt_nexthop_len);
+        if (RTN_UNICAST == rtm->rtm_type)
+            entry->rt_type = INETCIDRROUTETYPE_REMOTE;
+    }
+
+#ifdef USING_IP_FORWARD_MIB_INETCIDRROUTETABLE_INETCIDRROUTETABLE_MODULE
+    /*
+     * same as the /proc loader: the if index tells apart routes which
+     * only differ in their interface. ipv6 routes of the other tables
+     * (local, ...) show up too, so the table goes into the policy as well.
+     */
+    if (INETADDRESSTYPE_IPV6 == entry->rt_dest_type)
+        _policy_set(entry, RT_TABLE_MAIN == table ? 0 : table, if_index);
+    else if (NULL == gateway)
+        _policy_set(entry, 0, if_index);
+#endif
+
+    return (*func)(entry, context);
+}
+
+/*
+ * convert a RTM_NEWROUTE or RTM_DELROUTE message into entries, one for
+ * every next hop of the route.
+ *
+ * @retval  0 success (the message may have been skipped)
+ * @retval <0 error, or the return value of func
+ */
+static int
+_netlink_route(struct nlmsghdr *nlh, u_long *index,
+               _netlink_route_func *func, void *context)
+{
+    struct rtmsg        *rtm;
+    struct rtattr       *tb[RTA_MAX + 1], *rta;
+    netsnmp_route_entry *entry;
+    u_int                table;
+    int                  len, rc;
+
+    if (RTM_NEWROUTE != nlh->nlmsg_type && RTM_DELROUTE != nlh->nlmsg_type)
+        return 0;
+    if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*rtm)))
+        return -1;
+
+    rtm = (struct rtmsg *) NLMSG_DATA(nlh);
+    if ((AF_INET != rtm->rtm_family
+#ifdef NETSNMP_ENABLE_IPV6
+         && AF_INET6 != rtm->rtm_family
+#endif
+            ) || (rtm->rtm_flags & RTM_F_CLONED))
+        return 0;
+
+    memset(tb, 0, sizeof(tb));
+    len = nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*rtm));
+    for (rta = RTM_RTA(rtm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len))
+        if (rta->rta_type <= RTA_MAX)
+            tb[rta->rta_type] = rta;
+
+    table = rtm->rtm_table;
+#ifdef RTA_TABLE
+    if (tb[RTA_TABLE])
+        table = *(uint32_t *) RTA_DATA(tb[RTA_TABLE]);
+#endif
+
+    /*
+     * /proc/net/route only lists the main table, /proc/net/ipv6_route
+     * all of them.
+     */
+    if (AF_INET == rtm->rtm_family &&
+        (RT_TABLE_MAIN != table || RTN_BROADCAST == rtm->rtm_type ||
+         RTN_MULTICAST == rtm->rtm_type))
+        return 0;
+
+    if (NULL == tb[RTA_MULTIPATH]) {
+        entry = netsnmp_access_route_entry_create();
+        if (NULL == entry)
+            return -1;
+        entry->ns_rt_index = ++(*index);
+        if (RTM_DELROUTE == nlh->nlmsg_type)
+            entry->flags |= NETSNMP_ACCESS_ROUTE_REMOVED;
+        else if (nlh->nlmsg_flags & NLM_F_REPLACE)
+            entry->flags |= NETSNMP_ACCESS_ROUTE_REPLACE;
+        _netlink_route_fill(entry, rtm, tb);
+        return _netlink_route_nexthop(entry, rtm, table, tb[RTA_OIF] ?
+                                      *(int *) RTA_DATA(tb[RTA_OIF]) : 0,
+                                      tb[RTA_GATEWAY], func, context);
+    } else {
+        struct rtnexthop *nh = (struct rtnexthop *) RTA_DATA(tb[RTA_MULTIPATH]);
+        int               nh_len = RTA_PAYLOAD(tb[RTA_MULTIPATH]);
+        int               replace = RTM_NEWROUTE == nlh->nlmsg_type &&
+            (nlh->nlmsg_flags & NLM_F_REPLACE);
+
+        for (; nh_len >= (int) sizeof(*nh) && nh->rtnh_len >= sizeof(*nh) &&
+                 nh->rtnh_len <= nh_len;
+             nh_len -= NLMSG_ALIGN(nh->rtnh_len), nh = RTNH_NEXT(nh)) {
+            struct rtattr *gateway = NULL;
+            int            attr_len = nh->rtnh_len - sizeof(*nh);
+
+            for (rta = RTNH_DATA(nh); RTA_OK(rta, attr_len);
+                 rta = RTA_NEXT(rta, attr_len))
+                if (RTA_GATEWAY == rta->rta_type)
+                    gateway = rta;
+
+            entry = netsnmp_access_route_entry_create();
+            if (NULL == entry)
+                return -1;
+            entry->ns_rt_index = ++(*index);
+            if (RTM_DELROUTE == nlh->nlmsg_type)
+                entry->flags |= NETSNMP_ACCESS_ROUTE_REMOVED;
+            else if (replace) {
+                /* the old next hops go with the first new one */
+                entry->flags |= NETSNMP_ACCESS_ROUTE_REPLACE;
+                replace = 0;
+            }
+            _netlink_route_fill(entry, rtm, tb);
+            rc = _netlink_route_nexthop(entry, rtm, table, nh->rtnh_ifindex,
+                                        gateway, func, context);
+            if (rc < 0)
+                return rc;
+        }
+    }
+
+    return 0;
+}
+
+static int
+_netlink_route_dump_request(int fd, int family, unsigned int seq)
+{
+    struct {
+        struct nlmsghdr nlh;
+        struct rtmsg    rtm;
+    } req;
+    struct sockaddr_nl sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+
+    memset(&req, 0, sizeof(req));
+    req.nlh.nlmsg_len = sizeof(req);
+    req.nlh.nlmsg_type = RTM_GETROUTE;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nlh.nlmsg_seq = seq;
+    req.rtm.rtm_family = family;
+
+    if (sendto(fd, &req, sizeof(req), 0, (struct sockaddr *) &sa,
+               sizeof(sa)) < 0) {
+        DEBUGMSGTL(("access:route:netlink", "sendto: %s\n",
+                    strerror(errno)));
+        return -1;
+    }
+    return 0;
+}
+
+static int
+_netlink_route_insert(netsnmp_route_entry *entry, void *context)
+{
+    netsnmp_container *container = (netsnmp_container *) context;
+
+    if (CONTAINER_INSERT(container, entry) < 0) {
+        DEBUGMSGTL(("access:route:container", "error with route_entry: insert into container failed.\n"));
+        netsnmp_access_route_entry_free(entry);
+    }
+    return 0;
+}
+
+/*
+ * dump the routes of one address family
+ *
+ * @retval  0 success
+ * @retval -2 rtnetlink not available, nothing was loaded
+ * @retval -1 other errors, or the dump timed out
+ */
+static int
+_load_netlink(netsnmp_container *container, u_long *index, int family)
+{
+    static unsigned int seq;
+    long        buf[ROUTE_NETLINK_BUF_SIZE / sizeof(long)];
+    struct timeval timeout;
+    int         fd, len, rc = 0, done = 0, count = 0;
+
+    DEBUGMSGTL(("access:route:container",
+                "route_container_arch_load netlink (family %d)\n", family));
+
+    fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (fd < 0) {
+        DEBUGMSGTL(("access:route:netlink", "socket: %s\n", strerror(errno)));
+        return -2;
+    }
+
+    timeout.tv_sec = ROUTE_NETLINK_DUMP_TIMEOUT;
+    timeout.tv_usec = 0;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                   sizeof(timeout)) < 0)
+        DEBUGMSGTL(("access:route:netlink", "SO_RCVTIMEO: %s\n",
+                    strerror(errno)));
+
+    if (_netlink_route_dump_request(fd, family, ++seq) < 0) {
+        close(fd);
+        return -2;
+    }
+
+    while (!done) {
+        struct nlmsghdr *nlh = (struct nlmsghdr *) buf;
+
+        len = recv(fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (EINTR == errno)
+                continue;
+            if (EAGAIN == errno || EWOULDBLOCK == errno) {
+                snmp_log(LOG_WARNING, "route netlink dump timed out\n");
+                rc = -1;
+                break;
+            }
+            snmp_log_perror("route _load_netlink: recv");
+            rc = count ? -1 : -2;
+            break;
+        }
+        if (0 == len)
+            break;
+
+        for (; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_seq != seq)
+                continue;
+            if (NLMSG_DONE == nlh->nlmsg_type) {
+                done = 1;
+                break;
+            }
+            if (NLMSG_ERROR == nlh->nlmsg_type) {
+                DEBUGMSGTL(("access:route:netlink", "dump failed\n"));
+                rc = count ? -1 : -2;
+                done = 1;
+                break;
+            }
+            ++count;
+            if (_netlink_route(nlh, index, _netlink_route_insert,
+                               container) < 0) {
+                rc = -1;
+                done = 1;
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    DEBUGMSGTL(("access:route:netlink", "%d routes of family %d (rc %d)\n",
+                count, family, rc));
+
+    return rc;
+}
+
+/*
+ * route update subscription
+ */
+static int
+_netlink_route_update(netsnmp_route_entry *entry, void *context)
+{
+    netsnmp_route_access *access = (netsnmp_route_access *) context;
+
+#ifdef USING_IP_FORWARD_MIB_INETCIDRROUTETABLE_INETCIDRROUTETABLE_MODULE
+    _policy_share(entry);
+#endif
+    entry->generation = access->generation;
+    access->update_hook(access, entry);
+    return 0;
+}
+
+static void
+_route_read_netlink(int fd, void *data)
+{
+    netsnmp_route_access *access = (netsnmp_route_access *) data;
+    static u_long   index;
+    long            buf[ROUTE_NETLINK_BUF_SIZE / sizeof(long)];
+    struct nlmsghdr *nlh;
+    int             len;
+
+    do {
+        len = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    } while (len < 0 && EINTR == errno);
+    if (len < 0) {
+        if (EAGAIN == errno || EWOULDBLOCK == errno)
+            return;
+        /*
+         * ENOBUFS: updates were lost, resynchronize on the next load
+         */
+        snmp_log(LOG_WARNING, "route netlink buffer overrun\n");
+        access->synchronized = -1;
+        if (NULL != access->cache_expired)
+            *access->cache_expired = 1;
+        return;
+    }
+
+    for (nlh = (struct nlmsghdr *) buf; NLMSG_OK(nlh, len);
+         nlh = NLMSG_NEXT(nlh, len)) {
+        if (NLMSG_DONE == nlh->nlmsg_type) {
+            if (nlh->nlmsg_seq == _route_dump_seq)
+                access->synchronized = 1;
+            continue;
+        }
+        if (NLMSG_ERROR == nlh->nlmsg_type) {
+            if (nlh->nlmsg_seq == _route_dump_seq) {
+                snmp_log(LOG_ERR, "route netlink dump failed\n");
+                access->synchronized = -1;
+            }
+            continue;
+        }
+        if (_netlink_route(nlh, &index, _netlink_route_update, access) < 0)
+            NETSNMP_LOGONCE((LOG_ERR, "bad route netlink message\n"));
+    }
+}
+
+/*
+ * stop listening to route updates. The rows keep the shared policies,
+ * the next load subscribes again.
+ */
+static void
+_route_netlink_close(netsnmp_route_access *access)
+{
+    int fd = (uintptr_t) access->arch_magic;
+
+    if (fd > 0) {
+        unregister_readfd(fd);
+        close(fd);
+        access->arch_magic = NULL;
+    }
+    access->synchronized = 0;
+}
+
+/** arch specific route update subscription
+ * @internal
+ *
+ * The first load subscribes to the route changes of the kernel and dumps
+ * the routes, later ones return right away, unless updates were lost.
+ * The dump is given ROUTE_NETLINK_DUMP_TIMEOUT seconds, a kernel which
+ * does not answer does not block the agent.
+ *
+ * @retval  0 success
+ * @retval -1 error or timeout, the caller reloads the routes this time
+ * @retval -2 not supported, the caller reloads the routes instead
+ */
+int
+netsnmp_arch_route_access_load(netsnmp_route_access *access)
+{
+    int fd = (uintptr_t) access->arch_magic;
+    struct timeval now, deadline, timeout;
+
+    if (access->synchronized > 0)
+        return 0;
+
+    if (0 == fd) {
+        struct sockaddr_nl sa;
+        int                size = ROUTE_NETLINK_RCVBUF;
+
+        fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+        if (fd < 0) {
+            DEBUGMSGTL(("access:route:netlink", "socket: %s\n",
+                        strerror(errno)));
+            return -2;
+        }
+
+        memset(&sa, 0, sizeof(sa));
+        sa.nl_family = AF_NETLINK;
+        sa.nl_groups = RTMGRP_IPV4_ROUTE;
+#ifdef NETSNMP_ENABLE_IPV6
+        sa.nl_groups |= RTMGRP_IPV6_ROUTE;
+#endif
+        if (bind(fd, (struct sockaddr *) &sa, sizeof(sa)) < 0) {
+            DEBUGMSGTL(("access:route:netlink", "bind: %s\n",
+                        strerror(errno)));
+            close(fd);
+            return -2;
+        }
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0)
+            DEBUGMSGTL(("access:route:netlink", "SO_RCVBUF: %s\n",
+                        strerror(errno)));
+
+        if (register_readfd(fd, _route_read_netlink, access) != 0) {
+            snmp_log(LOG_ERR,"netsnmp_arch_route_access_load: error registering netlink socket\n");
+            close(fd);
+            return -1;
+        }
+        access->arch_magic = (void *)(uintptr_t)fd;
+    }
+
+    DEBUGMSGTL(("access:route:netlink", "synchronizing routes\n"));
+
+    access->generation++;
+    access->synchronized = 0;
+    if (_netlink_route_dump_request(fd, AF_UNSPEC, ++_route_dump_seq) < 0) {
+        _route_netlink_close(access);
+        return -1;
+    }
+
+    /*
+     * the updates which come in meanwhile are applied in order
+     */
+    netsnmp_get_monotonic_clock(&deadline);
+    deadline.tv_sec += ROUTE_NETLINK_DUMP_TIMEOUT;
+    while (0 == access->synchronized) {
+        fd_set readfds;
+        int    rc;
+
+        netsnmp_get_monotonic_clock(&now);
+        if (!timercmp(&now, &deadline, <)) {
+            snmp_log(LOG_WARNING, "route netlink dump timed out\n");
+            _route_netlink_close(access);
+            return -1;
+        }
+        NETSNMP_TIMERSUB(&deadline, &now, &timeout);
+
+        FD_ZERO(&readfds);
+        FD_SET(fd, &readfds);
+        rc = select(fd + 1, &readfds, NULL, NULL, &timeout);
+        if (rc < 0 && EINTR != errno)
+            break;
+        if (rc > 0)
+            _route_read_netlink(fd, access);
+    }
+    if (access->synchronized <= 0) {
+        /*
+         * overrun or error during the dump itself: retry on the next load
+         */
+        access->synchronized = 0;
+        return -1;
+    }
+    access->gc_hook(access);
+
+    return 0;
+}
+
+int
+netsnmp_arch_route_access_unload(netsnmp_route_access *access)
+{
+    _route_netlink_close(access);
+
+#ifdef USING_IP_FORWARD_MIB_INETCIDRROUTETABLE_INETCIDRROUTETABLE_MODULE
+    /*
+     * the rows sharing them are released along with the subscription
+     */
+    if (NULL != _policies) {
+        CONTAINER_CLEAR(_policies, _policy_free, NULL);
+        CONTAINER_FREE(_policies);
+        _policies = NULL;
+    }
+#endif
+
+    return 0;
+}
+
+#else /* HAVE_LINUX_RTNETLINK_H */
+
+int
+netsnmp_arch_route_access_load(netsnmp_route_access *access)
+{
+    return -2;
+}
+
+int
+netsnmp_arch_route_access_unload(netsnmp_route_access *access)
+{
+    return 0;
+}
+
+#endif /* HAVE_LINUX_RTNETLINK_H */
+
 /** arch specific load
  * @internal
  *
@@ -358,6 +1017,26 @@ netsnmp_access_route_container_arch_load(netsnmp_container* container,
         return -1;
     }
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+    rc = _load_netlink(container, &count, AF_INET);
+#ifdef NETSNMP_ENABLE_IPV6
+    if ((0 == rc) && !(load_flags & NETSNMP_ACCESS_ROUTE_LOAD_IPV4_ONLY)) {
+        rc = _load_netlink(container, &count, AF_INET6);
+        if (-2 == rc)
+            rc = 0;
+    }
+#endif
+    if (0 == rc)
+        return 0;
+
+    /*
+     * start over from /proc
+     */
+    netsnmp_access_route_container_free(container,
+                                        NETSNMP_ACCESS_ROUTE_FREE_KEEP_CONTAINER);
+    count = 0;
+#endif
+
     rc = _load_ipv4(container, &count);
     
 #ifdef NETSNMP_ENABLE_IPV6
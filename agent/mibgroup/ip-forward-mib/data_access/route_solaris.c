@@ -98,6 +98,23 @@ netsnmp_arch_route_delete(netsnmp_route_entry *entry)
     return -2;
 }
 
+/** arch specific route update subscription
+ * @internal
+ *
+ * @retval -2 not supported, the caller reloads the routes instead
+ */
+int
+netsnmp_arch_route_access_load(netsnmp_route_access *access)
+{
+    return -2;
+}
+
+int
+netsnmp_arch_route_access_unload(netsnmp_route_access *access)
+{
+    return 0;
+}
+
 
 static int
 IP_Cmp_Route(void *addr, void *ep)
@@ -138,6 +138,23 @@ netsnmp_arch_route_delete(netsnmp_route_entry *entry)
     return (err == 0 ? 0 : -2);
 }
 
+/** arch specific route update subscription
+ * @internal
+ *
+ * @retval -2 not supported, the caller reloads the routes instead
+ */
+int
+netsnmp_arch_route_access_load(netsnmp_route_access *access)
+{
+    return -2;
+}
+
+int
+netsnmp_arch_route_access_unload(netsnmp_route_access *access)
+{
+    return 0;
+}
+
 #if defined(freebsd4) || defined(netbsd4) || defined(openbsd) || defined(darwin)
 static int
 _type_from_flags(int flags)
@@ -344,7 +361,7 @@ _load_routing_table_from_sysctl(netsnmp_container* container, int *index,
         */
 	entry->rt_policy = calloc(3, sizeof(oid));
 	entry->rt_policy[2] = entry->if_index;
-	entry->rt_policy_len = sizeof(oid)*3;
+	entry->rt_policy_len = 3;
 #endif
 
         entry->rt_type = _type_from_flags(rtm->rtm_flags);
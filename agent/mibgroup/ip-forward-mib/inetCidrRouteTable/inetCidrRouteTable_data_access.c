@@ -19,6 +19,10 @@
 
 #include "inetCidrRouteTable_data_access.h"
 
+netsnmp_feature_require(container_lifo)
+static netsnmp_route_access *route_access = NULL;
+static netsnmp_cache *route_cache = NULL;
+
 /** @ingroup interface 
  * @addtogroup data_access data_access: Routines to access data
  *
@@ -62,6 +66,12 @@ inetCidrRouteTable_init_data(inetCidrRouteTable_registration *
     /*
      * TODO:303:o: Initialize inetCidrRouteTable data.
      */
+    netsnmp_ds_register_config(ASN_BOOLEAN,
+                               netsnmp_ds_get_string(NETSNMP_DS_LIBRARY_ID,
+                                                     NETSNMP_DS_LIB_APPTYPE),
+                               "route_netlink_updates",
+                               NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_ROUTE_UPDATES);
 
     return MFD_SUCCESS;
 }                               /* inetCidrRouteTable_init_data */
@@ -112,14 +122,19 @@ inetCidrRouteTable_container_init(netsnmp_container **container_ptr_ptr,
     /*
      * For advanced users, you can use a custom container. If you
      * do not create one, one will be created for you.
+     *
+     * routes come and go one by one when updates are enabled, and full
+     * routing tables are big: use a tree.
      */
-    *container_ptr_ptr = NULL;
+    *container_ptr_ptr =
+        netsnmp_container_find("inetCidrRouteTable:btree:table_container");
 
     if (NULL == cache) {
         snmp_log(LOG_ERR,
                  "bad cache param to inetCidrRouteTable_container_init\n");
         return;
     }
+    route_cache = cache;
 
     /*
      * TODO:345:A: Set up inetCidrRouteTable cache properties.
@@ -132,34 +147,94 @@ inetCidrRouteTable_container_init(netsnmp_container **container_ptr_ptr,
     cache->timeout = INETCIDRROUTETABLE_CACHE_TIMEOUT;  /* seconds */
 }                               /* inetCidrRouteTable_container_init */
 
+/*
+ * policy sub-identifier i, with a missing policy being { 0, 0 }. Where
+ * the arch code uses one, the interface index comes last, after the
+ * first two, and goes with the next hop rather than the route.
+ */
+static oid
+_route_policy(const netsnmp_route_entry *entry, int i)
+{
+    if ((NULL == entry->rt_policy) || (i >= entry->rt_policy_len))
+        return 0;
+    return entry->rt_policy[i];
+}
+
+/* do two entries belong to the same route, whatever their next hops? */
+static int
+_same_route(const netsnmp_route_entry *lhs, const netsnmp_route_entry *rhs)
+{
+    return (lhs->rt_dest_type == rhs->rt_dest_type &&
+            lhs->rt_dest_len == rhs->rt_dest_len &&
+            memcmp(lhs->rt_dest, rhs->rt_dest, lhs->rt_dest_len) == 0 &&
+            lhs->rt_pfx_len == rhs->rt_pfx_len &&
+            lhs->rt_metric1 == rhs->rt_metric1 &&
+            _route_policy(lhs, 0) == _route_policy(rhs, 0) &&
+            _route_policy(lhs, 1) == _route_policy(rhs, 1));
+}
+
+typedef struct {
+    netsnmp_route_entry *route;
+    netsnmp_container   *to_delete;
+} _replace_ctx;
+
+static void
+_collect_replaced_route_ctx(inetCidrRouteTable_rowreq_ctx *ctx,
+                            _replace_ctx *rctx)
+{
+    if (_same_route(ctx->data, rctx->route))
+        CONTAINER_INSERT(rctx->to_delete, ctx);
+}
+
 /**
- * check entry for update
+ * remove the rows of the next hops a replaced route had
  */
 static void
-_snarf_route_entry(netsnmp_route_entry *route_entry,
-                   netsnmp_container *container)
+_remove_replaced_routes(netsnmp_route_entry *route_entry,
+                        netsnmp_container *container)
 {
-    inetCidrRouteTable_rowreq_ctx *rowreq_ctx;
+    _replace_ctx rctx;
+
+    rctx.to_delete = netsnmp_container_find("lifo");
+    if (NULL == rctx.to_delete)
+        return;
+    rctx.route = route_entry;
+
+    CONTAINER_FOR_EACH(container,
+                       (netsnmp_container_obj_func *) _collect_replaced_route_ctx,
+                       &rctx);
+
+    while (CONTAINER_SIZE(rctx.to_delete)) {
+        inetCidrRouteTable_rowreq_ctx *ctx = (inetCidrRouteTable_rowreq_ctx*)CONTAINER_FIRST(rctx.to_delete);
+        DEBUGMSGT(("verbose:inetCidrRouteTable:inetCidrRouteTable_cache_load", "removing replaced route\n"));
+        CONTAINER_REMOVE(container, ctx);
+        inetCidrRouteTable_release_rowreq_ctx(ctx);
+        CONTAINER_REMOVE(rctx.to_delete, NULL);
+    }
+    CONTAINER_FREE(rctx.to_delete);
+}
+
+/**
+ * add, update or remove the row of a route
+ */
+static void
+_add_or_update_route_entry(netsnmp_route_entry *route_entry,
+                           netsnmp_container *container)
+{
+    inetCidrRouteTable_rowreq_ctx *rowreq_ctx, *old;
+    unsigned        generation;
 
     netsnmp_assert(NULL != route_entry);
     netsnmp_assert(NULL != container);
 
-    /*
-     * per  inetCidrRouteType:
-     *
-     * Routes which do not result in traffic forwarding or 
-     * rejection should not be displayed even if the  
-     * implementation keeps them stored internally.
-     */
-    if (route_entry->rt_type == 0) {    /* set when route not up */
-        DEBUGMSGT(("verbose:inetCidrRouteTable:inetCidrRouteTable_cache_load", "skipping route\n"));
-        netsnmp_access_route_entry_free(route_entry);
-        return;
+    if (route_entry->flags & NETSNMP_ACCESS_ROUTE_REPLACE) {
+        _remove_replaced_routes(route_entry, container);
+        route_entry->flags &= ~NETSNMP_ACCESS_ROUTE_REPLACE;
     }
 
     /*
-     * allocate an row context and set the index(es), then add it to
-     * the container
+     * allocate an row context and set the index(es), then try to find it in
+     * the container.
      */
     rowreq_ctx = inetCidrRouteTable_allocate_rowreq_ctx(route_entry, NULL);
     if ((NULL != rowreq_ctx) &&
@@ -167,11 +242,42 @@ _snarf_route_entry(netsnmp_route_entry *route_entry,
          (rowreq_ctx, route_entry->rt_dest_type,
           (char *) route_entry->rt_dest, route_entry->rt_dest_len,
           route_entry->rt_pfx_len,
-          route_entry->rt_policy, route_entry->rt_policy_len,
+          route_entry->rt_policy,
+          route_entry->rt_policy_len * sizeof(oid),
           route_entry->rt_nexthop_type,
           (char *) route_entry->rt_nexthop, route_entry->rt_nexthop_len))) {
-        CONTAINER_INSERT(container, rowreq_ctx);
-        rowreq_ctx->row_status = ROWSTATUS_ACTIVE;
+
+        old = (inetCidrRouteTable_rowreq_ctx *)
+            CONTAINER_FIND(container, rowreq_ctx);
+        /*
+         * per  inetCidrRouteType:
+         *
+         * Routes which do not result in traffic forwarding or 
+         * rejection should not be displayed even if the  
+         * implementation keeps them stored internally.
+         */
+        if ((route_entry->flags & NETSNMP_ACCESS_ROUTE_REMOVED) ||
+            (route_entry->rt_type == 0)) {    /* set when route not up */
+            DEBUGMSGT(("verbose:inetCidrRouteTable:inetCidrRouteTable_cache_load", "skipping route\n"));
+            if (NULL != old) {
+                CONTAINER_REMOVE(container, old);
+                inetCidrRouteTable_release_rowreq_ctx(old);
+            }
+            inetCidrRouteTable_release_rowreq_ctx(rowreq_ctx);
+        } else if (NULL != old) {
+            /*
+             * the row is already there, update it. Copying doesn't
+             * touch the generation.
+             */
+            generation = route_entry->generation;
+            netsnmp_access_route_entry_copy(old->data, route_entry);
+            old->data->generation = generation;
+            /* this deletes route_entry too */
+            inetCidrRouteTable_release_rowreq_ctx(rowreq_ctx);
+        } else {
+            CONTAINER_INSERT(container, rowreq_ctx);
+            rowreq_ctx->row_status = ROWSTATUS_ACTIVE;
+        }
     } else {
         if (rowreq_ctx) {
             snmp_log(LOG_ERR, "error setting index while loading "
@@ -182,6 +288,52 @@ _snarf_route_entry(netsnmp_route_entry *route_entry,
     }
 }
 
+static void
+_route_hook_update(netsnmp_route_access *access, netsnmp_route_entry *entry)
+{
+    _add_or_update_route_entry(entry, access->magic);
+}
+
+typedef struct {
+    unsigned generation;
+    netsnmp_container *to_delete;
+} _collect_ctx;
+
+/**
+ * Put all rows with outdated generation to deletion list.
+ */
+static void
+_collect_invalid_route_ctx(inetCidrRouteTable_rowreq_ctx *ctx,
+                           _collect_ctx *cctx)
+{
+    if (ctx->data->generation != cctx->generation)
+        CONTAINER_INSERT(cctx->to_delete, ctx);
+}
+
+static void
+_route_hook_gc(netsnmp_route_access *access)
+{
+    netsnmp_container *container = access->magic;
+    _collect_ctx cctx;
+
+    cctx.to_delete = netsnmp_container_find("lifo");
+    if (NULL == cctx.to_delete)
+        return;
+    cctx.generation = access->generation;
+
+    CONTAINER_FOR_EACH(container,
+                       (netsnmp_container_obj_func *) _collect_invalid_route_ctx,
+                       &cctx);
+
+    while (CONTAINER_SIZE(cctx.to_delete)) {
+        inetCidrRouteTable_rowreq_ctx *ctx = (inetCidrRouteTable_rowreq_ctx*)CONTAINER_FIRST(cctx.to_delete);
+        CONTAINER_REMOVE(container, ctx);
+        inetCidrRouteTable_release_rowreq_ctx(ctx);
+        CONTAINER_REMOVE(cctx.to_delete, NULL);
+    }
+    CONTAINER_FREE(cctx.to_delete);
+}
+
 /**
  * container shutdown
  *
@@ -209,6 +361,10 @@ inetCidrRouteTable_container_shutdown(netsnmp_container *container_ptr)
         return;
     }
 
+    if (NULL != route_access) {
+        netsnmp_access_route_delete(route_access);
+        route_access = NULL;
+    }
 }                               /* inetCidrRouteTable_container_shutdown */
 
 /**
@@ -247,8 +403,6 @@ inetCidrRouteTable_container_shutdown(netsnmp_container *container_ptr)
 int
 inetCidrRouteTable_container_load(netsnmp_container *container)
 {
-    netsnmp_container *route_container;
-
     DEBUGMSGTL(("verbose:inetCidrRouteTable:inetCidrRouteTable_container_load", "called\n"));
 
     /*
@@ -257,30 +411,25 @@ inetCidrRouteTable_container_load(netsnmp_container *container)
      * set the index(es) [and data, optionally] and insert into
      * the container.
      *
-     * we use the netsnmp data access api to get the data
-     */
-    route_container =
-        netsnmp_access_route_container_load(NULL,
-                                            NETSNMP_ACCESS_ROUTE_LOAD_NOFLAGS);
-    DEBUGMSGT(("verbose:inetCidrRouteTable:inetCidrRouteTable_cache_load",
-               "%d records\n", (int)CONTAINER_SIZE(route_container)));
-
-    if (NULL == route_container)
-        return MFD_RESOURCE_UNAVAILABLE;        /* msg already logged */
-
-    /*
-     * we just got a fresh copy of route data. snarf data
+     * we use the netsnmp data access api to get the data. It is
+     * set up on the first load, once the configuration has been read.
      */
-    CONTAINER_FOR_EACH(route_container,
-                       (netsnmp_container_obj_func *) _snarf_route_entry,
-                       container);
+    if (NULL == route_access) {
+        route_access = netsnmp_access_route_create(
+            netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                                   NETSNMP_DS_AGENT_ROUTE_UPDATES) ?
+            NETSNMP_ACCESS_ROUTE_CREATE_SUBSCRIBE :
+            NETSNMP_ACCESS_ROUTE_CREATE_NOFLAGS,
+            _route_hook_update, _route_hook_gc,
+            route_cache ? &route_cache->flags : NULL,
+            route_cache ? &route_cache->expired : NULL);
+        if (NULL == route_access)
+            return MFD_RESOURCE_UNAVAILABLE;        /* msg already logged */
+    }
 
-    /*
-     * free the container. we've either claimed each ifentry, or released it,
-     * so the dal function doesn't need to clear the container.
-     */
-    netsnmp_access_route_container_free(route_container,
-                                        NETSNMP_ACCESS_ROUTE_FREE_DONT_CLEAR);
+    route_access->magic = container;
+    if (netsnmp_access_route_load(route_access) < 0)
+        return MFD_RESOURCE_UNAVAILABLE;
 
     DEBUGMSGT(("verbose:inetCidrRouteTable:inetCidrRouteTable_cache_load",
                "%d records\n", (int)CONTAINER_SIZE(container)));
@@ -306,6 +455,11 @@ inetCidrRouteTable_container_free(netsnmp_container *container)
 {
     DEBUGMSGTL(("verbose:inetCidrRouteTable:inetCidrRouteTable_container_free", "called\n"));
 
+    if (NULL != route_access) {
+        netsnmp_access_route_unload(route_access);
+        route_access->magic = NULL;
+    }
+
     /*
      * TODO:380:M: Free inetCidrRouteTable container data.
      */
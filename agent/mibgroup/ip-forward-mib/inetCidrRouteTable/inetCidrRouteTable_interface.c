@@ -2335,7 +2335,8 @@ _inetCidrRouteTable_container_init(inetCidrRouteTable_interface_ctx *
         return;
     }
 
-    if_ctx->cache->flags = NETSNMP_CACHE_DONT_INVALIDATE_ON_SET;
+    if_ctx->cache->flags = NETSNMP_CACHE_DONT_INVALIDATE_ON_SET |
+        NETSNMP_CACHE_STALE_WHILE_REVALIDATE;
 
     inetCidrRouteTable_container_init(&if_ctx->container, if_ctx->cache);
     if (NULL == if_ctx->container) {
@@ -2283,7 +2283,8 @@ _ipCidrRouteTable_container_init(ipCidrRouteTable_interface_ctx * if_ctx)
         return;
     }
 
-    if_ctx->cache->flags = NETSNMP_CACHE_DONT_INVALIDATE_ON_SET;
+    if_ctx->cache->flags = NETSNMP_CACHE_DONT_INVALIDATE_ON_SET |
+        NETSNMP_CACHE_STALE_WHILE_REVALIDATE;
 
     ipCidrRouteTable_container_init(&if_ctx->container, if_ctx->cache);
     if (NULL == if_ctx->container) {
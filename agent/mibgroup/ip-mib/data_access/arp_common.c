@@ -63,7 +63,7 @@ void netsnmp_access_arp_entry_update(netsnmp_arp_entry *entry,
             memcmp(entry->arp_physaddress, new_data->arp_physaddress, entry->arp_physaddress_len) != 0) {
          modified = 1;
          entry->arp_physaddress_len = new_data->arp_physaddress_len;
-         memcpy(entry->arp_physaddress, new_data->arp_physaddress, sizeof(entry->arp_physaddress_len));
+         memcpy(entry->arp_physaddress, new_data->arp_physaddress, sizeof(entry->arp_physaddress));
      }
     if (entry->arp_state != new_data->arp_state) {
          modified = 1;
@@ -16,6 +16,7 @@
 
 static int fillup_entry_info(netsnmp_arp_entry *entry, struct nlmsghdr *h);
 static void netsnmp_access_arp_read_netlink(int fd, void *data);
+static int netsnmp_access_arp_recv(int fd, netsnmp_arp_access *access);
 
 /**
  */
@@ -40,10 +41,15 @@ netsnmp_access_arp_create(u_int init_flags,
     access->gc_hook = gc_hook;
     access->synchronized = 0;
 
+    /*
+     * the notifications keep the container current, so it must survive
+     * the expiry of the cache: freeing it would force a full dump.
+     */
     if (cache_timeout != NULL)
         *cache_timeout = 5;
     if (cache_flags != NULL)
-        *cache_flags |= NETSNMP_CACHE_RESET_TIMER_ON_USE | NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD;
+        *cache_flags |= NETSNMP_CACHE_RESET_TIMER_ON_USE | NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD
+                        | NETSNMP_CACHE_DONT_FREE_EXPIRED;
     access->cache_expired = cache_expired;
 
     DEBUGMSGTL(("access:netlink:arp", "create arp cache\n"));
@@ -62,59 +68,215 @@ int netsnmp_access_arp_delete(netsnmp_arp_access *access)
     return 0;
 }
 
-int netsnmp_access_arp_load(netsnmp_arp_access *access)
+/*
+ * receive buffer of the notification socket; a burst of neighbour
+ * updates on a busy host would overrun the default size quickly, and
+ * every overrun costs a full dump of the table.
+ */
+#define ARP_NETLINK_RCVBUF (1024 * 1024)
+
+static int
+_arp_netlink_open(netsnmp_arp_access *access)
+{
+    struct sockaddr_nl sa;
+    int fd, rcvbuf = ARP_NETLINK_RCVBUF;
+
+    fd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (fd < 0) {
+        snmp_log_perror("netsnmp_access_arp_load: netlink socket create error");
+        return -1;
+    }
+
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) < 0)
+        DEBUGMSGTL(("access:netlink:arp", "SO_RCVBUF: %s\n", strerror(errno)));
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = RTMGRP_NEIGH;
+    if (bind(fd, (struct sockaddr*) &sa, sizeof(sa)) < 0) {
+        snmp_log_perror("netsnmp_access_arp_load: netlink bind failed");
+        close(fd);
+        return -1;
+    }
+
+    if (register_readfd(fd, netsnmp_access_arp_read_netlink, access) != 0) {
+        snmp_log(LOG_ERR,"netsnmp_access_arp_load: error registering netlink socket\n");
+        close(fd);
+        return -1;
+    }
+    access->arch_magic = (void *)(uintptr_t)fd;
+
+    return fd;
+}
+
+/*
+ * order of the inetNetToMediaTable index (ifIndex, address type,
+ * address), so that a dump appends to the table container instead of
+ * inserting every row in the middle of it.
+ */
+static int
+_arp_entry_compare(const void *lhs, const void *rhs)
 {
-    int r, fd = (uintptr_t) access->arch_magic;
+    const netsnmp_arp_entry *l = *(const netsnmp_arp_entry * const *) lhs;
+    const netsnmp_arp_entry *r = *(const netsnmp_arp_entry * const *) rhs;
+
+    if (l->if_index != r->if_index)
+        return l->if_index < r->if_index ? -1 : 1;
+    if (l->arp_ipaddress_len != r->arp_ipaddress_len)
+        return l->arp_ipaddress_len < r->arp_ipaddress_len ? -1 : 1;
+    return memcmp(l->arp_ipaddress, r->arp_ipaddress, l->arp_ipaddress_len);
+}
+
+/*
+ * dump the kernel neighbour table through a socket of its own, so that
+ * notifications and the dump don't compete for one receive buffer.
+ */
+static int
+_arp_netlink_dump(netsnmp_arp_access *access)
+{
+    static unsigned int seq;
     struct {
         struct nlmsghdr n;
         struct ndmsg r;
     } req;
+    netsnmp_arp_entry *entry, **entries = NULL, **tmp;
+    size_t count = 0, size = 0, i;
+    char buf[16384];
+    struct nlmsghdr *h;
+    int fd, r, len, done = 0, rc = 0;
 
-    if (access->synchronized)
-        return 0;
+    fd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (fd < 0) {
+        snmp_log_perror("netsnmp_access_arp_load: netlink socket create error");
+        return -1;
+    }
 
-    if (fd == 0) {
-        struct sockaddr_nl sa;
+    memset(&req, 0, sizeof(req));
+    req.n.nlmsg_len = sizeof(req);
+    req.n.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.n.nlmsg_type = RTM_GETNEIGH;
+    req.n.nlmsg_seq = ++seq;
+    req.r.ndm_family = AF_UNSPEC;
 
-        fd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
-        if (fd < 0) {
-            snmp_log_perror("netsnmp_access_arp_load: netlink socket create error");
-            return -1;
+    if (send(fd, &req, req.n.nlmsg_len, 0) < 0) {
+        snmp_log_perror("netsnmp_access_arp_load: send failed");
+        close(fd);
+        return -1;
+    }
+
+    while (!done) {
+        r = recv(fd, buf, sizeof(buf), 0);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            snmp_log_perror("netsnmp_access_arp_load: recv failed");
+            rc = -1;
+            break;
         }
-        access->arch_magic = (void *)(uintptr_t)fd;
+        if (r == 0)
+            break;
+        len = r;
 
-        memset(&sa, 0, sizeof(sa));
-        sa.nl_family = AF_NETLINK;
-        sa.nl_groups = RTMGRP_NEIGH;
-        if (bind(fd, (struct sockaddr*) &sa, sizeof(sa)) < 0) {
-            snmp_log_perror("netsnmp_access_arp_load: netlink bind failed");
-            return -1;
+        for (h = (struct nlmsghdr *) buf; NLMSG_OK(h, len);
+             h = NLMSG_NEXT(h, len)) {
+            if (h->nlmsg_seq != seq)
+                continue;
+            if (h->nlmsg_type == NLMSG_DONE) {
+                done = 1;
+                break;
+            }
+            if (h->nlmsg_type == NLMSG_ERROR) {
+                DEBUGMSGTL(("access:netlink:arp", "dump failed\n"));
+                rc = -1;
+                done = 1;
+                break;
+            }
+
+            entry = netsnmp_access_arp_entry_create();
+            if (NULL == entry) {
+                rc = -1;
+                done = 1;
+                break;
+            }
+            entry->generation = access->generation;
+            r = fillup_entry_info(entry, h);
+            if (r <= 0) {
+                if (r < 0) {
+                    NETSNMP_LOGONCE((LOG_ERR, "filling entry info failed\n"));
+                    DEBUGMSGTL(("access:netlink:arp", "filling entry info failed\n"));
+                }
+                netsnmp_access_arp_entry_free(entry);
+                continue;
+            }
+
+            if (count == size) {
+                size = size ? 2 * size : 256;
+                tmp = (netsnmp_arp_entry **)
+                    realloc(entries, size * sizeof(*entries));
+                if (NULL == tmp) {
+                    netsnmp_access_arp_entry_free(entry);
+                    rc = -1;
+                    done = 1;
+                    break;
+                }
+                entries = tmp;
+            }
+            entries[count++] = entry;
         }
+    }
+    close(fd);
+
+    if (count > 1)
+        qsort(entries, count, sizeof(*entries), _arp_entry_compare);
+    for (i = 0; i < count; ++i)
+        access->update_hook(access, entries[i]);
+    free(entries);
+
+    DEBUGMSGTL(("access:netlink:arp", "dumped %lu entries\n",
+                (unsigned long) count));
+
+    return rc;
+}
+
+/*
+ * the table is kept up to date by the RTMGRP_NEIGH notifications, so it
+ * is only dumped on the first load, and after the notification socket
+ * overran and lost some of them.
+ */
+int netsnmp_access_arp_load(netsnmp_arp_access *access)
+{
+    int fd = (uintptr_t) access->arch_magic;
+
+    if (access->synchronized)
+        return 0;
 
-        if (register_readfd(fd, netsnmp_access_arp_read_netlink, access) != 0) {
-            snmp_log(LOG_ERR,"netsnmp_access_arp_load: error registering netlink socket\n");
+    if (fd == 0) {
+        fd = _arp_netlink_open(access);
+        if (fd < 0)
             return -1;
-        }
+    } else {
+        /*
+         * whatever is queued predates the dump
+         */
+        while (netsnmp_access_arp_recv(fd, access) > 0)
+            ;
     }
 
     DEBUGMSGTL(("access:netlink:arp", "synchronizing arp table\n"));
 
+    access->synchronized = 1;
     access->generation++;
-
-    memset(&req, 0, sizeof(req));
-    req.n.nlmsg_len = sizeof(req);
-    req.n.nlmsg_flags = NLM_F_REQUEST | NLM_F_ROOT;
-    req.n.nlmsg_type = RTM_GETNEIGH;
-    req.r.ndm_family = AF_UNSPEC;
-
-    r = send(fd, &req, req.n.nlmsg_len, 0);
-    if (r < 0) {
-        snmp_log_perror("netsnmp_access_arp_refresh: send failed");
+    if (_arp_netlink_dump(access) < 0) {
+        access->synchronized = 0;
         return -1;
     }
 
-    while (!access->synchronized)
-        netsnmp_access_arp_read_netlink(fd, access);
+    /*
+     * changes made while the kernel was dumping; an overrun here clears
+     * synchronized again, and the next load dumps once more.
+     */
+    while (netsnmp_access_arp_recv(fd, access) > 0)
+        ;
     access->gc_hook(access);
 
     return 0;
@@ -136,9 +298,15 @@ int netsnmp_access_arp_unload(netsnmp_arp_access *access)
     return 0;
 }
 
-static void netsnmp_access_arp_read_netlink(int fd, void *data)
+/*
+ * apply one datagram of notifications.
+ *
+ * @retval 1 a datagram was read
+ * @retval 0 nothing queued, or the socket overran
+ */
+static int
+netsnmp_access_arp_recv(int fd, netsnmp_arp_access *access)
 {
-    netsnmp_arp_access *access = (netsnmp_arp_access *) data;
     netsnmp_arp_entry *entry;
     char buf[16384];
     struct nlmsghdr *h;
@@ -146,26 +314,19 @@ static void netsnmp_access_arp_read_netlink(int fd, void *data)
 
     do {
         r = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
-        if (r < 0) {
-            if (errno == EINTR)
-                continue;
-            if (errno == EAGAIN)
-                return;
-            snmp_log(LOG_WARNING, "netlink buffer overrun\n");
+    } while (r < 0 && errno == EINTR);
+    if (r < 0) {
+        if (errno != EAGAIN) {
+            DEBUGMSGTL(("access:netlink:arp", "netlink buffer overrun\n"));
             access->synchronized = 0;
             if (access->cache_expired != NULL)
-		*access->cache_expired = 1;
-            return;
+                *access->cache_expired = 1;
         }
-    } while (r < 0 && errno == EINTR);
+        return 0;
+    }
     len = r;
 
     for (h = (struct nlmsghdr *) buf; NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
-         if (h->nlmsg_type == NLMSG_DONE) {
-             access->synchronized = 1;
-             continue;
-         }
-
          entry = netsnmp_access_arp_entry_create();
          if (NULL == entry)
              break;
@@ -184,6 +345,12 @@ static void netsnmp_access_arp_read_netlink(int fd, void *data)
              netsnmp_access_arp_entry_free(entry);
          }
     }
+    return 1;
+}
+
+static void netsnmp_access_arp_read_netlink(int fd, void *data)
+{
+    netsnmp_access_arp_recv(fd, (netsnmp_arp_access *) data);
 }
 
 static int
@@ -21,6 +21,7 @@
 
 netsnmp_feature_require(prefix_info)
 netsnmp_feature_require(find_prefix_info)
+netsnmp_feature_require(fd_event_manager)
 
 netsnmp_feature_child_of(ipaddress_arch_entry_copy, ipaddress_common)
 
@@ -28,19 +29,18 @@ netsnmp_feature_child_of(ipaddress_arch_entry_copy, ipaddress_common)
 netsnmp_feature_require(ipaddress_ioctl_entry_copy)
 #endif /* NETSNMP_FEATURE_REQUIRE_IPADDRESS_ARCH_ENTRY_COPY */
 
-#if defined (NETSNMP_ENABLE_IPV6)
 #include <linux/types.h>
 #include <asm/types.h>
 #if defined(HAVE_LINUX_RTNETLINK_H)
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
-#ifdef RTMGRP_IPV6_PREFIX
+#if defined(NETSNMP_ENABLE_IPV6) && defined(RTMGRP_IPV6_PREFIX)
 #define SUPPORT_PREFIX_FLAGS 1
-#endif /* RTMGRP_IPV6_PREFIX */
+#endif /* NETSNMP_ENABLE_IPV6 && RTMGRP_IPV6_PREFIX */
 #endif /* HAVE_LINUX_RTNETLINK_H */
-#endif
 
 #include "ipaddress_ioctl.h"
+#include "ipaddress_linux.h"
 #ifdef SUPPORT_PREFIX_FLAGS
 extern prefix_cbx *prefix_head_list;
 #endif
@@ -51,6 +51,18 @@ netsnmp_access_ipaddress_extra_prefix_info(int index,
                                            u_long *preferedlt,
                                            ulong *validlt,
                                            char *addr);
+
+/*
+ * struct for the entries of the address cache, for what the kernel's
+ * address messages carry but a netsnmp_ipaddress_entry doesn't.
+ */
+typedef struct _netlink_extras {
+    u_long          stamp;          /* uptime when lifetimes were read */
+    in_addr_t       broadcast;
+    u_char          has_broadcast;
+} _netlink_extras;
+
+#define NETLINK_TOKEN "netlink_extras"
 #endif
 
 /*
@@ -91,6 +103,13 @@ netsnmp_arch_ipaddress_entry_cleanup(netsnmp_ipaddress_entry *entry)
      * cleanup ipv6 stuff
      *   so far, we can just share the ipv4 stuff, so nothing to do
      */
+
+#ifdef HAVE_LINUX_RTNETLINK_H
+    /*
+     * entries of the address cache have netlink extras too
+     */
+    netsnmp_remove_list_node(&entry->arch_data, NETLINK_TOKEN);
+#endif
 }
 
 #ifndef NETSNMP_FEATURE_REMOVE_IPADDRESS_ARCH_ENTRY_COPY
@@ -157,6 +176,640 @@ netsnmp_arch_ipaddress_delete(netsnmp_ipaddress_entry *entry)
     }
 }
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+/*
+ * The addresses are kept in a container which follows the kernel
+ * through RTM_NEWADDR/RTM_DELADDR notifications, so that loading them
+ * is a copy instead of an ioctl or two and a netlink dump per address.
+ * ipAddrTable and the interface loader read the container directly.
+ */
+#define IA_NETLINK_BUF_SIZE 32768
+
+static netsnmp_container *_ia_cache = NULL;
+static int      _ia_cache_fd = -1;      /* address notifications */
+static int      _ia_cache_valid = 0;    /* nothing was missed since dump */
+
+/*
+ * the kernel allows one ipv4 address to be configured with several
+ * prefix lengths, but not so for ipv6, where the prefix length of an
+ * address may be changed.
+ */
+static int
+_ia_cache_compare(const void *lhs, const void *rhs)
+{
+    const netsnmp_ipaddress_entry *l = (const netsnmp_ipaddress_entry *) lhs;
+    const netsnmp_ipaddress_entry *r = (const netsnmp_ipaddress_entry *) rhs;
+    int             rc;
+
+    if (l->if_index != r->if_index)
+        return l->if_index < r->if_index ? -1 : 1;
+    if (l->ia_address_len != r->ia_address_len)
+        return l->ia_address_len < r->ia_address_len ? -1 : 1;
+    rc = memcmp(l->ia_address, r->ia_address, l->ia_address_len);
+    if (rc || 4 != l->ia_address_len)
+        return rc;
+    return (int) l->ia_prefix_len - (int) r->ia_prefix_len;
+}
+
+static _netlink_extras *
+_netlink_extras_get(netsnmp_ipaddress_entry *entry)
+{
+    if ((NULL == entry) || (NULL == entry->arch_data))
+        return NULL;
+
+    return (_netlink_extras *) netsnmp_get_list_data(entry->arch_data,
+                                                     NETLINK_TOKEN);
+}
+
+static netsnmp_ipaddress_entry *
+_ia_cache_entry_create(netsnmp_ipaddress_entry *key)
+{
+    netsnmp_ipaddress_entry *entry;
+    netsnmp_data_list *node;
+    _netlink_extras *nle;
+
+    entry = netsnmp_access_ipaddress_entry_create();
+    if (NULL == entry)
+        return NULL;
+
+    nle = SNMP_MALLOC_TYPEDEF(_netlink_extras);
+    node = nle ? netsnmp_create_data_list(NETLINK_TOKEN, nle, free) : NULL;
+    if (NULL == node) {
+        free(nle);
+        netsnmp_access_ipaddress_entry_free(entry);
+        return NULL;
+    }
+    netsnmp_data_list_add_node(&entry->arch_data, node);
+
+    entry->if_index = key->if_index;
+    entry->ia_address_len = key->ia_address_len;
+    memcpy(entry->ia_address, key->ia_address, key->ia_address_len);
+    entry->ia_prefix_len = key->ia_prefix_len;
+
+    if (CONTAINER_INSERT(_ia_cache, entry) != 0) {
+        netsnmp_access_ipaddress_entry_free(entry);
+        return NULL;
+    }
+    return entry;
+}
+
+static void
+_ia_cache_entry_release(netsnmp_ipaddress_entry *entry, void *context)
+{
+    netsnmp_access_ipaddress_entry_free(entry);
+}
+
+/*
+ * set the mib data of an ipv4 entry, the way
+ * _netsnmp_ioctl_ipaddress_container_load_v4 does.
+ */
+static void
+_ia_cache_set_v4(netsnmp_ipaddress_entry *entry, struct ifaddrmsg *ifa,
+                 const char *label, const void *broadcast)
+{
+    _ioctl_extras   *extras = netsnmp_ioctl_ipaddress_extras_get(entry);
+    _netlink_extras *nle = _netlink_extras_get(entry);
+    in_addr_t        ipval;
+
+    memset(extras->name, 0, sizeof(extras->name));
+    entry->flags &= ~NETSNMP_ACCESS_IPADDRESS_ISALIAS;
+    if (NULL != label) {
+        strlcpy((char *) extras->name, label, sizeof(extras->name));
+        if (NULL != strchr(label, ':'))
+            entry->flags |= NETSNMP_ACCESS_IPADDRESS_ISALIAS;
+    }
+    extras->flags = ifa->ifa_flags;
+
+    nle->has_broadcast = (NULL != broadcast);
+    if (NULL != broadcast)
+        memcpy(&nle->broadcast, broadcast, sizeof(nle->broadcast));
+
+    entry->ia_type = IPADDRESSTYPE_UNICAST;
+    entry->ia_status = IPADDRESSSTATUSTC_PREFERRED;
+    memcpy(&ipval, entry->ia_address, sizeof(ipval));
+    if (IS_APIPA(ipval))
+        entry->ia_origin = IPADDRESSORIGINTC_RANDOM;
+    else
+        entry->ia_origin = IPADDRESSORIGINTC_MANUAL;
+}
+
+#ifdef NETSNMP_ENABLE_IPV6
+/*
+ * set the mib data of an ipv6 entry, the way _load_v6 does.
+ */
+static void
+_ia_cache_set_v6(netsnmp_ipaddress_entry *entry, struct ifaddrmsg *ifa,
+                 int anycast, const struct ifa_cacheinfo *ci)
+{
+    _ioctl_extras   *extras = netsnmp_ioctl_ipaddress_extras_get(entry);
+    _netlink_extras *nle = _netlink_extras_get(entry);
+    int              flags = ifa->ifa_flags;
+
+    entry->flags = flags;
+    extras->flags = flags;
+
+    if ((flags & IFA_F_PERMANENT) || (!flags))
+        entry->ia_status = IPADDRESSSTATUSTC_PREFERRED; /* ?? */
+#ifdef IFA_F_TEMPORARY
+    else if (flags & IFA_F_TEMPORARY)
+        entry->ia_status = IPADDRESSSTATUSTC_PREFERRED; /* ?? */
+#endif
+    else if (flags & IFA_F_DEPRECATED)
+        entry->ia_status = IPADDRESSSTATUSTC_DEPRECATED;
+    else if (flags & IFA_F_TENTATIVE)
+        entry->ia_status = IPADDRESSSTATUSTC_TENTATIVE;
+    else {
+        entry->ia_status = IPADDRESSSTATUSTC_UNKNOWN;
+        DEBUGMSGTL(("access:ipaddress:ipv6", "unknown flags 0x%x\n", flags));
+    }
+
+    entry->ia_type = anycast ? IPADDRESSTYPE_ANYCAST : IPADDRESSTYPE_UNICAST;
+
+    if (!flags)
+        entry->ia_origin = IPADDRESSORIGINTC_LINKLAYER;
+#ifdef IFA_F_TEMPORARY
+    else if (flags & IFA_F_TEMPORARY)
+        entry->ia_origin = IPADDRESSORIGINTC_RANDOM;
+#endif
+    else if (IN6_IS_ADDR_LINKLOCAL(entry->ia_address))
+        entry->ia_origin = IPADDRESSORIGINTC_LINKLAYER;
+    else
+        entry->ia_origin = IPADDRESSORIGINTC_MANUAL;
+
+    if (entry->ia_origin == IPADDRESSORIGINTC_LINKLAYER)
+        entry->ia_storagetype = STORAGETYPE_PERMANENT;
+    else
+        entry->ia_storagetype = STORAGETYPE_VOLATILE;
+
+    /*
+     * the lifetimes count down from the time of the message
+     */
+    if (NULL != ci) {
+        entry->ia_prefered_lifetime = ci->ifa_prefered;
+        entry->ia_valid_lifetime = ci->ifa_valid;
+    }
+    nle->stamp = netsnmp_get_agent_uptime();
+}
+#endif /* NETSNMP_ENABLE_IPV6 */
+
+/*
+ * apply one address message to the cache
+ */
+static void
+_ia_cache_update(struct nlmsghdr *nlh)
+{
+    netsnmp_ipaddress_entry key, *entry;
+    struct ifaddrmsg *ifa;
+    struct ifa_cacheinfo *ci = NULL;
+    struct rtattr  *rta;
+    const void     *address = NULL, *local = NULL, *broadcast = NULL;
+    const char     *label = NULL;
+    int             rtalen, addr_len, anycast = 0;
+
+    if ((RTM_NEWADDR != nlh->nlmsg_type &&
+         RTM_DELADDR != nlh->nlmsg_type) ||
+        nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*ifa)))
+        return;
+
+    ifa = (struct ifaddrmsg *) NLMSG_DATA(nlh);
+    if (AF_INET == ifa->ifa_family)
+        addr_len = 4;
+#ifdef NETSNMP_ENABLE_IPV6
+    else if (AF_INET6 == ifa->ifa_family)
+        addr_len = 16;
+#endif
+    else
+        return;
+
+    rtalen = IFA_PAYLOAD(nlh);
+    for (rta = IFA_RTA(ifa); RTA_OK(rta, rtalen);
+         rta = RTA_NEXT(rta, rtalen)) {
+        switch (rta->rta_type) {
+        case IFA_ADDRESS:
+            if (RTA_PAYLOAD(rta) >= addr_len)
+                address = RTA_DATA(rta);
+            break;
+        case IFA_LOCAL:
+            if (RTA_PAYLOAD(rta) >= addr_len)
+                local = RTA_DATA(rta);
+            break;
+        case IFA_BROADCAST:
+            if (RTA_PAYLOAD(rta) >= sizeof(in_addr_t))
+                broadcast = RTA_DATA(rta);
+            break;
+        case IFA_ANYCAST:
+            anycast = 1;
+            break;
+        case IFA_LABEL:
+            if (RTA_PAYLOAD(rta) > 0 &&
+                '\0' == ((char *) RTA_DATA(rta))[RTA_PAYLOAD(rta) - 1])
+                label = (const char *) RTA_DATA(rta);
+            break;
+        case IFA_CACHEINFO:
+            if (RTA_PAYLOAD(rta) >= sizeof(*ci))
+                ci = (struct ifa_cacheinfo *) RTA_DATA(rta);
+            break;
+        }
+    }
+
+    /*
+     * IFA_ADDRESS is the peer's address on point to point links
+     */
+    if (NULL != local)
+        address = local;
+    if (NULL == address)
+        return;
+
+    memset(&key, 0, sizeof(key));
+    key.if_index = ifa->ifa_index;
+    key.ia_address_len = addr_len;
+    memcpy(key.ia_address, address, addr_len);
+    key.ia_prefix_len = ifa->ifa_prefixlen;
+    entry = (netsnmp_ipaddress_entry *) CONTAINER_FIND(_ia_cache, &key);
+
+    if (RTM_DELADDR == nlh->nlmsg_type) {
+        if (NULL != entry) {
+            CONTAINER_REMOVE(_ia_cache, entry);
+            netsnmp_access_ipaddress_entry_free(entry);
+        }
+        return;
+    }
+
+    if (NULL == entry) {
+        entry = _ia_cache_entry_create(&key);
+        if (NULL == entry) {
+            _ia_cache_valid = 0;
+            return;
+        }
+    }
+    entry->ia_prefix_len = ifa->ifa_prefixlen;
+
+    if (4 == addr_len)
+        _ia_cache_set_v4(entry, ifa, label, broadcast);
+#ifdef NETSNMP_ENABLE_IPV6
+    else
+        _ia_cache_set_v6(entry, ifa, anycast, ci);
+#endif
+}
+
+/*
+ * read one datagram of address notifications
+ *
+ * @retval 1 something was read
+ * @retval 0 nothing to read
+ */
+static int
+_ia_cache_recv(int fd)
+{
+    long            buf[IA_NETLINK_BUF_SIZE / sizeof(long)];
+    struct nlmsghdr *nlh;
+    int             len;
+
+    do {
+        len = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    } while (len < 0 && EINTR == errno);
+    if (len < 0) {
+        if (EAGAIN == errno || EWOULDBLOCK == errno)
+            return 0;
+        /*
+         * ENOBUFS: notifications were lost, dump everything again
+         */
+        DEBUGMSGTL(("access:ipaddress:cache", "netlink buffer overrun\n"));
+        _ia_cache_valid = 0;
+        return 1;
+    }
+
+    for (nlh = (struct nlmsghdr *) buf; NLMSG_OK(nlh, len);
+         nlh = NLMSG_NEXT(nlh, len))
+        _ia_cache_update(nlh);
+    return 1;
+}
+
+static void
+_ia_cache_read_netlink(int fd, void *data)
+{
+    _ia_cache_recv(fd);
+}
+
+/*
+ * subscribe to address notifications. Without them, the addresses
+ * are dumped again for every load.
+ */
+static void
+_ia_cache_listen(void)
+{
+    struct sockaddr_nl sa;
+    int             fd;
+
+    fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (fd < 0) {
+        DEBUGMSGTL(("access:ipaddress:cache", "socket: %s\n",
+                    strerror(errno)));
+        return;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = RTMGRP_IPV4_IFADDR;
+#ifdef NETSNMP_ENABLE_IPV6
+    sa.nl_groups |= RTMGRP_IPV6_IFADDR;
+#endif
+    if (bind(fd, (struct sockaddr *) &sa, sizeof(sa)) < 0) {
+        DEBUGMSGTL(("access:ipaddress:cache", "bind: %s\n",
+                    strerror(errno)));
+        close(fd);
+        return;
+    }
+
+    if (register_readfd(fd, _ia_cache_read_netlink, NULL) != 0) {
+        snmp_log(LOG_ERR, "error registering ipaddress netlink socket\n");
+        close(fd);
+        return;
+    }
+    _ia_cache_fd = fd;
+}
+
+/*
+ * fill the cache from a RTM_GETADDR dump
+ *
+ * @retval  0 success
+ * @retval -2 rtnetlink not available
+ * @retval <0 other errors
+ */
+static int
+_ia_cache_dump(void)
+{
+    static unsigned int seq;
+    struct {
+        struct nlmsghdr  nlh;
+        struct ifaddrmsg ifa;
+    } req;
+    struct sockaddr_nl sa;
+    long        buf[IA_NETLINK_BUF_SIZE / sizeof(long)];
+    int         fd, len, rc = 0, done = 0, count = 0;
+
+    fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (fd < 0) {
+        DEBUGMSGTL(("access:ipaddress:cache", "socket: %s\n",
+                    strerror(errno)));
+        return -2;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+
+    memset(&req, 0, sizeof(req));
+    req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+    req.nlh.nlmsg_type = RTM_GETADDR;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nlh.nlmsg_seq = ++seq;
+
+    if (sendto(fd, &req, req.nlh.nlmsg_len, 0, (struct sockaddr *) &sa,
+               sizeof(sa)) < 0) {
+        DEBUGMSGTL(("access:ipaddress:cache", "sendto: %s\n",
+                    strerror(errno)));
+        close(fd);
+        return -2;
+    }
+
+    while (!done) {
+        struct nlmsghdr *nlh = (struct nlmsghdr *) buf;
+
+        len = recv(fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (EINTR == errno)
+                continue;
+            snmp_log_perror("ipaddress _ia_cache_dump: recv");
+            rc = count ? -1 : -2;
+            break;
+        }
+        if (0 == len)
+            break;
+
+        for (; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_seq != seq)
+                continue;
+            if (NLMSG_DONE == nlh->nlmsg_type) {
+                done = 1;
+                break;
+            }
+            if (NLMSG_ERROR == nlh->nlmsg_type) {
+                DEBUGMSGTL(("access:ipaddress:cache", "dump failed\n"));
+                rc = count ? -1 : -2;
+                done = 1;
+                break;
+            }
+            ++count;
+            _ia_cache_update(nlh);
+        }
+    }
+
+    close(fd);
+    DEBUGMSGTL(("access:ipaddress:cache", "%d addresses dumped (rc %d)\n",
+                count, rc));
+
+    return rc;
+}
+
+netsnmp_container *
+netsnmp_linux_ipaddress_container(void)
+{
+    if (NULL == _ia_cache) {
+        _ia_cache = netsnmp_container_find("access_ipaddress_cache:"
+                                           "table_container");
+        if (NULL == _ia_cache) {
+            snmp_log(LOG_ERR, "could not create ipaddress cache container\n");
+            return NULL;
+        }
+        _ia_cache->compare = _ia_cache_compare;
+        _ia_cache->container_name = strdup("ia_cache");
+        /*
+         * subscribe before the first dump, so that nothing falls
+         * between the two.
+         */
+        _ia_cache_listen();
+    }
+
+    if (_ia_cache_fd >= 0)
+        while (_ia_cache_recv(_ia_cache_fd) > 0)
+            ;
+
+    if (!_ia_cache_valid) {
+        CONTAINER_CLEAR(_ia_cache,
+                        (netsnmp_container_obj_func *) _ia_cache_entry_release,
+                        NULL);
+        if (_ia_cache_dump() < 0)
+            return NULL;
+        _ia_cache_valid = (_ia_cache_fd >= 0);
+    }
+
+    return _ia_cache;
+}
+
+int
+netsnmp_linux_ipaddress_broadcast(netsnmp_ipaddress_entry *entry,
+                                  in_addr_t *broadcast)
+{
+    _netlink_extras *nle = _netlink_extras_get(entry);
+
+    if ((NULL == nle) || !nle->has_broadcast)
+        return -1;
+
+    *broadcast = nle->broadcast;
+    return 0;
+}
+
+/*
+ * make a copy of a cache entry for the caller's container
+ */
+static netsnmp_ipaddress_entry *
+_ia_cache_copy(netsnmp_ipaddress_entry *cached, u_long now)
+{
+    netsnmp_ipaddress_entry *entry;
+
+    entry = netsnmp_access_ipaddress_entry_create();
+    if (NULL == entry)
+        return NULL;
+
+    memcpy(netsnmp_ioctl_ipaddress_extras_get(entry),
+           netsnmp_ioctl_ipaddress_extras_get(cached),
+           sizeof(_ioctl_extras));
+    entry->flags = cached->flags;
+    entry->if_index = cached->if_index;
+    entry->ia_address_len = cached->ia_address_len;
+    memcpy(entry->ia_address, cached->ia_address, cached->ia_address_len);
+    entry->ia_prefix_len = cached->ia_prefix_len;
+    entry->ia_type = cached->ia_type;
+    entry->ia_status = cached->ia_status;
+    entry->ia_origin = cached->ia_origin;
+    entry->ia_storagetype = cached->ia_storagetype;
+
+#ifdef NETSNMP_ENABLE_IPV6
+    if (16 == entry->ia_address_len) {
+        _netlink_extras *nle = _netlink_extras_get(cached);
+        u_long          elapsed = (now - nle->stamp) / 100;
+        struct in6_addr in6;
+        char            addr[40];
+#ifdef SUPPORT_PREFIX_FLAGS
+        prefix_cbx      prefix_val;
+#endif
+
+        /*
+         * 0xffffffff is forever
+         */
+        entry->ia_prefered_lifetime = cached->ia_prefered_lifetime;
+        if (0xffffffffUL != entry->ia_prefered_lifetime)
+            entry->ia_prefered_lifetime =
+                entry->ia_prefered_lifetime > elapsed ?
+                entry->ia_prefered_lifetime - elapsed : 0;
+        entry->ia_valid_lifetime = cached->ia_valid_lifetime;
+        if (0xffffffffUL != entry->ia_valid_lifetime)
+            entry->ia_valid_lifetime =
+                entry->ia_valid_lifetime > elapsed ?
+                entry->ia_valid_lifetime - elapsed : 0;
+
+        memcpy(&in6, entry->ia_address, sizeof(in6));
+        snprintf(addr, sizeof(addr), "%04x%04x%04x%04x%04x%04x%04x%04x",
+                 NIP6(in6));
+#ifdef SUPPORT_PREFIX_FLAGS
+        if (net_snmp_find_prefix_info(&prefix_head_list, addr,
+                                      &prefix_val) < 0) {
+            DEBUGMSGTL(("access:ipaddress:container", "unable to find info\n"));
+            entry->ia_onlink_flag = 1;  /*Set by default as true*/
+            entry->ia_autonomous_flag = 2; /*Set by default as false*/
+        } else {
+            entry->ia_onlink_flag = prefix_val.ipAddressPrefixOnLinkFlag;
+            entry->ia_autonomous_flag =
+                prefix_val.ipAddressPrefixAutonomousFlag;
+        }
+#else
+        entry->ia_onlink_flag = 1;  /*Set by default as true*/
+        entry->ia_autonomous_flag = 2; /*Set by default as false*/
+#endif
+    }
+#endif /* NETSNMP_ENABLE_IPV6 */
+
+    return entry;
+}
+
+/**
+ * @internal
+ * load the addresses from the cache
+ *
+ * @retval  0 success
+ * @retval -2 rtnetlink not available
+ * @retval -3 could not create entry (probably malloc)
+ */
+static int
+_load_netlink(netsnmp_container *container, u_int load_flags)
+{
+    netsnmp_container *cache = netsnmp_linux_ipaddress_container();
+    netsnmp_iterator *it;
+    netsnmp_ipaddress_entry *cached, *entry;
+    in_addr_t       broadcast;
+    u_long          now = netsnmp_get_agent_uptime();
+    int             idx_offset = 0, rc = 0;
+
+    if (NULL == cache)
+        return -2;
+    it = CONTAINER_ITERATOR(cache);
+    if (NULL == it)
+        return -3;
+
+    for (cached = (netsnmp_ipaddress_entry *) ITERATOR_FIRST(it); cached;
+         cached = (netsnmp_ipaddress_entry *) ITERATOR_NEXT(it)) {
+
+        if (4 == cached->ia_address_len) {
+            if (load_flags & NETSNMP_ACCESS_IPADDRESS_LOAD_IPV6_ONLY)
+                continue;
+        } else if (load_flags & NETSNMP_ACCESS_IPADDRESS_LOAD_IPV4_ONLY)
+            continue;
+
+        entry = _ia_cache_copy(cached, now);
+        if (NULL == entry) {
+            rc = -3;
+            break;
+        }
+        entry->ns_ia_index = ++idx_offset;
+        if (CONTAINER_INSERT(container, entry) < 0) {
+            DEBUGMSGTL(("access:ipaddress:container","error with ipaddress_entry: insert into container failed.\n"));
+            netsnmp_access_ipaddress_entry_free(entry);
+            continue;
+        }
+
+        /*
+         * the broadcast address gets an entry of its own
+         */
+        if (netsnmp_linux_ipaddress_broadcast(cached, &broadcast) < 0)
+            continue;
+        entry = netsnmp_access_ipaddress_entry_create();
+        if (NULL == entry) {
+            rc = -3;
+            break;
+        }
+        entry->ns_ia_index = ++idx_offset;
+        entry->if_index = cached->if_index;
+        entry->ia_address_len = sizeof(broadcast);
+        memcpy(entry->ia_address, &broadcast, sizeof(broadcast));
+        entry->ia_prefix_len = cached->ia_prefix_len;
+        entry->ia_type = IPADDRESSTYPE_BROADCAST;
+        entry->ia_status = IPADDRESSSTATUSTC_PREFERRED;
+        entry->ia_origin = cached->ia_origin;
+        if (CONTAINER_INSERT(container, entry) < 0) {
+            DEBUGMSGTL(("access:ipaddress:container","error with ipaddress_entry: insert broadcast entry into container failed.\n"));
+            netsnmp_access_ipaddress_entry_free(entry);
+        }
+    }
+    ITERATOR_RELEASE(it);
+
+    if (rc < 0) {
+        u_int flags = NETSNMP_ACCESS_IPADDRESS_FREE_KEEP_CONTAINER;
+        netsnmp_access_ipaddress_container_free(container, flags);
+    }
+    return rc;
+}
+#endif /* HAVE_LINUX_RTNETLINK_H */
+
 /**
  *
  * @retval  0 no errors
@@ -168,6 +821,13 @@ netsnmp_arch_ipaddress_container_load(netsnmp_container *container,
 {
     int rc = 0, idx_offset = 0;
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+    rc = _load_netlink(container, load_flags);
+    if (-2 != rc)
+        return rc;
+    rc = 0;
+#endif
+
     if (0 == (load_flags & NETSNMP_ACCESS_IPADDRESS_LOAD_IPV6_ONLY)) {
         rc = _netsnmp_ioctl_ipaddress_container_load_v4(container, idx_offset);
         if(rc < 0) {
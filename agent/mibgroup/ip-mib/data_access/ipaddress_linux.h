@@ -19,3 +19,37 @@
  */
 config_require(ip-mib/data_access/ipaddress_ioctl)
 config_require(util_funcs)
+
+#ifndef NETSNMP_ACCESS_IPADDRESS_LINUX_H
+#define NETSNMP_ACCESS_IPADDRESS_LINUX_H
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+/*
+ * the addresses as last reported by rtnetlink, without the broadcast
+ * entries. The container and its entries belong to ipaddress_linux:
+ * don't change or free them, and don't keep them beyond the current
+ * request.
+ *
+ * @retval NULL rtnetlink not available
+ */
+netsnmp_container *
+netsnmp_linux_ipaddress_container(void);
+
+/*
+ * the broadcast address of an ipv4 entry of that container
+ *
+ * @retval  0 broadcast set
+ * @retval -1 no broadcast address
+ */
+int
+netsnmp_linux_ipaddress_broadcast(netsnmp_ipaddress_entry *entry,
+                                  in_addr_t *broadcast);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NETSNMP_ACCESS_IPADDRESS_LINUX_H */
@@ -113,6 +113,10 @@
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include <net-snmp/agent/auto_nlist.h>
 #include <net-snmp/data_access/interface.h>
+#if defined(linux) && defined(HAVE_LINUX_RTNETLINK_H)
+#include <net-snmp/data_access/ipaddress.h>
+#include "ip-mib/data_access/ipaddress_linux.h"
+#endif
 
 #include "ip.h"
 #include "interfaces.h"
@@ -497,6 +501,71 @@ Address_Scan_Next(Index, Retin_ifaddr)
 static struct ifreq *ifr;
 static int ifr_counter;
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+static netsnmp_iterator *ia_it;
+static netsnmp_ipaddress_entry *ia_entry;
+
+/*
+ * walk the ipv4 addresses of the ipaddress data access, which
+ * rtnetlink keeps up to date.
+ *
+ * @retval 0 the addresses are walked from the container
+ * @retval 1 no container, the caller uses SIOCGIFCONF instead
+ */
+static int
+_address_scan_init_netlink(void)
+{
+    netsnmp_container *container = netsnmp_linux_ipaddress_container();
+
+    if (ia_it)
+        ITERATOR_RELEASE(ia_it);
+    ia_it = container ? CONTAINER_ITERATOR(container) : NULL;
+    if (NULL == ia_it)
+        return 1;
+    ia_entry = (netsnmp_ipaddress_entry *) ITERATOR_FIRST(ia_it);
+    return 0;
+}
+
+static int
+_address_scan_next_netlink(short *Index, struct ifnet *Retifnet)
+{
+    struct sockaddr_in *sin;
+    in_addr_t       broadcast;
+
+    while (ia_entry && 4 != ia_entry->ia_address_len)
+        ia_entry = (netsnmp_ipaddress_entry *) ITERATOR_NEXT(ia_it);
+    if (NULL == ia_entry)
+        return (0);             /* EOF */
+
+    if (Retifnet) {
+        sin = (struct sockaddr_in *) &Retifnet->if_addr;
+        memset(sin, 0, sizeof(Retifnet->if_addr));
+        sin->sin_family = AF_INET;
+        memcpy(&sin->sin_addr.s_addr, ia_entry->ia_address, 4);
+
+        sin = (struct sockaddr_in *) &Retifnet->ia_subnetmask;
+        memset(sin, 0, sizeof(Retifnet->ia_subnetmask));
+        sin->sin_family = AF_INET;
+        sin->sin_addr.s_addr =
+            netsnmp_ipaddress_ipv4_mask(ia_entry->ia_prefix_len);
+
+        sin = (struct sockaddr_in *) &Retifnet->ifu_broadaddr;
+        memset(sin, 0, sizeof(Retifnet->ifu_broadaddr));
+        if (netsnmp_linux_ipaddress_broadcast(ia_entry, &broadcast) == 0) {
+            sin->sin_family = AF_INET;
+            sin->sin_addr.s_addr = broadcast;
+        }
+    }
+
+    if (Index)
+        *Index = ia_entry->if_index;
+
+    ia_entry = (netsnmp_ipaddress_entry *) ITERATOR_NEXT(ia_it);
+    return (1);                 /* DONE */
+}
+
+#endif /* HAVE_LINUX_RTNETLINK_H */
+
 static void
 Address_Scan_Init(void)
 {
@@ -504,10 +573,16 @@ Address_Scan_Init(void)
     int fd;
     int lastlen = 0;
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+    if (_address_scan_init_netlink() == 0)
+        return;
+#endif
+
     /* get info about all interfaces */
 
     ifc.ifc_len = 0;
     SNMP_FREE(ifc.ifc_buf);
+    ifr = NULL;
     ifr_counter = 0;
 
     if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
@@ -560,6 +635,12 @@ Address_Scan_Next(short *Index, struct ifnet *Retifnet)
 {
     struct ifnet   ifnet_store;
     int fd;
+
+#ifdef HAVE_LINUX_RTNETLINK_H
+    if (ia_it)
+        return _address_scan_next_netlink(Index, Retifnet);
+#endif
+
     if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
     {
 	DEBUGMSGTL(("snmpd", "socket open failure in Address_Scan_Next\n"));
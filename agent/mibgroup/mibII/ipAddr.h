@@ -8,6 +8,7 @@
 #if !defined(NETSNMP_ENABLE_MFD_REWRITES)
 config_require(mibII/ip)
 #endif
+config_arch_require(linux, ip-mib/data_access/ipaddress)
 
      extern FindVarMethod var_ipAddrEntry;
 
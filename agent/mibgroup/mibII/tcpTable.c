@@ -136,6 +136,7 @@ struct netsnmp_inpcb_s {
 TCPTABLE_ENTRY_TYPE	*tcp_head  = NULL;
 int                      tcp_size  = 0;	/* Only used for table-based systems */
 int                      tcp_estab = 0;
+static netsnmp_cache    *tcp_cache = NULL;
 
 
 	/*
@@ -192,6 +193,7 @@ init_tcpTable(void)
     iinfo->get_first_data_point = tcpTable_first_entry;
     iinfo->get_next_data_point  = tcpTable_next_entry;
     iinfo->table_reginfo        = table_info;
+    iinfo->flags               |= NETSNMP_ITERATOR_FLAG_SNAPSHOT;
 #if defined (WIN32) || defined (cygwin)
     iinfo->flags               |= NETSNMP_ITERATOR_FLAG_SORTED;
 #endif /* WIN32 || cygwin */
@@ -212,10 +214,12 @@ init_tcpTable(void)
      * .... with a local cache
      *    (except for Solaris, which uses a different approach)
      */
-    netsnmp_inject_handler( reginfo,
-		    netsnmp_get_cache_handler(TCP_STATS_CACHE_TIMEOUT,
-			   		tcpTable_load, tcpTable_free,
-					tcpTable_oid, OID_LENGTH(tcpTable_oid)));
+    tcp_cache = netsnmp_cache_create(TCP_STATS_CACHE_TIMEOUT,
+                                     tcpTable_load, tcpTable_free,
+                                     tcpTable_oid, OID_LENGTH(tcpTable_oid));
+    if (!tcp_cache)
+        return;
+    netsnmp_inject_handler(reginfo, netsnmp_cache_handler_get(tcp_cache));
 }
 
 
@@ -325,7 +329,12 @@ tcpTable_handler(netsnmp_mib_handler          *handler,
 #ifndef NETSNMP_FEATURE_REMOVE_TCP_COUNT_CONNECTIONS
 int
 TCP_Count_Connections( void ) {
-    tcpTable_load(NULL, NULL);
+    /*
+     * Go through the table's cache: the iterator snapshot holds pointers
+     * into tcp_head, and is only rebuilt when the cache reloads.
+     */
+    if (tcp_cache)
+        netsnmp_cache_check_and_reload(tcp_cache);
     return tcp_estab;
 }
 #endif /* NETSNMP_FEATURE_REMOVE_TCP_COUNT_CONNECTIONS */
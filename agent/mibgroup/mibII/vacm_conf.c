@@ -1148,6 +1148,11 @@ vacm_warn_if_not_configured(int majorID, int minorID, void *serverarg,
     return SNMP_ERR_NOERROR;
 }
 
+static int      _vacm_check_view_contents(netsnmp_pdu *pdu, oid * name,
+                                          size_t namelen, int check_subtree,
+                                          int viewtype, int flags,
+                                          const char **view_name);
+
 int
 vacm_in_view_callback(int majorID, int minorID, void *serverarg,
                       void *clientarg)
@@ -1158,14 +1163,28 @@ vacm_in_view_callback(int majorID, int minorID, void *serverarg,
 
     if (view_parms == NULL)
         return 1;
-    retval = vacm_in_view(view_parms->pdu, view_parms->name,
-                          view_parms->namelen, view_parms->check_subtree);
+    if (view_parms->name == NULL &&
+        (view_parms->pdu->command == SNMP_MSG_GET ||
+         view_parms->pdu->command == SNMP_MSG_GETNEXT ||
+         view_parms->pdu->command == SNMP_MSG_GETBULK))
+        /*
+         * initial check of a read request: also tell the caller which
+         * view the request will be using
+         */
+        retval = _vacm_check_view_contents(view_parms->pdu, NULL, 0,
+                                           view_parms->check_subtree,
+                                           VACM_VIEW_READ,
+                                           VACM_CHECK_VIEW_CONTENTS_NO_FLAGS,
+                                           &view_parms->view_name);
+    else
+        retval = vacm_in_view(view_parms->pdu, view_parms->name,
+                              view_parms->namelen,
+                              view_parms->check_subtree);
     if (retval != 0)
         view_parms->errorcode = retval;
     return retval;
 }
 
-
 /**
  * vacm_in_view: decides if a given PDU can be acted upon
  *
@@ -1254,6 +1273,19 @@ vacm_check_view(netsnmp_pdu *pdu, oid * name, size_t namelen,
 int
 vacm_check_view_contents(netsnmp_pdu *pdu, oid * name, size_t namelen,
                          int check_subtree, int viewtype, int flags)
+{
+    return _vacm_check_view_contents(pdu, name, namelen, check_subtree,
+                                     viewtype, flags, NULL);
+}
+
+/*
+ * As vacm_check_view_contents, but if view_name is not NULL and name is
+ * NULL, also reports the name of the view that would be used.
+ */
+static int
+_vacm_check_view_contents(netsnmp_pdu *pdu, oid * name, size_t namelen,
+                          int check_subtree, int viewtype, int flags,
+                          const char **view_name)
 {
     struct vacm_accessEntry *ap;
     struct vacm_groupEntry *gp;
@@ -1446,6 +1478,8 @@ vacm_check_view_contents(netsnmp_pdu *pdu, oid * name, size_t namelen,
 
     if (name == NULL) { /* only check the setup of the vacm for the request */
         DEBUGMSG(("mibII/vacm_vars", ", Done checking setup\n"));
+        if (view_name && viewtype >= 0 && viewtype < VACM_MAX_VIEWS)
+            *view_name = ap->views[viewtype];
         return VACM_SUCCESS;
     }
 
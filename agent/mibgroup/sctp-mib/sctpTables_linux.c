@@ -281,6 +281,7 @@ load_assoc(sctpTables_containers * containers)
         return SNMP_ERR_GENERR;
     }
 
+    netsnmp_get_pid_from_inode_lock();
     netsnmp_get_pid_from_inode_init();
 
     /*
@@ -299,6 +300,7 @@ load_assoc(sctpTables_containers * containers)
         }
     }
     fclose(f);
+    netsnmp_get_pid_from_inode_unlock();
 
     return SNMP_ERR_NOERROR;
 }
@@ -43,6 +43,7 @@ struct myproc {
     char            fixcmd[STRMAX];
     int             min;
     int             max;
+    int             count;      /* see sh_count_myprocs() */
     struct myproc  *next;
 };
 
@@ -116,6 +116,98 @@ netsnmp_access_tcpconn_container_free(netsnmp_container *container, u_int free_f
         CONTAINER_FREE(container);
 }
 
+/**---------------------------------------------------------------------*/
+/*
+ * snapshot functions
+ */
+/**
+ * read the connections into a snapshot, without logging or touching
+ * any data shared with the agent's main thread, so a cache helper
+ * worker thread can do it (NETSNMP_CACHE_LOAD_THREAD_SAFE).
+ *
+ * Where the arch code can't load that way, snap->rc is -2 and
+ * netsnmp_access_tcpconn_snapshot_container() does a regular load.
+ *
+ * @retval NULL  no memory, or the load failed
+ * @retval !NULL the snapshot
+ */
+netsnmp_tcpconn_snapshot *
+netsnmp_access_tcpconn_snapshot_load(u_int load_flags)
+{
+    netsnmp_tcpconn_snapshot *snap =
+        SNMP_MALLOC_TYPEDEF(netsnmp_tcpconn_snapshot);
+
+    if (NULL == snap)
+        return NULL;
+    snap->load_flags = load_flags;
+    snap->rc = netsnmp_arch_tcpconn_snapshot_load(snap, load_flags);
+    if ((0 != snap->rc) && (-2 != snap->rc)) {
+        netsnmp_access_tcpconn_snapshot_free(snap);
+        return NULL;
+    }
+    return snap;
+}
+
+/**
+ * the connections of a snapshot, in a container like the one
+ * netsnmp_access_tcpconn_container_load() returns. The container
+ * belongs to the snapshot. Main thread only.
+ *
+ * @retval NULL  error
+ * @retval !NULL pointer to container
+ */
+netsnmp_container *
+netsnmp_access_tcpconn_snapshot_container(netsnmp_tcpconn_snapshot *snap)
+{
+    size_t i;
+
+    if (NULL == snap)
+        return NULL;
+    if (NULL != snap->container)
+        return snap->container;
+
+    if (0 != snap->rc) {
+        snap->container =
+            netsnmp_access_tcpconn_container_load(NULL, snap->load_flags);
+        return snap->container;
+    }
+
+    snap->container = netsnmp_access_tcpconn_container_init(snap->load_flags);
+    if (NULL == snap->container)
+        return NULL;
+    for (i = 0; i < snap->count; ++i) {
+        snap->entries[i]->arbitrary_index = i + 1;
+        if (CONTAINER_INSERT(snap->container, snap->entries[i]) != 0)
+            netsnmp_access_tcpconn_entry_free(snap->entries[i]);
+    }
+    snap->count = 0;
+    DEBUGMSGTL(("access:tcpconn:container", "%d connections from snapshot\n",
+                (int)CONTAINER_SIZE(snap->container)));
+
+    return snap->container;
+}
+
+/**
+ * free a snapshot. Thread safe as long as
+ * netsnmp_access_tcpconn_snapshot_container() hasn't been called on it.
+ */
+void
+netsnmp_access_tcpconn_snapshot_free(netsnmp_tcpconn_snapshot *snap)
+{
+    size_t i;
+
+    if (NULL == snap)
+        return;
+    /* not turned into a container: plain allocations without arch data */
+    for (i = 0; i < snap->count; ++i)
+        free(snap->entries[i]);
+    free(snap->entries);
+    if (NULL != snap->container)
+        netsnmp_access_tcpconn_container_free(snap->container,
+                                              NETSNMP_ACCESS_TCPCONN_FREE_NOFLAGS);
+    free(snap);
+}
+
 /**---------------------------------------------------------------------*/
 /*
  * tcpconn_entry functions
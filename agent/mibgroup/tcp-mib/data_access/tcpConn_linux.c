@@ -12,9 +12,23 @@
 #include "tcp-mib/tcpConnectionTable/tcpConnectionTable_constants.h"
 #include "tcp-mib/data_access/tcpConn_private.h"
 #include "mibgroup/util_funcs/get_pid_from_inode.h"
+#include "mibgroup/util_funcs/inet_diag.h"
+
+#ifdef HAVE_LINUX_NETLINK_H
+#include <netinet/tcp.h>
+#include <linux/types.h>
+#include <linux/inet_diag.h>
+#endif
+
 static int
 linux_states[12] = { 1, 5, 3, 4, 6, 7, 11, 1, 8, 9, 2, 10 };
 
+static int _load_diag(netsnmp_container *container, u_int flags,
+                      int family);
+#ifdef HAVE_LINUX_NETLINK_H
+static int _diag_snapshot_entry(const struct inet_diag_msg *msg,
+                                void *context);
+#endif
 static int _load4(netsnmp_container *container, u_int flags);
 #if defined (NETSNMP_ENABLE_IPV6)
 static int _load6(netsnmp_container *container, u_int flags);
@@ -84,30 +98,191 @@ netsnmp_arch_tcpconn_container_load(netsnmp_container *container,
     DEBUGMSGTL(("access:tcpconn:container",
                 "tcpconn_container_arch_load (flags %x)\n", load_flags));
 
-    /* Setup the pid_from_inode table, and fill it.*/
-    netsnmp_get_pid_from_inode_init();
-
     if (NULL == container) {
         snmp_log(LOG_ERR, "no container specified/found for access_tcpconn\n");
         return -1;
     }
 
-    rc = _load4(container, load_flags);
+    /* Setup the pid_from_inode table, and fill it.*/
+    netsnmp_get_pid_from_inode_lock();
+    netsnmp_get_pid_from_inode_init();
+
+    /*
+     * try sock_diag first, and fall back to parsing /proc/net/tcp if
+     * the kernel doesn't support it (-2).
+     */
+    rc = _load_diag(container, load_flags, AF_INET);
+    if (-2 == rc)
+        rc = _load4(container, load_flags);
 
 #if defined (NETSNMP_ENABLE_IPV6)
-    if((0 != rc) || (load_flags & NETSNMP_ACCESS_TCPCONN_LOAD_IPV4_ONLY))
+    if((0 != rc) || (load_flags & NETSNMP_ACCESS_TCPCONN_LOAD_IPV4_ONLY)) {
+        netsnmp_get_pid_from_inode_unlock();
         return rc;
+    }
 
     /*
      * load ipv6. ipv6 module might not be loaded,
      * so ignore -2 err (file not found)
      */
-    rc = _load6(container, load_flags);
+    rc = _load_diag(container, load_flags, AF_INET6);
+    if (-2 == rc)
+        rc = _load6(container, load_flags);
     if (-2 == rc)
         rc = 0;
 #endif
 
+    netsnmp_get_pid_from_inode_unlock();
+    return rc;
+}
+
+/**
+ * load the connections into a snapshot, for
+ * netsnmp_access_tcpconn_snapshot_load(). Only sock_diag can do that
+ * without logging; the pid table has a lock of its own.
+ *
+ * @retval  0 no errors
+ * @retval -2 sock_diag not supported, do a regular load
+ * @retval !0 errors
+ */
+int
+netsnmp_arch_tcpconn_snapshot_load(netsnmp_tcpconn_snapshot *snap,
+                                   u_int load_flags)
+{
+#ifdef HAVE_LINUX_NETLINK_H
+    unsigned int    states = ~0U;
+    int             rc;
+
+    if (load_flags & NETSNMP_ACCESS_TCPCONN_LOAD_ONLYLISTEN)
+        states = 1 << TCP_LISTEN;
+    else if (load_flags & NETSNMP_ACCESS_TCPCONN_LOAD_NOLISTEN)
+        states &= ~(1 << TCP_LISTEN);
+
+    netsnmp_get_pid_from_inode_lock();
+    netsnmp_get_pid_from_inode_init();
+
+    rc = netsnmp_inet_diag_dump_quiet(AF_INET, IPPROTO_TCP, states,
+                                      _diag_snapshot_entry, snap);
+#if defined (NETSNMP_ENABLE_IPV6)
+    /*
+     * ipv6 module might not be loaded, so ignore -2
+     */
+    if ((0 == rc) && !(load_flags & NETSNMP_ACCESS_TCPCONN_LOAD_IPV4_ONLY)) {
+        rc = netsnmp_inet_diag_dump_quiet(AF_INET6, IPPROTO_TCP, states,
+                                          _diag_snapshot_entry, snap);
+        if (-2 == rc)
+            rc = 0;
+    }
+#endif
+
+    netsnmp_get_pid_from_inode_unlock();
     return rc;
+#else
+    return -2;
+#endif
+}
+
+#ifdef HAVE_LINUX_NETLINK_H
+/* fill an entry from a sock_diag message */
+static void
+_diag_fill(netsnmp_tcpconn_entry *entry, const struct inet_diag_msg *msg)
+{
+    size_t addr_len = (AF_INET == msg->idiag_family) ? 4 : 16;
+
+    /** same host order values as the ones read from procfs */
+    entry->loc_port = ntohs(msg->id.idiag_sport);
+    entry->rmt_port = ntohs(msg->id.idiag_dport);
+    entry->tcpConnState = msg->idiag_state < 12 ?
+        linux_states[msg->idiag_state] : 2;
+    entry->pid = netsnmp_get_pid_from_inode(msg->idiag_inode);
+
+    memcpy(entry->loc_addr, msg->id.idiag_src, addr_len);
+    entry->loc_addr_len = addr_len;
+    memcpy(entry->rmt_addr, msg->id.idiag_dst, addr_len);
+    entry->rmt_addr_len = addr_len;
+}
+
+/*
+ * add one socket from a sock_diag dump
+ */
+static int
+_diag_entry(const struct inet_diag_msg *msg, void *context)
+{
+    netsnmp_container     *container = (netsnmp_container *) context;
+    netsnmp_tcpconn_entry *entry;
+
+    entry = netsnmp_access_tcpconn_entry_create();
+    if (NULL == entry)
+        return -3;
+    _diag_fill(entry, msg);
+
+    entry->arbitrary_index = CONTAINER_SIZE(container) + 1;
+    CONTAINER_INSERT(container, entry);
+
+    return 0;
+}
+
+/*
+ * add one socket from a sock_diag dump to a snapshot. May run in a
+ * worker thread: memory allocation only, no logging.
+ */
+static int
+_diag_snapshot_entry(const struct inet_diag_msg *msg, void *context)
+{
+    netsnmp_tcpconn_snapshot *snap = (netsnmp_tcpconn_snapshot *) context;
+    netsnmp_tcpconn_entry    *entry, **entries;
+
+    if (snap->count == snap->size) {
+        entries = (netsnmp_tcpconn_entry **)
+            realloc(snap->entries, (snap->size ? snap->size * 2 : 64) *
+                    sizeof(*entries));
+        if (NULL == entries)
+            return -3;
+        snap->entries = entries;
+        snap->size = snap->size ? snap->size * 2 : 64;
+    }
+
+    entry = SNMP_MALLOC_TYPEDEF(netsnmp_tcpconn_entry);
+    if (NULL == entry)
+        return -3;
+    entry->oid_index.len = 1;
+    entry->oid_index.oids = &entry->arbitrary_index;
+    _diag_fill(entry, msg);
+
+    snap->entries[snap->count++] = entry;
+
+    return 0;
+}
+#endif /* HAVE_LINUX_NETLINK_H */
+
+/**
+ * load the connections of one address family through a sock_diag
+ * netlink socket. The kernel sends the sockets in binary batches and
+ * does the listen state filtering, so a listener only load doesn't
+ * even see the established connections.
+ *
+ * @retval  0 no errors
+ * @retval -2 sock_diag not supported, use procfs
+ * @retval !0 errors
+ */
+static int
+_load_diag(netsnmp_container *container, u_int load_flags, int family)
+{
+#ifdef HAVE_LINUX_NETLINK_H
+    unsigned int    states = ~0U;
+
+    netsnmp_assert(NULL != container);
+
+    if (load_flags & NETSNMP_ACCESS_TCPCONN_LOAD_ONLYLISTEN)
+        states = 1 << TCP_LISTEN;
+    else if (load_flags & NETSNMP_ACCESS_TCPCONN_LOAD_NOLISTEN)
+        states &= ~(1 << TCP_LISTEN);
+
+    return netsnmp_inet_diag_dump(family, IPPROTO_TCP, states,
+                                  _diag_entry, container);
+#else
+    return -2;
+#endif
 }
 
 /**
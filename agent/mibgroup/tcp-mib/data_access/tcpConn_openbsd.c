@@ -95,6 +95,17 @@ netsnmp_arch_tcpconn_entry_delete(netsnmp_tcpconn_entry *entry)
 }
 
 
+/*
+ * no thread safe load here: let netsnmp_access_tcpconn_snapshot_container
+ * do a regular one
+ */
+int
+netsnmp_arch_tcpconn_snapshot_load(netsnmp_tcpconn_snapshot *snap,
+                                   u_int load_flags)
+{
+    return -2;
+}
+
 /**
  *
  * @retval  0 no errors
@@ -19,6 +19,63 @@
 
 #include "tcpConnectionTable_data_access.h"
 
+netsnmp_feature_require(container_sync)
+
+/*
+ * The connections are loaded into a cache of their own, which takes a
+ * fresh snapshot on every load (NETSNMP_CACHE_LOAD_THREAD_SAFE), and
+ * the table's rows are merged from its latest contents. In an agent
+ * built with --enable-reentrant an expired list is reloaded by the
+ * cache helper's worker threads while the table keeps using the old
+ * one, so dumping the kernel's sockets doesn't hold up the main loop;
+ * the rows may then lag by up to another cache timeout. The worker
+ * only fills the private snapshot; turning it into a container and
+ * merging the rows is done here, by the main loop.
+ */
+static netsnmp_cache *_connection_cache = NULL;
+
+static int
+_connection_cache_load(netsnmp_cache *cache, void *magic)
+{
+    /*
+     * may run in a worker thread: no logging, no shared data
+     */
+    cache->magic =
+        netsnmp_access_tcpconn_snapshot_load(NETSNMP_ACCESS_TCPCONN_LOAD_NOLISTEN);
+    return (NULL == cache->magic) ? -1 : 0;
+}
+
+static void
+_connection_cache_free(netsnmp_cache *cache, void *magic)
+{
+    netsnmp_access_tcpconn_snapshot_free((netsnmp_tcpconn_snapshot *) magic);
+}
+
+/*
+ * the loaded connections belong to the connection cache, so rows get
+ * their own copy of an entry
+ */
+static netsnmp_tcpconn_entry *
+_copy_connection(netsnmp_tcpconn_entry *entry)
+{
+    netsnmp_tcpconn_entry *copy = netsnmp_access_tcpconn_entry_create();
+
+    if (NULL == copy)
+        return NULL;
+    memcpy(copy->loc_addr, entry->loc_addr, sizeof(copy->loc_addr));
+    memcpy(copy->rmt_addr, entry->rmt_addr, sizeof(copy->rmt_addr));
+    copy->loc_addr_len = entry->loc_addr_len;
+    copy->rmt_addr_len = entry->rmt_addr_len;
+    copy->loc_port = entry->loc_port;
+    copy->rmt_port = entry->rmt_port;
+    copy->arbitrary_index = entry->arbitrary_index;
+    if (netsnmp_access_tcpconn_entry_update(copy, entry) < 0) {
+        netsnmp_access_tcpconn_entry_free(copy);
+        return NULL;
+    }
+    return copy;
+}
+
 /** @ingroup interface 
  * @addtogroup data_access data_access: Routines to access data
  *
@@ -131,6 +188,27 @@ tcpConnectionTable_container_init(netsnmp_container **container_ptr_ptr,
      */
     cache->timeout = TCPCONNECTIONTABLE_CACHE_TIMEOUT;  /* seconds */
     cache->flags |= NETSNMP_CACHE_DONT_INVALIDATE_ON_SET;
+
+    /*
+     * the container is updated in place on reload (see
+     * tcpConnectionTable_container_load), so keep it around.
+     */
+    cache->flags |= NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD |
+        NETSNMP_CACHE_DONT_FREE_EXPIRED | NETSNMP_CACHE_DONT_AUTO_RELEASE;
+
+    _connection_cache =
+        netsnmp_cache_create(TCPCONNECTIONTABLE_CACHE_TIMEOUT,
+                             _connection_cache_load, _connection_cache_free,
+                             NULL, 0);
+    if (NULL == _connection_cache) {
+        snmp_log(LOG_ERR, "error creating connection cache for "
+                 "tcpConnectionTable\n");
+        return;
+    }
+    _connection_cache->flags = NETSNMP_CACHE_LOAD_THREAD_SAFE;
+#ifdef NETSNMP_REENTRANT
+    _connection_cache->flags |= NETSNMP_CACHE_STALE_WHILE_REVALIDATE;
+#endif
 }                               /* tcpConnectionTable_container_init */
 
 /**
@@ -160,6 +238,8 @@ tcpConnectionTable_container_shutdown(netsnmp_container *container_ptr)
         return;
     }
 
+    netsnmp_cache_free(_connection_cache);
+    _connection_cache = NULL;
 }                               /* tcpConnectionTable_container_shutdown */
 
 /**
@@ -172,6 +252,13 @@ _add_connection(netsnmp_tcpconn_entry *entry, netsnmp_container *container)
 
     DEBUGMSGTL(("tcpConnectionTable:access", "creating new entry\n"));
 
+    entry = _copy_connection(entry);
+    if (NULL == entry) {
+        snmp_log(LOG_ERR, "memory allocation failed while loading "
+                 "tcpConnectionTable cache.\n");
+        return;
+    }
+
     /*
      * allocate an row context and set the index(es), then add it to
      * the container
@@ -206,13 +293,108 @@ _add_connection(netsnmp_tcpconn_entry *entry, netsnmp_container *container)
     }
 }
 
+/*
+ * incremental update callbacks
+ */
+static size_t
+_connection_key(const void *fresh, oid *buf, size_t max_len, void *context)
+{
+    const netsnmp_tcpconn_entry *entry = (const netsnmp_tcpconn_entry *) fresh;
+    tcpConnectionTable_mib_index tbl_idx;
+    netsnmp_index   oid_idx;
+
+    memset(&tbl_idx, 0x0, sizeof(tbl_idx));
+    if (MFD_SUCCESS !=
+        tcpConnectionTable_indexes_set_tbl_idx(&tbl_idx,
+                                               entry->loc_addr_len,
+                                               entry->loc_addr,
+                                               entry->loc_addr_len,
+                                               entry->loc_port,
+                                               entry->rmt_addr_len,
+                                               entry->rmt_addr,
+                                               entry->rmt_addr_len,
+                                               entry->rmt_port))
+        return 0;
+
+    oid_idx.oids = buf;
+    oid_idx.len = max_len;
+    if (0 != tcpConnectionTable_index_to_oid(&oid_idx, &tbl_idx))
+        return 0;
+
+    return oid_idx.len;
+}
+
+static int
+_update_connection(tcpConnectionTable_rowreq_ctx *rowreq_ctx,
+                   netsnmp_tcpconn_entry *entry, void *context)
+{
+    /*
+     * same connection; just refresh state and pid. The fresh entry
+     * isn't claimed.
+     */
+    netsnmp_access_tcpconn_entry_update(rowreq_ctx->data, entry);
+    return 0;
+}
+
+static void *
+_create_connection(netsnmp_tcpconn_entry *entry, void *context)
+{
+    tcpConnectionTable_rowreq_ctx *rowreq_ctx;
+
+    entry = _copy_connection(entry);
+    if (NULL == entry) {
+        snmp_log(LOG_ERR, "memory allocation failed while loading "
+                 "tcpConnectionTable cache.\n");
+        return NULL;
+    }
+    rowreq_ctx = tcpConnectionTable_allocate_rowreq_ctx(entry, NULL);
+    if (NULL == rowreq_ctx) {
+        snmp_log(LOG_ERR, "memory allocation failed while loading "
+                 "tcpConnectionTable cache.\n");
+        netsnmp_access_tcpconn_entry_free(entry);
+        return NULL;
+    }
+    if (MFD_SUCCESS != tcpConnectionTable_indexes_set(rowreq_ctx,
+                                                      entry->loc_addr_len,
+                                                      entry->loc_addr,
+                                                      entry->loc_addr_len,
+                                                      entry->loc_port,
+                                                      entry->rmt_addr_len,
+                                                      entry->rmt_addr,
+                                                      entry->rmt_addr_len,
+                                                      entry->rmt_port)) {
+        snmp_log(LOG_ERR, "error setting index while loading "
+                 "tcpConnectionTable cache.\n");
+        tcpConnectionTable_release_rowreq_ctx(rowreq_ctx);
+        return NULL;
+    }
+    return rowreq_ctx;
+}
+
+static void
+_release_connection(tcpConnectionTable_rowreq_ctx *rowreq_ctx,
+                    void *context)
+{
+    tcpConnectionTable_release_rowreq_ctx(rowreq_ctx);
+}
+
+static const netsnmp_container_sync_ops _connection_sync_ops = {
+    _connection_key,
+    (int (*)(void *, void *, void *)) _update_connection,
+    (void *(*)(void *, void *)) _create_connection,
+    (void (*)(void *, void *)) _release_connection,
+    NULL                        /* the connection cache owns the entries */
+};
+
 /**
  * load initial data
  *
  * TODO:350:M: Implement tcpConnectionTable data load
  * This function will also be called by the cache helper to load
- * the container again (after the container free function has been
- * called to free the previous contents).
+ * the container again. The container isn't freed first: rows for
+ * connections which still exist are kept and updated in place, rows
+ * for closed connections are removed and new connections are added.
+ * The connections come from the connection cache (see above).
  *
  * @param container container to which items should be inserted
  *
@@ -242,27 +424,32 @@ _add_connection(netsnmp_tcpconn_entry *entry, netsnmp_container *container)
 int
 tcpConnectionTable_container_load(netsnmp_container *container)
 {
-    netsnmp_container *raw_data =
-        netsnmp_access_tcpconn_container_load(NULL,
-                                              NETSNMP_ACCESS_TCPCONN_LOAD_NOLISTEN);
+    netsnmp_container *raw_data;
 
     DEBUGMSGTL(("verbose:tcpConnectionTable:tcpConnectionTable_container_load", "called\n"));
 
+    netsnmp_cache_check_and_reload(_connection_cache);
+    if ((NULL == _connection_cache) || !_connection_cache->valid) {
+        DEBUGMSGTL(("tcpConnectionTable:container_load",
+                    "no connections loaded\n"));
+        return MFD_RESOURCE_UNAVAILABLE;
+    }
+    raw_data = netsnmp_access_tcpconn_snapshot_container(
+        (netsnmp_tcpconn_snapshot *) _connection_cache->magic);
     if (NULL == raw_data)
         return MFD_RESOURCE_UNAVAILABLE;        /* msg already logged */
 
     /*
-     * got all the connections. pull out the active ones.
+     * got all the connections. merge them into the rows we already have,
+     * or start over if that isn't possible.
      */
-    CONTAINER_FOR_EACH(raw_data, (netsnmp_container_obj_func *)
-                       _add_connection, container);
-
-    /*
-     * free the container. we've either claimed each entry, or released it,
-     * so the dal function doesn't need to clear the container.
-     */
-    netsnmp_access_tcpconn_container_free(raw_data,
-                                          NETSNMP_ACCESS_TCPCONN_FREE_DONT_CLEAR);
+    if (netsnmp_container_sync(container, raw_data, &_connection_sync_ops,
+                               NULL) != 0) {
+        CONTAINER_CLEAR(container, (netsnmp_container_obj_func *)
+                        _release_connection, NULL);
+        CONTAINER_FOR_EACH(raw_data, (netsnmp_container_obj_func *)
+                           _add_connection, container);
+    }
 
     DEBUGMSGT(("verbose:tcpConnectionTable:tcpConnectionTable_cache_load",
                "%d records\n", (int)CONTAINER_SIZE(container)));
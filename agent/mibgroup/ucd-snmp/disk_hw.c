@@ -408,7 +408,9 @@ tryAgain:
     case ERRORFLAG:
         long_ret = 0;
         val = netsnmp_fsys_avail_ull(entry);
-        if (( entry->minspace >= 0 ) &&
+        if (entry->flags & NETSNMP_FS_FLAG_STALE)
+            long_ret = 1;
+        else if (( entry->minspace >= 0 ) &&
             ( val < entry->minspace ))
             long_ret = 1;
         else if (( entry->minpercent >= 0 ) &&
@@ -419,7 +421,10 @@ tryAgain:
     case ERRORMSG:
         errmsg[0] = 0;
         val = netsnmp_fsys_avail_ull(entry);
-        if (( entry->minspace >= 0 ) &&
+        if (entry->flags & NETSNMP_FS_FLAG_STALE)
+                snprintf(errmsg, sizeof(errmsg),
+                        "%s: not responding", entry->path);
+        else if (( entry->minspace >= 0 ) &&
             ( val < entry->minspace ))
                 snprintf(errmsg, sizeof(errmsg),
                         "%s: less than %d free (= %d)",
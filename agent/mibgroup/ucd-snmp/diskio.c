@@ -30,7 +30,9 @@
 #if defined (linux)
 /* for stat() */
 #include <ctype.h>
+#include <errno.h>
 #include <sys/stat.h>
+#include <sys/sysmacros.h>
 #endif
 
 #include <net-snmp/net-snmp-includes.h>
@@ -105,16 +107,26 @@ static int ps_numdisks;			/* number of disks in system, may change while running
 #endif
 
 #if defined (linux)
+#include <fcntl.h>
+#include <fnmatch.h>
+
 #define DISKIO_SAMPLE_INTERVAL 5
 void devla_getstats(unsigned int regno, void * dummy);
 static void diskio_parse_config_disks(const char *token, char *cptr);
+static void diskio_parse_config_pattern(const char *token, char *cptr);
 static int diskio_pre_update_config(int, int, void *, void *);
+static int diskio_post_read_config(int, int, void *, void *);
 static void diskio_free_config(void);
 
-#define DISK_INCR 2
-
+/*
+ * one block device. The entries are kept from one sample to the next
+ * in a container indexed by major.minor, so that the load averages,
+ * rates and filter decisions stay with their device.
+ */
 typedef struct linux_diskio
 {
+    netsnmp_index oid_index;
+    oid  dev[2];
     int major;
     int  minor;
     unsigned long  blocks;
@@ -130,30 +142,53 @@ typedef struct linux_diskio
     unsigned long  running;
     unsigned long  use;
     unsigned long  aveq;
-} linux_diskio;
 
-/* disk load averages */
-typedef struct linux_diskio_la
-{
+    u_int excluded_gen;         /* diskio_filter_gen when last checked */
+    int   excluded;
+
+    /* load averages and rates, updated by devla_getstats() */
+    int   la_valid;             /* the *_prev values hold a sample */
     unsigned long use_prev;
+    unsigned long rio_prev, wio_prev, rsect_prev, wsect_prev;
     double la1, la5, la15;
-} linux_diskio_la;
+    u_long rio_rate, wio_rate;              /* operations per second */
+    u_long rsect_rate, wsect_rate;          /* kilobytes per second */
+} linux_diskio;
 
+/*
+ * the devices of the last sample, in the order the kernel lists them
+ */
 typedef struct linux_diskio_header
 {
-    linux_diskio* indices;
+    linux_diskio** indices;
     int length;
     int alloc;
 } linux_diskio_header;
 
-typedef struct linux_diskio_la_header
-{
-    linux_diskio_la * indices;
-    int length;
-} linux_diskio_la_header;
-
 static linux_diskio_header head;
-static linux_diskio_la_header la_head;
+
+/*
+ * all devices seen in the last sample, and the ones of the sample in
+ * progress. Entries move from one to the other as they are seen again.
+ */
+static netsnmp_container *diskio_cache;
+static netsnmp_container *diskio_cache_next;
+
+/* when the counters in head were read */
+static struct timeval diskio_sample_time;
+
+/*
+ * diskio_include / diskio_exclude patterns. Bumping diskio_filter_gen
+ * makes every device be checked against them again.
+ */
+struct diskio_pattern {
+    struct diskio_pattern *next;
+    int                    include;
+    char                  *pattern;
+};
+static struct diskio_pattern *diskio_patterns;
+static int                    diskio_have_includes;
+static u_int                  diskio_filter_gen = 1;
 
 #endif /* linux */
 
@@ -249,6 +284,16 @@ init_diskio(void)
          var_diskio, 1, {12}},
         {DISKIO_NWRITTENX, ASN_COUNTER64, NETSNMP_OLDAPI_RONLY,
          var_diskio, 1, {13}},
+#ifdef linux
+        {DISKIO_READS_RATE, ASN_GAUGE, NETSNMP_OLDAPI_RONLY,
+         var_diskio, 1, {14}},
+        {DISKIO_WRITES_RATE, ASN_GAUGE, NETSNMP_OLDAPI_RONLY,
+         var_diskio, 1, {15}},
+        {DISKIO_NREAD_RATE, ASN_GAUGE, NETSNMP_OLDAPI_RONLY,
+         var_diskio, 1, {16}},
+        {DISKIO_NWRITTEN_RATE, ASN_GAUGE, NETSNMP_OLDAPI_RONLY,
+         var_diskio, 1, {17}},
+#endif
     };
 
     /*
@@ -294,6 +339,15 @@ init_diskio(void)
     ps_disk = NULL;
 #endif
 
+#ifdef linux
+    diskio_cache = netsnmp_container_find("diskio_cache:hash");
+    diskio_cache_next = netsnmp_container_find("diskio_cache:hash");
+    if (NULL == diskio_cache || NULL == diskio_cache_next) {
+        snmp_log(LOG_ERR, "diskio: could not create the device cache\n");
+        return;
+    }
+#endif
+
 #if defined (HAVE_GETDEVS) || defined(HAVE_DEVSTAT_GETDEVS) || defined(linux)
     devla_getstats(0, NULL);
     /* collect LA data regularly */
@@ -316,11 +370,17 @@ init_diskio(void)
 
     snmpd_register_config_handler("diskio", diskio_parse_config_disks,
         diskio_free_config, "path | device");
-    
+    snmpd_register_config_handler("diskio_include",
+        diskio_parse_config_pattern, NULL, "pattern [pattern ...]");
+    snmpd_register_config_handler("diskio_exclude",
+        diskio_parse_config_pattern, NULL, "pattern [pattern ...]");
 
     snmp_register_callback(SNMP_CALLBACK_APPLICATION,
 	                   SNMPD_CALLBACK_PRE_UPDATE_CONFIG,
 	                   diskio_pre_update_config, NULL);
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY,
+                           SNMP_CALLBACK_POST_READ_CONFIG,
+                           diskio_post_read_config, NULL);
 
 #endif
 }
@@ -334,10 +394,24 @@ diskio_pre_update_config(int major, int minor, void *serverarg, void *clientarg)
     return 0;
 }
 
+/*
+ * the exclusion settings may have changed: check every device again
+ */
+static int
+diskio_post_read_config(int major, int minor, void *serverarg,
+                        void *clientarg)
+{
+    if (++diskio_filter_gen == 0)
+        ++diskio_filter_gen;
+    cache_time = 0;
+    return 0;
+}
+
 static void
 diskio_free_config()
 {
     int i;
+    struct diskio_pattern *pat;
 
     DEBUGMSGTL(("diskio", "free config %d\n",
 		netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
@@ -349,12 +423,19 @@ diskio_free_config()
     netsnmp_ds_set_boolean(NETSNMP_DS_APPLICATION_ID, 
 			   NETSNMP_DS_AGENT_DISKIO_NO_RAM,  0);
 
-    if (la_head.length) {
-        /* reset any usage stats, we may get different list of devices from config */
-        free(la_head.indices);
-        la_head.length = 0;
-        la_head.indices = NULL;
+    while (diskio_patterns) {
+        pat = diskio_patterns;
+        diskio_patterns = pat->next;
+        free(pat->pattern);
+        free(pat);
     }
+    diskio_have_includes = 0;
+
+    /* reset any usage stats, we may get different list of devices from config */
+    if (diskio_cache)
+        CONTAINER_CLEAR(diskio_cache, netsnmp_container_simple_free, NULL);
+    head.length = 0;
+    cache_time = 0;
     if (numdisks > 0) {
         head.length = 0;
         numdisks = 0;
@@ -479,6 +560,31 @@ diskio_parse_config_disks(const char *token, char *cptr)
 #endif /* HAVE_FSTAB_H || HAVE_GETMNTENT || HAVE_STATFS */
 }
 
+static void
+diskio_parse_config_pattern(const char *token, char *cptr)
+{
+    char pattern[STRMAX];
+    struct diskio_pattern *pat, **last;
+    int include = !strcmp(token, "diskio_include");
+
+    for (last = &diskio_patterns; *last; last = &(*last)->next)
+        ;
+    while (cptr && *cptr) {
+        cptr = copy_nword(cptr, pattern, sizeof(pattern));
+        pat = (struct diskio_pattern *) calloc(1, sizeof(*pat));
+        if (!pat || !(pat->pattern = strdup(pattern))) {
+            free(pat);
+            config_perror("malloc failed for diskio pattern");
+            return;
+        }
+        pat->include = include;
+        *last = pat;
+        last = &pat->next;
+        if (include)
+            diskio_have_includes = 1;
+    }
+}
+
 #endif /* linux */
 
 
@@ -1233,7 +1339,9 @@ var_diskio(struct variable * vp,
 void devla_getstats(unsigned int regno, void * dummy) {
 
     static double expon1, expon5, expon15;
-    double busy_time, busy_percent;
+    static struct timeval la_time;
+    double busy_time, busy_percent, interval;
+    linux_diskio *d;
     int idx;
 
     if (getstats() == 1) {
@@ -1241,42 +1349,52 @@ void devla_getstats(unsigned int regno, void * dummy) {
         return;
     }
 
-    if (!la_head.length) {
-        la_head.indices = (linux_diskio_la *) malloc(head.length * sizeof(linux_diskio_la));
-        for (idx=0; idx<head.length; idx++) {
-            la_head.indices[idx].la1 = la_head.indices[idx].la5 = la_head.indices[idx].la15 = 0.; 
-            la_head.indices[idx].use_prev = head.indices[idx].use;
-        }
-        la_head.length = head.length;
+    if (expon1 == 0.) {
         expon1 = exp(-(((double)DISKIO_SAMPLE_INTERVAL) / ((double)60)));
         expon5 = exp(-(((double)DISKIO_SAMPLE_INTERVAL) / ((double)300)));
         expon15 = exp(-(((double)DISKIO_SAMPLE_INTERVAL) / ((double)900)));
     }
-    else if (head.length - la_head.length) {
-        la_head.indices = (linux_diskio_la *) realloc(la_head.indices, head.length * sizeof(linux_diskio_la));
-        for (idx=la_head.length; idx<head.length; idx++) {
-            la_head.indices[idx].la1 = la_head.indices[idx].la5 = la_head.indices[idx].la15 = 0.; 
-            la_head.indices[idx].use_prev = head.indices[idx].use;
-        }
-        la_head.length = head.length;
-    }
+    interval = (diskio_sample_time.tv_sec - la_time.tv_sec) +
+        (diskio_sample_time.tv_usec - la_time.tv_usec) / 1000000.;
+    la_time = diskio_sample_time;
 
     for (idx=0; idx<head.length; idx++) {
-        busy_time = head.indices[idx].use - la_head.indices[idx].use_prev;
-        busy_percent = busy_time * 100. / ((double) DISKIO_SAMPLE_INTERVAL) / 1000.;
-        la_head.indices[idx].la1 = la_head.indices[idx].la1 * expon1 + busy_percent * (1. - expon1);
-        la_head.indices[idx].la5 = la_head.indices[idx].la5 * expon5 + busy_percent * (1. - expon5);
-        la_head.indices[idx].la15 = la_head.indices[idx].la15 * expon15 + busy_percent * (1. - expon15);
+        d = head.indices[idx];
+        if (!d->la_valid) {
+            /* a new device: this is its first sample */
+            d->la1 = d->la5 = d->la15 = 0.;
+            d->rio_rate = d->wio_rate = d->rsect_rate = d->wsect_rate = 0;
+        } else {
+            busy_time = d->use - d->use_prev;
+            busy_percent = busy_time * 100. / ((double) DISKIO_SAMPLE_INTERVAL) / 1000.;
+            d->la1 = d->la1 * expon1 + busy_percent * (1. - expon1);
+            d->la5 = d->la5 * expon5 + busy_percent * (1. - expon5);
+            d->la15 = d->la15 * expon15 + busy_percent * (1. - expon15);
+            if (interval > 0.) {
+                d->rio_rate = (d->rio - d->rio_prev) / interval;
+                d->wio_rate = (d->wio - d->wio_prev) / interval;
+                d->rsect_rate = (d->rsect - d->rsect_prev) / 2 / interval;
+                d->wsect_rate = (d->wsect - d->wsect_prev) / 2 / interval;
+            }
+        }
         /*
           fprintf(stderr, "(%d) update la1=%f la5=%f la15=%f\n",
-          idx, la_head.indices[idx].la1, la_head.indices[idx].la5, la_head.indices[idx].la15);   
+          idx, d->la1, d->la5, d->la15);
         */
-        la_head.indices[idx].use_prev = head.indices[idx].use;
+        d->use_prev = d->use;
+        d->rio_prev = d->rio;
+        d->wio_prev = d->wio;
+        d->rsect_prev = d->rsect;
+        d->wsect_prev = d->wsect;
+        d->la_valid = 1;
     }
 }
 
 int is_excluded(const char *name)
 {
+    struct diskio_pattern *pat;
+    int included = !diskio_have_includes;
+
     if (netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
                                NETSNMP_DS_AGENT_DISKIO_NO_FD)
                            && !(strncmp(name, "fd", 2)))
@@ -1289,15 +1407,221 @@ int is_excluded(const char *name)
                                NETSNMP_DS_AGENT_DISKIO_NO_RAM)
                            && !(strncmp(name, "ram", 3)))
         return 1;
-    return 0;
+    for (pat = diskio_patterns; pat; pat = pat->next) {
+        if (fnmatch(pat->pattern, name, 0) != 0)
+            continue;
+        if (!pat->include)
+            return 1;
+        included = 1;
+    }
+    return !included;
+}
+
+/*
+ * find the entry of a device in the previous sample, or create one,
+ * move it to the sample in progress and append it to head.
+ *
+ * @return the entry, or NULL if the device is excluded or on errors
+ */
+static linux_diskio *
+diskio_sample_device(int major, int minor, const char *name, int filter)
+{
+    linux_diskio *d, **indices;
+    netsnmp_index key;
+    oid dev[2];
+
+    dev[0] = major;
+    dev[1] = minor;
+    key.len = 2;
+    key.oids = dev;
+
+    d = (linux_diskio *) CONTAINER_FIND(diskio_cache_next, &key);
+    if (d)
+        return NULL;            /* listed twice */
+    d = (linux_diskio *) CONTAINER_FIND(diskio_cache, &key);
+    if (d) {
+        CONTAINER_REMOVE(diskio_cache, d);
+        if (strcmp(d->name, name) != 0) {
+            /* the numbers were reused for another device */
+            free(d);
+            d = NULL;
+        }
+    }
+    if (!d) {
+        d = (linux_diskio *) calloc(1, sizeof(linux_diskio));
+        if (!d)
+            return NULL;
+        d->major = major;
+        d->minor = minor;
+        d->dev[0] = major;
+        d->dev[1] = minor;
+        d->oid_index.len = 2;
+        d->oid_index.oids = d->dev;
+        strlcpy(d->name, name, sizeof(d->name));
+    }
+    if (CONTAINER_INSERT(diskio_cache_next, d) != 0) {
+        free(d);
+        return NULL;
+    }
+
+    if (filter && d->excluded_gen != diskio_filter_gen) {
+        d->excluded = is_excluded(d->name);
+        d->excluded_gen = diskio_filter_gen;
+    }
+    if (filter && d->excluded)
+        return NULL;
+
+    if (head.length == head.alloc) {
+        int alloc = head.alloc ? head.alloc * 2 : 64;
+
+        indices = (linux_diskio **) realloc(head.indices,
+                                            alloc * sizeof(linux_diskio *));
+        if (!indices)
+            return NULL;
+        head.indices = indices;
+        head.alloc = alloc;
+    }
+    head.indices[head.length++] = d;
+    return d;
+}
+
+/*
+ * start a sample: devices not seen again by diskio_sample_end() are
+ * dropped then.
+ */
+static void
+diskio_sample_begin(void)
+{
+    head.length = 0;
+}
+
+static void
+diskio_sample_end(void)
+{
+    netsnmp_container *tmp;
+
+    CONTAINER_CLEAR(diskio_cache, netsnmp_container_simple_free, NULL);
+    tmp = diskio_cache;
+    diskio_cache = diskio_cache_next;
+    diskio_cache_next = tmp;
+    netsnmp_get_monotonic_clock(&diskio_sample_time);
+}
+
+/*
+ * read all of /proc/diskstats. The buffer keeps the size of the largest
+ * read so far, so that after the first sample the kernel fills it with
+ * a single read() call.
+ *
+ * @return the length read, or -1 on errors
+ */
+static int
+diskio_read_diskstats(char **bufp)
+{
+    static char   *buf;
+    static size_t  size;
+    ssize_t        len, total = 0;
+    int            fd;
+
+    fd = open("/proc/diskstats", O_RDONLY);
+    if (fd < 0)
+        return -1;
+    for (;;) {
+        if (total + 1 >= size) {
+            size_t newsize = size ? size * 2 : 16384;
+            char  *newbuf = (char *) realloc(buf, newsize);
+
+            if (!newbuf) {
+                total = -1;
+                break;
+            }
+            buf = newbuf;
+            size = newsize;
+        }
+        len = read(fd, buf + total, size - total - 1);
+        if (len < 0) {
+            if (EINTR == errno)
+                continue;
+            total = -1;
+            break;
+        }
+        if (len == 0)
+            break;
+        total += len;
+    }
+    close(fd);
+    if (total < 0)
+        return -1;
+    buf[total] = '\0';
+    *bufp = buf;
+    return total;
+}
+
+/*
+ * parse one line of /proc/diskstats:
+ *   major minor name rio rmerge rsect ruse wio wmerge wsect wuse running use aveq ...
+ * or, for partitions on kernels before 2.6.25:
+ *   major minor name rio rsect wio wsect
+ */
+static void
+diskio_parse_diskstats_line(char *line)
+{
+    unsigned long val[11];
+    linux_diskio *d;
+    char *name, *end;
+    int major, minor, n;
+
+    major = strtol(line, &end, 10);
+    if (end == line)
+        return;
+    minor = strtol(end, &line, 10);
+    if (line == end)
+        return;
+    while (isspace((unsigned char)*line))
+        ++line;
+    name = line;
+    while (*line && !isspace((unsigned char)*line))
+        ++line;
+    if (line == name || !*line)
+        return;
+    *line++ = '\0';
+
+    for (n = 0; n < 11; ++n) {
+        val[n] = strtoul(line, &end, 10);
+        if (end == line)
+            break;
+        line = end;
+    }
+    if (n != 11 && n != 4)
+        return;
+
+    d = diskio_sample_device(major, minor, name, 1);
+    if (!d)
+        return;
+    if (n == 11) {
+        d->rio = val[0];
+        d->rmerge = val[1];
+        d->rsect = val[2];
+        d->ruse = val[3];
+        d->wio = val[4];
+        d->wmerge = val[5];
+        d->wsect = val[6];
+        d->wuse = val[7];
+        d->running = val[8];
+        d->use = val[9];
+        d->aveq = val[10];
+    } else {
+        d->rio = val[0];
+        d->rsect = val[1];
+        d->wio = val[2];
+        d->wsect = val[3];
+    }
 }
 
 static int get_sysfs_stats(void)
 {
     int i;
     char buffer[1024];
-
-    head.length  = 0;
+    linux_diskio tmp, *pTemp;
 
     for(i = 0; i < numdisks; i++) {
         FILE *f = fopen(disks[i].syspath, "r");
@@ -1311,25 +1635,32 @@ static int get_sysfs_stats(void)
             fclose(f);
             continue;
         }
+        fclose(f);
 
-        linux_diskio* pTemp;
-        if (head.length == head.alloc) {
-            head.alloc += DISK_INCR;
-            head.indices = (linux_diskio *) realloc(head.indices, head.alloc*sizeof(linux_diskio));
-        }
-        pTemp = &head.indices[head.length];
-        pTemp->major = disks[i].major;
-        pTemp->minor = disks[i].minor;
-        strlcpy( pTemp->name, disks[i].shortname, sizeof(pTemp->name) - 1 );
+        memset(&tmp, 0, sizeof(tmp));
         if (sscanf (buffer, "%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu\n",
-                &pTemp->rio, &pTemp->rmerge, &pTemp->rsect, &pTemp->ruse,
-                &pTemp->wio, &pTemp->wmerge, &pTemp->wsect, &pTemp->wuse,
-                &pTemp->running, &pTemp->use, &pTemp->aveq) != 11)
+                &tmp.rio, &tmp.rmerge, &tmp.rsect, &tmp.ruse,
+                &tmp.wio, &tmp.wmerge, &tmp.wsect, &tmp.wuse,
+                &tmp.running, &tmp.use, &tmp.aveq) != 11)
             sscanf (buffer, "%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu%*[ \n\t]%lu\n",
-                &pTemp->rio, &pTemp->rsect,
-                &pTemp->wio, &pTemp->wsect);
-        head.length++;
-        fclose(f);
+                &tmp.rio, &tmp.rsect,
+                &tmp.wio, &tmp.wsect);
+
+        pTemp = diskio_sample_device(disks[i].major, disks[i].minor,
+                                     disks[i].shortname, 0);
+        if (!pTemp)
+            continue;
+        pTemp->rio = tmp.rio;
+        pTemp->rmerge = tmp.rmerge;
+        pTemp->rsect = tmp.rsect;
+        pTemp->ruse = tmp.ruse;
+        pTemp->wio = tmp.wio;
+        pTemp->wmerge = tmp.wmerge;
+        pTemp->wsect = tmp.wsect;
+        pTemp->wuse = tmp.wuse;
+        pTemp->running = tmp.running;
+        pTemp->use = tmp.use;
+        pTemp->aveq = tmp.aveq;
     }
     return 0;
 }
@@ -1339,59 +1670,47 @@ getstats(void)
 {
     FILE* parts;
     time_t now;
+    char *buf, *line, *eol;
     
     now = time(NULL);
     if (cache_time + CACHE_TIMEOUT > now) {
         return 0;
     }
+    if (!diskio_cache || !diskio_cache_next)
+        return 1;
 
-    if (!head.indices) {
-	head.alloc = DISK_INCR;
-	head.indices = (linux_diskio *)malloc(head.alloc*sizeof(linux_diskio));
-    }
-    head.length  = 0;
-
-    memset(head.indices, 0, head.alloc*sizeof(linux_diskio));
+    diskio_sample_begin();
 
     if (numdisks>0) {
         /* 'diskio' configuration is used - go through the whitelist only and
          * read /sys/dev/block/xxx */
+        get_sysfs_stats();
+        diskio_sample_end();
         cache_time = now;
-        return get_sysfs_stats();
+        return 0;
     }
     /* 'diskio' configuration is not used - report all devices */
     /* Is this a 2.6 kernel? */
-    parts = fopen("/proc/diskstats", "r");
-    if (parts) {
-	char buffer[1024];
-	while (fgets(buffer, sizeof(buffer), parts)) {
-	    linux_diskio* pTemp;
-	    if (head.length == head.alloc) {
-		head.alloc += DISK_INCR;
-		head.indices = (linux_diskio *)realloc(head.indices, head.alloc*sizeof(linux_diskio));
-	    }
-	    pTemp = &head.indices[head.length];
-	    sscanf (buffer, "%d %d", &pTemp->major, &pTemp->minor);
- 	    if (sscanf (buffer, "%d %d %s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu\n",
-		    &pTemp->major, &pTemp->minor, pTemp->name,
-		    &pTemp->rio, &pTemp->rmerge, &pTemp->rsect, &pTemp->ruse,
-		    &pTemp->wio, &pTemp->wmerge, &pTemp->wsect, &pTemp->wuse,
- 		    &pTemp->running, &pTemp->use, &pTemp->aveq) != 14)
-		sscanf (buffer, "%d %d %s %lu %lu %lu %lu\n",
-		    &pTemp->major, &pTemp->minor, pTemp->name,
-		    &pTemp->rio, &pTemp->rsect,
-		    &pTemp->wio, &pTemp->wsect);
-            if (!is_excluded(pTemp->name))
-	        head.length++;
-	}
+    if (diskio_read_diskstats(&buf) >= 0) {
+        for (line = buf; *line; line = eol) {
+            eol = strchr(line, '\n');
+            if (eol)
+                *eol++ = '\0';
+            else
+                eol = line + strlen(line);
+            diskio_parse_diskstats_line(line);
+        }
     }
     else {
 	/* See if a 2.4 kernel */
 	char buffer[1024];
 	int rc;
+	linux_diskio tmp, *pTemp;
+
 	parts = fopen("/proc/partitions", "r");
 	if (!parts) {
 	    snmp_log_perror("/proc/partitions");
+	    diskio_sample_end();
 	    return 1;
 	}
 
@@ -1402,30 +1721,37 @@ getstats(void)
 	fgets(buffer, sizeof(buffer), parts);
 
 	while (! feof(parts)) {
-	    linux_diskio* pTemp;
-
-	    if (head.length == head.alloc) {
-		head.alloc += DISK_INCR;
-		head.indices = (linux_diskio *)realloc(head.indices, head.alloc*sizeof(linux_diskio));
-	    }
-	    pTemp = &head.indices[head.length];
-
 	    rc = fscanf(parts, "%d %d %lu %255s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu\n",
-		    &pTemp->major, &pTemp->minor, &pTemp->blocks, pTemp->name,
-		    &pTemp->rio, &pTemp->rmerge, &pTemp->rsect, &pTemp->ruse,
-		    &pTemp->wio, &pTemp->wmerge, &pTemp->wsect, &pTemp->wuse,
-		    &pTemp->running, &pTemp->use, &pTemp->aveq);
+		    &tmp.major, &tmp.minor, &tmp.blocks, tmp.name,
+		    &tmp.rio, &tmp.rmerge, &tmp.rsect, &tmp.ruse,
+		    &tmp.wio, &tmp.wmerge, &tmp.wsect, &tmp.wuse,
+		    &tmp.running, &tmp.use, &tmp.aveq);
             if (rc != 15) {
                snmp_log(LOG_ERR, "diskio.c: cannot find statistics in /proc/partitions\n");
                fclose(parts);
+               diskio_sample_end();
                return 1;
             }
-            if (!is_excluded(pTemp->name))
-	        head.length++;
+            pTemp = diskio_sample_device(tmp.major, tmp.minor, tmp.name, 1);
+            if (!pTemp)
+                continue;
+            pTemp->blocks = tmp.blocks;
+            pTemp->rio = tmp.rio;
+            pTemp->rmerge = tmp.rmerge;
+            pTemp->rsect = tmp.rsect;
+            pTemp->ruse = tmp.ruse;
+            pTemp->wio = tmp.wio;
+            pTemp->wmerge = tmp.wmerge;
+            pTemp->wsect = tmp.wsect;
+            pTemp->wuse = tmp.wuse;
+            pTemp->running = tmp.running;
+            pTemp->use = tmp.use;
+            pTemp->aveq = tmp.aveq;
 	}
+	fclose(parts);
     }
 
-    fclose(parts);
+    diskio_sample_end();
     cache_time = now;
     return 0;
 }
@@ -1461,48 +1787,51 @@ var_diskio(struct variable * vp,
       long_ret = indx+1;
       return (u_char *) &long_ret;
     case DISKIO_DEVICE:
-      *var_len = strlen(head.indices[indx].name);
-      return (u_char *) head.indices[indx].name;
+      *var_len = strlen(head.indices[indx]->name);
+      return (u_char *) head.indices[indx]->name;
     case DISKIO_NREAD:
-      long_ret = (head.indices[indx].rsect*512) & 0xffffffff;
+      long_ret = (head.indices[indx]->rsect*512) & 0xffffffff;
       return (u_char *) & long_ret;
     case DISKIO_NWRITTEN:
-      long_ret = (head.indices[indx].wsect*512) & 0xffffffff;
+      long_ret = (head.indices[indx]->wsect*512) & 0xffffffff;
       return (u_char *) & long_ret;
     case DISKIO_READS:
-      long_ret = head.indices[indx].rio & 0xffffffff;
+      long_ret = head.indices[indx]->rio & 0xffffffff;
       return (u_char *) & long_ret;
     case DISKIO_WRITES:
-      long_ret = head.indices[indx].wio & 0xffffffff;
+      long_ret = head.indices[indx]->wio & 0xffffffff;
       return (u_char *) & long_ret;
     case DISKIO_LA1:
-      if (la_head.length > indx)
-          long_ret = la_head.indices[indx].la1;
-      else
-          long_ret = 0; /* we don't have the load yet */
+      long_ret = head.indices[indx]->la1; /* 0 until we have the load */
       return (u_char *) & long_ret;
     case DISKIO_LA5:
-      if (la_head.length > indx)
-          long_ret = la_head.indices[indx].la5;
-      else
-          long_ret = 0; /* we don't have the load yet */
+      long_ret = head.indices[indx]->la5;
       return (u_char *) & long_ret;
     case DISKIO_LA15:
-      if (la_head.length > indx)
-          long_ret = la_head.indices[indx].la15;
-      else
-          long_ret = 0;
+      long_ret = head.indices[indx]->la15;
       return (u_char *) & long_ret;
     case DISKIO_NREADX:
       *var_len = sizeof(struct counter64);
-      c64_ret.low = head.indices[indx].rsect * 512 & 0xffffffff;
-      c64_ret.high = head.indices[indx].rsect >> (32 - 9);
+      c64_ret.low = head.indices[indx]->rsect * 512 & 0xffffffff;
+      c64_ret.high = head.indices[indx]->rsect >> (32 - 9);
       return (u_char *) & c64_ret;
     case DISKIO_NWRITTENX:
       *var_len = sizeof(struct counter64);
-      c64_ret.low = head.indices[indx].wsect * 512 & 0xffffffff;
-      c64_ret.high = head.indices[indx].wsect >> (32 - 9);
+      c64_ret.low = head.indices[indx]->wsect * 512 & 0xffffffff;
+      c64_ret.high = head.indices[indx]->wsect >> (32 - 9);
       return (u_char *) & c64_ret;
+    case DISKIO_READS_RATE:
+      long_ret = head.indices[indx]->rio_rate & 0xffffffff;
+      return (u_char *) & long_ret;
+    case DISKIO_WRITES_RATE:
+      long_ret = head.indices[indx]->wio_rate & 0xffffffff;
+      return (u_char *) & long_ret;
+    case DISKIO_NREAD_RATE:
+      long_ret = head.indices[indx]->rsect_rate & 0xffffffff;
+      return (u_char *) & long_ret;
+    case DISKIO_NWRITTEN_RATE:
+      long_ret = head.indices[indx]->wsect_rate & 0xffffffff;
+      return (u_char *) & long_ret;
     default:
 	snmp_log(LOG_ERR, "don't know how to handle %d request\n", vp->magic);
   }
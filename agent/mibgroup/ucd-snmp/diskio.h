@@ -34,5 +34,9 @@ config_add_mib(UCD-DISKIO-MIB)
 #define DISKIO_LA15             11
 #define DISKIO_NREADX           12
 #define DISKIO_NWRITTENX        13
+#define DISKIO_READS_RATE       14
+#define DISKIO_WRITES_RATE      15
+#define DISKIO_NREAD_RATE       16
+#define DISKIO_NWRITTEN_RATE    17
 
 #endif                          /* _MIBGROUP_DISKIO_H */
@@ -59,16 +59,19 @@ struct variable2 extensible_passthru_variables[] = {
 void
 init_pass(void)
 {
-    snmpd_register_config_handler("pass", pass_parse_config,
-                                  pass_free_config, "miboid command");
+    snmpd_register_config_handler_incremental("pass", pass_parse_config,
+                                              pass_remove_config,
+                                              pass_free_config,
+                                              "miboid command");
 }
 
-void
-pass_parse_config(const char *token, char *cptr)
+/*
+ * fills in the priority, OID and command of a pass line
+ */
+static int
+pass_parse_line(char *cptr, struct extensible *pass)
 {
-    struct extensible **ppass = &passthrus, **etmp, *ptmp;
     char           *tcptr, *endopt;
-    int             i;
     unsigned long   priority;
 
     /*
@@ -84,19 +87,19 @@ pass_parse_config(const char *token, char *cptr)
 	cptr = skip_white(cptr);
 	if (! isdigit((unsigned char)(*cptr))) {
 	  config_perror("priority must be an integer");
-	  return;
+	  return -1;
 	}
 	priority = strtol((const char*) cptr, &endopt, 0);
 	if ((priority == LONG_MIN) || (priority == LONG_MAX)) {
 	  config_perror("priority under/overflow");
-	  return;
+	  return -1;
 	}
 	cptr = endopt;
 	cptr = skip_white(cptr);
 	break;
       default:
 	config_perror("unknown option for pass directive");
-	return;
+	return -1;
       }
     }
 
@@ -107,19 +110,13 @@ pass_parse_config(const char *token, char *cptr)
         cptr++;
     if (!isdigit((unsigned char)(*cptr))) {
         config_perror("second token is not a OID");
-        return;
+        return -1;
     }
-    numpassthrus++;
 
-    while (*ppass != NULL)
-        ppass = &((*ppass)->next);
-    (*ppass) = (struct extensible *) malloc(sizeof(struct extensible));
-    if (*ppass == NULL)
-        return;
-    (*ppass)->type = PASSTHRU;
-    (*ppass)->mibpriority = priority;
+    pass->type = PASSTHRU;
+    pass->mibpriority = priority;
 
-    (*ppass)->miblen = parse_miboid(cptr, (*ppass)->miboid);
+    pass->miblen = parse_miboid(cptr, pass->miboid);
     while (isdigit((unsigned char)(*cptr)) || *cptr == '.')
         cptr++;
     /*
@@ -128,14 +125,36 @@ pass_parse_config(const char *token, char *cptr)
     cptr = skip_white(cptr);
     if (cptr == NULL) {
         config_perror("No command specified on pass line");
-        (*ppass)->command[0] = 0;
+        pass->command[0] = 0;
     } else {
         for (tcptr = cptr; *tcptr != 0 && *tcptr != '#' && *tcptr != ';';
              tcptr++);
-        sprintf((*ppass)->command, "%.*s", (int) (tcptr - cptr), cptr);
+        sprintf(pass->command, "%.*s", (int) (tcptr - cptr), cptr);
+    }
+    strlcpy(pass->name, pass->command, sizeof(pass->name));
+    pass->next = NULL;
+    return 0;
+}
+
+void
+pass_parse_config(const char *token, char *cptr)
+{
+    struct extensible **ppass = &passthrus, **etmp, *ptmp;
+    struct extensible *newpass;
+    int             i;
+
+    newpass = (struct extensible *) malloc(sizeof(struct extensible));
+    if (newpass == NULL)
+        return;
+    if (pass_parse_line(cptr, newpass) < 0) {
+        free(newpass);
+        return;
     }
-    strlcpy((*ppass)->name, (*ppass)->command, sizeof((*ppass)->name));
-    (*ppass)->next = NULL;
+    numpassthrus++;
+
+    while (*ppass != NULL)
+        ppass = &((*ppass)->next);
+    (*ppass) = newpass;
 
     register_mib_priority("pass",
                  (struct variable *) extensible_passthru_variables,
@@ -168,6 +187,35 @@ pass_parse_config(const char *token, char *cptr)
     }
 }
 
+/*
+ * called when a pass line has been dropped from the configuration,
+ * leaving the other passthrus registered
+ */
+void
+pass_remove_config(const char *token, char *cptr)
+{
+    struct extensible **ppass, *etmp;
+    struct extensible oldpass;
+
+    if (pass_parse_line(cptr, &oldpass) < 0)
+        return;
+
+    for (ppass = &passthrus; (etmp = *ppass) != NULL;
+         ppass = &etmp->next) {
+        if (etmp->mibpriority == oldpass.mibpriority &&
+            !snmp_oid_compare(etmp->miboid, etmp->miblen,
+                              oldpass.miboid, oldpass.miblen) &&
+            !strcmp(etmp->command, oldpass.command)) {
+            *ppass = etmp->next;
+            unregister_mib_priority(etmp->miboid, etmp->miblen,
+                                    etmp->mibpriority);
+            free(etmp);
+            numpassthrus--;
+            return;
+        }
+    }
+}
+
 void
 pass_free_config(void)
 {
@@ -20,6 +20,7 @@ int             pass_compare(const void *, const void *);
  */
 void            pass_free_config(void);
 void            pass_parse_config(const char *, char *);
+void            pass_remove_config(const char *, char *);
 
 #include "mibdefs.h"
 
@@ -66,6 +66,12 @@ static struct myproc *get_proc_instance(struct myproc *, oid);
 struct myproc  *procwatch = NULL;
 static struct extensible fixproc;
 int             numprocs = 0;
+#ifdef USING_HOST_DATA_ACCESS_SWRUN_MODULE
+/*
+ * process table generation the counts in procwatch were taken from
+ */
+static u_int    proc_count_generation = 0;
+#endif
 
 void
 init_proc(void)
@@ -134,14 +140,17 @@ proc_free_config(void)
         ptmp2 = ptmp;
         ptmp = ptmp->next;
 #if HAVE_PCRE_H
-        if (ptmp->regexp) {
-            free(ptmp->regexp);
+        if (ptmp2->regexp) {
+            free(ptmp2->regexp);
         }
 #endif
         free(ptmp2);
     }
     procwatch = NULL;
     numprocs = 0;
+#ifdef USING_HOST_DATA_ACCESS_SWRUN_MODULE
+    proc_count_generation = 0;
+#endif
 }
 
 /*
@@ -250,6 +259,9 @@ proc_parse_config(const char *token, char *cptr)
 #endif
     DEBUGMSGTL(("ucd-snmp/proc", "Read:  %s (%d) (%d)\n",
                 (*procp)->name, (*procp)->max, (*procp)->min));
+#ifdef USING_HOST_DATA_ACCESS_SWRUN_MODULE
+    proc_count_generation = 0;
+#endif
 }
 
 /*
@@ -387,18 +399,81 @@ get_proc_instance(struct myproc *proc, oid inst)
     return (proc);
 }
 
+#ifdef USING_HOST_DATA_ACCESS_SWRUN_MODULE
+/*
+ * count the processes of every proc entry in a single pass over the
+ * shared process table.
+ */
+static void
+count_all_myprocs(netsnmp_container *snapshot)
+{
+    netsnmp_swrun_entry *entry;
+    netsnmp_iterator  *it;
+    struct myproc     *proc;
+#if HAVE_PCRE_H
+    char fullCommand[64 + 128 + 128 + 3];
+    int  found_ndx[30];
+    int  len;
+#endif
+
+    for (proc = procwatch; proc != NULL; proc = proc->next)
+        proc->count = 0;
+    if (snapshot == NULL)
+        return;
+
+    it = CONTAINER_ITERATOR( snapshot );
+    if (it == NULL)
+        return;
+    while ((entry = (netsnmp_swrun_entry*)ITERATOR_NEXT( it )) != NULL) {
+#if HAVE_PCRE_H
+        len = -1;
+#endif
+        for (proc = procwatch; proc != NULL; proc = proc->next) {
+#if HAVE_PCRE_H
+            if (proc->regexp != NULL) {
+                /* need to assemble full command back so regexps can get full picture */
+                if (len < 0)
+                    len = sprintf(fullCommand, "%s %s", entry->hrSWRunPath,
+                                  entry->hrSWRunParameters);
+                if (pcre_exec((pcre *) proc->regexp, NULL, fullCommand, len,
+                              0, 0, found_ndx, 30) > 0)
+                    proc->count++;
+                continue;
+            }
+#endif
+            if (strcmp(entry->hrSWRunName, proc->name) == 0)
+                proc->count++;
+        }
+    }
+    ITERATOR_RELEASE( it );
+}
+#endif
+
 int
 sh_count_myprocs(struct myproc *proc)
 {
+#ifdef USING_HOST_DATA_ACCESS_SWRUN_MODULE
+    netsnmp_container *snapshot;
+    u_int           generation;
+#endif
+
     if (proc == NULL)
         return 0;
 
-#if defined(USING_HOST_DATA_ACCESS_SWRUN_MODULE) && defined(HAVE_PCRE_H)
-    if (proc->regexp != NULL)
-      return sh_count_procs_by_regex(proc->name, proc->regexp);
-#endif
-
+#ifdef USING_HOST_DATA_ACCESS_SWRUN_MODULE
+    /*
+     * every column of every row needs a count: take them all at once,
+     * and keep them until the process table is reloaded.
+     */
+    snapshot = netsnmp_swrun_snapshot(&generation);
+    if (generation != proc_count_generation) {
+        count_all_myprocs(snapshot);
+        proc_count_generation = generation;
+    }
+    return proc->count;
+#else
     return sh_count_procs(proc->name);
+#endif
 }
 
 #ifdef USING_HOST_DATA_ACCESS_SWRUN_MODULE
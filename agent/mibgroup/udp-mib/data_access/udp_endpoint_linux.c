@@ -16,14 +16,21 @@
 
 #include "udp-mib/udpEndpointTable/udpEndpointTable_constants.h"
 #include "mibgroup/util_funcs/get_pid_from_inode.h"
+#include "mibgroup/util_funcs/inet_diag.h"
 #include "udp_endpoint_private.h"
 
 #include <fcntl.h>
+#ifdef HAVE_LINUX_NETLINK_H
+#include <linux/types.h>
+#include <linux/inet_diag.h>
+#endif
 
 netsnmp_feature_require(text_utils)
+netsnmp_feature_require(udp_endpoint_entry_create)
 netsnmp_feature_child_of(udp_endpoint_all, libnetsnmpmibs)
 netsnmp_feature_child_of(udp_endpoint_writable, udp_endpoint_all)
 
+static int _load_diag(netsnmp_container *container, int family);
 static int _load4(netsnmp_container *container, u_int flags);
 #if defined (NETSNMP_ENABLE_IPV6)
 static int _load6(netsnmp_container *container, u_int flags);
@@ -92,24 +99,36 @@ netsnmp_arch_udp_endpoint_container_load(netsnmp_container *container,
     int rc = 0;
 
     /* Setup the pid_from_inode table, and fill it.*/
+    netsnmp_get_pid_from_inode_lock();
     netsnmp_get_pid_from_inode_init();
 
-    rc = _load4(container, load_flags);
+    /*
+     * try sock_diag first, and fall back to parsing /proc/net/udp if
+     * the kernel doesn't support it (-2).
+     */
+    rc = _load_diag(container, AF_INET);
+    if (-2 == rc)
+        rc = _load4(container, load_flags);
     if(rc < 0) {
         u_int flags = NETSNMP_ACCESS_UDP_ENDPOINT_FREE_KEEP_CONTAINER;
+        netsnmp_get_pid_from_inode_unlock();
         netsnmp_access_udp_endpoint_container_free(container, flags);
         return rc;
     }
 
 #if defined (NETSNMP_ENABLE_IPV6)
-    rc = _load6(container, load_flags);
+    rc = _load_diag(container, AF_INET6);
+    if (-2 == rc)
+        rc = _load6(container, load_flags);
     if(rc < 0) {
         u_int flags = NETSNMP_ACCESS_UDP_ENDPOINT_FREE_KEEP_CONTAINER;
+        netsnmp_get_pid_from_inode_unlock();
         netsnmp_access_udp_endpoint_container_free(container, flags);
         return rc;
     }
 #endif
 
+    netsnmp_get_pid_from_inode_unlock();
     return 0;
 }
 
@@ -246,6 +265,69 @@ _process_line_udp_ep(netsnmp_line_info *line_info, void *mem,
     return PMLP_RC_MEMORY_USED;
 }
 
+#ifdef HAVE_LINUX_NETLINK_H
+/*
+ * add one socket from a sock_diag dump
+ */
+static int
+_diag_entry(const struct inet_diag_msg *msg, void *context)
+{
+    netsnmp_container          *container = (netsnmp_container *) context;
+    netsnmp_udp_endpoint_entry *ep;
+    size_t                      addr_len;
+
+    addr_len = (AF_INET == msg->idiag_family) ? 4 : 16;
+
+    ep = netsnmp_access_udp_endpoint_entry_create();
+    if (NULL == ep)
+        return -1;
+
+    memcpy(ep->loc_addr, msg->id.idiag_src, addr_len);
+    ep->loc_addr_len = addr_len;
+    ep->loc_port = ntohs(msg->id.idiag_sport);
+    memcpy(ep->rmt_addr, msg->id.idiag_dst, addr_len);
+    ep->rmt_addr_len = addr_len;
+    ep->rmt_port = ntohs(msg->id.idiag_dport);
+    ep->state = msg->idiag_state;
+
+    /*
+     * Use inode as instance value.
+     */
+    ep->instance = msg->idiag_inode;
+    ep->pid = netsnmp_get_pid_from_inode(msg->idiag_inode);
+
+    ep->index = CONTAINER_SIZE(container);
+    if (CONTAINER_INSERT(container, ep) != 0) {
+        netsnmp_access_udp_endpoint_entry_free(ep);
+        return -1;
+    }
+
+    return 0;
+}
+#endif /* HAVE_LINUX_NETLINK_H */
+
+/**
+ * load the endpoints of one address family through a sock_diag
+ * netlink socket, which sends them in binary batches.
+ *
+ * @retval  0 no errors
+ * @retval -2 sock_diag not supported, use procfs
+ * @retval !0 errors
+ */
+static int
+_load_diag(netsnmp_container *container, int family)
+{
+#ifdef HAVE_LINUX_NETLINK_H
+    if (NULL == container)
+        return -1;
+
+    return netsnmp_inet_diag_dump(family, IPPROTO_UDP, ~0U,
+                                  _diag_entry, container);
+#else
+    return -2;
+#endif
+}
+
 /**
  *
  * @retval  0 no errors
@@ -21,6 +21,8 @@
 
 #include "udpEndpointTable_data_access.h"
 
+netsnmp_feature_require(container_sync)
+
 /** @ingroup interface 
  * @addtogroup data_access data_access: Routines to access data
  *
@@ -133,6 +135,13 @@ udpEndpointTable_container_init(netsnmp_container **container_ptr_ptr,
      * cache->enabled to 0.
      */
     cache->timeout = UDPENDPOINTTABLE_CACHE_TIMEOUT;    /* seconds */
+
+    /*
+     * the container is updated in place on reload (see
+     * udpEndpointTable_container_load), so keep it around.
+     */
+    cache->flags |= NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD |
+        NETSNMP_CACHE_DONT_FREE_EXPIRED | NETSNMP_CACHE_DONT_AUTO_RELEASE;
 }                               /* udpEndpointTable_container_init */
 
 /**
@@ -164,13 +173,126 @@ udpEndpointTable_container_shutdown(netsnmp_container *container_ptr)
 
 }                               /* udpEndpointTable_container_shutdown */
 
+static u_long
+_address_type_from_len(int addrlen) {
+	switch (addrlen) {
+	case 4: 
+		return INETADDRESSTYPE_IPV4;
+	case 16: 
+		return INETADDRESSTYPE_IPV6;
+	case 0: 
+		return INETADDRESSTYPE_UNKNOWN;
+	default:
+		/* To get same behavior as before */
+		return INETADDRESSTYPE_IPV4;
+	}
+}
+
+/*
+ * incremental update callbacks
+ */
+static size_t
+_endpoint_key(const void *fresh, oid *buf, size_t max_len, void *context)
+{
+    const netsnmp_udp_endpoint_entry *ep =
+        (const netsnmp_udp_endpoint_entry *) fresh;
+    udpEndpointTable_mib_index tbl_idx;
+    netsnmp_index   oid_idx;
+    /* the index setup takes non-const addresses */
+    char            loc_addr[NETSNMP_ACCESS_IPADDRESS_BUF_SIZE];
+    char            rmt_addr[NETSNMP_ACCESS_IPADDRESS_BUF_SIZE];
+
+    memcpy(loc_addr, ep->loc_addr, sizeof(loc_addr));
+    memcpy(rmt_addr, ep->rmt_addr, sizeof(rmt_addr));
+    memset(&tbl_idx, 0x0, sizeof(tbl_idx));
+    if (MFD_SUCCESS !=
+        udpEndpointTable_indexes_set_tbl_idx(&tbl_idx,
+                                             _address_type_from_len(ep->loc_addr_len),
+                                             loc_addr,
+                                             ep->loc_addr_len,
+                                             ep->loc_port,
+                                             _address_type_from_len(ep->rmt_addr_len),
+                                             rmt_addr,
+                                             ep->rmt_addr_len,
+                                             ep->rmt_port,
+                                             ep->instance,
+                                             ep->pid))
+        return 0;
+
+    oid_idx.oids = buf;
+    oid_idx.len = max_len;
+    if (0 != udpEndpointTable_index_to_oid(&oid_idx, &tbl_idx))
+        return 0;
+
+    return oid_idx.len;
+}
+
+static int
+_update_endpoint(udpEndpointTable_rowreq_ctx *rowreq_ctx,
+                 netsnmp_udp_endpoint_entry *ep, void *context)
+{
+    /** everything else is part of the index */
+    rowreq_ctx->tbl_idx.udpEndpointProcess = ep->pid;
+    return 0;
+}
+
+static void *
+_create_endpoint(netsnmp_udp_endpoint_entry *ep, void *context)
+{
+    udpEndpointTable_rowreq_ctx *rowreq_ctx;
+
+    rowreq_ctx = udpEndpointTable_allocate_rowreq_ctx();
+    if (NULL == rowreq_ctx) {
+        snmp_log(LOG_ERR, "memory allocation failed\n");
+        return NULL;
+    }
+    if (MFD_SUCCESS !=
+        udpEndpointTable_indexes_set(rowreq_ctx,
+                                     _address_type_from_len(ep->loc_addr_len),
+                                     (char *) ep->loc_addr,
+                                     ep->loc_addr_len,
+                                     ep->loc_port,
+                                     _address_type_from_len(ep->rmt_addr_len),
+                                     (char *) ep->rmt_addr,
+                                     ep->rmt_addr_len,
+                                     ep->rmt_port,
+                                     ep->instance,
+                                     ep->pid)) {
+        snmp_log(LOG_ERR,
+                 "error setting index while loading "
+                 "udpEndpointTable data.\n");
+        udpEndpointTable_release_rowreq_ctx(rowreq_ctx);
+        return NULL;
+    }
+    return rowreq_ctx;
+}
+
+static void
+_release_endpoint(udpEndpointTable_rowreq_ctx *rowreq_ctx, void *context)
+{
+    udpEndpointTable_release_rowreq_ctx(rowreq_ctx);
+}
+
+/*
+ * the endpoint entries are never claimed; they go away with their
+ * container.
+ */
+static const netsnmp_container_sync_ops _endpoint_sync_ops = {
+    _endpoint_key,
+    (int (*)(void *, void *, void *)) _update_endpoint,
+    (void *(*)(void *, void *)) _create_endpoint,
+    (void (*)(void *, void *)) _release_endpoint,
+    NULL
+};
+
 /**
  * load initial data
  *
  * TODO:350:M: Implement udpEndpointTable data load
  * This function will also be called by the cache helper to load
- * the container again (after the container free function has been
- * called to free the previous contents).
+ * the container again. The container isn't freed first: rows for
+ * endpoints which still exist are kept, rows for closed endpoints are
+ * removed and new endpoints are added.
  *
  * @param container container to which items should be inserted
  *
@@ -197,21 +319,6 @@ udpEndpointTable_container_shutdown(netsnmp_container *container_ptr)
  *  data here.
  *
  */
-static u_long
-_address_type_from_len(int addrlen) {
-	switch (addrlen) {
-	case 4: 
-		return INETADDRESSTYPE_IPV4;
-	case 16: 
-		return INETADDRESSTYPE_IPV6;
-	case 0: 
-		return INETADDRESSTYPE_UNKNOWN;
-	default:
-		/* To get same behavior as before */
-		return INETADDRESSTYPE_IPV4;
-	}
-}
-
 int
 udpEndpointTable_container_load(netsnmp_container *container)
 {
@@ -220,12 +327,6 @@ udpEndpointTable_container_load(netsnmp_container *container)
     netsnmp_iterator *ep_it;
     netsnmp_udp_endpoint_entry *ep;
 
-    /*
-     * temporary storage for index values
-     */
-    u_long	udpEndpointLocalAddressType;
-    u_long	udpEndpointRemoteAddressType;
-
     DEBUGMSGTL(("verbose:udpEndpointTable:udpEndpointTable_container_load",
                 "called\n"));
 
@@ -238,59 +339,35 @@ udpEndpointTable_container_load(netsnmp_container *container)
     ep_c = netsnmp_access_udp_endpoint_container_load(NULL, 0);
     if (NULL == ep_c)
         return MFD_RESOURCE_UNAVAILABLE;
-    ep_it = CONTAINER_ITERATOR(ep_c);
-    if (NULL == ep_it) {
-        netsnmp_access_udp_endpoint_container_free(ep_c, 0);
-        return MFD_RESOURCE_UNAVAILABLE;
-    }
-    for (ep = (netsnmp_udp_endpoint_entry*)ITERATOR_FIRST(ep_it); ep;
-         ep = (netsnmp_udp_endpoint_entry*)ITERATOR_NEXT (ep_it)) {
-
-        /*
-         * TODO:352:M: |   |-> set indexes in new udpEndpointTable rowreq context.
-         */
-        rowreq_ctx = udpEndpointTable_allocate_rowreq_ctx();
-        if (NULL == rowreq_ctx) {
-            snmp_log(LOG_ERR, "memory allocation failed\n");
+
+    /*
+     * merge the endpoints into the rows we already have, or start
+     * over if that isn't possible.
+     */
+    if (netsnmp_container_sync(container, ep_c, &_endpoint_sync_ops,
+                               NULL) != 0) {
+        CONTAINER_CLEAR(container, (netsnmp_container_obj_func *)
+                        _release_endpoint, NULL);
+        ep_it = CONTAINER_ITERATOR(ep_c);
+        if (NULL == ep_it) {
+            netsnmp_access_udp_endpoint_container_free(ep_c, 0);
             return MFD_RESOURCE_UNAVAILABLE;
         }
-        udpEndpointLocalAddressType = _address_type_from_len(ep->loc_addr_len);
-	udpEndpointRemoteAddressType = _address_type_from_len(ep->rmt_addr_len);
-        if (MFD_SUCCESS !=
-            udpEndpointTable_indexes_set(rowreq_ctx,
-                                         udpEndpointLocalAddressType,
-                                         (char *) ep->loc_addr,
-                                         ep->loc_addr_len,
-                                         ep->loc_port,
-                                         udpEndpointRemoteAddressType,
-                                         (char *) ep->rmt_addr,
-                                         ep->rmt_addr_len,
-                                         ep->rmt_port,
-                                         ep->instance,
-                                         ep->pid)) {
-            snmp_log(LOG_ERR,
-                     "error setting index while loading "
-                     "udpEndpointTable data.\n");
-            udpEndpointTable_release_rowreq_ctx(rowreq_ctx);
-            continue;
+        for (ep = (netsnmp_udp_endpoint_entry*)ITERATOR_FIRST(ep_it); ep;
+             ep = (netsnmp_udp_endpoint_entry*)ITERATOR_NEXT (ep_it)) {
+            rowreq_ctx = _create_endpoint(ep, NULL);
+            if (NULL == rowreq_ctx)
+                continue;
+
+            /*
+             * insert into table container
+             */
+            if (CONTAINER_INSERT(container, rowreq_ctx))
+                udpEndpointTable_release_rowreq_ctx(rowreq_ctx);
         }
-
-        /*
-         * TODO:352:r: |   |-> populate udpEndpointTable data context.
-         * Populate data context here. (optionally, delay until row prep)
-         */
-        /*
-         * non-TRANSIENT data: no need to copy. set pointer to data 
-         */
-
-        /*
-         * insert into table container
-         */
-        CONTAINER_INSERT(container, rowreq_ctx);
+        ITERATOR_RELEASE(ep_it);
     }
 
-    ITERATOR_RELEASE(ep_it);
-
     netsnmp_access_udp_endpoint_container_free(ep_c, 0);
 
 
@@ -17,6 +17,9 @@
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef NETSNMP_REENTRANT
+#include <pthread.h>
+#endif
 
 # define PROC_PATH          "/proc"
 # define SOCKET_TYPE_1      "socket:["
@@ -34,6 +37,10 @@ typedef struct {
 #define INODE_PID_TABLE_SIZE (INODE_PID_TABLE_LENGTH * sizeof (inode_pid_ent_t))
 static inode_pid_ent_t  inode_pid_table[INODE_PID_TABLE_LENGTH];
 
+#ifdef NETSNMP_REENTRANT
+static pthread_mutex_t  inode_pid_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 static uint32_t
 _hash(uint64_t key)
 {
@@ -99,6 +106,28 @@ static pid_t _get(ino64_t inode)
     return 0;
 }
 
+/*
+ * The table is shared by all loaders, and a thread safe cache (see
+ * NETSNMP_CACHE_LOAD_THREAD_SAFE) may fill it from a worker thread
+ * while the main loop loads another table. Hold the lock from
+ * netsnmp_get_pid_from_inode_init() until the last lookup.
+ */
+void
+netsnmp_get_pid_from_inode_lock(void)
+{
+#ifdef NETSNMP_REENTRANT
+    pthread_mutex_lock(&inode_pid_lock);
+#endif
+}
+
+void
+netsnmp_get_pid_from_inode_unlock(void)
+{
+#ifdef NETSNMP_REENTRANT
+    pthread_mutex_unlock(&inode_pid_lock);
+#endif
+}
+
 void
 netsnmp_get_pid_from_inode_init(void)
 {
@@ -28,6 +28,8 @@ config_error(get_pid_from_inode is only suppored on linux)
 
 #include <sys/types.h>
 
+void netsnmp_get_pid_from_inode_lock(void);
+void netsnmp_get_pid_from_inode_unlock(void);
 void netsnmp_get_pid_from_inode_init(void);
 pid_t netsnmp_get_pid_from_inode(ino64_t);
 
@@ -0,0 +1,172 @@
+#include <net-snmp/net-snmp-config.h>
+
+#include "inet_diag.h"
+
+#include <net-snmp/output_api.h>
+
+#include <errno.h>
+#if HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#ifdef HAVE_LINUX_NETLINK_H
+#include <linux/types.h>
+#include <linux/netlink.h>
+#include <linux/inet_diag.h>
+#include <linux/sock_diag.h>
+
+#ifndef NETLINK_SOCK_DIAG
+#define NETLINK_SOCK_DIAG NETLINK_INET_DIAG
+#endif
+
+/*
+ * big enough for the kernel to put a few hundred sockets in every
+ * datagram of the dump.
+ */
+#define INET_DIAG_BUF_SIZE 32768
+
+/*
+ * every dump has a socket of its own, so the replies can't be mixed up
+ * with those of another dump, even one running concurrently in another
+ * thread. A constant sequence number is enough, and keeps the dumps
+ * free of shared state.
+ */
+#define INET_DIAG_SEQ 1
+
+static int
+_inet_diag_dump(int family, int protocol, unsigned int states,
+                netsnmp_inet_diag_callback *callback, void *context,
+                int quiet)
+{
+    struct {
+        struct nlmsghdr          nlh;
+        struct inet_diag_req_v2  req;
+    } request;
+    struct sockaddr_nl sa;
+    long        buf[INET_DIAG_BUF_SIZE / sizeof(long)];
+    int         fd, len, rc = 0, done = 0, count = 0;
+
+    fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_SOCK_DIAG);
+    if (fd < 0) {
+        if (!quiet)
+            DEBUGMSGTL(("inet_diag", "socket: %s\n", strerror(errno)));
+        return -2;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+
+    memset(&request, 0, sizeof(request));
+    request.nlh.nlmsg_len = sizeof(request);
+    request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.nlh.nlmsg_seq = INET_DIAG_SEQ;
+    request.req.sdiag_family = family;
+    request.req.sdiag_protocol = protocol;
+    request.req.idiag_states = states;
+
+    if (sendto(fd, &request, sizeof(request), 0, (struct sockaddr *) &sa,
+               sizeof(sa)) < 0) {
+        if (!quiet)
+            DEBUGMSGTL(("inet_diag", "sendto: %s\n", strerror(errno)));
+        close(fd);
+        return -2;
+    }
+
+    while (!done) {
+        struct nlmsghdr *nlh = (struct nlmsghdr *) buf;
+
+        len = recv(fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (EINTR == errno)
+                continue;
+            if (!quiet)
+                snmp_log_perror("netsnmp_inet_diag_dump: recv");
+            rc = count ? -1 : -2;
+            break;
+        }
+        if (0 == len)
+            break;
+
+        for (; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_seq != INET_DIAG_SEQ)
+                continue;
+            if (NLMSG_DONE == nlh->nlmsg_type) {
+                done = 1;
+                break;
+            }
+            if (NLMSG_ERROR == nlh->nlmsg_type) {
+                struct nlmsgerr *err = (struct nlmsgerr *) NLMSG_DATA(nlh);
+
+                /*
+                 * old kernels, or a missing udp_diag module
+                 */
+                if (!quiet)
+                    DEBUGMSGTL(("inet_diag", "dump of %d/%d failed: %s\n",
+                                family, protocol, strerror(-err->error)));
+                rc = count ? -1 : -2;
+                done = 1;
+                break;
+            }
+            if (SOCK_DIAG_BY_FAMILY != nlh->nlmsg_type ||
+                nlh->nlmsg_len < NLMSG_LENGTH(sizeof(struct inet_diag_msg)))
+                continue;
+
+            ++count;
+            rc = (*callback)((struct inet_diag_msg *) NLMSG_DATA(nlh),
+                             context);
+            if (rc < 0) {
+                done = 1;
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    if (!quiet)
+        DEBUGMSGTL(("inet_diag", "%d sockets of %d/%d (rc %d)\n", count,
+                    family, protocol, rc));
+
+    return rc < 0 ? rc : 0;
+}
+
+int
+netsnmp_inet_diag_dump(int family, int protocol, unsigned int states,
+                       netsnmp_inet_diag_callback *callback, void *context)
+{
+    return _inet_diag_dump(family, protocol, states, callback, context, 0);
+}
+
+int
+netsnmp_inet_diag_dump_quiet(int family, int protocol, unsigned int states,
+                             netsnmp_inet_diag_callback *callback,
+                             void *context)
+{
+    return _inet_diag_dump(family, protocol, states, callback, context, 1);
+}
+
+#else /* HAVE_LINUX_NETLINK_H */
+
+int
+netsnmp_inet_diag_dump(int family, int protocol, unsigned int states,
+                       netsnmp_inet_diag_callback *callback, void *context)
+{
+    return -2;
+}
+
+int
+netsnmp_inet_diag_dump_quiet(int family, int protocol, unsigned int states,
+                             netsnmp_inet_diag_callback *callback,
+                             void *context)
+{
+    return -2;
+}
+
+#endif /* HAVE_LINUX_NETLINK_H */
@@ -0,0 +1,43 @@
+/*
+ * util_funcs/inet_diag.h:  utility function to dump the kernel's socket
+ * tables through a NETLINK_SOCK_DIAG socket on linux.
+ */
+#ifndef NETSNMP_MIBGROUP_UTIL_FUNCS_INET_DIAG_H
+#define NETSNMP_MIBGROUP_UTIL_FUNCS_INET_DIAG_H
+
+#ifndef linux
+config_error(inet_diag is only suppored on linux)
+#endif
+
+struct inet_diag_msg;
+
+/*
+ * called once for every socket in the dump. A negative return value
+ * stops the dump, and is passed back to the caller.
+ */
+typedef int (netsnmp_inet_diag_callback)(const struct inet_diag_msg *msg,
+                                         void *context);
+
+/*
+ * dump all sockets of an address family (AF_INET or AF_INET6) and
+ * protocol (IPPROTO_TCP or IPPROTO_UDP) whose state is set in the
+ * states bitmask (1 << TCP_xxx). The kernel does the state filtering.
+ *
+ * @retval  0 success
+ * @retval -2 sock_diag not available, nothing was passed to the callback
+ * @retval <0 other errors, or the callback's return value
+ */
+int netsnmp_inet_diag_dump(int family, int protocol, unsigned int states,
+                           netsnmp_inet_diag_callback *callback,
+                           void *context);
+
+/*
+ * the same without any logging, so it can run outside the agent's main
+ * thread: nothing but the callback and the dump's own socket is touched.
+ */
+int netsnmp_inet_diag_dump_quiet(int family, int protocol,
+                                 unsigned int states,
+                                 netsnmp_inet_diag_callback *callback,
+                                 void *context);
+
+#endif /* NETSNMP_MIBGROUP_UTIL_FUNCS_INET_DIAG_H */
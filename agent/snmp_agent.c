@@ -47,6 +47,7 @@ SOFTWARE.
 #include <net-snmp/net-snmp-features.h>
 
 #include <sys/types.h>
+#include <ctype.h>
 #ifdef HAVE_LIMITS_H
 #include <limits.h>
 #endif
@@ -127,6 +128,8 @@ netsnmp_feature_child_of(set_all_requests_error, netsnmp_unused)
 netsnmp_feature_child_of(addrcache_age, netsnmp_unused)
 netsnmp_feature_child_of(delete_subtree_cache, netsnmp_unused)
 
+netsnmp_feature_require(oid_is_subtree)
+
 
 NETSNMP_INLINE void
 netsnmp_agent_add_list_data(netsnmp_agent_request_info *ari,
@@ -193,21 +196,35 @@ netsnmp_free_agent_request_info(netsnmp_agent_request_info *ari)
 oid      version_sysoid[] = { NETSNMP_SYSTEM_MIB };
 int      version_sysoid_len = OID_LENGTH(version_sysoid);
 
-#define SNMP_ADDRCACHE_SIZE 10
+#define SNMP_ADDRCACHE_SIZE 4096
+#define SNMP_ADDRCACHE_BUCKETS 1024 /* power of two */
 #define SNMP_ADDRCACHE_MAXAGE 300 /* in seconds */
+#define SNMP_ADDRCACHE_EVICT_TRIES 8
 
-enum {
-    SNMP_ADDRCACHE_UNUSED = 0,
-    SNMP_ADDRCACHE_USED = 1
+/*
+ * token bucket, for admission control (see rateLimit below)
+ */
+struct rate_bucket {
+    double         tokens;
+    struct timeval lastFillM;
 };
 
+struct rate_limit;
+
 struct addrCache {
     char           *addr;
-    int            status;
+    u_int          hash;
     struct timeval lastHitM;
+    struct rate_limit *limit;       /* rule for this source, if any */
+    u_int          limit_generation;
+    struct rate_bucket bucket;
+    struct addrCache *next;
+    struct addrCache *lruPrev, *lruNext; /* most recently used first */
 };
 
-static struct addrCache addrCache[SNMP_ADDRCACHE_SIZE];
+static struct addrCache *addrCache[SNMP_ADDRCACHE_BUCKETS];
+static struct addrCache *addrCacheMRU, *addrCacheLRU;
+static int      addrCacheCount;
 int             log_addresses = 0;
 
 
@@ -224,6 +241,7 @@ static netsnmp_agent_session *agent_session_list = NULL;
 netsnmp_agent_session *netsnmp_processing_set = NULL;
 netsnmp_agent_session *agent_delegated_list = NULL;
 netsnmp_agent_session *netsnmp_agent_queued_list = NULL;
+static netsnmp_agent_session *agent_coalesced_list = NULL;
 
 
 int             netsnmp_agent_check_packet(netsnmp_session *,
@@ -244,6 +262,9 @@ int             handle_set_loop(netsnmp_agent_session *asp);
 int             netsnmp_check_queued_chain_for(netsnmp_agent_session *asp);
 int             netsnmp_add_queued(netsnmp_agent_session *asp);
 int             netsnmp_remove_from_delegated(netsnmp_agent_session *asp);
+static void     _coalesce_respond(netsnmp_agent_session *asp);
+static void     _coalesce_forget(netsnmp_agent_session *asp);
+static void     _coalesce_redispatch(void);
 
 
 static int      current_globalid = 0;
@@ -715,50 +736,150 @@ agent_check_and_process(int block)
 void
 netsnmp_addrcache_initialise(void)
 {
-    int             i = 0;
+    memset(addrCache, 0, sizeof(addrCache));
+    addrCacheMRU = addrCacheLRU = NULL;
+    addrCacheCount = 0;
+}
 
-    for (i = 0; i < SNMP_ADDRCACHE_SIZE; i++) {
-        addrCache[i].addr = NULL;
-        addrCache[i].status = SNMP_ADDRCACHE_UNUSED;
-    }
+static void
+_addrcache_free_entry(struct addrCache *ac)
+{
+    free(ac->addr);
+    free(ac);
+    addrCacheCount--;
 }
 
 void netsnmp_addrcache_destroy(void)
 {
-    int             i = 0;
+    struct addrCache *ac;
+    int             i;
+
+    for (i = 0; i < SNMP_ADDRCACHE_BUCKETS; i++) {
+        while ((ac = addrCache[i]) != NULL) {
+            addrCache[i] = ac->next;
+            _addrcache_free_entry(ac);
+        }
+    }
+    addrCacheMRU = addrCacheLRU = NULL;
+}
+
+static u_int
+_addrcache_hash(const char *addr)
+{
+    u_int           hash = 5381;
+
+    while (*addr)
+        hash = hash * 33 + (u_char) *addr++;
+    return hash;
+}
+
+static void
+_addrcache_lru_unlink(struct addrCache *ac)
+{
+    if (ac->lruPrev)
+        ac->lruPrev->lruNext = ac->lruNext;
+    else
+        addrCacheMRU = ac->lruNext;
+    if (ac->lruNext)
+        ac->lruNext->lruPrev = ac->lruPrev;
+    else
+        addrCacheLRU = ac->lruPrev;
+    ac->lruPrev = ac->lruNext = NULL;
+}
+
+static void
+_addrcache_lru_push(struct addrCache *ac)
+{
+    ac->lruPrev = NULL;
+    ac->lruNext = addrCacheMRU;
+    if (addrCacheMRU)
+        addrCacheMRU->lruPrev = ac;
+    else
+        addrCacheLRU = ac;
+    addrCacheMRU = ac;
+}
+
+static void
+_addrcache_remove(struct addrCache *ac)
+{
+    struct addrCache **prevNext;
 
-    for (i = 0; i < SNMP_ADDRCACHE_SIZE; i++) {
-        if (addrCache[i].status == SNMP_ADDRCACHE_USED) {
-            free(addrCache[i].addr);
-            addrCache[i].status = SNMP_ADDRCACHE_UNUSED;
+    for (prevNext = &addrCache[ac->hash & (SNMP_ADDRCACHE_BUCKETS - 1)];
+         *prevNext; prevNext = &(*prevNext)->next) {
+        if (*prevNext == ac) {
+            *prevNext = ac->next;
+            break;
         }
     }
+    _addrcache_lru_unlink(ac);
+    _addrcache_free_entry(ac);
 }
 
 /*
- * Adds a new entry to the cache of addresses that
- * have recently made connections to the agent.
- * Returns 0 if the entry already exists (but updates
- * the entry with a new timestamp) and 1 if the
- * entry did not previously exist.
- *
- * Implements a simple LRU cache replacement
- * policy. Uses a linear search, which should be
- * okay, as long as SNMP_ADDRCACHE_SIZE remains
- * relatively small.
+ * Remove the entries that have not been seen for a while, starting
+ * from the least recently used end.
+ */
+static void
+_addrcache_expire(const struct timeval *aged)
+{
+    struct addrCache *ac;
+
+    while ((ac = addrCacheLRU) != NULL &&
+           timercmp(&ac->lastHitM, aged, <))
+        _addrcache_remove(ac);
+}
+
+static int      _addrcache_idle(struct addrCache *ac,
+                                const struct timeval *now);
+
+/*
+ * Make room for a new entry by dropping the least recently used one.
+ * Entries still holding rate limiting state (a bucket that hasn't
+ * refilled yet) are not dropped, as that would hand their source a
+ * fresh burst; they are moved to the front instead, for at most
+ * SNMP_ADDRCACHE_EVICT_TRIES entries.  Returns 1 if an entry was freed.
+ */
+static int
+_addrcache_evict(const struct timeval *now)
+{
+    struct addrCache *ac;
+    int             i;
+
+    for (i = 0; i < SNMP_ADDRCACHE_EVICT_TRIES; i++) {
+        ac = addrCacheLRU;
+        if (!ac)
+            return 0;
+        if (_addrcache_idle(ac, now)) {
+            if (netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                                       NETSNMP_DS_AGENT_VERBOSE))
+                snmp_log(LOG_INFO, "Purging address from address cache: %s",
+                         ac->addr);
+            _addrcache_remove(ac);
+            return 1;
+        }
+        _addrcache_lru_unlink(ac);
+        _addrcache_lru_push(ac);
+    }
+    return 0;
+}
+
+/*
+ * Looks up (or adds) the cache entry for an address that has recently
+ * made a connection to the agent, and updates its timestamp.
+ * *is_new is set to 1 if the entry did not previously exist (or had
+ * expired), and 0 otherwise.
  *
- * @retval 0 : updated existing entry
- * @retval 1 : added new entry
+ * The cache is hashed on the address, so lookups stay cheap with many
+ * sources.  When it is full, the least recently used entry is replaced
+ * (see _addrcache_evict); if none can be, NULL is returned.
  */
-int
-netsnmp_addrcache_add(const char *addr)
+static struct addrCache *
+_addrcache_lookup(const char *addr, int *is_new)
 {
-    int oldest = -1; /* Index of the oldest cache entry */
-    int unused = -1; /* Index of the first free cache entry */
-    int i; /* Looping variable */
-    int rc = -1;
-    struct timeval now; /* What time is it now? */
-    struct timeval aged; /* Oldest allowable cache entry */
+    struct addrCache *ac;
+    u_int           hash;
+    struct timeval  now; /* What time is it now? */
+    struct timeval  aged; /* Oldest allowable cache entry */
 
     /*
      * First get the current and oldest allowable timestamps
@@ -767,89 +888,74 @@ netsnmp_addrcache_add(const char *addr)
     aged.tv_sec = now.tv_sec - SNMP_ADDRCACHE_MAXAGE;
     aged.tv_usec = now.tv_usec;
 
+    if (NULL == addr) {
+        _addrcache_expire(&aged);
+        return NULL;
+    }
+
+    hash = _addrcache_hash(addr);
+    for (ac = addrCache[hash & (SNMP_ADDRCACHE_BUCKETS - 1)]; ac;
+         ac = ac->next) {
+        if (ac->hash == hash && strcmp(ac->addr, addr) == 0) {
+            /* should have expired, so is new */
+            *is_new = timercmp(&ac->lastHitM, &aged, <);
+            ac->lastHitM = now;
+            if (ac != addrCacheMRU) {
+                _addrcache_lru_unlink(ac);
+                _addrcache_lru_push(ac);
+            }
+            return ac;
+        }
+    }
+
     /*
-     * Now look for a place to put this thing
+     * We didn't find the entry in the cache
      */
-    for(i = 0; i < SNMP_ADDRCACHE_SIZE; i++) {
-        if (addrCache[i].status == SNMP_ADDRCACHE_UNUSED) { /* If unused */
-            /*
-             * remember this location, in case addr isn't in the cache
-             */
-            if (unused < 0)
-                unused = i;
-        }
-        else { /* If used */
-            if ((NULL != addr) && (strcmp(addrCache[i].addr, addr) == 0)) {
-                /*
-                 * found a match
-                 */
-                addrCache[i].lastHitM = now;
-                if (timercmp(&addrCache[i].lastHitM, &aged, <))
-		    rc = 1; /* should have expired, so is new */
-		else
-		    rc = 0; /* not expired, so is existing entry */
-                break;
-            }
-            else {
-                /*
-                 * Used, but not this address. check if it's stale.
-                 */
-                if (timercmp(&addrCache[i].lastHitM, &aged, <)) {
-                    /*
-                     * Stale, reuse
-                     */
-                    SNMP_FREE(addrCache[i].addr);
-                    addrCache[i].status = SNMP_ADDRCACHE_UNUSED;
-                    /*
-                     * remember this location, in case addr isn't in the cache
-                     */
-		    if (unused < 0)
-                        unused = i;
-                }
-	        else {
-                    /*
-                     * Still fresh, but a candidate for LRU replacement
-                     */
-                    if (oldest < 0)
-                        oldest = i;
-                    else if (timercmp(&addrCache[i].lastHitM,
-                                      &addrCache[oldest].lastHitM, <))
-                        oldest = i;
-                } /* fresh */
-            } /* used, no match */
-        } /* used */
-    } /* for loop */
+    if (addrCacheCount >= SNMP_ADDRCACHE_SIZE) {
+        _addrcache_expire(&aged);
+        if (addrCacheCount >= SNMP_ADDRCACHE_SIZE && !_addrcache_evict(&now))
+            return NULL;
+    }
 
-    if ((-1 == rc) && (NULL != addr)) {
-        /*
-         * We didn't find the entry in the cache
-         */
-        if (unused >= 0) {
-            /*
-             * If we have a slot free anyway, use it
-             */
-            addrCache[unused].addr = strdup(addr);
-            addrCache[unused].status = SNMP_ADDRCACHE_USED;
-            addrCache[unused].lastHitM = now;
-        }
-        else { /* Otherwise, replace oldest entry */
-            if (netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
-                                       NETSNMP_DS_AGENT_VERBOSE))
-                snmp_log(LOG_INFO, "Purging address from address cache: %s",
-                         addrCache[oldest].addr);
-            
-            free(addrCache[oldest].addr);
-            addrCache[oldest].addr = strdup(addr);
-            addrCache[oldest].lastHitM = now;
-        }
-        rc = 1;
+    ac = SNMP_MALLOC_STRUCT(addrCache);
+    if (!ac)
+        return NULL;
+    ac->addr = strdup(addr);
+    if (!ac->addr) {
+        free(ac);
+        return NULL;
     }
+    ac->hash = hash;
+    ac->lastHitM = now;
+    ac->next = addrCache[hash & (SNMP_ADDRCACHE_BUCKETS - 1)];
+    addrCache[hash & (SNMP_ADDRCACHE_BUCKETS - 1)] = ac;
+    _addrcache_lru_push(ac);
+    addrCacheCount++;
+    *is_new = 1;
+    return ac;
+}
+
+/*
+ * Adds a new entry to the cache of addresses that
+ * have recently made connections to the agent.
+ * Returns 0 if the entry already exists (but updates
+ * the entry with a new timestamp) and 1 if the
+ * entry did not previously exist.
+ *
+ * @retval 0 : updated existing entry
+ * @retval 1 : added new entry
+ */
+int
+netsnmp_addrcache_add(const char *addr)
+{
+    int             rc = -1;
+
+    _addrcache_lookup(addr, &rc);
     if ((log_addresses && (1 == rc)) ||
         netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
                                NETSNMP_DS_AGENT_VERBOSE)) {
         snmp_log(LOG_INFO, "Received SNMP packet(s) from %s\n", addr);
      }
-
     return rc;
 }
 
@@ -866,6 +972,401 @@ netsnmp_addrcache_age(void)
 }
 #endif /* NETSNMP_FEATURE_REMOVE_ADDRCACHE_AGE */
 
+/*
+ * Admission control.
+ *
+ *   rateLimit [-p PRIORITY] source ADDRESS|default RATE [BURST]
+ *   rateLimit [-p PRIORITY] secName NAME RATE [BURST]
+ *   rateLimitTotal RATE [BURST]
+ *
+ * Source limits give every sending address its own token bucket (so
+ * one busy poller only uses up its own share), and are checked before
+ * the packet is even parsed.  The buckets live in the address cache;
+ * sources that can't get an entry there (because it is full of other
+ * sources that are still being limited) share the rule's own bucket.
+ * Security name limits (community or USM user) share one bucket per
+ * rule.  The agent-wide limit is shared by everybody; a request with
+ * priority P may keep drawing on it until it is P bursts in debt, so
+ * higher priority managers are the last to be turned away when the
+ * agent is saturated.  Requests are still answered in the order they
+ * arrive: this only decides which ones are dropped.  Dropped requests
+ * are counted per rule, logged at most once a minute, and counted in
+ * total by nsRateLimitDropped (netsnmp_agent_rate_limit_dropped()).
+ */
+#define RATE_LIMIT_SOURCE        1
+#define RATE_LIMIT_SECNAME       2
+#define RATE_LIMIT_LOG_INTERVAL  60 /* in seconds */
+
+struct rate_limit {
+    int             type;
+    char           *name;
+    u_int           rate;           /* requests per second */
+    u_int           burst;
+    int             priority;
+    struct rate_bucket bucket;      /* shared bucket, see above */
+    u_long          dropped;
+    u_long          dropped_logged;
+    time_t          last_log;
+    struct rate_limit *next;
+};
+
+static struct rate_limit *rate_limits;
+static struct rate_limit rate_limit_total;
+static u_int    rate_limit_generation = 1;
+static u_long   rate_limit_dropped_total;
+
+/*
+ * Refill a bucket and try to take one request out of it, allowing it
+ * to go down to -debt.  Returns 1 if the request may proceed.
+ */
+static int
+_rate_bucket_take(struct rate_bucket *bucket, u_int rate, u_int burst,
+                  double debt)
+{
+    struct timeval  now, diff;
+
+    netsnmp_get_monotonic_clock(&now);
+    if (!timerisset(&bucket->lastFillM)) {
+        bucket->tokens = burst;
+    } else {
+        NETSNMP_TIMERSUB(&now, &bucket->lastFillM, &diff);
+        bucket->tokens += (diff.tv_sec + diff.tv_usec / 1000000.0) * rate;
+        if (bucket->tokens > burst)
+            bucket->tokens = burst;
+    }
+    bucket->lastFillM = now;
+
+    if (bucket->tokens - 1 < -debt)
+        return 0;
+    bucket->tokens -= 1;
+    return 1;
+}
+
+/*
+ * Returns 1 if the address cache entry carries no rate limiting state
+ * worth keeping, ie dropping it and starting over later with a full
+ * bucket would make no difference.
+ */
+static int
+_addrcache_idle(struct addrCache *ac, const struct timeval *now)
+{
+    struct timeval  diff;
+
+    if (!ac->limit || ac->limit_generation != rate_limit_generation ||
+        !timerisset(&ac->bucket.lastFillM))
+        return 1;
+    NETSNMP_TIMERSUB(now, &ac->bucket.lastFillM, &diff);
+    return ac->bucket.tokens +
+        (diff.tv_sec + diff.tv_usec / 1000000.0) * ac->limit->rate >=
+        ac->limit->burst;
+}
+
+static void
+_rate_limit_dropped(struct rate_limit *rl, const char *who)
+{
+    time_t          now = netsnmp_get_agent_uptime() / 100;
+
+    rl->dropped++;
+    rate_limit_dropped_total++;
+    DEBUGMSGTL(("snmp_agent:ratelimit", "dropped request from %s\n",
+                who ? who : "(agent-wide limit)"));
+    if (rl->last_log && now - rl->last_log < RATE_LIMIT_LOG_INTERVAL)
+        return;
+    snmp_log(LOG_WARNING, "%s rate limit%s%s reached: %lu request(s) "
+             "dropped (%lu in total)\n", who ? "request" : "agent-wide",
+             who ? " for " : "", who ? who : "",
+             rl->dropped - rl->dropped_logged, rl->dropped);
+    rl->dropped_logged = rl->dropped;
+    rl->last_log = now ? now : 1;
+}
+
+static struct rate_limit *
+_rate_limit_find(int type, const char *name)
+{
+    struct rate_limit *rl, *dflt = NULL;
+
+    for (rl = rate_limits; rl; rl = rl->next) {
+        if (rl->type != type)
+            continue;
+        if (strcmp(rl->name, name) == 0)
+            return rl;
+        if (type == RATE_LIMIT_SOURCE && strcmp(rl->name, "default") == 0)
+            dflt = rl;
+    }
+    return dflt;
+}
+
+/*
+ * Sources are identified by host address alone, so all of a manager's
+ * ports share one bucket.
+ */
+static void
+_rate_limit_host(const char *addr_string, char *host, size_t host_len)
+{
+    const char     *cp;
+
+    cp = strchr(addr_string, '[');
+    if (cp) {
+        strlcpy(host, cp + 1, host_len);
+        host[strcspn(host, "]")] = '\0';
+    } else
+        strlcpy(host, addr_string, host_len);
+}
+
+/*
+ * Per-source check, done before the packet is parsed.
+ */
+static int
+_rate_limit_check_source(const char *addr_string)
+{
+    struct addrCache *ac;
+    struct rate_limit *rl;
+    char            host[64];
+    int             is_new;
+
+    _rate_limit_host(addr_string, host, sizeof(host));
+
+    ac = _addrcache_lookup(host, &is_new);
+    if (!ac) {
+        /*
+         * no room for a bucket of its own
+         */
+        rl = _rate_limit_find(RATE_LIMIT_SOURCE, host);
+        if (!rl || _rate_bucket_take(&rl->bucket, rl->rate, rl->burst, 0))
+            return 1;
+        _rate_limit_dropped(rl, host);
+        return 0;
+    }
+    if (ac->limit_generation != rate_limit_generation) {
+        ac->limit = _rate_limit_find(RATE_LIMIT_SOURCE, host);
+        ac->limit_generation = rate_limit_generation;
+        timerclear(&ac->bucket.lastFillM);
+    }
+    if (!ac->limit)
+        return 1;
+    if (_rate_bucket_take(&ac->bucket, ac->limit->rate, ac->limit->burst, 0))
+        return 1;
+    _rate_limit_dropped(ac->limit, host);
+    return 0;
+}
+
+/*
+ * Priority of the source rule that applies to a parsed request.
+ */
+static int
+_rate_limit_source_priority(netsnmp_session *session, netsnmp_pdu *pdu)
+{
+    netsnmp_transport *transport;
+    struct rate_limit *rl;
+    char           *addr_string;
+    char            host[64];
+
+    if (!rate_limits)
+        return 0;
+    transport = snmp_sess_transport(snmp_sess_pointer(session));
+    if (!transport || !transport->f_fmtaddr)
+        return 0;
+    addr_string = transport->f_fmtaddr(transport, pdu->transport_data,
+                                       pdu->transport_data_length);
+    if (!addr_string)
+        return 0;
+    _rate_limit_host(addr_string, host, sizeof(host));
+    free(addr_string);
+
+    rl = _rate_limit_find(RATE_LIMIT_SOURCE, host);
+    return rl ? rl->priority : 0;
+}
+
+/*
+ * Per-security name and agent-wide checks, done once the request has
+ * been parsed.  source_priority is that of the request's source rule.
+ */
+static int
+_rate_limit_check_pdu(netsnmp_pdu *pdu, int source_priority)
+{
+    struct rate_limit *rl = NULL;
+    char            name[SNMP_MAXBUF_SMALL];
+    int             priority = source_priority;
+
+    if (pdu->flags & UCD_MSG_FLAG_RESPONSE_PDU)
+        return 1;
+
+    if (rate_limits) {
+        name[0] = '\0';
+        if (pdu->version == SNMP_VERSION_3) {
+            if (pdu->securityName)
+                strlcpy(name, pdu->securityName, sizeof(name));
+        } else if (pdu->community &&
+                   pdu->community_len < sizeof(name)) {
+            memcpy(name, pdu->community, pdu->community_len);
+            name[pdu->community_len] = '\0';
+        }
+        if (name[0])
+            rl = _rate_limit_find(RATE_LIMIT_SECNAME, name);
+    }
+    if (rl) {
+        if (!_rate_bucket_take(&rl->bucket, rl->rate, rl->burst, 0)) {
+            _rate_limit_dropped(rl, name);
+            return 0;
+        }
+        if (rl->priority > priority)
+            priority = rl->priority;
+    }
+
+    if (rate_limit_total.rate &&
+        !_rate_bucket_take(&rate_limit_total.bucket, rate_limit_total.rate,
+                           rate_limit_total.burst,
+                           (double) priority * rate_limit_total.burst)) {
+        _rate_limit_dropped(&rate_limit_total, NULL);
+        return 0;
+    }
+    return 1;
+}
+
+static int
+_rate_limit_parse(char *cptr, u_int *rate, u_int *burst)
+{
+    char            buf[SNMP_MAXBUF_SMALL];
+    char           *ecp;
+    unsigned long   val;
+
+    cptr = copy_nword(cptr, buf, sizeof(buf));
+    val = strtoul(buf, &ecp, 10);
+    if (ecp == buf || *ecp || val == 0 || val > INT_MAX) {
+        config_perror("bad RATE (requests per second)");
+        return 0;
+    }
+    *rate = val;
+    *burst = val;
+    if (cptr) {
+        copy_nword(cptr, buf, sizeof(buf));
+        val = strtoul(buf, &ecp, 10);
+        if (ecp == buf || *ecp || val == 0 || val > INT_MAX) {
+            config_perror("bad BURST (requests)");
+            return 0;
+        }
+        *burst = val;
+    }
+    return 1;
+}
+
+/*
+ * rateLimit [-p PRIORITY] source ADDRESS|default RATE [BURST]
+ * rateLimit [-p PRIORITY] secName NAME RATE [BURST]
+ */
+void
+snmpd_parse_config_rate_limit(const char *token, char *cptr)
+{
+    char            buf[SNMP_MAXBUF_SMALL];
+    struct rate_limit *rl;
+    int             priority = 0, type;
+
+    cptr = copy_nword(cptr, buf, sizeof(buf));
+    if (strcmp(buf, "-p") == 0) {
+        if (!cptr) {
+            config_perror("missing PRIORITY");
+            return;
+        }
+        cptr = copy_nword(cptr, buf, sizeof(buf));
+        priority = atoi(buf);
+        if (priority < 0) {
+            config_perror("PRIORITY must not be negative");
+            return;
+        }
+        if (!cptr) {
+            config_perror("missing source or secName");
+            return;
+        }
+        cptr = copy_nword(cptr, buf, sizeof(buf));
+    }
+    if (strcasecmp(buf, "source") == 0)
+        type = RATE_LIMIT_SOURCE;
+    else if (strcasecmp(buf, "secName") == 0)
+        type = RATE_LIMIT_SECNAME;
+    else {
+        config_perror("expected source or secName");
+        return;
+    }
+    if (!cptr) {
+        config_perror("missing NAME");
+        return;
+    }
+    cptr = copy_nword(cptr, buf, sizeof(buf));
+    if (!cptr) {
+        config_perror("missing RATE");
+        return;
+    }
+
+    rl = SNMP_MALLOC_STRUCT(rate_limit);
+    if (!rl) {
+        config_perror("malloc failed");
+        return;
+    }
+    if (!_rate_limit_parse(cptr, &rl->rate, &rl->burst)) {
+        free(rl);
+        return;
+    }
+    rl->type = type;
+    rl->priority = priority;
+    rl->name = strdup(buf);
+    if (!rl->name) {
+        free(rl);
+        config_perror("malloc failed");
+        return;
+    }
+    rl->next = rate_limits;
+    rate_limits = rl;
+    rate_limit_generation++;
+
+    DEBUGMSGTL(("snmp_agent:ratelimit", "%s %s: %u/s, burst %u, "
+                "priority %d\n", type == RATE_LIMIT_SOURCE ? "source" :
+                "secName", rl->name, rl->rate, rl->burst, rl->priority));
+}
+
+/*
+ * rateLimitTotal RATE [BURST]
+ */
+void
+snmpd_parse_config_rate_limit_total(const char *token, char *cptr)
+{
+    u_int           rate, burst;
+
+    if (!cptr) {
+        config_perror("missing RATE");
+        return;
+    }
+    if (!_rate_limit_parse(cptr, &rate, &burst))
+        return;
+    rate_limit_total.rate = rate;
+    rate_limit_total.burst = burst;
+    timerclear(&rate_limit_total.bucket.lastFillM);
+}
+
+/*
+ * Total number of requests dropped by the rateLimit and rateLimitTotal
+ * rules since the agent started.
+ */
+u_long
+netsnmp_agent_rate_limit_dropped(void)
+{
+    return rate_limit_dropped_total;
+}
+
+void
+snmpd_free_rate_limits(void)
+{
+    struct rate_limit *rl;
+
+    while ((rl = rate_limits) != NULL) {
+        rate_limits = rl->next;
+        free(rl->name);
+        free(rl);
+    }
+    memset(&rate_limit_total, 0, sizeof(rate_limit_total));
+    /* forget the rules cached in the address cache */
+    rate_limit_generation++;
+}
+
 /*******************************************************************-o-******
  * netsnmp_agent_check_packet
  *
@@ -965,12 +1466,16 @@ netsnmp_agent_check_packet(netsnmp_session * session,
     }
 #endif                          /*NETSNMP_USE_LIBWRAP */
 
-    snmp_increment_statistic(STAT_SNMPINPKTS);
-
     if (addr_string != NULL) {
         netsnmp_addrcache_add(addr_string);
+        if (rate_limits && !_rate_limit_check_source(addr_string)) {
+            SNMP_FREE(addr_string);
+            return 0;
+        }
         SNMP_FREE(addr_string);
     }
+
+    snmp_increment_statistic(STAT_SNMPINPKTS);
     return 1;
 }
 
@@ -980,6 +1485,11 @@ netsnmp_agent_check_parse(netsnmp_session * session, netsnmp_pdu *pdu,
                           int result)
 {
     if (result == 0) {
+        if ((rate_limits || rate_limit_total.rate) &&
+            !_rate_limit_check_pdu(pdu, rate_limit_total.rate ?
+                                   _rate_limit_source_priority(session, pdu) :
+                                   0))
+            return 0;
         if (snmp_get_do_logging() &&
 	    netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID, 
 				   NETSNMP_DS_AGENT_VERBOSE)) {
@@ -1431,7 +1941,8 @@ free_agent_snmp_session(netsnmp_agent_session *asp)
     DEBUGMSGTL(("snmp_agent","agent_session %8p released\n", asp));
 
     netsnmp_remove_from_delegated(asp);
-    
+    _coalesce_forget(asp);
+
     DEBUGMSGTL(("verbose:asp", "asp %p reqinfo %p freed\n",
                 asp, asp->reqinfo));
     if (asp->orig_pdu)
@@ -1808,6 +2319,7 @@ netsnmp_wrap_up_request(netsnmp_agent_session *asp, int status)
         asp->pdu->command = SNMP_MSG_RESPONSE;
         asp->pdu->errstat = asp->status;
         asp->pdu->errindex = asp->index;
+        _coalesce_respond(asp);
         if (!snmp_send(asp->session, asp->pdu) &&
              asp->session->s_snmp_errno != SNMPERR_SUCCESS) {
             netsnmp_variable_list *var_ptr;
@@ -1900,6 +2412,22 @@ netsnmp_free_agent_snmp_session_by_session(netsnmp_session * sess,
             next = a->next;
         }
     }
+
+    /*
+     * requests parked on an identical one can't be answered either
+     */
+    prevNext = &agent_coalesced_list;
+    for (a = agent_coalesced_list; a != NULL; a = next) {
+        next = a->next;
+        if (a->session == sess) {
+            *prevNext = next;
+            a->next = NULL;
+            a->coalesced_with = NULL;
+            free_agent_snmp_session(a);
+        } else {
+            prevNext = &(a->next);
+        }
+    }
 }
 #endif /* NETSNMP_FEATURE_REMOVE_FREE_AGENT_SNMP_SESSION_BY_SESSION */
 
@@ -2101,6 +2629,11 @@ netsnmp_add_varbind_to_cache(netsnmp_agent_session *asp, int vbcount,
         DEBUGMSGOID(("snmp_agent", tp->end_a, tp->end_len));
         DEBUGMSG(("snmp_agent", ", \n"));
 
+        /*
+         * load anything the module deferred until its first request 
+         */
+        netsnmp_lazy_init_subtree(tp);
+
         /*
          * malloc the request structure 
          */
@@ -2670,16 +3203,443 @@ netsnmp_check_all_requests_status(netsnmp_agent_session *asp,
     return asp->status;
 }
 
+/*
+ * Agent-wide response cache.
+ *
+ * Subtrees listed with the "responseCache" token have the results of
+ * their GET and GETNEXT requests remembered for a short time (in
+ * milliseconds) and replayed to later requests, from any session, in
+ * place of calling the handlers again.  Entries are keyed on the
+ * context, the request mode and the requested OID.  The cache sits
+ * below the access control checks (in_a_view() before GET dispatch,
+ * check_acm() on GETNEXT results), so every replayed varbind is still
+ * filtered through the view of the manager asking for it.
+ */
+typedef struct response_cache_subtree_s {
+    oid             name[MAX_OID_LEN];
+    size_t          name_len;
+    u_int           ttl;        /* in milliseconds */
+    struct response_cache_subtree_s *next;
+} response_cache_subtree;
+
+typedef struct response_cache_entry_s {
+    /*
+     * key 
+     */
+    char           *context;
+    size_t          context_len;
+    int             mode;
+    int             inclusive;
+    oid            *name;
+    size_t          name_len;
+
+    /*
+     * cached result 
+     */
+    netsnmp_variable_list *vb;
+    struct timeval  expires;
+
+    /*
+     * insertion order, oldest first, for evicting when full 
+     */
+    struct response_cache_entry_s *older, *newer;
+
+    /*
+     * only used while waiting for the handlers to fill in a result 
+     */
+    const response_cache_subtree *subtree;
+    netsnmp_request_info *request;
+    struct response_cache_entry_s *next;
+} response_cache_entry;
+
+#define RESPONSE_CACHE_DEFAULT_MAX_ENTRIES 10000
+
+static response_cache_subtree *response_cache_subtrees = NULL;
+static netsnmp_container *response_cache = NULL;
+static response_cache_entry *response_cache_oldest = NULL;
+static response_cache_entry *response_cache_newest = NULL;
+static int      response_cache_max_entries =
+    RESPONSE_CACHE_DEFAULT_MAX_ENTRIES;
+
+static int
+_response_cache_compare(const void *lhs, const void *rhs)
+{
+    const response_cache_entry *l = (const response_cache_entry *) lhs;
+    const response_cache_entry *r = (const response_cache_entry *) rhs;
+    int             rc;
+
+    rc = netsnmp_compare_mem(l->context, l->context_len,
+                             r->context, r->context_len);
+    if (rc)
+        return rc;
+    if (l->mode != r->mode)
+        return l->mode < r->mode ? -1 : 1;
+    if (l->inclusive != r->inclusive)
+        return l->inclusive < r->inclusive ? -1 : 1;
+    return snmp_oid_compare(l->name, l->name_len, r->name, r->name_len);
+}
+
+static void
+_response_cache_entry_free(void *data, void *context)
+{
+    response_cache_entry *entry = (response_cache_entry *) data;
+
+    if (!entry)
+        return;
+    SNMP_FREE(entry->context);
+    SNMP_FREE(entry->name);
+    if (entry->vb)
+        snmp_free_var(entry->vb);
+    free(entry);
+}
+
+/*
+ * take an entry out of the cache and free it 
+ */
+static void
+_response_cache_remove(response_cache_entry *entry)
+{
+    CONTAINER_REMOVE(response_cache, entry);
+    if (entry->older)
+        entry->older->newer = entry->newer;
+    else
+        response_cache_oldest = entry->newer;
+    if (entry->newer)
+        entry->newer->older = entry->older;
+    else
+        response_cache_newest = entry->older;
+    _response_cache_entry_free(entry, NULL);
+}
+
+static void
+_response_cache_flush(void)
+{
+    response_cache_oldest = response_cache_newest = NULL;
+    if (response_cache && CONTAINER_SIZE(response_cache)) {
+        DEBUGMSGTL(("response_cache", "flushing %" NETSNMP_PRIz "u entries\n",
+                    CONTAINER_SIZE(response_cache)));
+        CONTAINER_CLEAR(response_cache, _response_cache_entry_free, NULL);
+    }
+}
+
+static const response_cache_subtree *
+_response_cache_subtree_find(const oid *name, size_t name_len)
+{
+    const response_cache_subtree *rcs;
+
+    for (rcs = response_cache_subtrees; rcs; rcs = rcs->next)
+        if (netsnmp_oid_is_subtree(rcs->name, rcs->name_len,
+                                   name, name_len) == 0)
+            return rcs;
+    return NULL;
+}
+
+static int
+_response_cache_mode_ok(netsnmp_agent_session *asp)
+{
+    return response_cache_subtrees &&
+        (asp->mode == MODE_GET || asp->mode == MODE_GETNEXT);
+}
+
+static void
+_response_cache_make_key(response_cache_entry *key,
+                         netsnmp_agent_session *asp,
+                         netsnmp_request_info *request)
+{
+    key->context = asp->pdu->contextName;
+    key->context_len = asp->pdu->contextNameLen;
+    key->mode = asp->mode;
+    key->inclusive = (asp->mode == MODE_GETNEXT) ? request->inclusive : 0;
+    key->name = request->requestvb->name;
+    key->name_len = request->requestvb->name_length;
+}
+
+/*
+ * Look up a fresh cache entry for a request, dropping it if it has
+ * expired.
+ */
+static response_cache_entry *
+_response_cache_lookup(netsnmp_agent_session *asp,
+                       netsnmp_request_info *request,
+                       const struct timeval *now)
+{
+    response_cache_entry key, *entry;
+
+    _response_cache_make_key(&key, asp, request);
+    entry = (response_cache_entry *) CONTAINER_FIND(response_cache, &key);
+    if (entry && !timercmp(now, &entry->expires, <)) {
+        _response_cache_remove(entry);
+        entry = NULL;
+    }
+    return entry;
+}
+
+/*
+ * Answer a whole group of requests (one subtree's worth) from the
+ * cache.  Returns 1 if every request was answered, 0 if the handlers
+ * must be called.  Partial hits are not served, since the handlers
+ * expect to see the complete request chain they were given.
+ */
+static int
+_response_cache_serve(netsnmp_agent_session *asp,
+                      netsnmp_request_info *requests,
+                      const struct timeval *now)
+{
+    netsnmp_request_info *request;
+    response_cache_entry *entry;
+
+    if (!response_cache || !CONTAINER_SIZE(response_cache))
+        return 0;
+
+    for (request = requests; request; request = request->next) {
+        if (!_response_cache_subtree_find(request->requestvb->name,
+                                          request->requestvb->name_length))
+            return 0;
+        if (!_response_cache_lookup(asp, request, now))
+            return 0;
+    }
+
+    for (request = requests; request; request = request->next) {
+        entry = _response_cache_lookup(asp, request, now);
+        if (asp->mode == MODE_GETNEXT)
+            snmp_set_var_objid(request->requestvb, entry->vb->name,
+                               entry->vb->name_length);
+        snmp_set_var_typed_value(request->requestvb, entry->vb->type,
+                                 entry->vb->val.string, entry->vb->val_len);
+        DEBUGMSGTL(("response_cache", "served "));
+        DEBUGMSGOID(("response_cache", entry->name, entry->name_len));
+        DEBUGMSG(("response_cache", " from cache\n"));
+    }
+    return 1;
+}
+
+/*
+ * Remember the keys of the cacheable requests in a group before the
+ * handlers run (GETNEXT handlers overwrite the requested OID).
+ */
+static response_cache_entry *
+_response_cache_prepare(netsnmp_agent_session *asp,
+                        netsnmp_request_info *requests)
+{
+    netsnmp_request_info *request;
+    const response_cache_subtree *rcs;
+    response_cache_entry key, *entry, *pending = NULL;
+
+    for (request = requests; request; request = request->next) {
+        rcs = _response_cache_subtree_find(request->requestvb->name,
+                                           request->requestvb->name_length);
+        if (!rcs)
+            continue;
+        entry = SNMP_MALLOC_TYPEDEF(response_cache_entry);
+        if (!entry)
+            break;
+        _response_cache_make_key(&key, asp, request);
+        entry->mode = key.mode;
+        entry->inclusive = key.inclusive;
+        entry->context_len = key.context_len;
+        if (key.context_len)
+            entry->context = (char *) netsnmp_memdup(key.context,
+                                                     key.context_len);
+        entry->name = snmp_duplicate_objid(key.name, key.name_len);
+        entry->name_len = key.name_len;
+        if (!entry->name || (key.context_len && !entry->context)) {
+            _response_cache_entry_free(entry, NULL);
+            break;
+        }
+        entry->subtree = rcs;
+        entry->request = request;
+        entry->next = pending;
+        pending = entry;
+    }
+    return pending;
+}
+
+/*
+ * Store the results the handlers produced for the prepared requests.
+ * Delegated requests (whose answers arrive later), errors and
+ * exception values are never cached.
+ */
+static void
+_response_cache_store(netsnmp_agent_session *asp,
+                      response_cache_entry *pending,
+                      const struct timeval *now)
+{
+    response_cache_entry *entry, *old;
+    netsnmp_variable_list *vb;
+    int             cacheable = 1;
+
+    for (entry = pending; entry; entry = entry->next)
+        if (entry->request->delegated)
+            cacheable = 0;
+
+    while (pending) {
+        entry = pending;
+        pending = entry->next;
+        vb = entry->request->requestvb;
+
+        if (!cacheable || entry->request->status != SNMP_ERR_NOERROR ||
+            vb->type == ASN_NULL || vb->type == ASN_PRIV_RETRY ||
+            vb->type == SNMP_NOSUCHOBJECT ||
+            vb->type == SNMP_NOSUCHINSTANCE ||
+            vb->type == SNMP_ENDOFMIBVIEW ||
+            netsnmp_oid_is_subtree(entry->subtree->name,
+                                   entry->subtree->name_len,
+                                   vb->name, vb->name_length) != 0) {
+            _response_cache_entry_free(entry, NULL);
+            continue;
+        }
+
+        entry->vb = SNMP_MALLOC_TYPEDEF(netsnmp_variable_list);
+        if (!entry->vb || snmp_clone_var(vb, entry->vb)) {
+            _response_cache_entry_free(entry, NULL);
+            continue;
+        }
+        entry->expires.tv_sec = now->tv_sec + entry->subtree->ttl / 1000;
+        entry->expires.tv_usec =
+            now->tv_usec + (entry->subtree->ttl % 1000) * 1000;
+        if (entry->expires.tv_usec >= 1000000) {
+            entry->expires.tv_sec++;
+            entry->expires.tv_usec -= 1000000;
+        }
+        entry->subtree = NULL;
+        entry->request = NULL;
+        entry->next = NULL;
+
+        if (!response_cache) {
+            response_cache = netsnmp_container_find("response_cache:"
+                                                    "table_container");
+            if (!response_cache) {
+                _response_cache_entry_free(entry, NULL);
+                continue;
+            }
+            response_cache->container_name = strdup("response_cache");
+            response_cache->compare = _response_cache_compare;
+        }
+
+        old = (response_cache_entry *) CONTAINER_FIND(response_cache, entry);
+        if (old)
+            _response_cache_remove(old);
+        else if (response_cache_max_entries > 0 &&
+                 (int) CONTAINER_SIZE(response_cache) >=
+                 response_cache_max_entries && response_cache_oldest) {
+            /*
+             * the oldest entry is the first one to expire anyway 
+             */
+            _response_cache_remove(response_cache_oldest);
+        }
+        if (CONTAINER_INSERT(response_cache, entry) != 0) {
+            _response_cache_entry_free(entry, NULL);
+            continue;
+        }
+        entry->older = response_cache_newest;
+        if (response_cache_newest)
+            response_cache_newest->newer = entry;
+        else
+            response_cache_oldest = entry;
+        response_cache_newest = entry;
+    }
+}
+
+/*
+ * responseCache OID TTL_MS
+ */
+void
+snmpd_parse_config_response_cache(const char *token, char *cptr)
+{
+    char            buf[SPRINT_MAX_LEN];
+    char           *ecp;
+    response_cache_subtree *rcs;
+    unsigned long   ttl;
+
+    cptr = copy_nword(cptr, buf, sizeof(buf));
+    if (!cptr) {
+        config_perror("missing TTL (in milliseconds)");
+        return;
+    }
+    ttl = strtoul(cptr, &ecp, 10);
+    if (ecp == cptr || ttl == 0 || ttl > INT_MAX) {
+        config_perror("bad TTL (in milliseconds)");
+        return;
+    }
+
+    rcs = SNMP_MALLOC_TYPEDEF(response_cache_subtree);
+    if (!rcs) {
+        config_perror("malloc failed");
+        return;
+    }
+    rcs->name_len = MAX_OID_LEN;
+    if (!snmp_parse_oid(buf, rcs->name, &rcs->name_len)) {
+        config_perror("unknown OID");
+        free(rcs);
+        return;
+    }
+    rcs->ttl = ttl;
+    rcs->next = response_cache_subtrees;
+    response_cache_subtrees = rcs;
+
+    DEBUGMSGTL(("response_cache", "caching "));
+    DEBUGMSGOID(("response_cache", rcs->name, rcs->name_len));
+    DEBUGMSG(("response_cache", " for %u ms\n", rcs->ttl));
+}
+
+/*
+ * responseCacheMaxEntries NUM
+ */
+void
+snmpd_parse_config_response_cache_max(const char *token, char *cptr)
+{
+    char           *ecp;
+    long            max;
+
+    max = strtol(cptr, &ecp, 10);
+    while (ecp && isspace((unsigned char) *ecp))
+        ecp++;
+    if (ecp == cptr || *ecp || max < 0 || max > INT_MAX) {
+        config_perror("bad number of entries (0 or more expected)");
+        return;
+    }
+    response_cache_max_entries = max;
+}
+
+void
+snmpd_free_response_cache(void)
+{
+    response_cache_subtree *rcs;
+
+    while (response_cache_subtrees) {
+        rcs = response_cache_subtrees;
+        response_cache_subtrees = rcs->next;
+        free(rcs);
+    }
+    if (response_cache) {
+        _response_cache_flush();
+        CONTAINER_FREE(response_cache);
+        response_cache = NULL;
+    }
+    response_cache_max_entries = RESPONSE_CACHE_DEFAULT_MAX_ENTRIES;
+}
+
 int
 handle_var_requests(netsnmp_agent_session *asp)
 {
     int             i, retstatus = SNMP_ERR_NOERROR,
         status = SNMP_ERR_NOERROR, final_status = SNMP_ERR_NOERROR;
     netsnmp_handler_registration *reginfo;
+    response_cache_entry *pending;
+    struct timeval  now;
+    int             use_response_cache;
 
     asp->reqinfo->asp = asp;
     asp->reqinfo->mode = asp->mode;
 
+    use_response_cache = _response_cache_mode_ok(asp);
+    if (use_response_cache)
+        netsnmp_get_monotonic_clock(&now);
+#ifndef NETSNMP_NO_WRITE_SUPPORT
+    else if (asp->mode == MODE_SET_COMMIT)
+        _response_cache_flush();
+#endif /* NETSNMP_NO_WRITE_SUPPORT */
+
     /*
      * now, have the subtrees in the cache go search for their results 
      */
@@ -2692,8 +3652,20 @@ handle_var_requests(netsnmp_agent_session *asp)
          */
         if(NULL != asp->treecache[i].subtree->reginfo) {
             reginfo = asp->treecache[i].subtree->reginfo;
-            status = netsnmp_call_handlers(reginfo, asp->reqinfo,
-                                           asp->treecache[i].requests_begin);
+            if (use_response_cache &&
+                _response_cache_serve(asp, asp->treecache[i].requests_begin,
+                                      &now)) {
+                status = SNMP_ERR_NOERROR;
+            } else {
+                pending = use_response_cache ?
+                    _response_cache_prepare(asp,
+                                            asp->treecache[i].requests_begin)
+                    : NULL;
+                status = netsnmp_call_handlers(reginfo, asp->reqinfo,
+                                               asp->treecache[i].requests_begin);
+                if (pending)
+                    _response_cache_store(asp, pending, &now);
+            }
         }
         else
             status = SNMP_ERR_GENERR;
@@ -2818,6 +3790,11 @@ netsnmp_check_outstanding_agent_requests(void)
      */
     netsnmp_check_delegated_requests();
 
+    /*
+     * restart requests whose coalesced leader went away
+     */
+    _coalesce_redispatch();
+
     /*
      * if we are processing a set and there are more delegated
      * requests, keep waiting before getting to queued requests.
@@ -3262,6 +4239,204 @@ handle_set_loop(netsnmp_agent_session *asp)
 }
 #endif /* NETSNMP_NO_WRITE_SUPPORT */
 
+/*
+ * Request coalescing.
+ *
+ * With "coalesceRequests yes", a new GET, GETNEXT or GETBULK request
+ * that is identical to one still waiting on a delegated (eg, AgentX or
+ * pass_persist) answer is not processed again.  Requests are identical
+ * if they have the same version, context, read view and varbind list.
+ * The newcomer is parked on agent_coalesced_list and sent a copy of the
+ * in-flight request's response once that completes.  If the in-flight
+ * request is freed without answering, the newcomer is processed on its
+ * own from the main loop (netsnmp_check_outstanding_agent_requests).
+ */
+static int
+_coalesce_pdu_match(netsnmp_agent_session *leader, netsnmp_pdu *pdu)
+{
+    /*
+     * the leader's own pdu is being worked on (and GETBULK repeat
+     * counts have been clamped), so compare against its copy of the
+     * original request
+     */
+    netsnmp_pdu    *lpdu = leader->orig_pdu;
+    netsnmp_variable_list *lvb, *vb;
+
+    if (lpdu->command != pdu->command ||
+        lpdu->version != pdu->version ||
+        lpdu->securityModel != pdu->securityModel ||
+        lpdu->securityLevel != pdu->securityLevel ||
+        lpdu->errstat != pdu->errstat ||
+        lpdu->errindex != pdu->errindex ||
+        (lpdu->flags & UCD_MSG_FLAG_ALWAYS_IN_VIEW) !=
+        (pdu->flags & UCD_MSG_FLAG_ALWAYS_IN_VIEW) ||
+        netsnmp_compare_mem(lpdu->contextName, lpdu->contextNameLen,
+                            pdu->contextName, pdu->contextNameLen) != 0)
+        return 0;
+
+    for (lvb = lpdu->variables, vb = pdu->variables;
+         lvb && vb; lvb = lvb->next_variable, vb = vb->next_variable) {
+        if (lvb->type != vb->type ||
+            snmp_oid_compare(lvb->name, lvb->name_length,
+                             vb->name, vb->name_length) != 0)
+            return 0;
+    }
+    return lvb == NULL && vb == NULL;
+}
+
+/*
+ * Park asp on an identical delegated request, if there is one.
+ * Returns 1 if it was parked, 0 if it should be processed normally.
+ */
+static int
+_coalesce_with_delegated(netsnmp_agent_session *asp)
+{
+    netsnmp_agent_session *leader;
+    const char     *view, *leader_view;
+
+    if (!agent_delegated_list ||
+        !netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                                NETSNMP_DS_AGENT_COALESCE_REQUESTS))
+        return 0;
+
+    switch (asp->pdu->command) {
+    case SNMP_MSG_GET:
+    case SNMP_MSG_GETNEXT:
+    case SNMP_MSG_GETBULK:
+        break;
+    default:
+        return 0;
+    }
+
+    view = netsnmp_acm_view_name(asp->pdu);
+    if (!view)
+        return 0;
+
+    for (leader = agent_delegated_list; leader; leader = leader->next) {
+        if (!leader->pdu || !leader->orig_pdu ||
+            (leader->flags & SNMP_AGENT_FLAGS_CANCEL_IN_PROGRESS) ||
+            !_coalesce_pdu_match(leader, asp->pdu))
+            continue;
+        leader_view = netsnmp_acm_view_name(leader->pdu);
+        if (!leader_view || strcmp(view, leader_view) != 0)
+            continue;
+
+        DEBUGMSGTL(("snmp_agent", "coalescing asp %8p with in-flight "
+                    "asp %8p\n", asp, leader));
+        asp->coalesced_with = leader;
+        asp->next = agent_coalesced_list;
+        agent_coalesced_list = asp;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Send a copy of asp's (finished) response to every request that was
+ * parked on it.
+ */
+static void
+_coalesce_respond(netsnmp_agent_session *asp)
+{
+    netsnmp_agent_session *follower, *next, **prevNext;
+    netsnmp_variable_list *vars;
+
+    prevNext = &agent_coalesced_list;
+    for (follower = agent_coalesced_list; follower; follower = next) {
+        next = follower->next;
+        if (follower->coalesced_with != asp) {
+            prevNext = &(follower->next);
+            continue;
+        }
+
+        vars = snmp_clone_varbind(asp->pdu->variables);
+        if (!follower->pdu || (asp->pdu->variables && !vars)) {
+            /*
+             * can't copy the answer, so leave it to be worked out
+             * separately from the main loop
+             */
+            snmp_free_varbind(vars);
+            follower->coalesced_with = NULL;
+            prevNext = &(follower->next);
+            continue;
+        }
+        *prevNext = next;
+        follower->next = NULL;
+        follower->coalesced_with = NULL;
+
+        DEBUGMSGTL(("snmp_agent", "answering coalesced asp %8p from "
+                    "asp %8p\n", follower, asp));
+        snmp_free_varbind(follower->pdu->variables);
+        follower->pdu->variables = vars;
+        follower->pdu->command = SNMP_MSG_RESPONSE;
+        follower->pdu->errstat = asp->pdu->errstat;
+        follower->pdu->errindex = asp->pdu->errindex;
+        if (follower->pdu->errstat == SNMP_ERR_NOERROR)
+            snmp_increment_statistic_by(STAT_SNMPINTOTALREQVARS,
+                                        count_varbinds(vars));
+        if (!snmp_send(follower->session, follower->pdu))
+            snmp_free_pdu(follower->pdu);
+        follower->pdu = NULL;
+        snmp_increment_statistic(STAT_SNMPOUTPKTS);
+        snmp_increment_statistic(STAT_SNMPOUTGETRESPONSES);
+        netsnmp_remove_and_free_agent_snmp_session(follower);
+    }
+}
+
+/*
+ * asp is being freed: take it off the coalesced list, and orphan any
+ * requests parked on it so that _coalesce_redispatch() picks them up.
+ */
+static void
+_coalesce_forget(netsnmp_agent_session *asp)
+{
+    netsnmp_agent_session *a, **prevNext = &agent_coalesced_list;
+
+    for (a = agent_coalesced_list; a; a = *prevNext) {
+        if (a == asp) {
+            *prevNext = a->next;
+            a->next = NULL;
+            continue;
+        }
+        if (a->coalesced_with == asp) {
+            DEBUGMSGTL(("snmp_agent", "coalesced asp %8p lost asp %8p\n",
+                        a, asp));
+            a->coalesced_with = NULL;
+        }
+        prevNext = &(a->next);
+    }
+}
+
+/*
+ * Process the orphaned coalesced requests on their own.  Called from the
+ * main loop, never from inside the free path.
+ */
+static void
+_coalesce_redispatch(void)
+{
+    netsnmp_agent_session *a, *next, **prevNext, *orphans = NULL;
+
+    prevNext = &agent_coalesced_list;
+    for (a = agent_coalesced_list; a; a = next) {
+        next = a->next;
+        if (a->coalesced_with == NULL) {
+            *prevNext = next;
+            a->next = orphans;
+            orphans = a;
+        } else {
+            prevNext = &(a->next);
+        }
+    }
+
+    while ((a = orphans) != NULL) {
+        orphans = a->next;
+        a->next = NULL;
+        DEBUGMSGTL(("snmp_agent", "processing orphaned coalesced request, "
+                    "asp = %8p\n", a));
+        netsnmp_handle_request(a, SNMP_ERR_NOERROR);
+    }
+}
+
 int
 netsnmp_handle_request(netsnmp_agent_session *asp, int status)
 {
@@ -3285,6 +4460,13 @@ netsnmp_handle_request(netsnmp_agent_session *asp, int status)
             return 1;
         }
 
+        /*
+         * share the work of an identical request that is already
+         * waiting on a delegated answer
+         */
+        if (_coalesce_with_delegated(asp))
+            return 1;
+
         /*
          * check for set request
          */
@@ -437,6 +437,7 @@ main(int argc, char *argv[])
     int             agent_mode = -1;
     char           *pid_file = NULL;
     char            option_compatability[] = "-Le";
+    struct timeval  startM, nowM;
 #ifndef WIN32
     int             prepared_sockets = 0;
 #endif
@@ -943,6 +944,7 @@ main(int argc, char *argv[])
 			       NETSNMP_DS_AGENT_ROLE, agent_mode);
     }
 
+    netsnmp_get_monotonic_clock(&startM);
     if (init_agent(app_name) != 0) {
         snmp_log(LOG_ERR, "Agent initialization failed\n");
         goto out;
@@ -1106,6 +1108,13 @@ main(int argc, char *argv[])
      * We're up, log our version number.  
      */
     snmp_log(LOG_INFO, "NET-SNMP version %s\n", netsnmp_get_version());
+    netsnmp_get_monotonic_clock(&nowM);
+    NETSNMP_TIMERSUB(&nowM, &startM, &nowM);
+    snmp_log(LOG_INFO, "Agent initialization took %ld.%03ld seconds%s\n",
+             (long)nowM.tv_sec, (long)(nowM.tv_usec / 1000),
+             netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                                    NETSNMP_DS_AGENT_LAZY_INIT) ?
+             " (lazy module initialization)" : "");
 #ifdef WIN32SERVICE
     agent_status = AGENT_RUNNING;
 #endif
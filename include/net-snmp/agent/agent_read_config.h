@@ -17,6 +17,12 @@ extern          "C" {
                                                                   char *),
                                                   void (*releaser) (void),
                                                   const char *help);
+    void            snmpd_register_config_handler_incremental(
+                                 const char *token,
+                                 void (*parser) (const char *, char *),
+                                 void (*remover) (const char *, char *),
+                                 void (*releaser) (void),
+                                 const char *help);
     void            snmpd_register_const_config_handler(
                                  const char *,
                                  void (*parser) (const char *, const char *),
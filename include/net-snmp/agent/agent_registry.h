@@ -32,6 +32,7 @@ struct view_parameters {
 					    specifying an error, as it starts
 					    in a success state.  */
     int             check_subtree;
+    const char     *view_name;		/*  Read view, set by ACM_CHECK_INITIAL */
 };
 
 struct register_parameters {
@@ -136,9 +137,19 @@ int             in_a_view		   (oid *, size_t *,
 					    netsnmp_pdu *, int);
 int             check_access		   (netsnmp_pdu *pdu);
 int             netsnmp_acm_check_subtree  (netsnmp_pdu *, oid *, size_t);
+const char     *netsnmp_acm_view_name      (netsnmp_pdu *pdu);
 void            register_mib_reattach	   (void);
 void            register_mib_detach	   (void);
 
+int             netsnmp_register_lazy_init (const char *name,
+                                            const oid *root,
+                                            size_t root_len,
+                                            void (*init_fn)(void *),
+                                            void *magic);
+void            netsnmp_unregister_lazy_init(void (*init_fn)(void *),
+                                             void *magic);
+void            netsnmp_lazy_init_subtree  (netsnmp_subtree *tp);
+
 /*
  * REGISTER_MIB(): This macro simply loads register_mib with less pain:
  * 
@@ -67,6 +67,16 @@ extern          "C" {
         oid *rootoid;
         int  rootoid_len;
 
+        /*
+         * For NETSNMP_CACHE_STALE_WHILE_REVALIDATE: how long (in s)
+         * past its timeout an expired cache may still be used while
+         * the reload is pending (0: another timeout period).
+         */
+        int      max_stale;
+        u_int    reload_id;     /* pending background reload alarm */
+
+        void    *load_job;      /* pending load in a worker thread */
+
     };
 
 
@@ -120,6 +130,8 @@ extern          "C" {
 #define NETSNMP_CACHE_PRELOAD                               0x0010
 #define NETSNMP_CACHE_AUTO_RELOAD                           0x0020
 #define NETSNMP_CACHE_RESET_TIMER_ON_USE                    0x0040
+#define NETSNMP_CACHE_STALE_WHILE_REVALIDATE                0x0080
+#define NETSNMP_CACHE_LOAD_THREAD_SAFE                      0x0100
 
 #define NETSNMP_CACHE_HINT_HANDLER_ARGS                     0x1000
 
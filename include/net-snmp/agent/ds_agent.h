@@ -36,6 +36,9 @@
 #define NETSNMP_DS_AGENT_DISKIO_NO_FD   18      /* 1 = don't report /dev/fd*   entries in diskIOTable */
 #define NETSNMP_DS_AGENT_DISKIO_NO_LOOP 19      /* 1 = don't report /dev/loop* entries in diskIOTable */
 #define NETSNMP_DS_AGENT_DISKIO_NO_RAM  20      /* 1 = don't report /dev/ram*  entries in diskIOTable */
+#define NETSNMP_DS_AGENT_COALESCE_REQUESTS 21   /* 1 = share identical in-flight requests */
+#define NETSNMP_DS_AGENT_LAZY_INIT      22      /* 1 = defer module data loads to first use */
+#define NETSNMP_DS_AGENT_ROUTE_UPDATES  23      /* 1 = follow route changes through netlink */
 
 /* WARNING: The trap receiver also uses DS flags and must not conflict with these!
  * If you define additional boolean entries, check in "apps/snmptrapd_ds.h" first */
@@ -70,5 +73,6 @@
 #define NETSNMP_DS_AGENT_INTERNAL_SECLEVEL 12   /* used by internal queries */
 #define NETSNMP_DS_AGENT_MAX_GETBULKREPEATS 13 /* max getbulk repeats */
 #define NETSNMP_DS_AGENT_MAX_GETBULKRESPONSES 14   /* max getbulk respones */
+#define NETSNMP_DS_AGENT_FSYS_STAT_TIMEOUT 15   /* max seconds to wait for statfs */
 
 #endif
@@ -62,6 +62,7 @@ struct netsnmp_cpu_info_s {
 netsnmp_cpu_info *netsnmp_cpu_get_first(  void );
 netsnmp_cpu_info *netsnmp_cpu_get_next( netsnmp_cpu_info* );
 netsnmp_cpu_info *netsnmp_cpu_get_byIdx(  int,   int );
+netsnmp_cpu_info *netsnmp_cpu_get_next_byIdx( int );
 netsnmp_cpu_info *netsnmp_cpu_get_byName( char*, int );
 
 netsnmp_cache *netsnmp_cpu_get_cache( void );
@@ -209,6 +209,13 @@ extern          "C" {
         netsnmp_cachemap *cache_store;
         int             vbcount;
         int             flags;
+
+        /*
+         * the in-flight request this one is parked on, while it is
+         * on the coalesced list (NULL once that request went away
+         * without answering)
+         */
+        struct netsnmp_agent_session_s *coalesced_with;
     } netsnmp_agent_session;
 
     /*
@@ -219,6 +226,22 @@ extern          "C" {
     void            netsnmp_addrcache_destroy(void);
     void            netsnmp_addrcache_age(void);
 
+    /*
+     * Agent-wide response cache configuration.
+     */
+
+    void            snmpd_parse_config_response_cache(const char *token,
+                                                      char *cptr);
+    void            snmpd_parse_config_response_cache_max(const char *token,
+                                                          char *cptr);
+    void            snmpd_free_response_cache(void);
+    void            snmpd_parse_config_rate_limit(const char *token,
+                                                  char *cptr);
+    void            snmpd_parse_config_rate_limit_total(const char *token,
+                                                        char *cptr);
+    void            snmpd_free_rate_limits(void);
+    u_long          netsnmp_agent_rate_limit_dropped(void);
+
 
     /*
      * config file parsing routines 
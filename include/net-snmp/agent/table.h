@@ -186,6 +186,43 @@ extern          "C" {
 	unsigned int
 		netsnmp_table_next_column(netsnmp_table_request_info *table_info);
 
+    /*
+     * Walk cursors: where the last GETNEXT from a manager ended in a
+     * table, so that the next request of the walk can carry on from
+     * there instead of searching the table again.  Used by the
+     * table_iterator and table_container helpers; the meaning of
+     * pos, sync and data is up to them.
+     */
+#define NETSNMP_TABLE_CURSOR_MAX 8
+
+    typedef struct netsnmp_table_cursor_s {
+        u_char         *source;        /* manager transport address */
+        size_t          source_len;
+        oid             name[MAX_OID_LEN];  /* last OID returned */
+        size_t          name_len;
+        u_long          last_used;
+        size_t          pos;
+        u_long          sync;
+        void           *data;
+        void          (*free_data)(void *);
+    } netsnmp_table_cursor;
+
+    typedef struct netsnmp_table_cursors_s {
+        netsnmp_table_cursor cursor[NETSNMP_TABLE_CURSOR_MAX];
+        u_long          clock;
+    } netsnmp_table_cursors;
+
+    netsnmp_table_cursor *
+        netsnmp_table_cursor_find(netsnmp_table_cursors *cursors,
+                                  netsnmp_agent_request_info *reqinfo,
+                                  const oid *name, size_t name_len);
+    netsnmp_table_cursor *
+        netsnmp_table_cursor_save(netsnmp_table_cursors *cursors,
+                                  netsnmp_table_cursor *cursor,
+                                  netsnmp_agent_request_info *reqinfo,
+                                  const oid *name, size_t name_len);
+    void netsnmp_table_cursors_clear(netsnmp_table_cursors *cursors);
+
 
     int   netsnmp_sparse_table_register(netsnmp_handler_registration    *reginfo,
                                         netsnmp_table_registration_info *tabreq);
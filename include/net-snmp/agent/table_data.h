@@ -36,6 +36,7 @@ extern          "C" {
         int             store_indexes;
         netsnmp_table_row *first_row;
         netsnmp_table_row *last_row;
+        netsnmp_container *container;   /* rows indexed by index_oid */
     } netsnmp_table_data;
 
 /* =================================
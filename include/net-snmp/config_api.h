@@ -26,6 +26,14 @@ extern          "C" {
                                   void (*releaser) (void),
                                   const char *usageLine);
     NETSNMP_IMPORT
+    struct config_line *register_config_handler_incremental(
+                                  const char *filePrefix,
+                                  const char *token,
+                                  void (*parser) (const char *, char *),
+                                  void (*remover) (const char *, char *),
+                                  void (*releaser) (void),
+                                  const char *usageLine);
+    NETSNMP_IMPORT
     struct config_line *register_prenetsnmp_mib_handler(const char *filePrefix,
                                                 const char *token,
                                                 void (*parser) (const char *, char *),
@@ -46,6 +54,14 @@ extern          "C" {
                                                 void (*releaser) (void),
                                                 const char *usageLine);
 
+    NETSNMP_IMPORT
+    struct config_line *register_app_config_handler_incremental(
+                                                const char *token,
+                                                void (*parser) (const char *, char *),
+                                                void (*remover) (const char *, char *),
+                                                void (*releaser) (void),
+                                                const char *usageLine);
+
     NETSNMP_IMPORT
     struct config_line *register_app_prenetsnmp_mib_handler(
                                                 const char *token,
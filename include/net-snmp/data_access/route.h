@@ -30,16 +30,12 @@ typedef struct netsnmp_route_s {
    netsnmp_index oid_index;   /* MUST BE FIRST!! for container use */
    oid           ns_rt_index; /* arbitrary index */
 
-   int       flags; /* for net-snmp use */
-
    oid       if_index;
 
     /*
-     * addresses, in network byte order
+     * pointers and wide fields first, and the small ones packed together
+     * at the end: there may be a lot of routes.
      */
-   u_char    rt_dest[NETSNMP_ACCESS_ROUTE_ADDR_BUF_SIZE];
-   u_char    rt_nexthop[NETSNMP_ACCESS_ROUTE_ADDR_BUF_SIZE];
-
 #ifdef USING_IP_FORWARD_MIB_INETCIDRROUTETABLE_INETCIDRROUTETABLE_MODULE
    /*
     * define the maximum oid length for a policy, for use by the
@@ -47,22 +43,22 @@ typedef struct netsnmp_route_s {
     */
 #define NETSNMP_POLICY_OID_MAX_LEN  3
    oid      *rt_policy;      /* NULL should be interpreted as { 0, 0 } */
-   u_char    rt_policy_len;  /* 0-128 oids */
 #endif
-
-   u_char    rt_dest_len;    /* 4 | 16 since we only do ipv4|ipv6 */
-   u_char    rt_dest_type;   /* InetAddressType 0-16 */
-   u_char    rt_nexthop_len; /* 4 | 16 since we only do ipv4|ipv6*/
-   u_char    rt_nexthop_type;/* InetAddressType 0-16 */
-   u_char    rt_pfx_len;     /* 0-128 bits */
-   u_char    rt_type;        /* ip(1-4) != inet(1-5) */
-   u_char    rt_proto;       /* ip(enum 1-16) ?= inet(IANAipRouteProtocol 1-17) */
-
 #ifdef USING_IP_FORWARD_MIB_IPCIDRROUTETABLE_IPCIDRROUTETABLE_MODULE
    /** rt_info != inet_policy, because that would have made sense */
-   uint8_t   rt_info_len;    /* 0-128 oids */
    oid      *rt_info;        /* NULL should be interpreted as { 0, 0 } */
+#endif
 
+    /*
+     * addresses, in network byte order
+     */
+   u_char    rt_dest[NETSNMP_ACCESS_ROUTE_ADDR_BUF_SIZE];
+   u_char    rt_nexthop[NETSNMP_ACCESS_ROUTE_ADDR_BUF_SIZE];
+
+   int       flags; /* for net-snmp use */
+   u_int     generation;     /* for netsnmp_route_access users */
+
+#ifdef USING_IP_FORWARD_MIB_IPCIDRROUTETABLE_IPCIDRROUTETABLE_MODULE
    uint32_t  rt_mask;        /* ipv4 only */
    uint32_t  rt_tos;         /* Integer32 (0..2147483647) */
 #endif
@@ -76,6 +72,20 @@ typedef struct netsnmp_route_s {
    int32_t   rt_metric4;
    int32_t   rt_metric5;
 
+#ifdef USING_IP_FORWARD_MIB_INETCIDRROUTETABLE_INETCIDRROUTETABLE_MODULE
+   u_char    rt_policy_len;  /* 0-128 oids */
+#endif
+#ifdef USING_IP_FORWARD_MIB_IPCIDRROUTETABLE_IPCIDRROUTETABLE_MODULE
+   uint8_t   rt_info_len;    /* 0-128 oids */
+#endif
+   u_char    rt_dest_len;    /* 4 | 16 since we only do ipv4|ipv6 */
+   u_char    rt_dest_type;   /* InetAddressType 0-16 */
+   u_char    rt_nexthop_len; /* 4 | 16 since we only do ipv4|ipv6*/
+   u_char    rt_nexthop_type;/* InetAddressType 0-16 */
+   u_char    rt_pfx_len;     /* 0-128 bits */
+   u_char    rt_type;        /* ip(1-4) != inet(1-5) */
+   u_char    rt_proto;       /* ip(enum 1-16) ?= inet(IANAipRouteProtocol 1-17) */
+
 } netsnmp_route_entry;
 
 
@@ -119,6 +129,49 @@ int
 netsnmp_access_route_entry_copy(netsnmp_route_entry *lhs,
                                 netsnmp_route_entry *rhs);
 
+/*
+ * route access: keeps a table's container in step with the kernel.
+ *
+ * Every load hands the current routes, stamped with the access generation,
+ * to update_hook, and then calls gc_hook to drop the entries with an
+ * older generation. With NETSNMP_ACCESS_ROUTE_CREATE_SUBSCRIBE, where
+ * the architecture supports it, route changes are passed to update_hook
+ * as they happen (with NETSNMP_ACCESS_ROUTE_REMOVED set for deleted
+ * routes, and NETSNMP_ACCESS_ROUTE_REPLACE on the first next hop of a
+ * route replacing all entries for the same destination, prefix length,
+ * metric and policy), and loads are no-ops until the subscription is
+ * lost.
+ */
+struct netsnmp_route_access_s;
+typedef struct netsnmp_route_access_s netsnmp_route_access;
+
+typedef void (NetsnmpAccessRouteUpdate)(netsnmp_route_access *,
+                                        netsnmp_route_entry *);
+typedef void (NetsnmpAccessRouteGC)    (netsnmp_route_access *);
+
+struct netsnmp_route_access_s {
+    void *magic;
+    void *arch_magic;
+    u_int flags;
+    int synchronized;
+    unsigned generation;
+    NetsnmpAccessRouteUpdate *update_hook;
+    NetsnmpAccessRouteGC *gc_hook;
+    char *cache_expired;
+};
+
+netsnmp_route_access *
+netsnmp_access_route_create(u_int init_flags,
+                            NetsnmpAccessRouteUpdate *update_hook,
+                            NetsnmpAccessRouteGC *gc_hook,
+                            int *cache_flags, char *cache_expired);
+#define NETSNMP_ACCESS_ROUTE_CREATE_NOFLAGS             0x0000
+#define NETSNMP_ACCESS_ROUTE_CREATE_SUBSCRIBE           0x0001
+
+int netsnmp_access_route_delete(netsnmp_route_access *access);
+int netsnmp_access_route_load(netsnmp_route_access *access);
+int netsnmp_access_route_unload(netsnmp_route_access *access);
+
 /*
  * find entry in container
  */
@@ -141,6 +194,8 @@ netsnmp_access_route_entry_set(netsnmp_route_entry * entry);
 #define NETSNMP_ACCESS_ROUTE_CHANGE                         0x20000000
 #define NETSNMP_ACCESS_ROUTE_POLICY_STATIC                  0x10000000
 #define NETSNMP_ACCESS_ROUTE_POLICY_DEEP_COPY               0x08000000
+#define NETSNMP_ACCESS_ROUTE_REMOVED                        0x04000000
+#define NETSNMP_ACCESS_ROUTE_REPLACE                        0x02000000
 
 /* 
  * mask for change flag bits
@@ -85,6 +85,8 @@ extern "C" {
 
     void netsnmp_swrun_entry_free(netsnmp_swrun_entry *entry);
 
+    netsnmp_container *netsnmp_swrun_snapshot(u_int *generation);
+
     int  swrun_count_processes( int include_kthreads );
     int  swrun_max_processes(   void );
     int  swrun_count_processes_by_name( char *name );
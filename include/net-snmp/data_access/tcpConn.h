@@ -54,6 +54,24 @@ extern          "C" {
    
     } netsnmp_tcpconn_entry;
 
+/*
+ * netsnmp_tcpconn_snapshot
+ *   - connections read by netsnmp_access_tcpconn_snapshot_load, which
+ *     may run outside the agent's main thread
+ */
+    typedef struct netsnmp_tcpconn_snapshot_s {
+
+        netsnmp_tcpconn_entry **entries;   /* plain array, in load order */
+        size_t                  count;
+        size_t                  size;
+
+        u_int                   load_flags;
+        int                     rc;        /* arch load result */
+
+        netsnmp_container      *container; /* built from entries */
+
+    } netsnmp_tcpconn_snapshot;
+
 
 /**---------------------------------------------------------------------*/
 /*
@@ -82,6 +100,17 @@ extern          "C" {
 #define NETSNMP_ACCESS_TCPCONN_FREE_DONT_CLEAR            0x0001
 #define NETSNMP_ACCESS_TCPCONN_FREE_KEEP_CONTAINER        0x0002
 
+/*
+ * snapshot load (thread safe: no logging, no shared data), and turning
+ * it into a container (main thread only)
+ */
+    netsnmp_tcpconn_snapshot *
+    netsnmp_access_tcpconn_snapshot_load(u_int load_flags);
+    netsnmp_container *
+    netsnmp_access_tcpconn_snapshot_container(netsnmp_tcpconn_snapshot *snap);
+    void
+    netsnmp_access_tcpconn_snapshot_free(netsnmp_tcpconn_snapshot *snap);
+
 
 /*
  * create/free a tcpconn entry
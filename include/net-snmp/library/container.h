@@ -324,6 +324,34 @@ extern "C" {
     NETSNMP_IMPORT
     void  netsnmp_container_simple_free(void *data, void *context);
 
+    /*
+     * incremental update of a container from a fresh snapshot.
+     *
+     * The entries of the live container must start with a netsnmp_index.
+     * The fresh entries can be of any type; the key callback fills in
+     * the live index of a fresh entry (up to max_len sub-ids) and returns
+     * its length, or 0 to drop the entry.
+     */
+    typedef struct netsnmp_container_sync_ops_s {
+        /** build the live index of a fresh entry */
+        size_t (*key)(const void *fresh, oid *buf, size_t max_len,
+                      void *context);
+        /** refresh a live entry. return 1 if fresh was claimed */
+        int    (*update)(void *live, void *fresh, void *context);
+        /** make a live entry from (and claiming) a fresh one */
+        void * (*create)(void *fresh, void *context);
+        /** release a live entry that disappeared */
+        void   (*release)(void *live, void *context);
+        /** free a fresh entry nobody claimed */
+        void   (*free_fresh)(void *fresh, void *context);
+    } netsnmp_container_sync_ops;
+
+    NETSNMP_IMPORT
+    int netsnmp_container_sync(netsnmp_container *live,
+                               netsnmp_container *fresh,
+                               const netsnmp_container_sync_ops *ops,
+                               void *context);
+
 /*
  * container optionflags
  */
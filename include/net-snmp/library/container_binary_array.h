@@ -39,6 +39,15 @@ extern          "C" {
 
     int netsnmp_binary_array_options_set(netsnmp_container *c, int set, u_int flags);
 
+    /*
+     * load many entries at once: inserts between these just append,
+     * and the array is sorted and de-duplicated once at the end.
+     */
+    int netsnmp_binary_array_bulk_begin(netsnmp_container *c);
+    int netsnmp_binary_array_bulk_end(netsnmp_container *c,
+                                      netsnmp_container_obj_func *dup_free,
+                                      void *context);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,62 @@
+/*
+ * container_hash.h
+ * $Id$
+ *
+ */
+#ifndef NETSNMP_CONTAINER_HASH_H
+#define NETSNMP_CONTAINER_HASH_H
+
+
+#include <net-snmp/library/container.h>
+#include <net-snmp/library/factory.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * function returning a hash of an object. Objects which compare
+     * equal must hash to the same value.
+     */
+    typedef u_int (netsnmp_container_hash)(const void *data);
+
+    /*
+     * get a container which finds entries through a hash table, and
+     * keeps a sorted index (built when needed) for find_next, get_subset
+     * and iterators.
+     */
+    netsnmp_container *netsnmp_container_get_hash(void);
+
+    /*
+     * get a factory for producing hash containers
+     */
+    netsnmp_factory   *netsnmp_container_get_hash_factory(void);
+
+    /*
+     * set the hash function. Not needed if compare is
+     * netsnmp_compare_netsnmp_index, netsnmp_compare_cstring or
+     * netsnmp_compare_direct_cstring. Must be called while the
+     * container is empty.
+     */
+    int netsnmp_container_hash_set_func(netsnmp_container *c,
+                                        netsnmp_container_hash *hash);
+
+    /*
+     * hash functions matching the common comparison routines
+     */
+    u_int netsnmp_hash_netsnmp_index(const void *data);
+    u_int netsnmp_hash_cstring(const void *data);
+    u_int netsnmp_hash_direct_cstring(const void *data);
+
+    /*
+     * initialize hash container. call at startup.
+     */
+    NETSNMP_IMPORT
+    void netsnmp_container_hash_init(void);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /** NETSNMP_CONTAINER_HASH_H */
@@ -33,6 +33,8 @@ extern          "C" {
         struct config_files *next;
     };
 
+    struct read_config_applied;
+
     struct config_line {
         char           *config_token;   /* Label for each line parser
                                          * in the given file. */
@@ -41,6 +43,11 @@ extern          "C" {
         struct config_line *next;
         char            config_time;    /* {NORMAL,PREMIB,EITHER}_CONFIG */
         char           *help;
+        void            (*remove_line) (const char *, char *);  /* undoes
+                                         * parse_line, for rereads */
+        struct read_config_applied *applied;    /* lines given to
+                                                 * parse_line, if
+                                                 * remove_line is set */
     };
 
     struct read_config_memory {
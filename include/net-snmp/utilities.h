@@ -54,6 +54,8 @@
 #include <net-snmp/library/container.h>
 #include <net-snmp/library/container_binary_array.h>
 #include <net-snmp/library/container_list_ssll.h>
+#include <net-snmp/library/container_btree.h>
+#include <net-snmp/library/container_hash.h>
 #include <net-snmp/library/container_iterator.h>
 
 #include <net-snmp/library/snmp_assert.h>
@@ -15,6 +15,8 @@
 #include <net-snmp/library/container_binary_array.h>
 #include <net-snmp/library/container_list_ssll.h>
 #include <net-snmp/library/container_null.h>
+#include <net-snmp/library/container_btree.h>
+#include <net-snmp/library/container_hash.h>
 
 netsnmp_feature_child_of(container_all, libnetsnmp)
 
@@ -24,6 +26,7 @@ netsnmp_feature_child_of(container_compare, container_all)
 netsnmp_feature_child_of(container_dup, container_all)
 netsnmp_feature_child_of(container_free_all, container_all)
 netsnmp_feature_child_of(subcontainer_find, container_all)
+netsnmp_feature_child_of(container_sync, container_all)
 
 netsnmp_feature_child_of(container_ncompare_cstring, container_compare)
 netsnmp_feature_child_of(container_compare_mem, container_compare)
@@ -93,6 +96,12 @@ netsnmp_container_init_list(void)
 #ifndef NETSNMP_FEATURE_REMOVE_CONTAINER_NULL
     netsnmp_container_null_init();
 #endif /* NETSNMP_FEATURE_REMOVE_CONTAINER_NULL */
+#ifndef NETSNMP_FEATURE_REMOVE_CONTAINER_BTREE
+    netsnmp_container_btree_init();
+#endif /* NETSNMP_FEATURE_REMOVE_CONTAINER_BTREE */
+#ifndef NETSNMP_FEATURE_REMOVE_CONTAINER_HASH
+    netsnmp_container_hash_init();
+#endif /* NETSNMP_FEATURE_REMOVE_CONTAINER_HASH */
 
     /*
      * default aliases for some containers
@@ -719,3 +728,188 @@ netsnmp_container_simple_free(void *data, void *context)
                 data, context));
     free((void*)data); /* SNMP_FREE wasted on param */
 }
+
+#ifndef NETSNMP_FEATURE_REMOVE_CONTAINER_SYNC
+/*------------------------------------------------------------------
+ * netsnmp_container_sync
+ *
+ * bring a live container in line with a fresh snapshot of the same
+ * data, without rebuilding it. Fresh entries are matched to live ones
+ * by index: matching live entries are handed to ops->update and stay
+ * where they are, live entries with no match are removed and released,
+ * and fresh entries with no match are turned into new live entries by
+ * ops->create. Fresh entries which weren't claimed are passed to
+ * ops->free_fresh; the caller still has to free the fresh container
+ * itself, without clearing it.
+ *
+ * returns 0 on success, or -1 if the working storage couldn't be
+ * allocated. Neither container has been touched in that case.
+ */
+typedef struct _sync_slot_s {
+    netsnmp_index  idx;     /* must be first */
+    void          *fresh;
+    int            matched;
+} _sync_slot;
+
+typedef struct _sync_state_s {
+    const netsnmp_container_sync_ops *ops;
+    void          *context;
+    _sync_slot    *slots;
+    size_t         count;
+    oid           *pool;
+    size_t         pool_used, pool_size;
+    void         **stale;
+    size_t         stale_count;
+    size_t         updated;
+    int            failed;
+} _sync_state;
+
+static void
+_sync_collect(void *data, void *context)
+{
+    _sync_state *st = (_sync_state *) context;
+    _sync_slot  *slot;
+    size_t       len;
+
+    if (st->failed)
+        return;
+    if (st->pool_size - st->pool_used < MAX_OID_LEN) {
+        oid *pool = (oid *) realloc(st->pool, (st->pool_size * 2 + MAX_OID_LEN)
+                                    * sizeof(oid));
+        if (NULL == pool) {
+            st->failed = 1;
+            return;
+        }
+        st->pool = pool;
+        st->pool_size = st->pool_size * 2 + MAX_OID_LEN;
+    }
+    slot = &st->slots[st->count];
+    len = st->ops->key(data, st->pool + st->pool_used, MAX_OID_LEN,
+                       st->context);
+    slot->fresh = data;
+    slot->matched = 0;
+    slot->idx.len = len;
+    /** offset into the pool until it stops moving */
+    slot->idx.oids = (oid *) (uintptr_t) st->pool_used;
+    st->pool_used += len;
+    ++st->count;
+}
+
+static int
+_sync_slot_compare(const void *lhs, const void *rhs)
+{
+    return snmp_oid_compare(((const _sync_slot *) lhs)->idx.oids,
+                            ((const _sync_slot *) lhs)->idx.len,
+                            ((const _sync_slot *) rhs)->idx.oids,
+                            ((const _sync_slot *) rhs)->idx.len);
+}
+
+static void
+_sync_match(void *data, void *context)
+{
+    _sync_state *st = (_sync_state *) context;
+    _sync_slot  *slot;
+
+    slot = (_sync_slot *) bsearch(data, st->slots, st->count,
+                                  sizeof(_sync_slot), _sync_slot_compare);
+    if (NULL == slot) {
+        st->stale[st->stale_count++] = data;
+        return;
+    }
+    slot->matched = 1;
+    if (st->ops->update && st->ops->update(data, slot->fresh, st->context))
+        slot->fresh = NULL;
+    ++st->updated;
+}
+
+int
+netsnmp_container_sync(netsnmp_container *live, netsnmp_container *fresh,
+                       const netsnmp_container_sync_ops *ops, void *context)
+{
+    _sync_state st;
+    size_t      i, j, added = 0;
+    void       *entry;
+
+    if ((NULL == live) || (NULL == fresh) || (NULL == ops) ||
+        (NULL == ops->key) || (NULL == ops->create))
+        return -1;
+
+    memset(&st, 0x0, sizeof(st));
+    st.ops = ops;
+    st.context = context;
+    st.slots = (_sync_slot *) malloc((CONTAINER_SIZE(fresh) + 1) *
+                                     sizeof(_sync_slot));
+    st.stale = (void **) malloc((CONTAINER_SIZE(live) + 1) * sizeof(void *));
+    if ((NULL == st.slots) || (NULL == st.stale)) {
+        free(st.slots);
+        free(st.stale);
+        return -1;
+    }
+
+    /*
+     * build the live index of every fresh entry, then sort them so
+     * live entries can be looked up with a binary search.
+     */
+    CONTAINER_FOR_EACH(fresh, _sync_collect, &st);
+    if (st.failed) {
+        free(st.slots);
+        free(st.stale);
+        free(st.pool);
+        return -1;
+    }
+    for (i = 0; i < st.count; ++i)
+        st.slots[i].idx.oids = st.pool + (uintptr_t) st.slots[i].idx.oids;
+
+    qsort(st.slots, st.count, sizeof(_sync_slot), _sync_slot_compare);
+    for (i = 0, j = 0; i < st.count; ++i) {
+        if ((0 == st.slots[i].idx.len) ||
+            ((j > 0) && (0 == _sync_slot_compare(&st.slots[j - 1],
+                                                 &st.slots[i])))) {
+            DEBUGMSGTL(("container:sync", "dropping fresh entry %p\n",
+                        st.slots[i].fresh));
+            if (ops->free_fresh)
+                ops->free_fresh(st.slots[i].fresh, context);
+            continue;
+        }
+        st.slots[j++] = st.slots[i];
+    }
+    st.count = j;
+
+    /*
+     * refresh the live entries still present, and remember the others
+     */
+    CONTAINER_FOR_EACH(live, _sync_match, &st);
+    for (i = 0; i < st.stale_count; ++i) {
+        CONTAINER_REMOVE(live, st.stale[i]);
+        if (ops->release)
+            ops->release(st.stale[i], context);
+    }
+
+    /*
+     * add the new entries, and get rid of the unclaimed ones
+     */
+    for (i = 0; i < st.count; ++i) {
+        if (!st.slots[i].matched) {
+            entry = ops->create(st.slots[i].fresh, context);
+            if (NULL == entry)
+                continue;
+            if (CONTAINER_INSERT(live, entry)) {
+                if (ops->release)
+                    ops->release(entry, context);
+                continue;
+            }
+            ++added;
+        } else if (st.slots[i].fresh && ops->free_fresh)
+            ops->free_fresh(st.slots[i].fresh, context);
+    }
+
+    DEBUGMSGTL(("container:sync", "%" NETSNMP_PRIz "d kept, %"
+                NETSNMP_PRIz "d added, %" NETSNMP_PRIz "d removed\n",
+                st.updated, added, st.stale_count));
+
+    free(st.slots);
+    free(st.stale);
+    free(st.pool);
+    return 0;
+}
+#endif /* NETSNMP_FEATURE_REMOVE_CONTAINER_SYNC */
@@ -37,6 +37,9 @@ typedef struct binary_array_table_s {
     size_t                     max_size;   /* Size of the current data table */
     size_t                     count;      /* Index of the next free entry */
     int                        dirty;
+    int                        bulk;       /* Bulk load in progress */
+    size_t                     sorted;     /* Entries known sorted in bulk */
+    size_t                     appended;   /* Entries appended in bulk */
     void                     **data;       /* The table itself */
 } binary_array_table;
 
@@ -47,6 +50,7 @@ typedef struct binary_array_iterator_s {
 } binary_array_iterator;
 
 static netsnmp_iterator *_ba_iterator_get(netsnmp_container *c);
+static int _ba_insert(netsnmp_container *container, const void *data);
 
 /**********************************************************************
  *
@@ -90,6 +94,45 @@ array_qsort(void **data, int first, int last, netsnmp_container_compare *f)
         array_qsort(data, i, last, f);
 }
 
+/*
+ * sort the entries appended during a bulk load on their own, then merge
+ * them with the sorted ones before them.  On equal keys the older entry
+ * comes first, which is what netsnmp_binary_array_bulk_end() relies on.
+ */
+static void
+_ba_merge_appended(netsnmp_container *c)
+{
+    binary_array_table *t = (binary_array_table*)c->container_data;
+    size_t             i, j, k, sorted;
+    void             **merged;
+
+    sorted = t->sorted;
+    if (t->count - sorted > 1)
+        array_qsort(t->data, sorted, t->count - 1, c->compare);
+
+    if (sorted > 0 && sorted < t->count &&
+        c->compare(t->data[sorted - 1], t->data[sorted]) >= 0) {
+        merged = (void**) malloc(t->count * sizeof(void*));
+        if (NULL == merged) {
+            /* fall back to sorting the lot */
+            array_qsort(t->data, 0, t->count - 1, c->compare);
+        } else {
+            for (i = 0, j = sorted, k = 0; i < sorted && j < t->count; )
+                merged[k++] = (c->compare(t->data[i], t->data[j]) <= 0) ?
+                    t->data[i++] : t->data[j++];
+            while (i < sorted)
+                merged[k++] = t->data[i++];
+            while (j < t->count)
+                merged[k++] = t->data[j++];
+            free(t->data);
+            t->data = merged;
+            t->max_size = t->count;
+        }
+    }
+    t->dirty = 0;
+    t->sorted = t->count;
+}
+
 static int
 Sort_Array(netsnmp_container *c)
 {
@@ -102,11 +145,17 @@ Sort_Array(netsnmp_container *c)
 
     if (t->dirty) {
         /*
-         * Sort the table 
+         * Sort the table.  Mid bulk load, duplicates are still in there;
+         * keep the older entries first so the dedupe keeps them.
          */
-        if (t->count > 1)
-            array_qsort(t->data, 0, t->count - 1, c->compare);
-        t->dirty = 0;
+        if (t->bulk)
+            _ba_merge_appended(c);
+        else {
+            if (t->count > 1)
+                array_qsort(t->data, 0, t->count - 1, c->compare);
+            t->dirty = 0;
+            t->sorted = t->count;
+        }
 
         /*
          * no way to know if it actually changed... just assume so.
@@ -327,6 +376,9 @@ netsnmp_binary_array_remove_at(netsnmp_container *c, size_t index, void **save)
     if (save)
         *save = t->data[index];
 
+    if (index < t->sorted)
+        --t->sorted;
+
     /*
      * if entry was last item, just decrement count
      */
@@ -404,62 +456,228 @@ netsnmp_binary_array_clear(netsnmp_container *c,
 
     t->count = 0;
     t->dirty = 0;
+    t->sorted = 0;
+    t->appended = 0;
     ++c->sync;
 }
 
+static int
+_ba_resize(binary_array_table *t, size_t min_size)
+{
+    size_t new_max;
+    void **new_data;
+
+    if (t->max_size >= min_size)
+        return 0;
+
+    /*
+     * Table is full, so extend it to double the size, or use 10 elements
+     * if it is empty.
+     */
+    new_max = t->max_size > 0 ? 2 * t->max_size : 10;
+    if (new_max < min_size)
+        new_max = min_size;
+    new_data = (void**) realloc(t->data, new_max * sizeof(void*));
+    if (new_data == NULL)
+        return -1;
+
+    memset(new_data + t->max_size, 0x0,
+           (new_max - t->max_size) * sizeof(void*));
+
+    t->data = new_data;
+    t->max_size = new_max;
+    return 0;
+}
+
+/*
+ * position at which entry should be inserted into the sorted array:
+ * after any equal entries, and set *found if there were some.
+ */
+static size_t
+_ba_insert_position(netsnmp_container *c, const void *entry, int *found)
+{
+    binary_array_table *t = (binary_array_table*)c->container_data;
+    size_t             first = 0, len = t->count, half;
+    int                result;
+
+    *found = 0;
+
+    /*
+     * loaders mostly insert in order, so check the end first
+     */
+    if (len == 0)
+        return 0;
+    result = c->compare(t->data[len - 1], entry);
+    if (result < 0)
+        return len;
+    if (result == 0) {
+        *found = 1;
+        return len;
+    }
+
+    while (len > 0) {
+        half = len >> 1;
+        result = c->compare(t->data[first + half], entry);
+        if (result <= 0) {
+            if (result == 0)
+                *found = 1;
+            first += half + 1;
+            len -= half + 1;
+        } else
+            len = half;
+    }
+    return first;
+}
+
 NETSNMP_STATIC_INLINE int
 netsnmp_binary_array_insert(netsnmp_container *c, const void *entry)
 {
     binary_array_table *t = (binary_array_table*)c->container_data;
-    int             was_dirty = 0;
+    size_t          pos;
+    int             found;
+
     /*
-     * check for duplicates
+     * during a bulk load, or for unsorted arrays, just append and let
+     * a later sort (or linear search) deal with it
      */
-    if (! (c->flags & CONTAINER_KEY_ALLOW_DUPLICATES)) {
-        was_dirty = t->dirty;
-        if (NULL != netsnmp_binary_array_get(c, entry, 1)) {
+    if (t->bulk || (c->flags & CONTAINER_KEY_UNSORTED)) {
+        if ((c->flags & CONTAINER_KEY_UNSORTED) &&
+            !(c->flags & CONTAINER_KEY_ALLOW_DUPLICATES) &&
+            linear_search(entry, c) != -1) {
             DEBUGMSGTL(("container","not inserting duplicate key\n"));
             return -1;
         }
+        if (_ba_resize(t, t->count + 1) < 0)
+            return -1;
+        t->data[t->count++] = NETSNMP_REMOVE_CONST(void *, entry);
+        t->dirty = 1;
+        if (t->bulk)
+            ++t->appended;
+        ++c->sync;
+        return 0;
     }
-    
+
+    if (t->dirty)
+        Sort_Array(c);
+
     /*
-     * check if we need to resize the array
+     * find the slot, checking for duplicates on the way
      */
-    if (t->max_size <= t->count) {
-        /*
-         * Table is full, so extend it to double the size, or use 10 elements
-         * if it is empty.
-         */
-        size_t const new_max = t->max_size > 0 ? 2 * t->max_size : 10;
-        void ** const new_data =
-            (void**) realloc(t->data, new_max * sizeof(void*));
+    pos = _ba_insert_position(c, entry, &found);
+    if (found && !(c->flags & CONTAINER_KEY_ALLOW_DUPLICATES)) {
+        DEBUGMSGTL(("container","not inserting duplicate key\n"));
+        return -1;
+    }
 
-        if (new_data == NULL)
-            return -1;
+    if (_ba_resize(t, t->count + 1) < 0)
+        return -1;
 
-        memset(new_data + t->max_size, 0x0,
-               (new_max - t->max_size) * sizeof(void*));
+    /*
+     * Insert the new entry into the data array, keeping it sorted
+     */
+    if (pos < t->count)
+        memmove(&t->data[pos + 1], &t->data[pos],
+                sizeof(void*) * (t->count - pos));
+    t->data[pos] = NETSNMP_REMOVE_CONST(void *, entry);
+    ++t->count;
+    t->sorted = t->count;
+    ++c->sync;
 
-        t->data = new_data;
-        t->max_size = new_max;
-    }
+    return 0;
+}
+
+/**
+ * Starts loading a lot of entries into a binary_array container.
+ *
+ * Until netsnmp_binary_array_bulk_end() is called, inserts just append to
+ * the array, without sorting or checking for duplicates.  Lookups still
+ * work, but sort the entries added so far into the array.
+ *
+ * @return 0, or -1 if c is not a binary_array (in which case inserts
+ *         carry on as normal).
+ */
+int
+netsnmp_binary_array_bulk_begin(netsnmp_container *c)
+{
+    binary_array_table *t;
+
+    if (NULL == c || c->insert != _ba_insert)
+        return -1;
 
+    t = (binary_array_table*)c->container_data;
+    if (!t->dirty)
+        t->sorted = t->count;
+    t->appended = 0;
+    t->bulk = 1;
+    return 0;
+}
+
+/**
+ * Finishes a bulk load: sorts the entries added since
+ * netsnmp_binary_array_bulk_begin(), merges them with the existing ones
+ * and, unless the container allows duplicates, drops all but one entry
+ * for each key.
+ *
+ * An entry which was already in the container wins over new ones with
+ * the same key; which of several new ones is kept is not specified.
+ *
+ * @param dup_free  if non-NULL, called for each entry dropped as a
+ *                  duplicate, e.g. to free it
+ * @param context   passed to dup_free
+ *
+ * @return the number of duplicates dropped, or -1 if c is not a
+ *         binary_array or no memory was available for the merge.
+ */
+int
+netsnmp_binary_array_bulk_end(netsnmp_container *c,
+                              netsnmp_container_obj_func *dup_free,
+                              void *context)
+{
+    binary_array_table *t;
+    size_t             i, j;
+    int                dropped = 0;
+
+    if (NULL == c || c->insert != _ba_insert)
+        return -1;
+
+    t = (binary_array_table*)c->container_data;
+    t->bulk = 0;
     /*
-     * Insert the new entry into the data array
+     * a lookup during the load may have sorted the new entries in
+     * already, so go by what was appended rather than by dirty
      */
-    t->data[t->count++] = NETSNMP_REMOVE_CONST(void *, entry);
-    t->dirty = 1;
+    if (!t->appended || (c->flags & CONTAINER_KEY_UNSORTED)) {
+        t->appended = 0;
+        t->sorted = t->count;
+        return 0;
+    }
+    t->appended = 0;
+
+    if (t->dirty)
+        _ba_merge_appended(c);
 
     /*
-     * if array was dirty before we called get, sync was incremented when
-     * get called SortArray. If we didn't call get or the array wasn't dirty,
-     * bump sync now.
+     * one pass to drop duplicates
      */
-    if (!was_dirty)
-        ++c->sync;
+    if (!(c->flags & CONTAINER_KEY_ALLOW_DUPLICATES) && t->count > 1) {
+        for (i = 0, j = 1; j < t->count; ++j) {
+            if (c->compare(t->data[i], t->data[j]) == 0) {
+                if (dup_free)
+                    (*dup_free) (t->data[j], context);
+                ++dropped;
+                continue;
+            }
+            t->data[++i] = t->data[j];
+        }
+        if (dropped)
+            DEBUGMSGTL(("container", "dropped %d duplicate keys from %s\n",
+                        dropped, c->container_name ? c->container_name : ""));
+        t->count = i + 1;
+    }
+    t->sorted = t->count;
+    ++c->sync;
 
-    return 0;
+    return dropped;
 }
 
 /**********************************************************************
@@ -667,6 +885,8 @@ _ba_duplicate(netsnmp_container *c, void *ctx, u_int flags)
     dupt->max_size = t->max_size;
     dupt->count = t->count;
     dupt->dirty = t->dirty;
+    dupt->sorted = t->sorted;
+    dupt->appended = t->appended;
 
     /*
      * shallow copy
@@ -792,7 +1012,14 @@ _ba_iterator_curr(binary_array_iterator *it)
 static void *
 _ba_iterator_first(binary_array_iterator *it)
 {
-    return _ba_iterator_position(it, 0);
+    if(NULL == it) {
+        netsnmp_assert(NULL != it);
+        return NULL;
+    }
+
+    it->pos = 0;
+
+    return _ba_iterator_position(it, it->pos);
 }
 
 static void *
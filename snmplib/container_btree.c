@@ -0,0 +1,964 @@
+/*
+ * container_btree.c
+ * $Id$
+ *
+ * A B+tree container. All entries live in the leaves, which are linked
+ * to each other so that find_next, get_subset and iterators just walk
+ * along them. Inner nodes only hold separators: separator i is the
+ * smallest entry in the subtree of child i+1. Each node holds up to
+ * BTREE_ORDER pointers in one array, so a lookup touches a handful of
+ * small contiguous arrays, and an insert or remove never moves more
+ * than one node's worth of pointers.
+ */
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-features.h>
+
+#include <stdio.h>
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#if HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+#include <sys/types.h>
+#if HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/types.h>
+#include <net-snmp/library/snmp_api.h>
+#include <net-snmp/library/container.h>
+#include <net-snmp/library/tools.h>
+#include <net-snmp/library/snmp_assert.h>
+
+#include <net-snmp/library/container_btree.h>
+
+netsnmp_feature_child_of(container_btree, container_types)
+
+#ifndef NETSNMP_FEATURE_REMOVE_CONTAINER_BTREE
+
+#define BTREE_ORDER      64                /* max keys per node */
+#define BTREE_MIN        (BTREE_ORDER / 2) /* min keys per non-root node */
+#define BTREE_MAX_DEPTH  16                /* enough for 32^16 entries */
+
+typedef struct btree_inner_s btree_inner;
+
+typedef struct btree_node_s {
+    btree_inner         *parent;
+    u_short              leaf;
+    u_short              count;
+    void                *key[BTREE_ORDER];
+} btree_node;
+
+typedef struct btree_leaf_s {
+    btree_node           n;
+    struct btree_leaf_s *prev;
+    struct btree_leaf_s *next;
+} btree_leaf;
+
+struct btree_inner_s {
+    btree_node           n;
+    btree_node          *child[BTREE_ORDER + 1];
+};
+
+typedef struct btree_container_s {
+    netsnmp_container    c;
+
+    size_t               count;      /* number of entries */
+    btree_node          *root;
+    btree_leaf          *head;       /* leftmost leaf */
+    btree_leaf          *tail;       /* rightmost leaf */
+} btree_container;
+
+typedef struct btree_iterator_s {
+    netsnmp_iterator     base;
+
+    btree_leaf          *leaf;
+    int                  pos;
+} btree_iterator;
+
+static netsnmp_iterator *_bt_iterator_get(netsnmp_container *c);
+
+
+/**********************************************************************
+ *
+ * tree maintenance
+ *
+ **********************************************************************/
+/*
+ * index of the first key in a node which is >= data, or > data if
+ * upper is set.
+ */
+NETSNMP_STATIC_INLINE int
+_bt_search(btree_node *n, const void *data, netsnmp_container_compare *cmp,
+           int upper)
+{
+    int first = 0, len = n->count, half, rc;
+
+    while (len > 0) {
+        half = len >> 1;
+        rc = (*cmp)(n->key[first + half], data);
+        if ((rc < 0) || (upper && (rc == 0))) {
+            first += half + 1;
+            len -= half + 1;
+        } else
+            len = half;
+    }
+    return first;
+}
+
+/*
+ * find the leaf that data belongs in, and its position there.
+ */
+static btree_leaf *
+_bt_descend(btree_container *bt, const void *data,
+            netsnmp_container_compare *cmp, int upper, int *pos)
+{
+    btree_node *n = bt->root;
+
+    while (!n->leaf)
+        n = ((btree_inner *)n)->child[_bt_search(n, data, cmp, upper)];
+    *pos = _bt_search(n, data, cmp, upper);
+    return (btree_leaf *)n;
+}
+
+/*
+ * like _bt_descend, but moves on to the next leaf if data is past the
+ * end of the one it belongs in. Returns NULL if there's no such entry.
+ */
+static btree_leaf *
+_bt_seek(btree_container *bt, const void *data,
+         netsnmp_container_compare *cmp, int upper, int *pos)
+{
+    btree_leaf *leaf;
+
+    if (NULL == bt->root)
+        return NULL;
+
+    leaf = _bt_descend(bt, data, cmp, upper, pos);
+    if (*pos == leaf->n.count) {
+        *pos = 0;
+        leaf = leaf->next;
+    }
+    return leaf;
+}
+
+NETSNMP_STATIC_INLINE btree_leaf *
+_bt_step(btree_leaf *leaf, int *pos)
+{
+    if (++*pos < leaf->n.count)
+        return leaf;
+    *pos = 0;
+    return leaf->next;
+}
+
+NETSNMP_STATIC_INLINE int
+_bt_child_index(btree_inner *p, btree_node *n)
+{
+    int i;
+
+    for (i = 0; i <= p->n.count; ++i)
+        if (p->child[i] == n)
+            return i;
+    netsnmp_assert(i <= p->n.count);
+    return 0;
+}
+
+/*
+ * the smallest entry in a leaf changed: update the separator which
+ * refers to it, if there is one.
+ */
+static void
+_bt_fix_min(btree_leaf *leaf)
+{
+    btree_node *n = &leaf->n;
+    int         i;
+
+    if (0 == leaf->n.count)
+        return;
+
+    for (; n->parent; n = &n->parent->n) {
+        i = _bt_child_index(n->parent, n);
+        if (i > 0) {
+            n->parent->n.key[i - 1] = leaf->n.key[0];
+            return;
+        }
+    }
+}
+
+/*
+ * remove separator i and child i+1 from an inner node
+ */
+static void
+_bt_remove_child(btree_inner *p, int i)
+{
+    memmove(&p->n.key[i], &p->n.key[i + 1],
+            (p->n.count - i - 1) * sizeof(void *));
+    memmove(&p->child[i + 1], &p->child[i + 2],
+            (p->n.count - i - 1) * sizeof(btree_node *));
+    --p->n.count;
+}
+
+/*
+ * hook a new right sibling into the tree, splitting parents as needed.
+ * The caller has already allocated any inner nodes this will need.
+ */
+static void
+_bt_insert_parent(btree_container *bt, btree_node *left, void *sep,
+                  btree_node *right, btree_inner **spare, int *nspare)
+{
+    btree_inner *p = left->parent, *q;
+    void        *keys[BTREE_ORDER + 1];
+    btree_node  *child[BTREE_ORDER + 2];
+    int          i;
+
+    if (NULL == p) {
+        /*
+         * new root
+         */
+        p = spare[--*nspare];
+        p->n.count = 1;
+        p->n.key[0] = sep;
+        p->child[0] = left;
+        p->child[1] = right;
+        left->parent = right->parent = p;
+        bt->root = &p->n;
+        return;
+    }
+
+    i = _bt_child_index(p, left);
+    if (p->n.count < BTREE_ORDER) {
+        memmove(&p->n.key[i + 1], &p->n.key[i],
+                (p->n.count - i) * sizeof(void *));
+        memmove(&p->child[i + 2], &p->child[i + 1],
+                (p->n.count - i) * sizeof(btree_node *));
+        p->n.key[i] = sep;
+        p->child[i + 1] = right;
+        right->parent = p;
+        ++p->n.count;
+        return;
+    }
+
+    /*
+     * full: split in half, and push the middle separator up
+     */
+    memcpy(keys, p->n.key, i * sizeof(void *));
+    keys[i] = sep;
+    memcpy(&keys[i + 1], &p->n.key[i], (BTREE_ORDER - i) * sizeof(void *));
+    memcpy(child, p->child, (i + 1) * sizeof(btree_node *));
+    child[i + 1] = right;
+    memcpy(&child[i + 2], &p->child[i + 1],
+           (BTREE_ORDER - i) * sizeof(btree_node *));
+
+    q = spare[--*nspare];
+    p->n.count = BTREE_MIN;
+    memcpy(p->n.key, keys, BTREE_MIN * sizeof(void *));
+    memcpy(p->child, child, (BTREE_MIN + 1) * sizeof(btree_node *));
+    for (i = 0; i <= BTREE_MIN; ++i)
+        p->child[i]->parent = p;
+
+    q->n.count = BTREE_ORDER - BTREE_MIN;
+    memcpy(q->n.key, &keys[BTREE_MIN + 1], q->n.count * sizeof(void *));
+    memcpy(q->child, &child[BTREE_MIN + 1],
+           (q->n.count + 1) * sizeof(btree_node *));
+    for (i = 0; i <= q->n.count; ++i)
+        q->child[i]->parent = q;
+
+    _bt_insert_parent(bt, &p->n, keys[BTREE_MIN], &q->n, spare, nspare);
+}
+
+static void
+_bt_rebalance_inner(btree_container *bt, btree_inner *n)
+{
+    btree_inner *p = n->n.parent, *left, *right;
+    int          i;
+
+    if (NULL == p) {
+        /*
+         * the root goes away once it's down to a single child
+         */
+        if (0 == n->n.count) {
+            bt->root = n->child[0];
+            bt->root->parent = NULL;
+            free(n);
+        }
+        return;
+    }
+    if (n->n.count >= BTREE_MIN)
+        return;
+
+    i = _bt_child_index(p, &n->n);
+    if (i > 0) {
+        left = (btree_inner *)p->child[--i];
+        right = n;
+    } else {
+        left = n;
+        right = (btree_inner *)p->child[1];
+    }
+
+    if (left->n.count + right->n.count + 1 <= BTREE_ORDER) {
+        /*
+         * merge right, and the separator between them, into left
+         */
+        left->n.key[left->n.count] = p->n.key[i];
+        memcpy(&left->n.key[left->n.count + 1], right->n.key,
+               right->n.count * sizeof(void *));
+        memcpy(&left->child[left->n.count + 1], right->child,
+               (right->n.count + 1) * sizeof(btree_node *));
+        left->n.count += right->n.count + 1;
+        for (i = 0; i <= left->n.count; ++i)
+            left->child[i]->parent = left;
+        _bt_remove_child(p, _bt_child_index(p, &right->n) - 1);
+        free(right);
+        _bt_rebalance_inner(bt, p);
+    } else if (left->n.count < right->n.count) {
+        /*
+         * rotate the first child of right over to left
+         */
+        left->n.key[left->n.count] = p->n.key[i];
+        left->child[left->n.count + 1] = right->child[0];
+        right->child[0]->parent = left;
+        ++left->n.count;
+        p->n.key[i] = right->n.key[0];
+        memmove(right->n.key, &right->n.key[1],
+                (right->n.count - 1) * sizeof(void *));
+        memmove(right->child, &right->child[1],
+                right->n.count * sizeof(btree_node *));
+        --right->n.count;
+    } else {
+        /*
+         * rotate the last child of left over to right
+         */
+        memmove(&right->n.key[1], right->n.key,
+                right->n.count * sizeof(void *));
+        memmove(&right->child[1], right->child,
+                (right->n.count + 1) * sizeof(btree_node *));
+        right->n.key[0] = p->n.key[i];
+        right->child[0] = left->child[left->n.count];
+        right->child[0]->parent = right;
+        ++right->n.count;
+        p->n.key[i] = left->n.key[left->n.count - 1];
+        --left->n.count;
+    }
+}
+
+static void
+_bt_rebalance_leaf(btree_container *bt, btree_leaf *leaf)
+{
+    btree_inner *p = leaf->n.parent;
+    btree_leaf  *left, *right;
+    int          i, move;
+
+    i = _bt_child_index(p, &leaf->n);
+    if (i > 0) {
+        left = (btree_leaf *)p->child[--i];
+        right = leaf;
+    } else {
+        left = leaf;
+        right = (btree_leaf *)p->child[1];
+    }
+
+    if (left->n.count + right->n.count <= BTREE_ORDER) {
+        /*
+         * merge right into left
+         */
+        memcpy(&left->n.key[left->n.count], right->n.key,
+               right->n.count * sizeof(void *));
+        left->n.count += right->n.count;
+        left->next = right->next;
+        if (right->next)
+            right->next->prev = left;
+        else
+            bt->tail = left;
+        _bt_remove_child(p, i);
+        free(right);
+        if (left == leaf)
+            _bt_fix_min(left);
+        _bt_rebalance_inner(bt, p);
+        return;
+    }
+
+    /*
+     * even the two out
+     */
+    if (left->n.count < right->n.count) {
+        move = (right->n.count - left->n.count) / 2;
+        memcpy(&left->n.key[left->n.count], right->n.key,
+               move * sizeof(void *));
+        memmove(right->n.key, &right->n.key[move],
+                (right->n.count - move) * sizeof(void *));
+        left->n.count += move;
+        right->n.count -= move;
+    } else {
+        move = (left->n.count - right->n.count) / 2;
+        memmove(&right->n.key[move], right->n.key,
+                right->n.count * sizeof(void *));
+        memcpy(right->n.key, &left->n.key[left->n.count - move],
+               move * sizeof(void *));
+        left->n.count -= move;
+        right->n.count += move;
+    }
+    p->n.key[i] = right->n.key[0];
+    if (left == leaf)
+        _bt_fix_min(left);
+}
+
+static void
+_bt_remove_at(btree_container *bt, btree_leaf *leaf, int pos)
+{
+    --leaf->n.count;
+    memmove(&leaf->n.key[pos], &leaf->n.key[pos + 1],
+            (leaf->n.count - pos) * sizeof(void *));
+    --bt->count;
+    ++bt->c.sync;
+
+    /*
+     * the entry might have been a separator; replace it before
+     * rebalancing moves separators around.
+     */
+    if (0 == pos)
+        _bt_fix_min(leaf);
+
+    if (NULL == leaf->n.parent) {
+        if (0 == leaf->n.count) {
+            free(leaf);
+            bt->root = NULL;
+            bt->head = bt->tail = NULL;
+        }
+        return;
+    }
+    if (leaf->n.count < BTREE_MIN)
+        _bt_rebalance_leaf(bt, leaf);
+}
+
+static void
+_bt_free_node(btree_node *n)
+{
+    int i;
+
+    if (!n->leaf)
+        for (i = 0; i <= n->count; ++i)
+            _bt_free_node(((btree_inner *)n)->child[i]);
+    free(n);
+}
+
+/**********************************************************************
+ *
+ * container
+ *
+ **********************************************************************/
+static void
+_bt_clear(netsnmp_container *c, netsnmp_container_obj_func *f,
+          void *context)
+{
+    btree_container *bt = (btree_container *)c;
+    btree_leaf      *leaf;
+    int              i;
+
+    if (NULL == c)
+        return;
+
+    if (NULL != f)
+        for (leaf = bt->head; leaf; leaf = leaf->next)
+            for (i = 0; i < leaf->n.count; ++i)
+                (*f) (leaf->n.key[i], context);
+
+    if (bt->root)
+        _bt_free_node(bt->root);
+    bt->root = NULL;
+    bt->head = bt->tail = NULL;
+    bt->count = 0;
+    ++c->sync;
+}
+
+static int
+_bt_free(netsnmp_container *c)
+{
+    if (c) {
+        _bt_clear(c, NULL, NULL);
+        free(c);
+    }
+    return 0;
+}
+
+static void *
+_bt_find(netsnmp_container *c, const void *data)
+{
+    btree_leaf *leaf;
+    int         pos;
+
+    if ((NULL == c) || (NULL == data))
+        return NULL;
+
+    leaf = _bt_seek((btree_container *)c, data, c->compare, 0, &pos);
+    if (leaf && (c->compare(leaf->n.key[pos], data) == 0))
+        return leaf->n.key[pos];
+
+    return NULL;
+}
+
+static void *
+_bt_find_next(netsnmp_container *c, const void *data)
+{
+    btree_container *bt = (btree_container *)c;
+    btree_leaf      *leaf;
+    int              pos;
+
+    if (NULL == c)
+        return NULL;
+
+    if (NULL == data)
+        return bt->head ? bt->head->n.key[0] : NULL;
+
+    leaf = _bt_seek(bt, data, c->compare, 1, &pos);
+    return leaf ? leaf->n.key[pos] : NULL;
+}
+
+static int
+_bt_insert(netsnmp_container *c, const void *data)
+{
+    btree_container *bt = (btree_container *)c;
+    btree_leaf      *leaf, *right;
+    btree_inner     *spare[BTREE_MAX_DEPTH], *p;
+    void            *keys[BTREE_ORDER + 1];
+    int              pos, rc, split, i, nspare = 0;
+
+    if ((NULL == c) || (NULL == data))
+        return -1;
+
+    if (NULL == bt->root) {
+        leaf = SNMP_MALLOC_TYPEDEF(btree_leaf);
+        if (NULL == leaf)
+            return -1;
+        leaf->n.leaf = 1;
+        leaf->n.key[0] = NETSNMP_REMOVE_CONST(void *, data);
+        leaf->n.count = 1;
+        bt->root = &leaf->n;
+        bt->head = bt->tail = leaf;
+        bt->count = 1;
+        ++c->sync;
+        return 0;
+    }
+
+    /*
+     * most loaders insert in order, so try the end first. Duplicates
+     * go after any entries they are equal to.
+     */
+    leaf = bt->tail;
+    rc = c->compare(leaf->n.key[leaf->n.count - 1], data);
+    if ((rc < 0) ||
+        ((rc == 0) && (c->flags & CONTAINER_KEY_ALLOW_DUPLICATES)))
+        pos = leaf->n.count;
+    else if (rc > 0) {
+        leaf = _bt_descend(bt, data, c->compare, 1, &pos);
+        if ((pos > 0) &&
+            !(c->flags & CONTAINER_KEY_ALLOW_DUPLICATES) &&
+            (c->compare(leaf->n.key[pos - 1], data) == 0))
+            rc = 0;
+    }
+    if (rc == 0 && !(c->flags & CONTAINER_KEY_ALLOW_DUPLICATES)) {
+        DEBUGMSGTL(("container","not inserting duplicate key\n"));
+        return -1;
+    }
+
+    if (leaf->n.count < BTREE_ORDER) {
+        /*
+         * pos can only be 0 in the leftmost leaf, which no separator
+         * refers to, so no fixups are needed.
+         */
+        memmove(&leaf->n.key[pos + 1], &leaf->n.key[pos],
+                (leaf->n.count - pos) * sizeof(void *));
+        leaf->n.key[pos] = NETSNMP_REMOVE_CONST(void *, data);
+        ++leaf->n.count;
+        ++bt->count;
+        ++c->sync;
+        return 0;
+    }
+
+    /*
+     * the leaf is full and must be split. Allocate everything that
+     * will take up front, so running out of memory leaves the tree
+     * untouched.
+     */
+    right = SNMP_MALLOC_TYPEDEF(btree_leaf);
+    if (NULL == right)
+        return -1;
+    for (p = leaf->n.parent; p && (p->n.count == BTREE_ORDER);
+         p = p->n.parent)
+        ++nspare;
+    if (NULL == p)
+        ++nspare;                  /* new root */
+    for (i = 0; i < nspare; ++i)
+        if (NULL == (spare[i] = SNMP_MALLOC_TYPEDEF(btree_inner)))
+            break;
+    if (i < nspare) {
+        while (i > 0)
+            free(spare[--i]);
+        free(right);
+        return -1;
+    }
+
+    memcpy(keys, leaf->n.key, pos * sizeof(void *));
+    keys[pos] = NETSNMP_REMOVE_CONST(void *, data);
+    memcpy(&keys[pos + 1], &leaf->n.key[pos],
+           (BTREE_ORDER - pos) * sizeof(void *));
+
+    /*
+     * appending to the last leaf: leave it full rather than half
+     * empty, so in-order loads end up with packed leaves.
+     */
+    if ((leaf == bt->tail) && (pos == BTREE_ORDER))
+        split = BTREE_ORDER;
+    else
+        split = (BTREE_ORDER + 1) / 2;
+
+    leaf->n.count = split;
+    memcpy(leaf->n.key, keys, split * sizeof(void *));
+    right->n.leaf = 1;
+    right->n.count = BTREE_ORDER + 1 - split;
+    memcpy(right->n.key, &keys[split], right->n.count * sizeof(void *));
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (leaf->next)
+        leaf->next->prev = right;
+    else
+        bt->tail = right;
+    leaf->next = right;
+
+    _bt_insert_parent(bt, &leaf->n, right->n.key[0], &right->n,
+                      spare, &nspare);
+    netsnmp_assert(0 == nspare);
+
+    ++bt->count;
+    ++c->sync;
+    return 0;
+}
+
+static int
+_bt_remove(netsnmp_container *c, const void *data)
+{
+    btree_leaf *leaf, *l;
+    int         pos, p;
+
+    if ((NULL == c) || (NULL == data))
+        return -1;
+
+    leaf = _bt_seek((btree_container *)c, data, c->compare, 0, &pos);
+    if ((NULL == leaf) || (c->compare(leaf->n.key[pos], data) != 0))
+        return -1;
+
+    /*
+     * with duplicates, prefer the entry that is the very same object
+     */
+    if (c->flags & CONTAINER_KEY_ALLOW_DUPLICATES) {
+        for (l = leaf, p = pos; l && (l->n.key[p] != data);
+             l = _bt_step(l, &p))
+            if (c->compare(l->n.key[p], data) != 0)
+                break;
+        if (l && (l->n.key[p] == data)) {
+            leaf = l;
+            pos = p;
+        }
+    }
+
+    _bt_remove_at((btree_container *)c, leaf, pos);
+    return 0;
+}
+
+static size_t
+_bt_size(netsnmp_container *c)
+{
+    if (NULL == c)
+        return 0;
+
+    return ((btree_container *)c)->count;
+}
+
+static void
+_bt_for_each(netsnmp_container *c, netsnmp_container_obj_func *f,
+             void *context)
+{
+    btree_leaf *leaf;
+    int         i;
+
+    if (NULL == c)
+        return;
+
+    for (leaf = ((btree_container *)c)->head; leaf; leaf = leaf->next)
+        for (i = 0; i < leaf->n.count; ++i)
+            (*f) (leaf->n.key[i], context);
+}
+
+static netsnmp_void_array *
+_bt_get_subset(netsnmp_container *c, void *data)
+{
+    netsnmp_void_array *va;
+    btree_leaf         *leaf, *l;
+    int                 pos, p;
+    size_t              n, i;
+
+    if ((NULL == c) || (NULL == data) || (NULL == c->ncompare))
+        return NULL;
+
+    leaf = _bt_seek((btree_container *)c, data, c->ncompare, 0, &pos);
+    for (n = 0, l = leaf, p = pos; l && (c->ncompare(l->n.key[p], data) == 0);
+         l = _bt_step(l, &p))
+        ++n;
+    if (0 == n)
+        return NULL;
+
+    va = SNMP_MALLOC_TYPEDEF(netsnmp_void_array);
+    if (NULL == va)
+        return NULL;
+    va->array = (void **) malloc(n * sizeof(void *));
+    if (NULL == va->array) {
+        free(va);
+        return NULL;
+    }
+    for (i = 0, l = leaf, p = pos; i < n; l = _bt_step(l, &p))
+        va->array[i++] = l->n.key[p];
+    va->size = n;
+
+    return va;
+}
+
+static int
+_bt_options(netsnmp_container *c, int set, u_int flags)
+{
+    if (set) {
+        if ((flags & CONTAINER_KEY_ALLOW_DUPLICATES) == flags)
+            c->flags = flags;
+        else
+            flags = (u_int)-1; /* unsupported flag */
+    }
+    else
+        return ((c->flags & flags) == flags);
+    return flags;
+}
+
+static netsnmp_container *
+_bt_duplicate(netsnmp_container *c, void *ctx, u_int flags)
+{
+    netsnmp_container *dup;
+    btree_leaf        *leaf;
+    int                i;
+
+    if (flags) {
+        snmp_log(LOG_ERR, "btree duplicate does not support flags yet\n");
+        return NULL;
+    }
+
+    dup = netsnmp_container_get_btree();
+    if (NULL == dup) {
+        snmp_log(LOG_ERR, "no memory for btree duplicate\n");
+        return NULL;
+    }
+    netsnmp_container_data_dup(dup, c);
+
+    /*
+     * shallow copy; entries arrive in order, so this just appends
+     */
+    for (leaf = ((btree_container *)c)->head; leaf; leaf = leaf->next)
+        for (i = 0; i < leaf->n.count; ++i)
+            if (dup->insert(dup, leaf->n.key[i]) < 0) {
+                snmp_log(LOG_ERR, "no memory for btree duplicate\n");
+                SNMP_FREE(dup->container_name);
+                _bt_free(dup);
+                return NULL;
+            }
+
+    return dup;
+}
+
+/**********************************************************************
+ *
+ *
+ *
+ **********************************************************************/
+netsnmp_container *
+netsnmp_container_get_btree(void)
+{
+    /*
+     * allocate memory
+     */
+    btree_container *bt = SNMP_MALLOC_TYPEDEF(btree_container);
+    if (NULL == bt) {
+        snmp_log(LOG_ERR, "couldn't allocate memory\n");
+        return NULL;
+    }
+
+    netsnmp_init_container((netsnmp_container *)bt, NULL, _bt_free,
+                           _bt_size, NULL, _bt_insert, _bt_remove,
+                           _bt_find);
+    bt->c.find_next = _bt_find_next;
+    bt->c.get_subset = _bt_get_subset;
+    bt->c.get_iterator = _bt_iterator_get;
+    bt->c.for_each = _bt_for_each;
+    bt->c.clear = _bt_clear;
+    bt->c.options = _bt_options;
+    bt->c.duplicate = _bt_duplicate;
+
+    return (netsnmp_container *)bt;
+}
+
+netsnmp_factory *
+netsnmp_container_get_btree_factory(void)
+{
+    static netsnmp_factory f = {"btree",
+                                (netsnmp_factory_produce_f*)
+                                netsnmp_container_get_btree };
+
+    return &f;
+}
+
+void
+netsnmp_container_btree_init(void)
+{
+    netsnmp_container_register("btree",
+                               netsnmp_container_get_btree_factory());
+}
+
+
+/**********************************************************************
+ *
+ * iterator
+ *
+ */
+NETSNMP_STATIC_INLINE btree_container *
+_bt_it2cont(btree_iterator *it)
+{
+    if(NULL == it) {
+        netsnmp_assert(NULL != it);
+        return NULL;
+    }
+
+    if(NULL == it->base.container) {
+        netsnmp_assert(NULL != it->base.container);
+        return NULL;
+    }
+
+    if(it->base.container->sync != it->base.sync) {
+        DEBUGMSGTL(("container:iterator", "out of sync\n"));
+        return NULL;
+    }
+
+    return (btree_container *)it->base.container;
+}
+
+static void *
+_bt_iterator_curr(btree_iterator *it)
+{
+    btree_container *t = _bt_it2cont(it);
+    if ((NULL == t) || (NULL == it->leaf))
+        return NULL;
+
+    return it->leaf->n.key[it->pos];
+}
+
+static void *
+_bt_iterator_first(btree_iterator *it)
+{
+    btree_container *t = _bt_it2cont(it);
+    if (NULL == t)
+        return NULL;
+
+    it->leaf = t->head;
+    it->pos = 0;
+
+    return it->leaf ? it->leaf->n.key[0] : NULL;
+}
+
+static void *
+_bt_iterator_next(btree_iterator *it)
+{
+    btree_container *t = _bt_it2cont(it);
+    if ((NULL == t) || (NULL == it->leaf))
+        return NULL;
+
+    it->leaf = _bt_step(it->leaf, &it->pos);
+
+    return it->leaf ? it->leaf->n.key[it->pos] : NULL;
+}
+
+static void *
+_bt_iterator_last(btree_iterator *it)
+{
+    btree_container *t = _bt_it2cont(it);
+    if ((NULL == t) || (NULL == t->tail))
+        return NULL;
+
+    it->leaf = t->tail;
+    it->pos = it->leaf->n.count - 1;
+
+    return it->leaf->n.key[it->pos];
+}
+
+static int
+_bt_iterator_reset(btree_iterator *it)
+{
+    btree_container *t;
+
+    /** can't use it2conf cuz we might be out of sync */
+    if(NULL == it) {
+        netsnmp_assert(NULL != it);
+        return 0;
+    }
+
+    if(NULL == it->base.container) {
+        netsnmp_assert(NULL != it->base.container);
+        return 0;
+    }
+    t = (btree_container *)it->base.container;
+
+    it->leaf = t->head;
+    it->pos = 0;
+
+    /*
+     * save sync count, to make sure container doesn't change while
+     * iterator is in use.
+     */
+    it->base.sync = it->base.container->sync;
+
+    return 0;
+}
+
+static int
+_bt_iterator_release(netsnmp_iterator *it)
+{
+    free(it);
+
+    return 0;
+}
+
+static netsnmp_iterator *
+_bt_iterator_get(netsnmp_container *c)
+{
+    btree_iterator *it;
+
+    if(NULL == c)
+        return NULL;
+
+    it = SNMP_MALLOC_TYPEDEF(btree_iterator);
+    if(NULL == it)
+        return NULL;
+
+    it->base.container = c;
+
+    it->base.first = (netsnmp_iterator_rtn*)_bt_iterator_first;
+    it->base.next = (netsnmp_iterator_rtn*)_bt_iterator_next;
+    it->base.curr = (netsnmp_iterator_rtn*)_bt_iterator_curr;
+    it->base.last = (netsnmp_iterator_rtn*)_bt_iterator_last;
+    it->base.reset = (netsnmp_iterator_rc*)_bt_iterator_reset;
+    it->base.release = (netsnmp_iterator_rc*)_bt_iterator_release;
+
+    (void)_bt_iterator_reset(it);
+
+    return (netsnmp_iterator *)it;
+}
+#else /* NETSNMP_FEATURE_REMOVE_CONTAINER_BTREE */
+netsnmp_feature_unused(container_btree);
+#endif /* NETSNMP_FEATURE_REMOVE_CONTAINER_BTREE */
@@ -0,0 +1,699 @@
+/*
+ * container_hash.c
+ * $Id$
+ *
+ * A container for tables that are mostly searched for exact matches.
+ * find, insert and remove go through an open addressing hash table.
+ * The entries are also kept in a binary_array, which is only brought
+ * up to date when something needs them in order: find_next,
+ * get_subset, for_each and iterators. Inserts are appended to it and
+ * sorted in on the next ordered access; a remove causes it to be
+ * rebuilt from scratch then.
+ */
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-features.h>
+
+#include <stdio.h>
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#if HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+#include <sys/types.h>
+#if HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/types.h>
+#include <net-snmp/library/snmp_api.h>
+#include <net-snmp/library/container.h>
+#include <net-snmp/library/container_binary_array.h>
+#include <net-snmp/library/tools.h>
+#include <net-snmp/library/snmp_assert.h>
+
+#include <net-snmp/library/container_hash.h>
+
+netsnmp_feature_child_of(container_hash, container_types)
+
+#ifndef NETSNMP_FEATURE_REMOVE_CONTAINER_HASH
+
+#define HASH_MIN_SLOTS   16
+
+/*
+ * marks a slot whose entry was removed; lookups must probe past it
+ */
+static char _hash_deleted;
+#define HASH_DELETED     ((void *)&_hash_deleted)
+
+/*
+ * state of the sorted index
+ */
+#define ORDER_CURRENT    0
+#define ORDER_PENDING    1   /* entries appended, not sorted in yet */
+#define ORDER_STALE      2   /* must be rebuilt */
+
+typedef struct hash_slot_s {
+    u_int                   hash;
+    void                   *data;
+} hash_slot;
+
+typedef struct hash_container_s {
+    netsnmp_container       c;
+
+    netsnmp_container_hash *hash;
+    hash_slot              *slots;
+    size_t                  nslots;    /* always a power of 2 */
+    size_t                  count;     /* number of entries */
+    size_t                  deleted;   /* slots holding HASH_DELETED */
+
+    netsnmp_container      *order;     /* sorted index */
+    int                     order_state;
+} hash_container;
+
+typedef struct hash_iterator_s {
+    netsnmp_iterator        base;
+
+    netsnmp_iterator       *order_it;
+} hash_iterator;
+
+static netsnmp_iterator *_hash_iterator_get(netsnmp_container *c);
+
+
+/**********************************************************************
+ *
+ * hash functions
+ *
+ **********************************************************************/
+#define FNV_OFFSET       2166136261U
+#define FNV_PRIME        16777619U
+
+/*
+ * spread the high bits of a hash down, since only the low ones are
+ * used to pick a slot.
+ */
+NETSNMP_STATIC_INLINE u_int
+_hash_final(u_int h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+NETSNMP_STATIC_INLINE u_int
+_hash_string(const char *s)
+{
+    u_int h = FNV_OFFSET;
+
+    for (; *s; ++s) {
+        h ^= (u_char)*s;
+        h *= FNV_PRIME;
+    }
+    return _hash_final(h);
+}
+
+/** hash to go with netsnmp_compare_netsnmp_index */
+u_int
+netsnmp_hash_netsnmp_index(const void *data)
+{
+    const netsnmp_index *idx = (const netsnmp_index *) data;
+    u_int                h = FNV_OFFSET;
+    size_t               i;
+
+    for (i = 0; i < idx->len; ++i) {
+        h ^= (u_int)idx->oids[i];
+        h *= FNV_PRIME;
+    }
+    return _hash_final(h);
+}
+
+/** hash to go with netsnmp_compare_cstring */
+u_int
+netsnmp_hash_cstring(const void *data)
+{
+    return _hash_string(*(const char * const *) data);
+}
+
+/** hash to go with netsnmp_compare_direct_cstring */
+u_int
+netsnmp_hash_direct_cstring(const void *data)
+{
+    return _hash_string((const char *) data);
+}
+
+/**********************************************************************
+ *
+ * hash table
+ *
+ **********************************************************************/
+static int
+_hash_pick_func(hash_container *hc)
+{
+    if (hc->c.compare == netsnmp_compare_netsnmp_index)
+        hc->hash = netsnmp_hash_netsnmp_index;
+    else if (hc->c.compare == netsnmp_compare_cstring)
+        hc->hash = netsnmp_hash_cstring;
+    else if (hc->c.compare == netsnmp_compare_direct_cstring)
+        hc->hash = netsnmp_hash_direct_cstring;
+    else {
+        snmp_log(LOG_ERR, "hash container '%s' has no hash function\n",
+                 hc->c.container_name ? hc->c.container_name : "");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * find the slot holding an entry equal to data. If there is none and
+ * insert_at is set, point it at the slot where data should go.
+ */
+static hash_slot *
+_hash_lookup(hash_container *hc, const void *data, u_int h,
+             hash_slot **insert_at)
+{
+    size_t     mask = hc->nslots - 1, i;
+    hash_slot *s, *avail = NULL;
+
+    for (i = h & mask; ; i = (i + 1) & mask) {
+        s = &hc->slots[i];
+        if (NULL == s->data) {
+            if (insert_at)
+                *insert_at = avail ? avail : s;
+            return NULL;
+        }
+        if (HASH_DELETED == s->data) {
+            if (NULL == avail)
+                avail = s;
+        }
+        else if ((s->hash == h) && (hc->c.compare(s->data, data) == 0))
+            return s;
+    }
+}
+
+/*
+ * rehash into a table big enough for count entries, which also gets
+ * rid of deleted slots.
+ */
+static int
+_hash_resize(hash_container *hc, size_t count)
+{
+    hash_slot *old = hc->slots;
+    size_t     old_n = hc->nslots, nslots = HASH_MIN_SLOTS, mask, i, j;
+
+    while (nslots < count * 2)
+        nslots <<= 1;
+
+    hc->slots = (hash_slot *) calloc(nslots, sizeof(hash_slot));
+    if (NULL == hc->slots) {
+        snmp_log(LOG_ERR, "couldn't allocate memory\n");
+        hc->slots = old;
+        return -1;
+    }
+    hc->nslots = nslots;
+    hc->deleted = 0;
+
+    mask = nslots - 1;
+    for (i = 0; i < old_n; ++i) {
+        if ((NULL == old[i].data) || (HASH_DELETED == old[i].data))
+            continue;
+        for (j = old[i].hash & mask; hc->slots[j].data; j = (j + 1) & mask)
+            ;
+        hc->slots[j] = old[i];
+    }
+    free(old);
+
+    return 0;
+}
+
+/*
+ * bring the sorted index up to date
+ */
+static netsnmp_container *
+_hash_order(hash_container *hc)
+{
+    netsnmp_container *o = hc->order;
+    size_t             i;
+
+    o->compare = hc->c.compare;
+    o->ncompare = hc->c.ncompare;
+
+    if (ORDER_STALE == hc->order_state) {
+        hc->order_state = ORDER_CURRENT;
+        o->clear(o, NULL, NULL);
+        netsnmp_binary_array_bulk_begin(o);
+        for (i = 0; i < hc->nslots; ++i) {
+            if ((NULL == hc->slots[i].data) ||
+                (HASH_DELETED == hc->slots[i].data))
+                continue;
+            if (o->insert(o, hc->slots[i].data) < 0) {
+                snmp_log(LOG_ERR, "couldn't rebuild hash container index\n");
+                hc->order_state = ORDER_STALE;
+                break;
+            }
+        }
+        netsnmp_binary_array_bulk_end(o, NULL, NULL);
+    }
+    else if (ORDER_PENDING == hc->order_state) {
+        netsnmp_binary_array_bulk_end(o, NULL, NULL);
+        hc->order_state = ORDER_CURRENT;
+    }
+
+    return o;
+}
+
+/**********************************************************************
+ *
+ * container
+ *
+ **********************************************************************/
+static void *
+_hash_find(netsnmp_container *c, const void *data)
+{
+    hash_container *hc = (hash_container *)c;
+    hash_slot      *s;
+
+    if ((NULL == c) || (NULL == data) || (0 == hc->count))
+        return NULL;
+
+    s = _hash_lookup(hc, data, (*hc->hash)(data), NULL);
+    return s ? s->data : NULL;
+}
+
+static void *
+_hash_find_next(netsnmp_container *c, const void *data)
+{
+    netsnmp_container *o;
+
+    if ((NULL == c) || (0 == ((hash_container *)c)->count))
+        return NULL;
+
+    o = _hash_order((hash_container *)c);
+    return o->find_next(o, data);
+}
+
+static int
+_hash_insert(netsnmp_container *c, const void *data)
+{
+    hash_container *hc = (hash_container *)c;
+    hash_slot      *s;
+    u_int           h;
+
+    if ((NULL == c) || (NULL == data))
+        return -1;
+
+    if ((NULL == hc->hash) && (_hash_pick_func(hc) < 0))
+        return -1;
+
+    /*
+     * keep at least a third of the slots empty
+     */
+    if (((hc->count + hc->deleted + 1) * 3 > hc->nslots * 2) &&
+        (_hash_resize(hc, hc->count + 1) < 0))
+        return -1;
+
+    h = (*hc->hash)(data);
+    if (_hash_lookup(hc, data, h, &s)) {
+        DEBUGMSGTL(("container","not inserting duplicate key\n"));
+        return -1;
+    }
+    if (HASH_DELETED == s->data)
+        --hc->deleted;
+    s->hash = h;
+    s->data = NETSNMP_REMOVE_CONST(void *, data);
+    ++hc->count;
+    ++c->sync;
+
+    if (ORDER_STALE != hc->order_state) {
+        if (ORDER_CURRENT == hc->order_state)
+            netsnmp_binary_array_bulk_begin(hc->order);
+        hc->order_state = ORDER_PENDING;
+        if (hc->order->insert(hc->order, data) < 0)
+            hc->order_state = ORDER_STALE;
+    }
+
+    return 0;
+}
+
+static int
+_hash_remove(netsnmp_container *c, const void *data)
+{
+    hash_container *hc = (hash_container *)c;
+    hash_slot      *s;
+
+    if ((NULL == c) || (NULL == data) || (0 == hc->count))
+        return -1;
+
+    s = _hash_lookup(hc, data, (*hc->hash)(data), NULL);
+    if (NULL == s)
+        return -1;
+
+    s->data = HASH_DELETED;
+    ++hc->deleted;
+    --hc->count;
+    ++c->sync;
+    hc->order_state = ORDER_STALE;
+
+    return 0;
+}
+
+static size_t
+_hash_size(netsnmp_container *c)
+{
+    if (NULL == c)
+        return 0;
+
+    return ((hash_container *)c)->count;
+}
+
+static void
+_hash_for_each(netsnmp_container *c, netsnmp_container_obj_func *f,
+               void *context)
+{
+    netsnmp_container *o;
+
+    if ((NULL == c) || (0 == ((hash_container *)c)->count))
+        return;
+
+    o = _hash_order((hash_container *)c);
+    o->for_each(o, f, context);
+}
+
+static netsnmp_void_array *
+_hash_get_subset(netsnmp_container *c, void *data)
+{
+    netsnmp_container *o;
+
+    if ((NULL == c) || (0 == ((hash_container *)c)->count))
+        return NULL;
+
+    o = _hash_order((hash_container *)c);
+    return o->get_subset(o, data);
+}
+
+static void
+_hash_clear(netsnmp_container *c, netsnmp_container_obj_func *f,
+            void *context)
+{
+    hash_container *hc = (hash_container *)c;
+    size_t          i;
+
+    if (NULL == c)
+        return;
+
+    if (NULL != f)
+        for (i = 0; i < hc->nslots; ++i)
+            if (hc->slots[i].data && (HASH_DELETED != hc->slots[i].data))
+                (*f) (hc->slots[i].data, context);
+
+    if (hc->slots)
+        memset(hc->slots, 0, hc->nslots * sizeof(hash_slot));
+    hc->count = hc->deleted = 0;
+    ++c->sync;
+
+    hc->order->clear(hc->order, NULL, NULL);
+    netsnmp_binary_array_bulk_end(hc->order, NULL, NULL);
+    hc->order_state = ORDER_CURRENT;
+}
+
+static int
+_hash_free(netsnmp_container *c)
+{
+    hash_container *hc = (hash_container *)c;
+
+    if (c) {
+        if (hc->order)
+            hc->order->cfree(hc->order);
+        free(hc->slots);
+        free(hc);
+    }
+    return 0;
+}
+
+static int
+_hash_options(netsnmp_container *c, int set, u_int flags)
+{
+    if (set) {
+        if (0 == flags)
+            c->flags = flags;
+        else
+            flags = (u_int)-1; /* unsupported flag */
+    }
+    else
+        return ((c->flags & flags) == flags);
+    return flags;
+}
+
+static netsnmp_container *
+_hash_duplicate(netsnmp_container *c, void *ctx, u_int flags)
+{
+    hash_container    *hc = (hash_container *)c;
+    netsnmp_container *dup;
+    size_t             i;
+
+    if (flags) {
+        snmp_log(LOG_ERR, "hash duplicate does not support flags yet\n");
+        return NULL;
+    }
+
+    dup = netsnmp_container_get_hash();
+    if (NULL == dup) {
+        snmp_log(LOG_ERR, "no memory for hash duplicate\n");
+        return NULL;
+    }
+    netsnmp_container_data_dup(dup, c);
+    ((hash_container *)dup)->hash = hc->hash;
+
+    /*
+     * shallow copy
+     */
+    for (i = 0; i < hc->nslots; ++i) {
+        if ((NULL == hc->slots[i].data) || (HASH_DELETED == hc->slots[i].data))
+            continue;
+        if (_hash_insert(dup, hc->slots[i].data) < 0) {
+            snmp_log(LOG_ERR, "no memory for hash duplicate\n");
+            SNMP_FREE(dup->container_name);
+            _hash_free(dup);
+            return NULL;
+        }
+    }
+
+    return dup;
+}
+
+/**********************************************************************
+ *
+ *
+ *
+ **********************************************************************/
+netsnmp_container *
+netsnmp_container_get_hash(void)
+{
+    /*
+     * allocate memory
+     */
+    hash_container *hc = SNMP_MALLOC_TYPEDEF(hash_container);
+    if (NULL == hc) {
+        snmp_log(LOG_ERR, "couldn't allocate memory\n");
+        return NULL;
+    }
+    hc->order = netsnmp_container_get_binary_array();
+    if (NULL == hc->order) {
+        free(hc);
+        return NULL; /* msg already logged */
+    }
+
+    netsnmp_init_container((netsnmp_container *)hc, NULL, _hash_free,
+                           _hash_size, NULL, _hash_insert, _hash_remove,
+                           _hash_find);
+    hc->c.find_next = _hash_find_next;
+    hc->c.get_subset = _hash_get_subset;
+    hc->c.get_iterator = _hash_iterator_get;
+    hc->c.for_each = _hash_for_each;
+    hc->c.clear = _hash_clear;
+    hc->c.options = _hash_options;
+    hc->c.duplicate = _hash_duplicate;
+
+    return (netsnmp_container *)hc;
+}
+
+/**
+ * Sets the function used to hash entries of a hash container. It is
+ * picked automatically for the common comparison routines; anything
+ * else needs one which hashes equal entries to the same value.
+ *
+ * @return 0 on success, or -1 if c is not an empty hash container.
+ */
+int
+netsnmp_container_hash_set_func(netsnmp_container *c,
+                                netsnmp_container_hash *hash)
+{
+    if ((NULL == c) || (c->insert != _hash_insert) ||
+        (((hash_container *)c)->count != 0))
+        return -1;
+
+    ((hash_container *)c)->hash = hash;
+    return 0;
+}
+
+netsnmp_factory *
+netsnmp_container_get_hash_factory(void)
+{
+    static netsnmp_factory f = {"hash",
+                                (netsnmp_factory_produce_f*)
+                                netsnmp_container_get_hash };
+
+    return &f;
+}
+
+void
+netsnmp_container_hash_init(void)
+{
+    netsnmp_container_register("hash",
+                               netsnmp_container_get_hash_factory());
+}
+
+
+/**********************************************************************
+ *
+ * iterator
+ *
+ * walks the sorted index, but stays in sync with the hash container
+ * itself.
+ */
+NETSNMP_STATIC_INLINE hash_container *
+_hash_it2cont(hash_iterator *it)
+{
+    if(NULL == it) {
+        netsnmp_assert(NULL != it);
+        return NULL;
+    }
+
+    if(NULL == it->base.container) {
+        netsnmp_assert(NULL != it->base.container);
+        return NULL;
+    }
+
+    if(it->base.container->sync != it->base.sync) {
+        DEBUGMSGTL(("container:iterator", "out of sync\n"));
+        return NULL;
+    }
+
+    if(NULL == it->order_it)
+        return NULL;
+
+    return (hash_container *)it->base.container;
+}
+
+static void *
+_hash_iterator_curr(hash_iterator *it)
+{
+    if (NULL == _hash_it2cont(it))
+        return NULL;
+
+    return it->order_it->curr(it->order_it);
+}
+
+static void *
+_hash_iterator_first(hash_iterator *it)
+{
+    if (NULL == _hash_it2cont(it))
+        return NULL;
+
+    return it->order_it->first(it->order_it);
+}
+
+static void *
+_hash_iterator_next(hash_iterator *it)
+{
+    if (NULL == _hash_it2cont(it))
+        return NULL;
+
+    return it->order_it->next(it->order_it);
+}
+
+static void *
+_hash_iterator_last(hash_iterator *it)
+{
+    if (NULL == _hash_it2cont(it))
+        return NULL;
+
+    return it->order_it->last(it->order_it);
+}
+
+static int
+_hash_iterator_reset(hash_iterator *it)
+{
+    netsnmp_container *o;
+
+    /** can't use it2conf cuz we might be out of sync */
+    if(NULL == it) {
+        netsnmp_assert(NULL != it);
+        return 0;
+    }
+
+    if(NULL == it->base.container) {
+        netsnmp_assert(NULL != it->base.container);
+        return 0;
+    }
+
+    o = _hash_order((hash_container *)it->base.container);
+    if (NULL == it->order_it)
+        it->order_it = o->get_iterator(o);
+    else
+        it->order_it->reset(it->order_it);
+
+    /*
+     * save sync count, to make sure container doesn't change while
+     * iterator is in use.
+     */
+    it->base.sync = it->base.container->sync;
+
+    return 0;
+}
+
+static int
+_hash_iterator_release(netsnmp_iterator *it)
+{
+    hash_iterator *hit = (hash_iterator *)it;
+
+    if (hit->order_it)
+        hit->order_it->release(hit->order_it);
+    free(it);
+
+    return 0;
+}
+
+static netsnmp_iterator *
+_hash_iterator_get(netsnmp_container *c)
+{
+    hash_iterator *it;
+
+    if(NULL == c)
+        return NULL;
+
+    it = SNMP_MALLOC_TYPEDEF(hash_iterator);
+    if(NULL == it)
+        return NULL;
+
+    it->base.container = c;
+
+    it->base.first = (netsnmp_iterator_rtn*)_hash_iterator_first;
+    it->base.next = (netsnmp_iterator_rtn*)_hash_iterator_next;
+    it->base.curr = (netsnmp_iterator_rtn*)_hash_iterator_curr;
+    it->base.last = (netsnmp_iterator_rtn*)_hash_iterator_last;
+    it->base.reset = (netsnmp_iterator_rc*)_hash_iterator_reset;
+    it->base.release = (netsnmp_iterator_rc*)_hash_iterator_release;
+
+    (void)_hash_iterator_reset(it);
+
+    return (netsnmp_iterator *)it;
+}
+#else /* NETSNMP_FEATURE_REMOVE_CONTAINER_HASH */
+netsnmp_feature_unused(container_hash);
+#endif /* NETSNMP_FEATURE_REMOVE_CONTAINER_HASH */
@@ -156,11 +156,35 @@ static int      config_errors;
 
 struct config_files *config_files = NULL;
 
+/*
+ * The lines which have been passed to a handler registered with a
+ * remover, so that a reread only needs to pass on the differences.
+ */
+struct read_config_applied {
+    char           *line;
+    char           *filename;
+    unsigned int    linecount;
+    int             state;
+    struct read_config_applied *next;
+};
+
+#define CONFIG_LINE_CURRENT     0       /* parsed, and still configured */
+#define CONFIG_LINE_STALE       1       /* parsed, not seen again yet */
+#define CONFIG_LINE_NEW         2       /* seen, not parsed yet */
+
+static int      config_rereading = 0;
+
+static void     config_forget_applied(struct config_line *lptr);
+static int      config_remember_applied(struct config_line *lptr,
+                                        const char *line);
+static void     config_apply_changes(void);
+
 
 static struct config_line *
 internal_register_config_handler(const char *type_param,
 				 const char *token,
 				 void (*parser) (const char *, char *),
+				 void (*remover) (const char *, char *),
 				 void (*releaser) (void), const char *help,
 				 int when)
 {
@@ -190,7 +214,8 @@ internal_register_config_handler(const char *type_param,
                 ++cptr;
             }
             ltmp2 = internal_register_config_handler(c, token, parser,
-                                                     releaser, help, when);
+                                                     remover, releaser,
+                                                     help, when);
         }
         return ltmp2;
     }
@@ -243,6 +268,7 @@ internal_register_config_handler(const char *type_param,
      * in the given file type.
      */
     (*ltmp)->parse_line = parser;
+    (*ltmp)->remove_line = remover;
     (*ltmp)->free_func = releaser;
 
     return (*ltmp);
@@ -255,8 +281,8 @@ register_prenetsnmp_mib_handler(const char *type,
                                 void (*parser) (const char *, char *),
                                 void (*releaser) (void), const char *help)
 {
-    return internal_register_config_handler(type, token, parser, releaser,
-					    help, PREMIB_CONFIG);
+    return internal_register_config_handler(type, token, parser, NULL,
+                                            releaser, help, PREMIB_CONFIG);
 }
 
 #ifndef NETSNMP_FEATURE_REMOVE_READ_CONFIG_REGISTER_APP_PRENETSNMP_MIB_HANDLER
@@ -310,8 +336,46 @@ register_config_handler(const char *type,
 			void (*parser) (const char *, char *),
 			void (*releaser) (void), const char *help)
 {
-    return internal_register_config_handler(type, token, parser, releaser,
-					    help, NORMAL_CONFIG);
+    return internal_register_config_handler(type, token, parser, NULL,
+                                            releaser, help, NORMAL_CONFIG);
+}
+
+/**
+ * register_config_handler_incremental registers a handler in the same way
+ * as register_config_handler, for a module which can add and remove
+ * individual lines while it is running.
+ *
+ * When the configuration files are re-read (e.g. on SIGHUP) the releaser
+ * is not called for such a handler.  Instead, once all the files have
+ * been read, the remover is called for each line which has gone from
+ * the configuration, and then the parser for each line which is new.
+ * Lines which are unchanged are not passed on again, so the module can
+ * keep the registrations and cached data belonging to them.
+ *
+ * The new lines are parsed after all the other tokens, so a handler
+ * using this must not depend on the order of its lines relative to
+ * those of other tokens.
+ *
+ * @param remover  called with the token and the rest of a line which was
+ *                 passed to the parser before and is no longer in the
+ *                 configuration.  It should undo what the parser did
+ *                 for that line.
+ *
+ * The other parameters are as for register_config_handler.  The releaser
+ * is still called when the handler is unregistered.
+ *
+ * @return Pointer to a new config line entry or NULL on error.
+ */
+struct config_line *
+register_config_handler_incremental(const char *type,
+                                    const char *token,
+                                    void (*parser) (const char *, char *),
+                                    void (*remover) (const char *, char *),
+                                    void (*releaser) (void),
+                                    const char *help)
+{
+    return internal_register_config_handler(type, token, parser, remover,
+                                            releaser, help, NORMAL_CONFIG);
 }
 
 #ifndef NETSNMP_FEATURE_REMOVE_READ_CONFIG_REGISTER_CONST_CONFIG_HANDLER
@@ -323,7 +387,7 @@ register_const_config_handler(const char *type,
 {
     return internal_register_config_handler(type, token,
                                             (void(*)(const char *, char *))
-                                            parser, releaser,
+                                            parser, NULL, releaser,
 					    help, NORMAL_CONFIG);
 }
 #endif /* NETSNMP_FEATURE_REMOVE_READ_CONFIG_REGISTER_CONST_CONFIG_HANDLER */
@@ -336,6 +400,17 @@ register_app_config_handler(const char *token,
     return (register_config_handler(NULL, token, parser, releaser, help));
 }
 
+struct config_line *
+register_app_config_handler_incremental(const char *token,
+                                        void (*parser) (const char *, char *),
+                                        void (*remover) (const char *, char *),
+                                        void (*releaser) (void),
+                                        const char *help)
+{
+    return (register_config_handler_incremental(NULL, token, parser, remover,
+                                                releaser, help));
+}
+
 
 
 /**
@@ -409,6 +484,7 @@ unregister_config_handler(const char *type_param, const char *token)
         struct config_line *ltmp2 = (*ltmp)->next;
         if ((*ltmp)->free_func)
             (*ltmp)->free_func();
+        config_forget_applied(*ltmp);
         SNMP_FREE((*ltmp)->config_token);
         SNMP_FREE((*ltmp)->help);
         SNMP_FREE(*ltmp);
@@ -423,6 +499,7 @@ unregister_config_handler(const char *type_param, const char *token)
         struct config_line *ltmp2 = (*ltmp)->next->next;
         if ((*ltmp)->next->free_func)
             (*ltmp)->next->free_func();
+        config_forget_applied((*ltmp)->next);
         SNMP_FREE((*ltmp)->next->config_token);
         SNMP_FREE((*ltmp)->next->help);
         SNMP_FREE((*ltmp)->next);
@@ -555,6 +632,9 @@ run_config_handler(struct config_line *lptr,
             while ((cp > cptr) && isspace((unsigned char)(*cp))) {
                 *(cp--) = '\0';
             }
+            if (lptr->remove_line &&
+                !config_remember_applied(lptr, cptr))
+                return SNMPERR_SUCCESS;
             (*(lptr->parse_line)) (token, cptr);
         }
         else
@@ -988,16 +1068,157 @@ read_config(const char *filename,
 
 
 
+/*
+ * Handlers with a remover keep their lines over a reread, which is
+ * then compared against what they were given last time.
+ */
+static void
+config_forget_applied(struct config_line *lptr)
+{
+    struct read_config_applied *ap;
+
+    while ((ap = lptr->applied) != NULL) {
+        lptr->applied = ap->next;
+        free(ap->line);
+        free(ap->filename);
+        free(ap);
+    }
+}
+
+/*
+ * Returns 1 if the line should be parsed straight away, or 0 if it is
+ * unchanged since the last read, or its parsing has been put off until
+ * config_apply_changes().
+ */
+static int
+config_remember_applied(struct config_line *lptr, const char *line)
+{
+    struct read_config_applied *ap, **app;
+
+    if (config_rereading) {
+        for (ap = lptr->applied; ap; ap = ap->next)
+            if (ap->state == CONFIG_LINE_STALE && !strcmp(ap->line, line)) {
+                ap->state = CONFIG_LINE_CURRENT;
+                DEBUGMSGTL(("read_config:incremental", "unchanged %s %s\n",
+                            lptr->config_token, line));
+                return 0;
+            }
+    }
+
+    for (app = &lptr->applied; *app; app = &(*app)->next)
+        ;
+    ap = SNMP_MALLOC_STRUCT(read_config_applied);
+    if (ap == NULL)
+        return 1;
+    ap->line = strdup(line);
+    ap->filename = curfilename ? strdup(curfilename) : NULL;
+    ap->linecount = linecount;
+    ap->state = config_rereading ? CONFIG_LINE_NEW : CONFIG_LINE_CURRENT;
+    *app = ap;
+    return !config_rereading;
+}
+
+/*
+ * Passes the differences found while rereading the configuration on to
+ * the handlers concerned: all the removals first, so that a line which
+ * has changed can be added again under the same name.
+ */
+static void
+config_apply_changes(void)
+{
+    struct config_files *ctmp;
+    struct config_line *ltmp;
+    struct read_config_applied *ap, **app;
+    const char * const prev_filename = curfilename;
+    const unsigned int prev_linecount = linecount;
+    char           *buf;
+
+    config_rereading = 0;
+
+    for (ctmp = config_files; ctmp != NULL; ctmp = ctmp->next)
+        for (ltmp = ctmp->start; ltmp != NULL; ltmp = ltmp->next) {
+            if (!ltmp->remove_line)
+                continue;
+            for (app = &ltmp->applied; (ap = *app) != NULL; ) {
+                if (ap->state != CONFIG_LINE_STALE) {
+                    app = &ap->next;
+                    continue;
+                }
+                *app = ap->next;
+                DEBUGMSGTL(("read_config:incremental", "removing %s %s\n",
+                            ltmp->config_token, ap->line));
+                curfilename = ap->filename;
+                linecount = ap->linecount;
+                (*(ltmp->remove_line)) (ltmp->config_token, ap->line);
+                free(ap->line);
+                free(ap->filename);
+                free(ap);
+            }
+        }
+
+    for (ctmp = config_files; ctmp != NULL; ctmp = ctmp->next)
+        for (ltmp = ctmp->start; ltmp != NULL; ltmp = ltmp->next) {
+            if (!ltmp->remove_line)
+                continue;
+            for (ap = ltmp->applied; ap; ap = ap->next) {
+                if (ap->state != CONFIG_LINE_NEW)
+                    continue;
+                ap->state = CONFIG_LINE_CURRENT;
+                buf = strdup(ap->line);
+                if (buf == NULL)
+                    continue;
+                DEBUGMSGTL(("read_config:incremental", "adding %s %s\n",
+                            ltmp->config_token, ap->line));
+                curfilename = ap->filename;
+                linecount = ap->linecount;
+                (*(ltmp->parse_line)) (ltmp->config_token, buf);
+                free(buf);
+            }
+        }
+
+    linecount = prev_linecount;
+    curfilename = prev_filename;
+}
+
 void
 free_config(void)
 {
     struct config_files *ctmp = config_files;
     struct config_line *ltmp;
+    struct read_config_applied *ap, **app;
+    int             reread;
+
+    /*
+     * once the configuration has been read, handlers with a remover
+     * keep their state for the reread to be compared against
+     */
+    reread = netsnmp_ds_get_boolean(NETSNMP_DS_LIBRARY_ID,
+                                    NETSNMP_DS_LIB_HAVE_READ_CONFIG);
 
     for (; ctmp != NULL; ctmp = ctmp->next)
-        for (ltmp = ctmp->start; ltmp != NULL; ltmp = ltmp->next)
+        for (ltmp = ctmp->start; ltmp != NULL; ltmp = ltmp->next) {
+            if (ltmp->remove_line && reread) {
+                for (app = &ltmp->applied; (ap = *app) != NULL; ) {
+                    if (ap->state == CONFIG_LINE_NEW) {
+                        /* never parsed, so nothing to remove */
+                        *app = ap->next;
+                        free(ap->line);
+                        free(ap->filename);
+                        free(ap);
+                        continue;
+                    }
+                    ap->state = CONFIG_LINE_STALE;
+                    app = &ap->next;
+                }
+                continue;
+            }
             if (ltmp->free_func)
                 (*(ltmp->free_func)) ();
+            if (ltmp->remove_line)
+                config_forget_applied(ltmp);
+        }
+    if (reread)
+        config_rereading = 1;
 }
 
 /*
@@ -1067,6 +1288,9 @@ read_configs(void)
 
     netsnmp_config_process_memories_when(NORMAL_CONFIG, 1);
 
+    if (config_rereading)
+        config_apply_changes();
+
     netsnmp_ds_set_boolean(NETSNMP_DS_LIBRARY_ID, 
 			   NETSNMP_DS_LIB_HAVE_READ_CONFIG, 1);
     snmp_call_callbacks(SNMP_CALLBACK_LIBRARY,
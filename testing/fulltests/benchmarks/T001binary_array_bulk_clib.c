@@ -0,0 +1,78 @@
+/* HEADER Binary array bulk load and sorted insert timings */
+
+/*
+ * Not a correctness test (see unit-tests/T023binary_array_bulk_clib.c);
+ * run with "RUNFULLTESTS -g benchmarks" or "make benchmark".
+ */
+static const char test_name[] = "binary-array-bulk-benchmark";
+#define BULK_ENTRIES 1000000
+#define STEP         7919          /* coprime with BULK_ENTRIES */
+oid *vals;
+netsnmp_index *idx, *ip, *prev;
+netsnmp_container *c;
+struct timeval start, end;
+size_t i, n;
+int rc, sorted;
+
+init_snmp(test_name);
+
+vals = (oid *) malloc(BULK_ENTRIES * sizeof(oid));
+idx = (netsnmp_index *) malloc(BULK_ENTRIES * sizeof(netsnmp_index));
+OKF(vals && idx, ("allocated %d entries", BULK_ENTRIES));
+if (vals && idx) {
+    for (i = 0; i < BULK_ENTRIES; ++i) {
+        vals[i] = i ? (vals[i - 1] + STEP) % BULK_ENTRIES : 0; /* shuffled */
+        idx[i].oids = &vals[i];
+        idx[i].len = 1;
+    }
+
+    c = netsnmp_container_get_binary_array();
+    c->compare = netsnmp_compare_netsnmp_index;
+    netsnmp_get_monotonic_clock(&start);
+    netsnmp_binary_array_bulk_begin(c);
+    for (i = 0; i < BULK_ENTRIES; ++i)
+        CONTAINER_INSERT(c, &idx[i]);
+    /* and every tenth one again */
+    for (i = 0; i < BULK_ENTRIES; i += 10)
+        CONTAINER_INSERT(c, &idx[i]);
+    rc = netsnmp_binary_array_bulk_end(c, NULL, NULL);
+    netsnmp_get_monotonic_clock(&end);
+    NETSNMP_TIMERSUB(&end, &start, &end);
+    printf("# bulk load of %d unordered entries: %ld.%06ld s\n",
+           BULK_ENTRIES, (long)end.tv_sec, (long)end.tv_usec);
+    OKF(rc == BULK_ENTRIES / 10 && CONTAINER_SIZE(c) == BULK_ENTRIES,
+        ("bulk load: %" NETSNMP_PRIz "d entries, %d duplicates dropped",
+         CONTAINER_SIZE(c), rc));
+    sorted = 1;
+    n = 0;
+    for (prev = NULL, ip = CONTAINER_FIRST(c); ip;
+         prev = ip, ip = CONTAINER_NEXT(c, ip), ++n)
+        if (prev && c->compare(prev, ip) >= 0)
+            sorted = 0;
+    OKF(sorted && n == BULK_ENTRIES, ("bulk load: container is in order"));
+    CONTAINER_FREE(c);
+
+    /*
+     * in-order single inserts, as most cache loaders do
+     */
+    for (i = 0; i < BULK_ENTRIES; ++i)
+        vals[i] = i;
+    c = netsnmp_container_get_binary_array();
+    c->compare = netsnmp_compare_netsnmp_index;
+    netsnmp_get_monotonic_clock(&start);
+    for (i = 0; i < BULK_ENTRIES; ++i)
+        CONTAINER_INSERT(c, &idx[i]);
+    netsnmp_get_monotonic_clock(&end);
+    NETSNMP_TIMERSUB(&end, &start, &end);
+    printf("# %d ordered single inserts: %ld.%06ld s\n",
+           BULK_ENTRIES, (long)end.tv_sec, (long)end.tv_usec);
+    OKF(CONTAINER_SIZE(c) == BULK_ENTRIES &&
+        CONTAINER_FIND(c, &idx[BULK_ENTRIES / 2]) == &idx[BULK_ENTRIES / 2],
+        ("ordered single inserts: %" NETSNMP_PRIz "d entries",
+         CONTAINER_SIZE(c)));
+    CONTAINER_FREE(c);
+}
+free(idx);
+free(vals);
+
+snmp_shutdown(test_name);
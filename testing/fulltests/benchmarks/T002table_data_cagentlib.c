@@ -0,0 +1,71 @@
+/* HEADER table_data row insert, walk and lookup timings */
+
+/*
+ * Not a correctness test (see unit-tests/T026table_data_cagentlib.c);
+ * run with "RUNFULLTESTS -g benchmarks" or "make benchmark".
+ */
+#define TD_ROWS  100000
+#define TD_STEP  7919           /* coprime with TD_ROWS */
+netsnmp_table_data *table;
+netsnmp_table_row *row, *next;
+oid     search[1];
+int32_t ival;
+long    i, k, n;
+int     ok;
+struct timeval start, end;
+
+init_agent("snmpd");
+init_snmp("snmpd");
+
+table = netsnmp_create_table_data("table_data benchmark");
+OK(table != NULL, "table data creation");
+netsnmp_table_data_add_index(table, ASN_INTEGER);
+
+netsnmp_get_monotonic_clock(&start);
+n = 0;
+for (i = 0, k = 0; i < TD_ROWS; ++i, k = (k + TD_STEP) % TD_ROWS) {
+    row = netsnmp_create_table_data_row();
+    ival = k;
+    netsnmp_table_row_add_index(row, ASN_INTEGER, &ival, sizeof(ival));
+    if (netsnmp_table_data_add_row(table, row) == SNMPERR_SUCCESS)
+        ++n;
+    else
+        netsnmp_table_data_delete_row(row);
+}
+netsnmp_get_monotonic_clock(&end);
+NETSNMP_TIMERSUB(&end, &start, &end);
+printf("# %d unordered row inserts: %ld.%06ld s\n",
+       TD_ROWS, (long)end.tv_sec, (long)end.tv_usec);
+OKF(n == TD_ROWS, ("inserted %ld rows", n));
+
+netsnmp_get_monotonic_clock(&start);
+for (n = 0, row = netsnmp_table_data_get_first_row(table); row;
+     row = netsnmp_table_data_get_next_row(table, row))
+    ++n;
+netsnmp_get_monotonic_clock(&end);
+NETSNMP_TIMERSUB(&end, &start, &end);
+printf("# %d row walk: %ld.%06ld s\n",
+       TD_ROWS, (long)end.tv_sec, (long)end.tv_usec);
+OKF(n == TD_ROWS, ("walked %ld rows", n));
+
+netsnmp_get_monotonic_clock(&start);
+ok = 1;
+for (i = 0, k = 0; i < TD_ROWS; ++i, k = (k + TD_STEP) % TD_ROWS) {
+    search[0] = k;
+    if (!netsnmp_table_data_get_from_oid(table, search, 1))
+        ok = 0;
+}
+netsnmp_get_monotonic_clock(&end);
+NETSNMP_TIMERSUB(&end, &start, &end);
+printf("# %d row lookups: %ld.%06ld s\n",
+       TD_ROWS, (long)end.tv_sec, (long)end.tv_usec);
+OK(ok, "every row found by index");
+
+for (row = netsnmp_table_data_get_first_row(table); row; row = next) {
+    next = row->next;
+    netsnmp_table_data_remove_and_delete_row(table, row);
+}
+netsnmp_table_data_delete_table(table);
+
+snmp_shutdown("snmpd");
+shutdown_agent();
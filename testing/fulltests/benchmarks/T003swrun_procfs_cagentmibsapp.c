@@ -0,0 +1,159 @@
+/*
+ * HEADER hrSWRunTable /proc load timings
+ */
+
+/*
+ * Not a correctness test; run with "RUNFULLTESTS -g benchmarks" or
+ * "make benchmark".  It builds a synthetic /proc-like tree in a
+ * temporary directory, and times a load of it with an empty process
+ * info cache, and loads after that.
+ */
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+#include <net-snmp/library/testing.h>
+#include <net-snmp/data_access/swrun.h>
+
+#include <stdio.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <sys/stat.h>
+
+#ifdef USING_HOST_DATA_ACCESS_SWRUN_PROCFS_STATUS_MODULE
+
+#define SWRUN_PROCESSES 20000
+#define SWRUN_LOADS     4       /* the first one with a cold cache */
+
+void init_swrun(void);
+
+extern const char *_swrun_procfs_dir;
+
+static void
+_write_file(const char *dir, int pid, const char *file, const char *data,
+            size_t len)
+{
+    char  path[SNMP_MAXPATH];
+    FILE *fp;
+
+    snprintf(path, sizeof(path), "%s/%d/%s", dir, pid, file);
+    fp = fopen(path, "w");
+    if (fp) {
+        fwrite(data, 1, len, fp);
+        fclose(fp);
+    }
+}
+
+static void
+_synthetic_proc_create(const char *dir, int count)
+{
+    char  path[SNMP_MAXPATH], buf[512];
+    int   pid, len;
+
+    for (pid = 1; pid <= count; ++pid) {
+        snprintf(path, sizeof(path), "%s/%d", dir, pid);
+        mkdir(path, 0755);
+        len = snprintf(buf, sizeof(buf),
+                       "%d (worker-%d) S 1 %d %d 0 -1 4194560 2500 0 0 0 "
+                       "%d %d 0 0 20 0 4 0 %d 123456789 %d 18446744073709551615 "
+                       "1 1 0 0 0 0 0 4096 0 0 0 0 17 %d 0 0 0 0 0\n",
+                       pid, pid, pid, pid, pid % 1000, pid % 100,
+                       1000 + pid, 100 + pid % 1000, pid % 8);
+        _write_file(dir, pid, "stat", buf, len);
+        len = snprintf(buf, sizeof(buf),
+                       "Name:\tworker-%d\nUmask:\t0022\nState:\tS (sleeping)\n"
+                       "Tgid:\t%d\nPid:\t%d\nPPid:\t1\n", pid, pid, pid);
+        _write_file(dir, pid, "status", buf, len);
+        len = snprintf(buf, sizeof(buf),
+                       "/usr/bin/worker-%d%c--config%c/etc/worker/%d.conf%c",
+                       pid, 0, 0, pid, 0);
+        _write_file(dir, pid, "cmdline", buf, len);
+    }
+}
+
+static void
+_synthetic_proc_remove(const char *dir, int count)
+{
+    static const char *files[] = { "stat", "status", "cmdline" };
+    char  path[SNMP_MAXPATH];
+    int   pid, i;
+
+    for (pid = 1; pid <= count; ++pid) {
+        for (i = 0; i < (int)(sizeof(files) / sizeof(files[0])); ++i) {
+            snprintf(path, sizeof(path), "%s/%d/%s", dir, pid, files[i]);
+            unlink(path);
+        }
+        snprintf(path, sizeof(path), "%s/%d", dir, pid);
+        rmdir(path);
+    }
+    rmdir(dir);
+}
+
+int
+main(int argc, char *argv[])
+{
+    char                 dir[] = "/tmp/swrun-XXXXXX";
+    char                 path[SNMP_MAXPATH];
+    netsnmp_container   *container;
+    netsnmp_swrun_entry *entry;
+    oid                  last_pid = SWRUN_PROCESSES;
+    netsnmp_index        last = { 1, &last_pid };
+    struct timeval       start, end;
+    size_t               count;
+    int                  i;
+
+    init_agent("snmpd");
+    init_snmp("snmpd");
+
+    if (NULL == mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    _synthetic_proc_create(dir, SWRUN_PROCESSES);
+    _swrun_procfs_dir = dir;
+
+    init_swrun();
+    container = netsnmp_container_find("swrun:table_container");
+    OK(container != NULL, "swrun container creation");
+
+    for (i = 0; container && i < SWRUN_LOADS; ++i) {
+        netsnmp_get_monotonic_clock(&start);
+        netsnmp_swrun_container_load(container, 0);
+        netsnmp_get_monotonic_clock(&end);
+        NETSNMP_TIMERSUB(&end, &start, &end);
+        printf("# %d process load, %s cache: %ld.%06ld s\n",
+               SWRUN_PROCESSES, i ? "warm" : "cold",
+               (long)end.tv_sec, (long)end.tv_usec);
+        count = CONTAINER_SIZE(container);
+        OKF(count == SWRUN_PROCESSES,
+            ("load %d: %" NETSNMP_PRIz "d processes", i, count));
+        entry = (netsnmp_swrun_entry *) CONTAINER_FIND(container, &last);
+        snprintf(path, sizeof(path), "/usr/bin/worker-%d", SWRUN_PROCESSES);
+        OKF(entry && 0 == strcmp(entry->hrSWRunPath, path),
+            ("load %d: path of the last process", i));
+        netsnmp_swrun_container_free_items(container);
+    }
+    if (container)
+        netsnmp_swrun_container_free(container, NETSNMP_SWRUN_NOFLAGS);
+
+    _synthetic_proc_remove(dir, SWRUN_PROCESSES);
+    snmp_shutdown("snmpd");
+    shutdown_agent();
+
+    PLAN(__test_counter);
+    return 0;
+}
+
+#else /* !USING_HOST_DATA_ACCESS_SWRUN_PROCFS_STATUS_MODULE */
+
+int
+main(int argc, char *argv[])
+{
+    printf("1..0 # SKIP no /proc based hrSWRunTable\n");
+    return 0;
+}
+
+#endif /* !USING_HOST_DATA_ACCESS_SWRUN_PROCFS_STATUS_MODULE */
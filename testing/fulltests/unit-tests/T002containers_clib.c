@@ -28,8 +28,57 @@ OK(CONTAINER_FIND(container, "bar") == NULL,
 OK(CONTAINER_SIZE(container) == 2,
    "container has the proper size for the elements after a removal");
 
+CONTAINER_REMOVE(container, "baz");
+CONTAINER_INSERT(container, "baz");
+CONTAINER_INSERT(container, "qux");
+
+p = CONTAINER_FIRST(container);
+OK(p && strcmp(p, "foo") == 0, "fifo returns 'foo' first");
+CONTAINER_REMOVE(container, NULL);
+p = CONTAINER_FIRST(container);
+OK(p && strcmp(p, "baz") == 0, "fifo returns re-added 'baz' next");
+CONTAINER_REMOVE(container, NULL);
+p = CONTAINER_FIRST(container);
+OK(p && strcmp(p, "qux") == 0, "fifo returns 'qux' last");
+CONTAINER_REMOVE(container, NULL);
+
+OK(CONTAINER_SIZE(container) == 0 && CONTAINER_FIRST(container) == NULL,
+   "fifo is empty");
+CONTAINER_INSERT(container, "foo");
+OK(CONTAINER_SIZE(container) == 1 && CONTAINER_FIRST(container) != NULL,
+   "emptied fifo can be reused");
+
 while ((p = CONTAINER_FIRST(container)))
   CONTAINER_REMOVE(container, p);
 CONTAINER_FREE(container);
 
+/*
+ * ITERATOR_FIRST rewinds an iterator which has run off the end
+ */
+{
+    const char *types[] = { "binary_array", "sorted_singly_linked_list" };
+    netsnmp_iterator *it;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        container = netsnmp_container_find(types[i]);
+        container->compare = (netsnmp_container_compare*) strcmp;
+        CONTAINER_INSERT(container, "a");
+        CONTAINER_INSERT(container, "b");
+        it = CONTAINER_ITERATOR(container);
+        p = ITERATOR_FIRST(it);
+        p = ITERATOR_NEXT(it);
+        p = ITERATOR_NEXT(it);
+        OKF(p == NULL, ("%s iterator ends after two items", types[i]));
+        p = ITERATOR_FIRST(it);
+        p = ITERATOR_NEXT(it);
+        OKF(p && strcmp(p, "b") == 0,
+            ("%s iterator restarts at ITERATOR_FIRST", types[i]));
+        ITERATOR_RELEASE(it);
+        while ((p = CONTAINER_FIRST(container)))
+            CONTAINER_REMOVE(container, p);
+        CONTAINER_FREE(container);
+    }
+}
+
 snmp_shutdown("container-test");
@@ -0,0 +1,117 @@
+/*
+ * HEADER Testing incremental rereading of configuration files
+ *
+ * Expected SUCCESSes for all tests:    9
+ */
+
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/library/testing.h>
+
+#include <stdio.h>
+#include <string.h>
+
+static char parsed[256];
+static char removed[256];
+static int  released = 0;
+
+static void
+parse_config(const char *token, char *cptr)
+{
+    strlcat(parsed, cptr, sizeof(parsed));
+    strlcat(parsed, ";", sizeof(parsed));
+}
+
+static void
+remove_config(const char *token, char *cptr)
+{
+    strlcat(removed, cptr, sizeof(removed));
+    strlcat(removed, ";", sizeof(removed));
+}
+
+static void
+release_config(void)
+{
+    ++released;
+}
+
+static int
+write_config(const char *path, const char *contents)
+{
+    FILE *fp = fopen(path, "w");
+
+    if (!fp)
+        return -1;
+    fputs(contents, fp);
+    fclose(fp);
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    char path[] = "/tmp/T022read_config_XXXXXX";
+    int  fd;
+
+    fd = mkstemp(path);
+    OKF(fd >= 0, ("creating %s\n", path));
+    if (fd < 0)
+        return 1;
+    close(fd);
+
+    write_config(path, "incrtoken a\nincrtoken b\nincrtoken b\n");
+    netsnmp_ds_set_boolean(NETSNMP_DS_LIBRARY_ID,
+                           NETSNMP_DS_LIB_DONT_PERSIST_STATE, 1);
+    netsnmp_ds_set_string(NETSNMP_DS_LIBRARY_ID,
+                          NETSNMP_DS_LIB_OPTIONALCONFIG, path);
+    register_config_handler_incremental("testing", "incrtoken",
+                                        parse_config, remove_config,
+                                        release_config, NULL);
+    init_snmp("testing");
+    OKF(strcmp(parsed, "a;b;b;") == 0,
+        ("first read parses every line, got \"%s\"\n", parsed));
+    OKF(removed[0] == '\0', ("nothing removed yet, got \"%s\"\n", removed));
+    released = 0;
+
+    /*
+     * one copy of b goes, a goes, c is new
+     */
+    parsed[0] = '\0';
+    write_config(path, "incrtoken b\nincrtoken c\n");
+    free_config();
+    read_configs();
+    OKF(strcmp(parsed, "c;") == 0,
+        ("reread parses only the new line, got \"%s\"\n", parsed));
+    OKF(strcmp(removed, "a;b;") == 0,
+        ("reread removes the dropped lines, got \"%s\"\n", removed));
+    OKF(released == 0, ("releaser not called on reread\n"));
+
+    /*
+     * no change
+     */
+    parsed[0] = removed[0] = '\0';
+    free_config();
+    read_configs();
+    OKF(parsed[0] == '\0' && removed[0] == '\0',
+        ("unchanged reread does nothing, got \"%s\" / \"%s\"\n",
+         parsed, removed));
+
+    /*
+     * changed line: removed before the new one is added
+     */
+    write_config(path, "incrtoken b\nincrtoken c2\n");
+    free_config();
+    read_configs();
+    OKF(strcmp(removed, "c;") == 0 && strcmp(parsed, "c2;") == 0,
+        ("changed line replaced, got \"%s\" / \"%s\"\n", removed, parsed));
+
+    snmp_shutdown("testing");
+    OKF(released == 1, ("releaser called once at shutdown, got %d\n",
+                        released));
+
+    unlink(path);
+    if (__did_plan == 0) {
+       PLAN(__test_counter);
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+/* HEADER Testing binary array bulk loads and sorted inserts */
+
+static const char test_name[] = "binary-array-bulk-test";
+#define BULK_ENTRIES 1000
+#define STEP         7919          /* coprime with BULK_ENTRIES */
+oid small_vals[] = { 5, 3, 9, 1, 7, 3, 5, 2 };
+netsnmp_index small[sizeof(small_vals)/sizeof(small_vals[0])];
+oid *vals;
+netsnmp_index *idx, *ip, *prev;
+netsnmp_container *c;
+size_t i, n;
+int rc, sorted;
+
+init_snmp(test_name);
+
+/*
+ * single inserts keep the array sorted and reject duplicates
+ */
+c = netsnmp_container_get_binary_array();
+c->compare = netsnmp_compare_netsnmp_index;
+for (i = 0; i < sizeof(small)/sizeof(small[0]); ++i) {
+    small[i].oids = &small_vals[i];
+    small[i].len = 1;
+}
+n = 0;
+for (i = 0; i < sizeof(small)/sizeof(small[0]); ++i)
+    if (CONTAINER_INSERT(c, &small[i]) == 0)
+        ++n;
+OKF(n == 6 && CONTAINER_SIZE(c) == 6,
+    ("single inserts: %" NETSNMP_PRIz "d of 8 accepted", n));
+sorted = 1;
+for (prev = NULL, ip = CONTAINER_FIRST(c); ip;
+     prev = ip, ip = CONTAINER_NEXT(c, ip))
+    if (prev && c->compare(prev, ip) >= 0)
+        sorted = 0;
+OKF(sorted, ("single inserts: container is in order"));
+CONTAINER_FREE(c);
+
+/*
+ * bulk load on top of existing entries: existing entries win
+ */
+c = netsnmp_container_get_binary_array();
+c->compare = netsnmp_compare_netsnmp_index;
+CONTAINER_INSERT(c, &small[0]);                 /* 5 */
+OKF(netsnmp_binary_array_bulk_begin(c) == 0, ("bulk begin"));
+for (i = 1; i < sizeof(small)/sizeof(small[0]); ++i)
+    CONTAINER_INSERT(c, &small[i]);
+rc = netsnmp_binary_array_bulk_end(c, NULL, NULL);
+OKF(rc == 2, ("bulk end dropped %d duplicates, expected 2", rc));
+OKF(CONTAINER_SIZE(c) == 6, ("bulk load: %" NETSNMP_PRIz "d entries",
+                             CONTAINER_SIZE(c)));
+OKF(CONTAINER_FIND(c, &small[6]) == &small[0],
+    ("bulk load: entry already present kept over new duplicate"));
+sorted = 1;
+for (prev = NULL, ip = CONTAINER_FIRST(c); ip;
+     prev = ip, ip = CONTAINER_NEXT(c, ip))
+    if (prev && c->compare(prev, ip) >= 0)
+        sorted = 0;
+OKF(sorted, ("bulk load: container is in order"));
+CONTAINER_FREE(c);
+
+/*
+ * a lookup in the middle of a bulk load must not stop bulk end from
+ * dropping the duplicates, before or after the lookup
+ */
+c = netsnmp_container_get_binary_array();
+c->compare = netsnmp_compare_netsnmp_index;
+CONTAINER_INSERT(c, &small[0]);                 /* 5 */
+netsnmp_binary_array_bulk_begin(c);
+for (i = 1; i < 4; ++i)                         /* 3 9 1 */
+    CONTAINER_INSERT(c, &small[i]);
+OKF(CONTAINER_FIND(c, &small[3]) == &small[3], ("mid bulk lookup"));
+for (i = 4; i < sizeof(small)/sizeof(small[0]); ++i)   /* 7 3 5 2 */
+    CONTAINER_INSERT(c, &small[i]);
+OKF(CONTAINER_FIND(c, &small[7]) == &small[7], ("lookup before bulk end"));
+rc = netsnmp_binary_array_bulk_end(c, NULL, NULL);
+OKF(rc == 2 && CONTAINER_SIZE(c) == 6,
+    ("mid bulk lookup: %" NETSNMP_PRIz "d entries, %d duplicates dropped",
+     CONTAINER_SIZE(c), rc));
+OKF(CONTAINER_FIND(c, &small[6]) == &small[0] &&
+    CONTAINER_FIND(c, &small[5]) == &small[1],
+    ("mid bulk lookup: older entries kept over new duplicates"));
+sorted = 1;
+for (prev = NULL, ip = CONTAINER_FIRST(c); ip;
+     prev = ip, ip = CONTAINER_NEXT(c, ip))
+    if (prev && c->compare(prev, ip) >= 0)
+        sorted = 0;
+OKF(sorted, ("mid bulk lookup: container is in order"));
+CONTAINER_FREE(c);
+
+/*
+ * bulk load of unordered entries, with duplicates
+ */
+vals = (oid *) malloc(BULK_ENTRIES * sizeof(oid));
+idx = (netsnmp_index *) malloc(BULK_ENTRIES * sizeof(netsnmp_index));
+OKF(vals && idx, ("allocated %d entries", BULK_ENTRIES));
+if (vals && idx) {
+    for (i = 0; i < BULK_ENTRIES; ++i) {
+        vals[i] = i ? (vals[i - 1] + STEP) % BULK_ENTRIES : 0; /* shuffled */
+        idx[i].oids = &vals[i];
+        idx[i].len = 1;
+    }
+
+    c = netsnmp_container_get_binary_array();
+    c->compare = netsnmp_compare_netsnmp_index;
+    netsnmp_binary_array_bulk_begin(c);
+    for (i = 0; i < BULK_ENTRIES; ++i)
+        CONTAINER_INSERT(c, &idx[i]);
+    /* and every tenth one again */
+    for (i = 0; i < BULK_ENTRIES; i += 10)
+        CONTAINER_INSERT(c, &idx[i]);
+    rc = netsnmp_binary_array_bulk_end(c, NULL, NULL);
+    OKF(rc == BULK_ENTRIES / 10 && CONTAINER_SIZE(c) == BULK_ENTRIES,
+        ("bulk load: %" NETSNMP_PRIz "d entries, %d duplicates dropped",
+         CONTAINER_SIZE(c), rc));
+    sorted = 1;
+    n = 0;
+    for (prev = NULL, ip = CONTAINER_FIRST(c); ip;
+         prev = ip, ip = CONTAINER_NEXT(c, ip), ++n)
+        if (prev && c->compare(prev, ip) >= 0)
+            sorted = 0;
+    OKF(sorted && n == BULK_ENTRIES, ("bulk load: container is in order"));
+    CONTAINER_FREE(c);
+}
+free(idx);
+free(vals);
+
+snmp_shutdown(test_name);
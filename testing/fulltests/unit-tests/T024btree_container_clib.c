@@ -0,0 +1,122 @@
+/* HEADER Testing the btree container */
+
+static const char test_name[] = "btree-container-test";
+#define BT_ENTRIES   5000          /* enough for a three level tree */
+#define BT_STEP      7919          /* coprime with BT_ENTRIES */
+oid *vals, prefix_val[1];
+netsnmp_index *idx, *ip, *prev, prefix, dups[3];
+netsnmp_container *c;
+netsnmp_iterator *it;
+netsnmp_void_array *va;
+size_t i, k, n;
+int ok, sorted;
+
+init_snmp(test_name);
+
+c = netsnmp_container_find("btree");
+OKF(c != NULL, ("btree container found in the factory"));
+vals = (oid *) malloc(BT_ENTRIES * 2 * sizeof(oid));
+idx = (netsnmp_index *) malloc(BT_ENTRIES * sizeof(netsnmp_index));
+if (c && vals && idx) {
+    c->ncompare = netsnmp_ncompare_netsnmp_index;
+
+    /*
+     * two-part indexes, inserted in a scrambled order
+     */
+    for (i = 0, k = 0; i < BT_ENTRIES; ++i, k = (k + BT_STEP) % BT_ENTRIES) {
+        vals[2 * k] = k / 100;
+        vals[2 * k + 1] = k % 100;
+        idx[k].oids = &vals[2 * k];
+        idx[k].len = 2;
+    }
+    n = 0;
+    for (i = 0, k = 0; i < BT_ENTRIES; ++i, k = (k + BT_STEP) % BT_ENTRIES)
+        if (CONTAINER_INSERT(c, &idx[k]) == 0)
+            ++n;
+    OKF(n == BT_ENTRIES && CONTAINER_SIZE(c) == BT_ENTRIES,
+        ("inserted %" NETSNMP_PRIz "d entries", CONTAINER_SIZE(c)));
+    OKF(CONTAINER_INSERT(c, &idx[42]) != 0, ("duplicate insert refused"));
+
+    sorted = 1;
+    for (n = 0, ip = CONTAINER_FIRST(c); ip; ip = CONTAINER_NEXT(c, ip), ++n)
+        if (ip != &idx[n])
+            sorted = 0;
+    OKF(sorted && n == BT_ENTRIES, ("find_next walks all entries in order"));
+
+    ok = 1;
+    for (i = 0; i < BT_ENTRIES; ++i)
+        if (CONTAINER_FIND(c, &idx[i]) != &idx[i])
+            ok = 0;
+    OKF(ok, ("find locates every entry"));
+
+    it = CONTAINER_ITERATOR(c);
+    sorted = 1;
+    for (n = 0, ip = ITERATOR_FIRST(it); ip; ip = ITERATOR_NEXT(it), ++n)
+        if (ip != &idx[n])
+            sorted = 0;
+    OKF(sorted && n == BT_ENTRIES, ("iterator walks all entries in order"));
+    OKF(ITERATOR_LAST(it) == &idx[BT_ENTRIES - 1], ("iterator last"));
+    ITERATOR_RELEASE(it);
+
+    prefix_val[0] = 23;
+    prefix.oids = prefix_val;
+    prefix.len = 1;
+    va = CONTAINER_GET_SUBSET(c, &prefix);
+    OKF(va && va->size == 100 && va->array[0] == &idx[2300] &&
+        va->array[99] == &idx[2399], ("get_subset returns one prefix"));
+    if (va) {
+        free(va->array);
+        free(va);
+    }
+
+    /*
+     * remove every other entry, in a scrambled order
+     */
+    for (i = 0, k = 0; i < BT_ENTRIES; ++i, k = (k + BT_STEP) % BT_ENTRIES)
+        if (k & 1)
+            CONTAINER_REMOVE(c, &idx[k]);
+    OKF(CONTAINER_SIZE(c) == BT_ENTRIES / 2,
+        ("%" NETSNMP_PRIz "d entries left after removals", CONTAINER_SIZE(c)));
+    OKF(CONTAINER_REMOVE(c, &idx[1]) != 0, ("removing a missing entry fails"));
+    ok = 1;
+    for (i = 0; i < BT_ENTRIES; ++i)
+        if (CONTAINER_FIND(c, &idx[i]) != ((i & 1) ? NULL : &idx[i]))
+            ok = 0;
+    OKF(ok, ("find after removals"));
+    OKF(CONTAINER_NEXT(c, &idx[1]) == &idx[2], ("find_next of a removed entry"));
+    sorted = 1;
+    for (n = 0, prev = NULL, ip = CONTAINER_FIRST(c); ip;
+         prev = ip, ip = CONTAINER_NEXT(c, ip), ++n)
+        if (prev && c->compare(prev, ip) >= 0)
+            sorted = 0;
+    OKF(sorted && n == BT_ENTRIES / 2, ("still in order after removals"));
+
+    for (i = 0; i < BT_ENTRIES; i += 2)
+        CONTAINER_REMOVE(c, &idx[i]);
+    OKF(CONTAINER_SIZE(c) == 0 && CONTAINER_FIRST(c) == NULL,
+        ("empty after removing everything"));
+
+    /*
+     * duplicates: kept in insertion order, removal prefers the same object
+     */
+    CONTAINER_SET_OPTIONS(c, CONTAINER_KEY_ALLOW_DUPLICATES, ok);
+    for (i = 0; i < 3; ++i) {
+        dups[i] = idx[7];
+        CONTAINER_INSERT(c, &dups[i]);
+    }
+    CONTAINER_INSERT(c, &idx[8]);
+    CONTAINER_INSERT(c, &idx[6]);
+    OKF(CONTAINER_SIZE(c) == 5 && CONTAINER_FIND(c, &idx[7]) == &dups[0] &&
+        CONTAINER_NEXT(c, &idx[7]) == &idx[8],
+        ("duplicates inserted, find_next skips them"));
+    CONTAINER_REMOVE(c, &dups[1]);
+    OKF(CONTAINER_NEXT(c, &idx[6]) == &dups[0] &&
+        CONTAINER_NEXT(c, &dups[0]) == &idx[8] && CONTAINER_SIZE(c) == 4,
+        ("removing a duplicate removes that object"));
+    CONTAINER_CLEAR(c, NULL, NULL);
+    CONTAINER_FREE(c);
+}
+free(idx);
+free(vals);
+
+snmp_shutdown(test_name);
@@ -0,0 +1,125 @@
+/* HEADER Testing the hash container */
+
+static const char test_name[] = "hash-container-test";
+#define H_ENTRIES   5000
+#define H_STEP      7919          /* coprime with H_ENTRIES */
+oid *vals, prefix_val[1];
+netsnmp_index *idx, *ip, prefix;
+netsnmp_container *c;
+netsnmp_iterator *it;
+netsnmp_void_array *va;
+size_t i, k, n;
+int ok, sorted;
+
+init_snmp(test_name);
+
+/*
+ * strings
+ */
+c = netsnmp_container_find("hash");
+OKF(c != NULL, ("hash container found in the factory"));
+if (c) {
+    c->compare = netsnmp_compare_direct_cstring;
+    CONTAINER_INSERT(c, "foo");
+    CONTAINER_INSERT(c, "bar");
+    CONTAINER_INSERT(c, "baz");
+    OKF(CONTAINER_FIND(c, "bar") != NULL && CONTAINER_FIND(c, "foobar") == NULL,
+        ("string lookups"));
+    OKF(CONTAINER_INSERT(c, "bar") != 0, ("duplicate insert refused"));
+    OKF(strcmp(CONTAINER_FIRST(c), "bar") == 0 &&
+        strcmp(CONTAINER_NEXT(c, "bar"), "baz") == 0 &&
+        strcmp(CONTAINER_NEXT(c, "baz"), "foo") == 0 &&
+        CONTAINER_NEXT(c, "foo") == NULL, ("strings walked in order"));
+    CONTAINER_REMOVE(c, "bar");
+    OKF(CONTAINER_FIND(c, "bar") == NULL && CONTAINER_SIZE(c) == 2 &&
+        strcmp(CONTAINER_FIRST(c), "baz") == 0, ("string removed"));
+    CONTAINER_FREE(c);
+}
+
+/*
+ * a compare routine without a known hash needs one set explicitly
+ */
+c = netsnmp_container_find("hash");
+c->compare = (netsnmp_container_compare*) strcmp;
+OKF(CONTAINER_INSERT(c, "foo") != 0, ("no hash function, no insert"));
+OKF(netsnmp_container_hash_set_func(c, netsnmp_hash_direct_cstring) == 0 &&
+    CONTAINER_INSERT(c, "foo") == 0 && CONTAINER_FIND(c, "foo") != NULL,
+    ("insert with an explicit hash function"));
+CONTAINER_FREE(c);
+
+/*
+ * indexes
+ */
+vals = (oid *) malloc(H_ENTRIES * 2 * sizeof(oid));
+idx = (netsnmp_index *) malloc(H_ENTRIES * sizeof(netsnmp_index));
+c = netsnmp_container_find("hash");
+if (c && vals && idx) {
+    c->ncompare = netsnmp_ncompare_netsnmp_index;
+    for (i = 0; i < H_ENTRIES; ++i) {
+        vals[2 * i] = i / 100;
+        vals[2 * i + 1] = i % 100;
+        idx[i].oids = &vals[2 * i];
+        idx[i].len = 2;
+    }
+    n = 0;
+    for (i = 0, k = 0; i < H_ENTRIES; ++i, k = (k + H_STEP) % H_ENTRIES)
+        if (CONTAINER_INSERT(c, &idx[k]) == 0)
+            ++n;
+    OKF(n == H_ENTRIES && CONTAINER_SIZE(c) == H_ENTRIES,
+        ("inserted %" NETSNMP_PRIz "d entries", CONTAINER_SIZE(c)));
+
+    ok = 1;
+    for (i = 0; i < H_ENTRIES; ++i)
+        if (CONTAINER_FIND(c, &idx[i]) != &idx[i])
+            ok = 0;
+    OKF(ok, ("find locates every entry"));
+
+    sorted = 1;
+    for (n = 0, ip = CONTAINER_FIRST(c); ip; ip = CONTAINER_NEXT(c, ip), ++n)
+        if (ip != &idx[n])
+            sorted = 0;
+    OKF(sorted && n == H_ENTRIES, ("find_next walks all entries in order"));
+
+    prefix_val[0] = 42;
+    prefix.oids = prefix_val;
+    prefix.len = 1;
+    va = CONTAINER_GET_SUBSET(c, &prefix);
+    OKF(va && va->size == 100 && va->array[0] == &idx[4200],
+        ("get_subset returns one prefix"));
+    if (va) {
+        free(va->array);
+        free(va);
+    }
+
+    /*
+     * removals invalidate the sorted index, which must be rebuilt
+     */
+    for (i = 1; i < H_ENTRIES; i += 2)
+        CONTAINER_REMOVE(c, &idx[i]);
+    OKF(CONTAINER_SIZE(c) == H_ENTRIES / 2 && CONTAINER_FIND(c, &idx[1]) == NULL &&
+        CONTAINER_REMOVE(c, &idx[1]) != 0, ("removals"));
+    it = CONTAINER_ITERATOR(c);
+    sorted = 1;
+    for (n = 0, ip = ITERATOR_FIRST(it); ip; ip = ITERATOR_NEXT(it), ++n)
+        if (ip != &idx[2 * n])
+            sorted = 0;
+    OKF(sorted && n == H_ENTRIES / 2, ("iterator walks the rest in order"));
+
+    /*
+     * changing the container leaves the iterator out of sync
+     */
+    CONTAINER_INSERT(c, &idx[1]);
+    OKF(ITERATOR_FIRST(it) == NULL, ("iterator out of sync after insert"));
+    ITERATOR_RELEASE(it);
+    OKF(CONTAINER_NEXT(c, &idx[0]) == &idx[1], ("new entry sorted in"));
+
+    CONTAINER_CLEAR(c, NULL, NULL);
+    OKF(CONTAINER_SIZE(c) == 0 && CONTAINER_FIRST(c) == NULL &&
+        CONTAINER_FIND(c, &idx[0]) == NULL, ("cleared"));
+}
+if (c)
+    CONTAINER_FREE(c);
+free(idx);
+free(vals);
+
+snmp_shutdown(test_name);
@@ -0,0 +1,100 @@
+/* HEADER Testing table_data row storage */
+
+#define TD_ROWS  1000
+#define TD_STEP  7919           /* coprime with TD_ROWS */
+netsnmp_table_data *table;
+netsnmp_table_row *row, *next;
+oid     search[1];
+int32_t ival;
+long    i, k, n;
+int     ok, sorted;
+
+init_agent("snmpd");
+init_snmp("snmpd");
+
+table = netsnmp_create_table_data("table_data unit-test");
+OK(table != NULL, "table data creation");
+netsnmp_table_data_add_index(table, ASN_INTEGER);
+
+/*
+ * insertion in a scrambled order
+ */
+n = 0;
+for (i = 0, k = 0; i < TD_ROWS; ++i, k = (k + TD_STEP) % TD_ROWS) {
+    row = netsnmp_create_table_data_row();
+    ival = k;
+    netsnmp_table_row_add_index(row, ASN_INTEGER, &ival, sizeof(ival));
+    if (netsnmp_table_data_add_row(table, row) == SNMPERR_SUCCESS)
+        ++n;
+    else
+        netsnmp_table_data_delete_row(row);
+}
+OKF(n == TD_ROWS && netsnmp_table_data_num_rows(table) == TD_ROWS,
+    ("inserted %ld rows", n));
+
+row = netsnmp_create_table_data_row();
+ival = 42;
+netsnmp_table_row_add_index(row, ASN_INTEGER, &ival, sizeof(ival));
+OK(netsnmp_table_data_add_row(table, row) != SNMPERR_SUCCESS,
+   "duplicate row refused");
+netsnmp_table_data_delete_row(row);
+
+/*
+ * walk
+ */
+sorted = 1;
+for (n = 0, row = netsnmp_table_data_get_first_row(table); row;
+     row = netsnmp_table_data_get_next_row(table, row), ++n)
+    if (row->index_oid_len != 1 || row->index_oid[0] != (oid) n)
+        sorted = 0;
+OKF(sorted && n == TD_ROWS, ("rows walked in order"));
+
+/*
+ * lookups
+ */
+ok = 1;
+for (i = 0, k = 0; i < TD_ROWS; ++i, k = (k + TD_STEP) % TD_ROWS) {
+    search[0] = k;
+    row = netsnmp_table_data_get_from_oid(table, search, 1);
+    if (!row || row->index_oid[0] != (oid) k)
+        ok = 0;
+}
+OK(ok, "every row found by index");
+search[0] = TD_ROWS;
+OK(netsnmp_table_data_get_from_oid(table, search, 1) == NULL,
+   "missing row not found");
+search[0] = 42;
+row = netsnmp_table_data_get_from_oid(table, search, 1);
+OK(row && row->prev && row->prev->index_oid[0] == 41 &&
+   row->next && row->next->index_oid[0] == 43, "rows linked in order");
+
+/*
+ * removal of every other row
+ */
+for (row = netsnmp_table_data_get_first_row(table); row; row = next) {
+    next = row->next;
+    if (row->index_oid[0] & 1)
+        netsnmp_table_data_remove_and_delete_row(table, row);
+}
+search[0] = 41;
+OKF(netsnmp_table_data_num_rows(table) == TD_ROWS / 2 &&
+    netsnmp_table_data_get_from_oid(table, search, 1) == NULL,
+    ("rows removed"));
+
+row = netsnmp_create_table_data_row();
+ival = 41;
+netsnmp_table_row_add_index(row, ASN_INTEGER, &ival, sizeof(ival));
+OK(netsnmp_table_data_add_row(table, row) == SNMPERR_SUCCESS &&
+   row->prev && row->prev->index_oid[0] == 40 &&
+   row->next && row->next->index_oid[0] == 42, "row linked in place");
+
+for (row = netsnmp_table_data_get_first_row(table); row; row = next) {
+    next = row->next;
+    netsnmp_table_data_remove_and_delete_row(table, row);
+}
+OK(netsnmp_table_data_num_rows(table) == 0 &&
+   netsnmp_table_data_get_first_row(table) == NULL, "table emptied");
+netsnmp_table_data_delete_table(table);
+
+snmp_shutdown("snmpd");
+shutdown_agent();
@@ -0,0 +1,116 @@
+/*
+ * HEADER Testing the cache handler's stale-while-revalidate mode
+ */
+
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+#include <net-snmp/library/testing.h>
+
+static int loads;
+
+static int
+test_load(netsnmp_cache *cache, void *magic)
+{
+    ++loads;
+    return 0;
+}
+
+static void
+test_free(netsnmp_cache *cache, void *magic)
+{
+}
+
+/*
+ * make the cache look as if it had been loaded age seconds ago
+ */
+static void
+age_cache(netsnmp_cache *cache, int age)
+{
+    ((struct timeval *) cache->timestampM)->tv_sec -= age;
+}
+
+/*
+ * run the main loop's alarms until the pending background reload is done
+ */
+static void
+run_reload(netsnmp_cache *cache)
+{
+    int             tries;
+
+    for (tries = 0; cache->reload_id != 0 && tries < 100; tries++) {
+        run_alarms();
+        if (cache->reload_id != 0)
+            usleep(1000);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const oid Oid[] = { 1, 3, 6, 1, 3, 327 }; /* experimental.327 */
+    netsnmp_cache  *cache;
+
+    init_agent("snmpd");
+    init_snmp("snmpd");
+
+    cache = netsnmp_cache_create(10, test_load, test_free, Oid,
+                                 OID_LENGTH(Oid));
+    OK(cache != NULL, "cache created");
+    if (cache) {
+        cache->flags |= NETSNMP_CACHE_STALE_WHILE_REVALIDATE;
+        cache->max_stale = 20;
+
+        netsnmp_cache_check_and_reload(cache);
+        OKF(loads == 1 && cache->valid, ("first use loads the cache"));
+        netsnmp_cache_check_and_reload(cache);
+        OKF(loads == 1, ("fresh cache is used as it is"));
+
+        /*
+         * expired, but within max_stale
+         */
+        age_cache(cache, 15);
+        netsnmp_cache_check_and_reload(cache);
+        OKF(loads == 1 && cache->valid && cache->reload_id != 0,
+            ("expired cache is served, reload scheduled"));
+        netsnmp_cache_check_and_reload(cache);
+        OKF(loads == 1, ("no second reload while one is pending"));
+        run_reload(cache);
+        OKF(loads == 2 && cache->reload_id == 0 &&
+            !netsnmp_cache_check_expired(cache),
+            ("reload done from the main loop (%d loads)", loads));
+
+        /*
+         * past timeout + max_stale: too old to be served
+         */
+        age_cache(cache, 35);
+        netsnmp_cache_check_and_reload(cache);
+        OKF(loads == 3 && cache->reload_id == 0 &&
+            !netsnmp_cache_check_expired(cache),
+            ("cache past max_stale is loaded before use (%d loads)", loads));
+
+        /*
+         * max_stale 0 means another timeout period
+         */
+        cache->max_stale = 0;
+        age_cache(cache, 15);
+        netsnmp_cache_check_and_reload(cache);
+        OKF(loads == 3 && cache->reload_id != 0,
+            ("default max_stale: expired cache is served"));
+        run_reload(cache);
+        age_cache(cache, 25);
+        netsnmp_cache_check_and_reload(cache);
+        OKF(loads == 5 && cache->reload_id == 0,
+            ("default max_stale: loaded before use after two timeouts "
+             "(%d loads)", loads));
+
+        netsnmp_cache_remove(cache);
+        netsnmp_cache_free(cache);
+    }
+
+    snmp_shutdown("snmpd");
+    shutdown_agent();
+
+    PLAN(__test_counter);
+    return 0;
+}
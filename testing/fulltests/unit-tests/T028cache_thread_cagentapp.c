@@ -0,0 +1,150 @@
+/*
+ * HEADER Testing the cache handler's thread safe loads
+ */
+
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+#include <net-snmp/library/testing.h>
+#ifdef NETSNMP_REENTRANT
+#include <pthread.h>
+#endif
+
+typedef struct {
+    int             generation;
+    int             off_thread;
+} test_contents;
+
+static int loads, frees;
+#ifdef NETSNMP_REENTRANT
+static pthread_t main_thread;
+#endif
+
+static int
+test_load(netsnmp_cache *cache, void *magic)
+{
+    test_contents  *contents;
+
+    if (NULL != cache->magic)
+        return -1;              /* must start out empty */
+    contents = SNMP_MALLOC_TYPEDEF(test_contents);
+    if (NULL == contents)
+        return -1;
+    contents->generation = ++loads;
+#ifdef NETSNMP_REENTRANT
+    contents->off_thread = !pthread_equal(pthread_self(), main_thread);
+#endif
+    cache->magic = contents;
+    return 0;
+}
+
+static void
+test_free(netsnmp_cache *cache, void *magic)
+{
+    ++frees;
+    free(magic);
+}
+
+/*
+ * make the cache look as if it had been loaded age seconds ago
+ */
+static void
+age_cache(netsnmp_cache *cache, int age)
+{
+    ((struct timeval *) cache->timestampM)->tv_sec -= age;
+}
+
+static int
+generation(netsnmp_cache *cache)
+{
+    return cache->magic ? ((test_contents *) cache->magic)->generation : 0;
+}
+
+#ifdef NETSNMP_REENTRANT
+/*
+ * run the main loop's alarms and file descriptor callbacks until the
+ * contents have been replaced, or for at most 5 seconds
+ */
+static void
+run_main_loop(netsnmp_cache *cache, int old_generation)
+{
+    fd_set          readfds, writefds, exceptfds;
+    struct timeval  timeout;
+    int             numfds, count, tries;
+
+    for (tries = 0; generation(cache) == old_generation && tries < 500;
+         tries++) {
+        run_alarms();
+        numfds = 0;
+        FD_ZERO(&readfds);
+        FD_ZERO(&writefds);
+        FD_ZERO(&exceptfds);
+        netsnmp_external_event_info(&numfds, &readfds, &writefds,
+                                    &exceptfds);
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 10000;
+        count = select(numfds, &readfds, &writefds, &exceptfds, &timeout);
+        if (count > 0)
+            netsnmp_dispatch_external_events(&count, &readfds, &writefds,
+                                             &exceptfds);
+    }
+}
+#endif
+
+int
+main(int argc, char *argv[])
+{
+    static const oid Oid[] = { 1, 3, 6, 1, 3, 328 }; /* experimental.328 */
+    netsnmp_cache  *cache;
+
+#ifdef NETSNMP_REENTRANT
+    main_thread = pthread_self();
+#endif
+    init_agent("snmpd");
+    init_snmp("snmpd");
+
+    cache = netsnmp_cache_create(10, test_load, test_free, Oid,
+                                 OID_LENGTH(Oid));
+    OK(cache != NULL, "cache created");
+    if (cache) {
+        cache->flags |= NETSNMP_CACHE_LOAD_THREAD_SAFE;
+
+        netsnmp_cache_check_and_reload(cache);
+        OKF(cache->valid && generation(cache) == 1 && frees == 0,
+            ("first load installs fresh contents"));
+
+        age_cache(cache, 15);
+        netsnmp_cache_check_and_reload(cache);
+        OKF(generation(cache) == 2 && frees == 1,
+            ("reload replaces the contents and frees the old ones"));
+
+#ifdef NETSNMP_REENTRANT
+        /*
+         * expired, served stale: the reload is done by a worker thread
+         */
+        cache->flags |= NETSNMP_CACHE_STALE_WHILE_REVALIDATE;
+        age_cache(cache, 15);
+        netsnmp_cache_check_and_reload(cache);
+        OKF(generation(cache) == 2 && frees == 1,
+            ("expired contents are kept until the reload is done"));
+        run_main_loop(cache, 2);
+        OKF(generation(cache) == 3 && frees == 2,
+            ("contents built in the background are installed (%d loads)",
+             loads));
+        OKF(((test_contents *) cache->magic)->off_thread,
+            ("contents were built off the main thread"));
+        OKF(NULL == cache->load_job && !netsnmp_cache_check_expired(cache),
+            ("cache is fresh after the install"));
+#endif
+
+        netsnmp_cache_remove(cache);
+        netsnmp_cache_free(cache);
+        OKF(frees == loads, ("the last contents are freed with the cache"));
+    }
+
+    snmp_shutdown("snmpd");
+    shutdown_agent();
+
+    PLAN(__test_counter);
+    return 0;
+}
@@ -109,6 +109,14 @@ SOURCE=..\..\snmplib\container_binary_array.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\snmplib\container_btree.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\snmplib\container_hash.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\snmplib\container_iterator.c
 # End Source File
 # Begin Source File